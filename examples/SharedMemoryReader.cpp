@@ -0,0 +1,78 @@
+/**
+ * @file SharedMemoryReader.cpp
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Example of an external tool reading the emulator state from shared memory.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ *
+ * Usage: SharedMemoryReader [/name]
+ * Run the emulator with the export enabled first (NES Settings window or use --headless --shm /use-nes ...).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "SharedMemoryLayout.h"
+
+int main(int argc, char ** argv) {
+
+    std::string name = argc > 1 ? argv[1] : "/use-nes";
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0) {
+        std::fprintf(stderr, "Region %s doesn't exist, is the export enabled?\n", name.c_str());
+        return 1;
+    }
+
+    void * region = mmap(nullptr, sizeof(SharedMemory::Layout), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(region == MAP_FAILED) {
+        std::fprintf(stderr, "Region %s couldn't be mapped.\n", name.c_str());
+        return 1;
+    }
+
+    const auto & layout = *static_cast<const SharedMemory::Layout *>(region);
+    if(layout.magic != SharedMemory::MAGIC || layout.version != SharedMemory::VERSION) {
+        std::fprintf(stderr, "Region %s has an unknown format.\n", name.c_str());
+        return 1;
+    }
+
+    uint64_t lastFrame = 0;
+    while(true) {
+
+        // Everything is computed in place; the values are only used if the snapshot was consistent.
+        uint64_t frameNumber = 0;
+        double luma = 0, rms = 0;
+        uint8_t ram0 = 0;
+
+        bool consistent = SharedMemory::read(layout, [&](const SharedMemory::Layout & data) {
+
+            frameNumber = data.frameNumber;
+            ram0 = data.ram[0];
+
+            uint64_t sum = 0;
+            size_t pixelCount = static_cast<size_t>(data.frameWidth) * data.frameHeight;
+            for(size_t i = 0; i < pixelCount * 3; i++)
+                sum += data.frame[i];
+            luma = pixelCount ? static_cast<double>(sum) / (pixelCount * 3) : 0;
+
+            double energy = 0;
+            for(uint32_t i = 0; i < data.audioSampleCount; i++)
+                energy += data.audio[i] * data.audio[i];
+            rms = data.audioSampleCount ? std::sqrt(energy / data.audioSampleCount) : 0;
+        });
+
+        if(consistent && frameNumber != lastFrame) {
+            std::printf("Frame %llu: mean level %.1f, RAM[0] = $%02X, audio RMS %.4f\n",
+                        static_cast<unsigned long long>(frameNumber), luma, ram0, rms);
+            std::fflush(stdout);
+            lastFrame = frameNumber;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+}
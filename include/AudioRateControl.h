@@ -0,0 +1,65 @@
+/**
+ * @file AudioRateControl.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Dynamic rate control of a real-time audio buffer.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_AUDIORATECONTROL_H
+#define USE_AUDIORATECONTROL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Dynamic rate control of a real-time audio buffer, independent of the audio backend (used by Sound).
+ *
+ * The sample producer multiplies its sample rate by the rate ratio, which is linearly mapped from the distance
+ * of the buffer fill level to the target and limited to 1 +- the maximal deviation. The buffer fill level
+ * thus settles near the target even if the audio device clock differs from the emulation clock.
+ *
+ * The buffer reports the reads of the audio device (the underruns are counted there, it may be another thread)
+ * and the frames it had to drop (overruns).
+ * */
+class AudioRateControl {
+
+private:
+    size_t m_targetFrames;
+    double m_maxDeviation;
+
+    /// Count of device reads with not enough frames buffered.
+    std::atomic<uint64_t> m_underruns = 0;
+    /// Count of writes dropped because the buffer was full.
+    std::atomic<uint64_t> m_overruns = 0;
+
+public:
+    /**
+     * @param targetFrames Buffer fill level to keep.
+     * @param maxDeviation Maximal deviation of the rate ratio from 1 (e.g. 0.005 = 0.5 %).
+     * */
+    AudioRateControl(size_t targetFrames, double maxDeviation);
+
+    /**
+     * Record a read of the audio device, counted as an underrun if there are not enough frames.
+     * @param bufferedFrames Frames available in the buffer.
+     * @param requestedFrames Frames requested by the device.
+     * */
+    void read(size_t bufferedFrames, size_t requestedFrames);
+
+    /// Record a write dropped because the buffer was full.
+    void overrun();
+
+    /**
+     * Get the ratio by which the sample producer should multiply the sample rate.
+     * @param bufferedFrames Current buffer fill level.
+     * @return Rate ratio, more than 1 if the buffer is below the target, less than 1 if above.
+     * */
+    [[nodiscard]] double getRateRatio(size_t bufferedFrames) const;
+
+    [[nodiscard]] size_t getTargetFrames() const;
+    [[nodiscard]] uint64_t getUnderruns() const;
+    [[nodiscard]] uint64_t getOverruns() const;
+};
+
+#endif //USE_AUDIORATECONTROL_H
@@ -0,0 +1,104 @@
+/**
+ * @file AudioSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Audio output abstraction.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_AUDIOSINK_H
+#define USE_AUDIOSINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Types.h"
+
+/**
+ * Audio output abstraction.
+ *
+ * The sample producer (Emulator or a headless runner) periodically calls writeFrames according to the sample rate,
+ * the sink takes a single frame from every source and outputs them somewhere: a sound device (Sound),
+ * a file (WavAudioSink), memory (MemoryAudioSink) or nowhere (NullAudioSink).
+ * */
+class AudioSink {
+
+public:
+    /// Buffer monitoring data.
+    struct Statistics {
+        size_t bufferedFrames;
+        size_t bufferSize;
+        uint64_t underruns;
+        uint64_t overruns;
+        double rateRatio;
+    };
+
+    virtual ~AudioSink() = default;
+
+    /// Start the output.
+    virtual void start() {}
+
+    /// Stop the output.
+    virtual void stop() {}
+
+    /**
+     * Take a single audio frame from every source and output it.
+     *
+     * @param sources Sound sources to take frames from.
+     * */
+    virtual void writeFrames(const SoundSampleSources & sources) = 0;
+
+    /**
+     * Get count of audio frames waiting in the output buffer to be played.
+     * @return Buffered frames, 0 if the sink is not real-time.
+     * */
+    [[nodiscard]] virtual size_t getBufferedFrames() const { return 0; }
+
+    /**
+     * Get count of audio frames which should be kept in the output buffer.
+     * @return Optimal buffer fill level, 0 if the sink is not real-time.
+     * */
+    [[nodiscard]] virtual size_t getTargetBufferedFrames() const { return 0; }
+
+    /**
+     * Get the ratio by which the sample producer should multiply the sample rate (see Sound).
+     * @return Rate ratio, 1 if the sink consumes any amount of frames.
+     * */
+    [[nodiscard]] virtual double getRateRatio() const { return 1.0; }
+
+    /**
+     * Get buffer monitoring data.
+     * @return Buffer fill, underrun and overrun counters.
+     * */
+    [[nodiscard]] virtual Statistics getStatistics() const {
+        return {.bufferedFrames = 0, .bufferSize = 0, .underruns = 0, .overruns = 0, .rateRatio = 1.0};
+    }
+
+protected:
+    /**
+     * Mix all the sources into a single frame.
+     * @param sources Sound sources to take frames from.
+     * @return Sum of the frames.
+     * */
+    static SoundStereoFrame mix(const SoundSampleSources & sources) {
+
+        SoundStereoFrame mixed{0, 0};
+        for(auto & getSample : sources) {
+            SoundStereoFrame frame = getSample();
+            mixed.left += frame.left;
+            mixed.right += frame.right;
+        }
+
+        return mixed;
+    }
+};
+
+/**
+ * Audio sink which discards everything.
+ * Used if there is no sound device available. The sources are not even evaluated.
+ * */
+class NullAudioSink : public AudioSink {
+
+public:
+    void writeFrames(const SoundSampleSources & /*sources*/) override {}
+};
+
+#endif //USE_AUDIOSINK_H
@@ -58,6 +58,8 @@ public:
 
     /**
      * Store a data interface.
+     * @note The ports keep a reference to the stored interface, so the kind of the interface (data/signal)
+     * must not change while the connector is connected.
      * @param interface Data interface to store.
      * */
     void setInterface(DataInterface interface);
@@ -12,6 +12,7 @@
 #include <memory>
 #include <map>
 #include "Sound.h"
+#include "FramePacer.h"
 #include "System.h"
 #include "ImInputBinder.h"
 
@@ -32,20 +33,40 @@ private:
     // ===========================================
     enum class SYSTEMS { NONE, BARE6502, NES } m_systemID = SYSTEMS::NONE;
     enum class STATE { STOPPED, RUNNING } m_runState = STATE::STOPPED;
+    enum class FASTFORWARD { OFF, X2, X4, X8, UNCAPPED } m_fastForward = FASTFORWARD::OFF;
+
+    // ===========================================
+    // Constants
+    // ===========================================
+    /// Frames skipped after every rendered frame in the uncapped fast-forward mode.
+    static constexpr unsigned int UNCAPPED_FRAME_SKIP = 15;
+    /// Part of the GUI frame time used for the emulation in the uncapped fast-forward mode.
+    static constexpr float UNCAPPED_TIME_BUDGET = 0.8f;
+    /// Count of clocks emulated between two time checks in the uncapped fast-forward mode.
+    static constexpr unsigned int UNCAPPED_CLOCK_CHUNK = 1024;
+    /// Fixed-point scale of the sample timer, so the rate ratio of the sound rate control can be applied.
+    static constexpr uint64_t SAMPLE_TIMER_SCALE = 1000;
 
     // ===========================================
     // Widgets, plug-ins and other components
     // ===========================================
     std::unique_ptr<System> m_system;
-    std::unique_ptr<Sound> m_sound;
+    std::unique_ptr<AudioSink> m_sound;
+    std::unique_ptr<FramePacer> m_pacer;
+    bool m_syncToAudio = false;
     ImInputBinder m_inputs;
     bool m_showBindingsWindow = false;
 
     // ===========================================
     // Helpers
     // ===========================================
-    /// Used to keep track of elapsed clocks to sync emulation with sound output.
-    unsigned long long m_clockCounter = 0;
+    /**
+     * Used to keep track of elapsed clocks to sync emulation with sound output.
+     * Incremented by the (rate controlled) sample rate every clock, a sample is due when it reaches the clock rate
+     * (multiplied by the fast-forward factor), so the fractional clocks per sample are not lost.
+     * Both values are multiplied by SAMPLE_TIMER_SCALE.
+     * */
+    unsigned long long m_sampleTimer = 0;
     /**
      * This function maps DockSpace enum to string, which is used by ImGui docking feature.
      *
@@ -63,6 +84,19 @@ private:
     /// Generate keybindings savefile name.
     std::string getKeybindingsSaveFileName() const;
 
+    /**
+     * Get the speed multiplier of the fast-forward mode.
+     * @param mode Fast-forward mode.
+     * @return Speed multiplier, 0 if the speed is uncapped.
+     * */
+    static unsigned int fastForwardFactor(FASTFORWARD mode);
+
+    /**
+     * Change the fast-forward mode and set the frame skipping of the running System accordingly.
+     * @param mode New fast-forward mode.
+     * */
+    void setFastForward(FASTFORWARD mode);
+
     // ===========================================
     // System handling
     // ===========================================
@@ -73,10 +107,13 @@ private:
     void loadSystem(std::unique_ptr<System> system);
 
     /**
-     * Emulate the System if enabled.
+     * Emulate the System if enabled. Stops when the System hits a breakpoint.
      * */
     void runSystem();
 
+    /// Stop running the System (and its sound output).
+    void stopSystem();
+
     // ===========================================
     // GUI callbacks
     // ===========================================
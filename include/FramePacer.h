@@ -0,0 +1,154 @@
+/**
+ * @file FramePacer.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Wall-clock emulation pacing.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_FRAMEPACER_H
+#define USE_FRAMEPACER_H
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Emulation pacing.
+ *
+ * FramePacer calculates how many System clocks should be emulated to keep the emulated time in sync with
+ * the real time. It is driven by a monotonic std::chrono::steady_clock timeline instead of the GUI framerate
+ * estimate, so the emulation speed does not depend on the GUI refresh rate.
+ *
+ * The elapsed time is converted to clocks using integer arithmetic and the remainder of the division
+ * is kept in a fractional accumulator, so no clocks are lost between the calls and the emulated time
+ * does not drift from the real time, regardless of the running time.
+ *
+ * Two pacing modes are available:
+ * - Wall clock: clocks are derived from the elapsed real time.
+ * - Audio: clocks are derived from the missing amount of audio frames in the output buffer, so the audio device
+ *   is the master clock. This avoids audio buffer under/overruns caused by the audio device clock being slightly
+ *   different from the system clock.
+ *
+ * How to use this class:
+ * 1) Construct using System's clock rate.
+ * 2) Call start() when the emulation is started (or resumed).
+ * 3) Periodically call clocksDue() and emulate the returned number of clocks.
+ * */
+class FramePacer {
+
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    /// Pacing source.
+    enum class MODE {
+        WALLCLOCK,  ///< Pace by the elapsed real time.
+        AUDIO       ///< Pace by the audio buffer fill level.
+    };
+
+private:
+    static constexpr uint64_t NS_PER_SECOND = 1'000'000'000;
+
+    /// Default maximal amount of real time which is caught up at once.
+    static constexpr std::chrono::milliseconds DEFAULT_MAX_CATCH_UP{100};
+
+    MODE m_mode = MODE::WALLCLOCK;
+
+    /// System clock rate in Hz.
+    uint64_t m_clockRate;
+    /// Speed multiplier.
+    unsigned int m_speed = 1;
+
+    /// Time of the last clocksDue() call.
+    clock_t::time_point m_lastUpdate;
+    /// Fractional accumulator: remainder of (elapsed ns * clock rate) not yet converted to whole clocks, in clock-nanoseconds.
+    uint64_t m_clockRemainder = 0;
+    /// If the elapsed time exceeds this value (e.g. window was dragged or debugger stopped the process), the rest is dropped.
+    std::chrono::nanoseconds m_maxCatchUp = DEFAULT_MAX_CATCH_UP;
+    /// Total real time dropped because of the catch-up limit.
+    std::chrono::nanoseconds m_droppedTime{0};
+
+    /// Audio sample rate used by the audio mode.
+    uint64_t m_sampleRate = 0;
+    /// Audio buffer fill level to keep in the audio mode.
+    uint64_t m_targetFrames = 0;
+    /// Fractional accumulator of the audio mode: remainder of (frames * clock rate) not yet converted to clocks.
+    uint64_t m_audioRemainder = 0;
+
+public:
+    /**
+     * Create pacer for a System with specified clock rate.
+     * @param clockRate System clock rate in Hz.
+     * */
+    explicit FramePacer(uint64_t clockRate);
+
+    /**
+     * Start a new timeline from the current time. Call whenever the emulation is (re)started,
+     * so the time spent in the stopped state is not caught up.
+     * */
+    void start();
+
+    /**
+     * Start a new timeline from the specified time.
+     * @param now Starting point.
+     * */
+    void start(clock_t::time_point now);
+
+    /**
+     * Get the number of clocks to emulate to catch up with the real time.
+     * @return Number of clocks.
+     * */
+    uint64_t clocksDue();
+
+    /**
+     * Get the number of clocks to emulate to catch up with the specified time.
+     * @param now Current time.
+     * @return Number of clocks.
+     * */
+    uint64_t clocksDue(clock_t::time_point now);
+
+    /**
+     * Get the number of clocks to emulate to refill the audio buffer to the target level.
+     * The wall-clock timeline is updated as well, so the mode can be switched at any time.
+     *
+     * @param bufferedFrames Count of audio frames currently waiting in the output buffer.
+     * @return Number of clocks.
+     * */
+    uint64_t clocksDueAudio(uint64_t bufferedFrames);
+
+    /**
+     * Set the System clock rate. The fractional accumulators are reset.
+     * @param clockRate Clock rate in Hz.
+     * */
+    void setClockRate(uint64_t clockRate);
+
+    /**
+     * Set the speed multiplier (used by fast-forward).
+     * @param speed Multiplier, 1 = real time.
+     * */
+    void setSpeed(unsigned int speed);
+
+    /**
+     * Set the maximal amount of real time caught up by a single clocksDue call.
+     * @param maxCatchUp Catch-up limit.
+     * */
+    void setMaxCatchUp(std::chrono::nanoseconds maxCatchUp);
+
+    /**
+     * Configure and enable the audio mode.
+     * @param sampleRate Audio sample rate in Hz.
+     * @param targetFrames Amount of audio frames to keep in the output buffer.
+     * */
+    void setAudioMaster(uint64_t sampleRate, uint64_t targetFrames);
+
+    /**
+     * Select the pacing mode.
+     * @param mode Pacing mode.
+     * */
+    void setMode(MODE mode);
+
+    [[nodiscard]] MODE getMode() const;
+
+    /// Get total real time dropped because of the catch-up limit.
+    [[nodiscard]] std::chrono::nanoseconds getDroppedTime() const;
+};
+
+#endif //USE_FRAMEPACER_H
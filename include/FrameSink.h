@@ -0,0 +1,49 @@
+/**
+ * @file FrameSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Video output abstraction.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_FRAMESINK_H
+#define USE_FRAMESINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Types.h"
+
+/**
+ * Non-owning view of a finished video frame.
+ * Pixels are stored by rows (pixels[x + y * width]).
+ * */
+struct VideoFrame {
+    const RGBPixel * pixels = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    /// Number of the frame since the power-on (including skipped frames), starting at 1.
+    uint64_t number = 0;
+};
+
+/**
+ * Video output abstraction.
+ *
+ * The System hands every composed frame to all the registered sinks (see System::addFrameSink).
+ * The frame is not copied: the view points directly to the GPU frame buffer and is only valid
+ * during the onFrame call. A sink which needs the data later has to copy it or keep the view
+ * only until the emulation continues (e.g. GUI rendering between two emulation runs).
+ *
+ * onFrame is called from the emulation loop, so it has to be fast and must never block.
+ * */
+class FrameSink {
+
+public:
+    virtual ~FrameSink() = default;
+
+    /**
+     * Process a finished frame.
+     * @param frame Frame data.
+     * */
+    virtual void onFrame(const VideoFrame & frame) = 0;
+};
+
+#endif //USE_FRAMESINK_H
@@ -0,0 +1,37 @@
+/**
+ * @file GuiFrameSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Video output to a GUI window.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_GUIFRAMESINK_H
+#define USE_GUIFRAMESINK_H
+
+#include "FrameSink.h"
+
+/**
+ * Frame sink rendering the last finished frame in an ImGui window.
+ *
+ * Only the view is kept, no pixels are copied: the GUI is rendered between two emulation runs,
+ * when the GPU front buffer holds exactly the last emitted frame.
+ * */
+class GuiFrameSink : public FrameSink {
+
+private:
+    VideoFrame m_frame;
+
+public:
+    void onFrame(const VideoFrame & frame) override;
+
+    /**
+     * Render the last frame into the current ImGui window.
+     * @param scale Scale of the picture.
+     * */
+    void render(float scale = 1.0f) const;
+
+    /// Get the last frame view, its pixels are null if there was no frame yet.
+    [[nodiscard]] const VideoFrame & getFrame() const;
+};
+
+#endif //USE_GUIFRAMESINK_H
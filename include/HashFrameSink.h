@@ -0,0 +1,54 @@
+/**
+ * @file HashFrameSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Video output hashing.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_HASHFRAMESINK_H
+#define USE_HASHFRAMESINK_H
+
+#include <vector>
+#include "FrameSink.h"
+
+/**
+ * Frame sink computing FNV-1a hashes of the frames, useful for regression checks.
+ * */
+class HashFrameSink : public FrameSink {
+
+private:
+    bool m_keepHashes;
+    std::vector<uint64_t> m_hashes;
+    uint64_t m_lastHash = 0;
+    uint64_t m_combinedHash = 0xcbf29ce484222325;
+    uint64_t m_frameCount = 0;
+
+public:
+    /**
+     * @param keepHashes Store the hash of every frame (see getHashes).
+     * */
+    explicit HashFrameSink(bool keepHashes = false);
+
+    void onFrame(const VideoFrame & frame) override;
+
+    /**
+     * Compute FNV-1a hash of the frame pixels.
+     * @param frame Frame to hash.
+     * @return 64-bit hash.
+     * */
+    [[nodiscard]] static uint64_t hash(const VideoFrame & frame);
+
+    /// Get hash of the last frame.
+    [[nodiscard]] uint64_t getLastHash() const;
+
+    /// Get a single hash of all the frames so far.
+    [[nodiscard]] uint64_t getCombinedHash() const;
+
+    /// Get hashes of all the frames, empty if not kept.
+    [[nodiscard]] const std::vector<uint64_t> & getHashes() const;
+
+    /// Get count of hashed frames.
+    [[nodiscard]] uint64_t getFrameCount() const;
+};
+
+#endif //USE_HASHFRAMESINK_H
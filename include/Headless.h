@@ -0,0 +1,173 @@
+/**
+ * @file Headless.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Emulation without GUI.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_HEADLESS_H
+#define USE_HEADLESS_H
+
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include "AudioSink.h"
+#include "WavAudioSink.h"
+#include "HashFrameSink.h"
+#include "StreamFrameSink.h"
+#include "PerfCounters.h"
+#include "StateHasher.h"
+#include "systems/NES.h"
+#include "systems/StaticNES.h"
+#include "systems/Bare6502.h"
+
+/**
+ * Headless runner.
+ *
+ * Runs the NES without GUI and sound device as fast as possible, for a specified amount of emulated time
+ * or frames. The audio can be rendered to a WAV file and the video to a raw RGB or Y4M stream.
+ * The state can be exported to shared memory for external tools.
+ * Used for batch rendering, regression checks and benchmarks.
+ *
+ * Usage: use --headless --rom <file.nes> [--seconds <n> | --frames <n>] [--wav <file.wav>] [--video <file>] ...
+ *
+ * The NES can be replaced by StaticNES (--static) for benchmarks, the output is the same.
+ *
+ * The cost of forking the final state (see System::fork) can be measured with --fork-bench.
+ *
+ * A hash of the emulation state at the end of every frame (see System::computeStateHash) can be written
+ * with --state-hashes. Diffing the files of two runs shows the first frame where they diverge.
+ *
+ * A plain 6502 binary can be run on Bare6502 instead (--6502), until it gets stuck on a trap
+ * (e.g. the pass/fail loops of the 6502 test suites) or the time runs out.
+ * */
+class Headless {
+
+public:
+    /// Runner configuration.
+    struct Options {
+        /// Cartridge to load.
+        std::string romPath;
+        /// Emulated time to run.
+        double seconds = 10.0;
+        /// WAV output path, no audio output if empty.
+        std::string wavPath;
+        /// WAV output format.
+        WavAudioSink::FORMAT wavFormat = WavAudioSink::FORMAT::FLOAT32;
+        /// Count of frames to run, 0 to run for the specified time.
+        uint64_t frames = 0;
+        /// Video output path, no video output if empty.
+        std::string videoPath;
+        /// Video output format.
+        StreamFrameSink::FORMAT videoFormat = StreamFrameSink::FORMAT::Y4M;
+        /// Shared memory region name (see SharedMemoryExport), no export if empty.
+        std::string shmName;
+        /// Chrome trace output path (profiling builds only), no trace if empty.
+        std::string tracePath;
+        /// Report hardware performance counters (see PerfCounters).
+        bool perfCounters = false;
+        /// Guest code flame graph output path (see GuestProfiler), no guest profiling if empty.
+        std::string guestProfilePath;
+        /// Symbol files for the guest profiler.
+        std::vector<std::string> symbolPaths;
+        /// CPU instruction trace output path (see TraceLogger), no trace if empty.
+        std::string cpuTracePath;
+        /// Code/Data Logger output path (FCEUX .cdl), no logging if empty.
+        std::string cdlPath;
+        /// Run StaticNES instead of the NES, the debugging outputs are not available.
+        bool staticNES = false;
+        /// Plain 6502 binary loaded at $0000 and run on Bare6502 instead of the NES.
+        std::string binaryPath;
+        /// Initial PC of the binary, the reset vector is used if empty.
+        std::optional<uint16_t> startAddress;
+        /// Address of the success trap, the run fails if the binary gets trapped elsewhere.
+        std::optional<uint16_t> successAddress;
+        /// Count of forks of the final state to benchmark (see System::fork), 0 to skip the benchmark.
+        uint64_t forkBenchmark = 0;
+        /// Per-frame state hash output path (see System::computeStateHash), no state hashing if empty.
+        std::string stateHashPath;
+    };
+
+private:
+    /// NTSC NES frame rate (master clock / (4 * 341 * 262 - 0.5)) as a fraction.
+    static constexpr uint32_t FRAME_RATE_NUMERATOR = 39375000;
+    static constexpr uint32_t FRAME_RATE_DENOMINATOR = 655171;
+
+    Options m_options;
+    std::unique_ptr<System> m_system;
+    /// m_system if it is the NES with the component graph, nullptr otherwise.
+    NES * m_nes = nullptr;
+    /// Used instead of m_system to run a plain 6502 binary.
+    std::unique_ptr<Bare6502> m_bare;
+    std::unique_ptr<AudioSink> m_sound;
+    HashFrameSink m_frameHash;
+    std::unique_ptr<StreamFrameSink> m_video;
+    /// State hash of every frame, one "<frame> <hash>" line per frame.
+    std::ofstream m_stateHashes;
+    /// Hash of all the frame state hashes.
+    StateHasher m_stateHash;
+
+    /**
+     * Print the hardware counters report.
+     * @param log Output stream.
+     * @param counters Counters used for the run.
+     * @param frameEvents Events counted in every frame.
+     * */
+    static void reportPerfCounters(std::ostream & log, const PerfCounters & counters,
+                                   const std::vector<PerfCounters::Values> & frameEvents);
+
+    /**
+     * Print the hottest guest routines.
+     * @param log Output stream.
+     * @param profiler Profiler used for the run.
+     * */
+    static void reportGuestProfile(std::ostream & log, const GuestProfiler & profiler);
+
+    /**
+     * Fork the system repeatedly and run every fork for a frame, with copy-on-write and full copy forks.
+     * @param log Output stream.
+     * */
+    void benchmarkForks(std::ostream & log);
+
+    /**
+     * Run the 6502 binary until it gets trapped.
+     * @param log Stream for the run summary.
+     * @return 1 if the success address is specified and the binary didn't get trapped there, 0 otherwise.
+     * */
+    int runBinary(std::ostream & log);
+
+public:
+    /**
+     * Prepare the system and outputs.
+     * @param options Runner configuration.
+     * @throw std::runtime_error If any file can't be opened.
+     * @throw std::invalid_argument If the cartridge is malformed.
+     * */
+    explicit Headless(Options options);
+
+    /**
+     * Parse command line arguments (following the --headless switch).
+     * @param argc Argument count.
+     * @param argv Arguments.
+     * @return Parsed options.
+     * @throw std::invalid_argument On unknown or malformed arguments.
+     * */
+    static Options parseArguments(int argc, char ** argv);
+
+    /**
+     * Print command line usage.
+     * @param os Output stream.
+     * */
+    static void printUsage(std::ostream & os);
+
+    /**
+     * Run the emulation.
+     * @param log Stream for the run summary.
+     * @return 0 on success, 1 if a 6502 binary didn't pass.
+     * */
+    int run(std::ostream & log);
+};
+
+#endif //USE_HEADLESS_H
@@ -0,0 +1,42 @@
+/**
+ * @file MemoryAudioSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Audio output to memory.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_MEMORYAUDIOSINK_H
+#define USE_MEMORYAUDIOSINK_H
+
+#include <vector>
+#include "AudioSink.h"
+
+/**
+ * Audio sink collecting the mixed stereo frames in memory. Mainly for tests.
+ * */
+class MemoryAudioSink : public AudioSink {
+
+private:
+    /// Interleaved samples (left, right, left, ...).
+    std::vector<float> m_samples;
+
+public:
+    void writeFrames(const SoundSampleSources & sources) override;
+
+    /// Get interleaved collected samples.
+    [[nodiscard]] const std::vector<float> & getSamples() const;
+
+    /// Get count of collected frames.
+    [[nodiscard]] size_t getFrameCount() const;
+
+    /**
+     * Get FNV-1a hash of the collected samples, useful for regression checks.
+     * @return 64-bit hash.
+     * */
+    [[nodiscard]] uint64_t hash() const;
+
+    /// Remove all the collected samples.
+    void clear();
+};
+
+#endif //USE_MEMORYAUDIOSINK_H
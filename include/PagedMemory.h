@@ -0,0 +1,152 @@
+/**
+ * @file PagedMemory.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Byte storage with copy-on-write pages.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_PAGEDMEMORY_H
+#define USE_PAGEDMEMORY_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * Byte storage split to fixed-size pages, which are shared between copies until written.
+ *
+ * Copying a PagedMemory only copies the page references (a fork of the memory), a page is duplicated
+ * on the first write to it by any of the copies. So a forked system shares all the memory it doesn't write.
+ *
+ * Only the pages owned by a copy are written in place. A copy owns the pages it created and gives up
+ * the ownership of all pages when it is copied (as the new copy does), so a shared page is never written
+ * and the copies can be used on different threads. The copy itself changes the ownership of the source,
+ * so the source must not be used by another thread while it is copied.
+ *
+ * The storage is not contiguous, use read/write or copyTo to access it.
+ * */
+class PagedMemory {
+
+public:
+    /// Page size, a power of two.
+    static constexpr size_t PAGE_BITS = 10;
+    static constexpr size_t PAGE_SIZE = size_t{1} << PAGE_BITS;
+    static constexpr size_t PAGE_MASK = PAGE_SIZE - 1;
+
+private:
+    using Page = std::array<uint8_t, PAGE_SIZE>;
+
+    std::vector<std::shared_ptr<Page>> m_pages;
+    /// Pages owned by this copy, the only ones written in place. Cleared in the source on copy.
+    mutable std::vector<bool> m_owned;
+    size_t m_size = 0;
+
+    /// Replace a page which isn't owned by a private copy.
+    void detach(size_t index);
+
+public:
+    PagedMemory() = default;
+
+    /**
+     * Fork the memory, the pages are shared until written by either copy.
+     * @param other Memory to copy, it gives up the ownership of its pages.
+     * */
+    PagedMemory(const PagedMemory & other);
+    PagedMemory & operator=(const PagedMemory & other);
+    PagedMemory(PagedMemory && other) noexcept = default;
+    PagedMemory & operator=(PagedMemory && other) noexcept = default;
+
+    /**
+     * Allocate the memory.
+     * @param size Size in bytes.
+     * @param value Initial value of all bytes.
+     * */
+    explicit PagedMemory(size_t size, uint8_t value = 0x00);
+
+    /// Memory size in bytes.
+    [[nodiscard]] size_t size() const {
+        return m_size;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_size == 0;
+    }
+
+    /**
+     * Read a byte.
+     * @param offset Offset, has to be less than size().
+     * @return Data.
+     * */
+    [[nodiscard]] uint8_t read(size_t offset) const {
+        return (*m_pages[offset >> PAGE_BITS])[offset & PAGE_MASK];
+    }
+
+    /**
+     * Write a byte, the page is duplicated first if it is shared.
+     * @param offset Offset, has to be less than size().
+     * @param data Data to write.
+     * */
+    void write(size_t offset, uint8_t data) {
+
+        size_t index = offset >> PAGE_BITS;
+        if(!m_owned[index])
+            detach(index);
+
+        (*m_pages[index])[offset & PAGE_MASK] = data;
+    }
+
+    /**
+     * Resize the memory, all pages become private.
+     * @param size New size in bytes.
+     * @param value Value of all bytes.
+     * */
+    void assign(size_t size, uint8_t value = 0x00);
+
+    /**
+     * Set all bytes, shared pages are replaced instead of being copied.
+     * @param value Value to set.
+     * */
+    void fill(uint8_t value);
+
+    /**
+     * Copy data to the memory.
+     * @param offset Start offset.
+     * @param data Data to copy, the part which doesn't fit is ignored.
+     * */
+    void load(size_t offset, std::span<const uint8_t> data);
+
+    /**
+     * Copy the contents to a contiguous buffer.
+     * @param destination Buffer, only the part which fits is copied.
+     * */
+    void copyTo(std::span<uint8_t> destination) const;
+
+    /**
+     * Make all pages private, e.g. to take a full snapshot instead of a fork.
+     * */
+    void unshare();
+
+    /// Count of pages shared with other living copies, informational only (the copy-on-write uses the ownership).
+    [[nodiscard]] size_t sharedPageCount() const;
+
+    /// Count of pages, the last one may be partial.
+    [[nodiscard]] size_t pageCount() const {
+        return m_pages.size();
+    }
+
+    /**
+     * Get the contiguous contents of a page, e.g. to process the memory in blocks.
+     * @param index Page index, has to be less than pageCount().
+     * @return Page data, the last page is cut to the memory size.
+     * */
+    [[nodiscard]] std::span<const uint8_t> page(size_t index) const {
+        size_t offset = index << PAGE_BITS;
+        return {m_pages[index]->data(), std::min(PAGE_SIZE, m_size - offset)};
+    }
+};
+
+#endif //USE_PAGEDMEMORY_H
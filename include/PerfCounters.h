@@ -0,0 +1,113 @@
+/**
+ * @file PerfCounters.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Hardware performance counters (Linux perf_event).
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_PERFCOUNTERS_H
+#define USE_PERFCOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Hardware performance counters of the calling thread.
+ *
+ * The counters are opened with perf_event_open (user space only, so the default perf_event_paranoid level
+ * is sufficient). Every counter is opened separately: the unsupported or not permitted ones
+ * (e.g. in virtual machines or containers) are just marked unavailable and read as zero, so the user
+ * of the class doesn't need to care. On platforms other than Linux nothing is available.
+ *
+ * Two ways of reading:
+ * - read(): a syscall per counter, precise and scaled if the counters are multiplexed. Suitable for reading
+ *   once per frame.
+ * - readFast(): user-space rdpmc (x86-64 only, if permitted by the kernel), a few dozen cycles.
+ *   Suitable for reading around small code regions (see Profiler::setPerfCounters).
+ *
+ * Counters are bound to the thread which created the object and must be read from it.
+ * */
+class PerfCounters {
+
+public:
+    /// Counted events.
+    enum class EVENT {
+        INSTRUCTIONS,
+        CYCLES,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES
+    };
+
+    static constexpr size_t EVENT_COUNT = 5;
+
+    /// Counter values indexed by EVENT.
+    using Values = std::array<uint64_t, EVENT_COUNT>;
+
+private:
+    struct Counter {
+        int fd = -1;
+        /// perf_event_mmap_page for rdpmc, null if not available.
+        void * page = nullptr;
+    };
+
+    std::array<Counter, EVENT_COUNT> m_counters;
+    std::string m_status;
+    bool m_fastRead = false;
+
+    /**
+     * Read all the counters by syscalls.
+     * @param scale Scale the multiplexed counters to the full time.
+     * */
+    [[nodiscard]] Values readCounters(bool scale) const;
+
+public:
+    /**
+     * Open and start the counters. Never throws on missing counters, see available() and getStatus().
+     * */
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters & operator=(const PerfCounters &) = delete;
+
+    /**
+     * Is the event counted?
+     * @param event Event.
+     * @return True if the counter was opened.
+     * */
+    [[nodiscard]] bool available(EVENT event) const;
+
+    /// Is any event counted?
+    [[nodiscard]] bool anyAvailable() const;
+
+    /// Can readFast be used (all available counters support rdpmc)?
+    [[nodiscard]] bool fastReadAvailable() const;
+
+    /// Get description of the counters state (e.g. why they are not available).
+    [[nodiscard]] const std::string & getStatus() const;
+
+    /**
+     * Read all the counters precisely.
+     * @return Counter values since the creation, unavailable counters are zero.
+     * */
+    [[nodiscard]] Values read() const;
+
+    /**
+     * Read all the counters from user space (see fastReadAvailable), falls back to syscalls.
+     * The values are never scaled when multiplexed, so use them only for differences.
+     * @return Raw counter values, unavailable counters are zero.
+     * */
+    [[nodiscard]] Values readFast() const;
+
+    /**
+     * Get event name.
+     * @param event Event.
+     * @return Name, e.g. "instructions".
+     * */
+    static const char * name(EVENT event);
+};
+
+#endif //USE_PERFCOUNTERS_H
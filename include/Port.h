@@ -52,6 +52,10 @@ public:
  * */
 class DataPort : public Port {
 
+private:
+    /// Interface of the connected Connector, resolved on connect so the accesses don't lock the Connector.
+    const DataInterface * m_interface = nullptr;
+
 public:
     DataPort() = default;
     ~DataPort() override = default;
@@ -93,6 +97,10 @@ public:
  * */
 class SignalPort : public Port {
 
+private:
+    /// Interface of the connected Connector, resolved on connect so the signals don't lock the Connector.
+    const SignalInterface * m_interface = nullptr;
+
 public:
     SignalPort() = default;
     ~SignalPort() override = default;
@@ -0,0 +1,228 @@
+/**
+ * @file Profiler.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Hot-path profiling instrumentation.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ *
+ * The instrumentation is only compiled in when USE_PROFILING is defined (CMake option USE_PROFILING),
+ * otherwise all the macros expand to nothing and have no cost.
+ *
+ * - USE_PROFILE_SCOPE(name): measure time spent in the rest of the enclosing scope.
+ * - USE_PROFILE_COUNT(name, value): add to a counter.
+ * - USE_PROFILE_FRAME(): close the current emulated frame (called by the System).
+ */
+
+#ifndef USE_PROFILER_H
+#define USE_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include "Types.h"
+#include "PerfCounters.h"
+
+/**
+ * Collector of the per-frame section timings and counters.
+ *
+ * Sections are registered by name on first use and accumulate time (inclusive: nested sections are counted
+ * in the parent as well) and call counts. On every frame boundary the accumulators are moved to a history
+ * of the last HISTORY_FRAMES frames, which is shown in the Performance window and can be saved as a Chrome trace.
+ *
+ * Accumulators are atomic, so the sections can be entered from other threads (e.g. APUSynthesizer),
+ * frame boundaries and the GUI have to be called from a single thread.
+ * */
+class Profiler {
+
+public:
+    static constexpr size_t MAX_SECTIONS = 32;
+    static constexpr size_t HISTORY_FRAMES = 600;
+
+    /// Accumulated data of a single frame.
+    struct FrameRecord {
+        /// Frame start since the profiler creation.
+        uint64_t startNs;
+        uint64_t durationNs;
+        std::array<uint64_t, MAX_SECTIONS> sectionNs;
+        std::array<uint64_t, MAX_SECTIONS> sectionCalls;
+    };
+
+    /// Measures the time (and hardware events, see setPerfCounters) from construction to destruction.
+    class ScopedTimer {
+        size_t m_section;
+        uint64_t m_start;
+        const PerfCounters * m_counters;
+        PerfCounters::Values m_startEvents;
+    public:
+        explicit ScopedTimer(size_t section) : m_section(section), m_counters(instance().countersForThisThread()) {
+            if(m_counters)
+                m_startEvents = m_counters->readFast();
+            m_start = now();
+        }
+        ~ScopedTimer() {
+            instance().add(m_section, now() - m_start);
+            if(m_counters)
+                instance().addEvents(m_section, m_startEvents, m_counters->readFast());
+        }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer & operator=(const ScopedTimer &) = delete;
+    };
+
+private:
+    struct Section {
+        std::string name;
+        std::atomic<uint64_t> ns{0};
+        std::atomic<uint64_t> calls{0};
+        /// Hardware events since the reset (not per frame).
+        std::array<std::atomic<uint64_t>, PerfCounters::EVENT_COUNT> events{};
+    };
+
+    std::array<Section, MAX_SECTIONS> m_sections;
+    std::atomic<size_t> m_sectionCount{0};
+    std::mutex m_registerMutex;
+
+    /// Ring of the finished frames.
+    std::vector<FrameRecord> m_history;
+    size_t m_historyPosition = 0;
+    size_t m_historyCount = 0;
+    uint64_t m_frameStart;
+
+    /// Hardware counters for the section events, only used on the thread which owns them.
+    std::atomic<const PerfCounters *> m_counters{nullptr};
+    std::thread::id m_countersThread;
+
+    /// Performance window state.
+    int m_averagedFrames = 60;
+    char m_tracePath[256] = "trace.json";
+    std::string m_traceStatus;
+
+    Profiler();
+
+    /// Get the counters if they can be read on the calling thread.
+    [[nodiscard]] const PerfCounters * countersForThisThread() const {
+        const PerfCounters * counters = m_counters.load(std::memory_order_acquire);
+        return (counters && std::this_thread::get_id() == m_countersThread) ? counters : nullptr;
+    }
+
+    void addEvents(size_t section, const PerfCounters::Values & start, const PerfCounters::Values & end) {
+        for(size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+            m_sections[section].events[i].fetch_add(end[i] - start[i], std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the history record.
+     * @param age 0 = the latest frame.
+     * */
+    [[nodiscard]] const FrameRecord & historyRecord(size_t age) const;
+
+public:
+    /// Get the process-wide profiler.
+    static Profiler & instance();
+
+    /// Get monotonic time in nanoseconds.
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Get a section ID, the section is created on first use.
+     * @param name Section name.
+     * @return Section ID.
+     * @throw std::length_error If there are too many sections.
+     * */
+    size_t registerSection(const std::string & name);
+
+    /**
+     * Record a section call.
+     * @param section Section ID.
+     * @param ns Time spent in the section.
+     * */
+    void add(size_t section, uint64_t ns) {
+        m_sections[section].ns.fetch_add(ns, std::memory_order_relaxed);
+        m_sections[section].calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Add to a section counter without timing.
+     * @param section Section ID.
+     * @param count Value to add.
+     * */
+    void count(size_t section, uint64_t count) {
+        m_sections[section].calls.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /// Close the current frame and move the accumulated data to the history.
+    void frame();
+
+    /**
+     * Count hardware events in the sections (only the ones entered on the calling thread).
+     * Reading the counters around every section is only cheap with rdpmc (see PerfCounters::fastReadAvailable).
+     * @param counters Counters owned by the calling thread, null to stop counting.
+     * */
+    void setPerfCounters(const PerfCounters * counters);
+
+    /// Get count of registered sections.
+    [[nodiscard]] size_t getSectionCount() const;
+
+    /**
+     * Get section name.
+     * @param section Section ID.
+     * */
+    [[nodiscard]] const std::string & getSectionName(size_t section) const;
+
+    /**
+     * Get hardware events counted in the section since the reset (see setPerfCounters).
+     * @param section Section ID.
+     * */
+    [[nodiscard]] PerfCounters::Values getSectionEvents(size_t section) const;
+
+    /// Clear the history and accumulators.
+    void reset();
+
+    /**
+     * Write the history in the Chrome trace event format (chrome://tracing, Perfetto).
+     * Every section is a separate track with one event per frame lasting the total time spent in the section,
+     * call counts are written as counter events.
+     * @param os Output stream.
+     * */
+    void writeChromeTrace(std::ostream & os) const;
+
+    /**
+     * Get the Performance window showing per-frame times, calls and histograms.
+     * @return Window configuration.
+     * */
+    EmulatorWindow getGUI();
+};
+
+#ifdef USE_PROFILING
+
+#define USE_PROFILE_CONCAT_INNER(a, b) a##b
+#define USE_PROFILE_CONCAT(a, b) USE_PROFILE_CONCAT_INNER(a, b)
+
+#define USE_PROFILE_SCOPE(name) \
+    static const size_t USE_PROFILE_CONCAT(useProfileSection, __LINE__) = Profiler::instance().registerSection(name); \
+    Profiler::ScopedTimer USE_PROFILE_CONCAT(useProfileTimer, __LINE__)(USE_PROFILE_CONCAT(useProfileSection, __LINE__))
+
+#define USE_PROFILE_COUNT(name, value) \
+    do { \
+        static const size_t useProfileSection = Profiler::instance().registerSection(name); \
+        Profiler::instance().count(useProfileSection, value); \
+    } while(0)
+
+#define USE_PROFILE_FRAME() Profiler::instance().frame()
+
+#else
+
+#define USE_PROFILE_SCOPE(name) ((void)0)
+#define USE_PROFILE_COUNT(name, value) ((void)0)
+#define USE_PROFILE_FRAME() ((void)0)
+
+#endif
+
+#endif //USE_PROFILER_H
@@ -0,0 +1,104 @@
+/**
+ * @file SPSCQueue.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Lock-free single producer, single consumer queue.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_SPSCQUEUE_H
+#define USE_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Bounded lock-free queue for passing data between exactly two threads.
+ *
+ * One thread may only push, the other one may only pop (or peek). No locks or allocations are used,
+ * so the queue is safe to use from real-time threads (e.g. audio callbacks).
+ *
+ * @tparam T Element type.
+ * @tparam Capacity Maximal count of elements, must be a power of two.
+ * */
+template<typename T, size_t Capacity>
+class SPSCQueue {
+
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    std::array<T, Capacity> m_buffer{};
+
+    /// Read position, owned by the consumer. Kept on a separate cache line from the write position.
+    alignas(64) std::atomic<size_t> m_head{0};
+    /// Write position, owned by the producer.
+    alignas(64) std::atomic<size_t> m_tail{0};
+
+public:
+    /**
+     * Add an element to the queue (producer only).
+     * @param value Element to add.
+     * @return False if the queue is full (the element is not added).
+     * */
+    bool push(const T & value) {
+
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if(tail - m_head.load(std::memory_order_acquire) >= Capacity)
+            return false;
+
+        m_buffer[tail & MASK] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Get the oldest element without removing it (consumer only).
+     * @return Pointer to the element, nullptr if the queue is empty.
+     * */
+    const T * front() const {
+
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if(head == m_tail.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &m_buffer[head & MASK];
+    }
+
+    /**
+     * Remove the oldest element (consumer only).
+     * @param value Removed element.
+     * @return False if the queue is empty.
+     * */
+    bool pop(T & value) {
+
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if(head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        value = m_buffer[head & MASK];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Get count of elements in the queue. The value is only approximate when used concurrently.
+     * @return Element count.
+     * */
+    [[nodiscard]] size_t size() const {
+        // Head first: tail can only grow meanwhile, so the result never underflows.
+        size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+
+    [[nodiscard]] static constexpr size_t capacity() {
+        return Capacity;
+    }
+};
+
+#endif //USE_SPSCQUEUE_H
@@ -0,0 +1,74 @@
+/**
+ * @file SharedMemoryExport.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Export of the emulator state to POSIX shared memory.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_SHAREDMEMORYEXPORT_H
+#define USE_SHAREDMEMORYEXPORT_H
+
+#include <array>
+#include <span>
+#include <string>
+#include "FrameSink.h"
+#include "SharedMemoryLayout.h"
+
+/**
+ * Writer of the shared memory region (see SharedMemory::Layout) for external tools and bots.
+ *
+ * The region is created on construction and removed on destruction. The System calls publish once per frame,
+ * which copies the frame, RAM, PRG RAM and the latest audio block into the region under the sequence lock.
+ * Readers map the region read-only and never block the emulation.
+ *
+ * Only available on POSIX systems.
+ * */
+class SharedMemoryExport {
+
+private:
+    std::string m_name;
+    SharedMemory::Layout * m_layout = nullptr;
+
+    /// Ring of the latest audio samples.
+    std::array<float, SharedMemory::AUDIO_BLOCK_SIZE> m_audio{};
+    size_t m_audioPosition = 0;
+    size_t m_audioCount = 0;
+
+public:
+    /**
+     * Create the shared memory region.
+     * @param name Region name, must start with a slash (e.g. "/use-nes").
+     * @param sampleRate Audio sample rate, informative only.
+     * @throw std::invalid_argument If the name is invalid.
+     * @throw std::runtime_error If the region already exists, can't be created or the platform is not supported.
+     * */
+    SharedMemoryExport(std::string name, uint32_t sampleRate);
+    ~SharedMemoryExport();
+
+    SharedMemoryExport(const SharedMemoryExport &) = delete;
+    SharedMemoryExport & operator=(const SharedMemoryExport &) = delete;
+
+    /**
+     * Record an audio sample, the latest block is exported on the next publish.
+     * @param sample Mono sample.
+     * */
+    void pushAudioSample(float sample) {
+        m_audio[m_audioPosition] = sample;
+        m_audioPosition = (m_audioPosition + 1) % m_audio.size();
+        if(m_audioCount < m_audio.size())
+            m_audioCount++;
+    }
+
+    /**
+     * Publish a new snapshot.
+     * @param frame Finished frame, it is cropped if larger than the region frame.
+     * @param ram System RAM, it is cropped if larger than the region RAM.
+     * @param prgRam Cartridge PRG RAM, it is cropped if larger than the region PRG RAM.
+     * */
+    void publish(const VideoFrame & frame, std::span<const uint8_t> ram, std::span<const uint8_t> prgRam);
+
+    /// Get the region name.
+    [[nodiscard]] const std::string & getName() const;
+};
+
+#endif //USE_SHAREDMEMORYEXPORT_H
@@ -0,0 +1,99 @@
+/**
+ * @file SharedMemoryLayout.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Layout of the shared memory region exported for external tools.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ *
+ * This header has no dependencies on the rest of the emulator, so external tools can include it alone.
+ */
+
+#ifndef USE_SHAREDMEMORYLAYOUT_H
+#define USE_SHAREDMEMORYLAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace SharedMemory {
+
+    /// Region identification ("USE" + version).
+    constexpr uint32_t MAGIC = 0x55534501;
+    /// Incremented on every incompatible layout change.
+    constexpr uint32_t VERSION = 1;
+
+    constexpr size_t FRAME_WIDTH = 256;
+    constexpr size_t FRAME_HEIGHT = 240;
+    /// Frame size in bytes (packed RGB24).
+    constexpr size_t FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 3;
+    constexpr size_t RAM_SIZE = 0x800;
+    /// Maximal exported PRG RAM size, larger PRG RAM is truncated.
+    constexpr size_t PRG_RAM_SIZE = 0x8000;
+    /// Count of the latest mono audio samples exported with every frame.
+    constexpr size_t AUDIO_BLOCK_SIZE = 1024;
+
+    /**
+     * Shared memory region contents.
+     *
+     * The region is published once per frame under a sequence lock: the writer makes the sequence odd,
+     * updates the data and makes the sequence even again. The writer never waits for the readers.
+     * A reader accesses the data in place and only has to check the sequence did not change meanwhile
+     * (see read()), no locks or copies are needed.
+     * */
+    struct Layout {
+        uint32_t magic;
+        uint32_t version;
+
+        /// Sequence lock counter, odd while the data is being written.
+        alignas(64) std::atomic<uint64_t> sequence;
+
+        /// Number of the exported frame since the power-on.
+        uint64_t frameNumber;
+        uint32_t frameWidth;
+        uint32_t frameHeight;
+        /// Valid bytes in prgRam.
+        uint32_t prgRamSize;
+        uint32_t audioSampleRate;
+        /// Valid samples in audio (the newest sample is the last one).
+        uint32_t audioSampleCount;
+
+        alignas(64) uint8_t frame[FRAME_SIZE];
+        uint8_t ram[RAM_SIZE];
+        uint8_t prgRam[PRG_RAM_SIZE];
+        float audio[AUDIO_BLOCK_SIZE];
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Sequence counter must be lock-free to be shared.");
+
+    /**
+     * Read a consistent snapshot of the region.
+     *
+     * The reader function accesses the region in place and may be called multiple times,
+     * its results are only valid if read() returns true.
+     *
+     * @tparam ReaderT Function taking a const Layout reference.
+     * @param layout Mapped region.
+     * @param reader Function reading the data.
+     * @param maxAttempts How many times to retry if the writer interferes.
+     * @return True if the reader saw a consistent snapshot.
+     * */
+    template<typename ReaderT>
+    bool read(const Layout & layout, ReaderT && reader, int maxAttempts = 100) {
+
+        for(int attempt = 0; attempt < maxAttempts; attempt++) {
+
+            uint64_t before = layout.sequence.load(std::memory_order_acquire);
+            if(before & 1)
+                continue;
+
+            reader(layout);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(layout.sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+
+        return false;
+    }
+}
+
+#endif //USE_SHAREDMEMORYLAYOUT_H
@@ -8,11 +8,14 @@
 #define USE_SOUND_H
 
 #include <memory>
+#include <atomic>
 #include "miniaudio.h"
 #include "Types.h"
+#include "AudioSink.h"
+#include "AudioRateControl.h"
 
 /**
- * USE sound manager.
+ * USE sound manager, audio sink playing on the sound device.
  *
  * The Sound class handles all sounds produced by the components, mixes and plays them.
  * Multi-platform audio provided by miniaudio.h.
@@ -26,14 +29,19 @@
  *
  * The class mixes the output of all the devices, passes them through LPF and outputs to the sound device.
  * Ring buffer is used to store samples in advance to battle crackling when there are not enough samples to play
- * when the dataCallback is called (missed deadline problem). If the buffer is not available at the moment of
- * writing, a cache is used instead, which is flushed to the buffer in the next write where the buffer is available.
+ * when the dataCallback is called (missed deadline problem).
+ *
+ * The sound device clock and the emulation clock always differ slightly, so the buffer would slowly drain or overflow.
+ * Instead of skipping parts of the buffer, dynamic rate control is used (see AudioRateControl): the sample producer
+ * asks for the rate ratio (see getRateRatio) and generates slightly more (or less) samples per second, so the buffer fill level is
+ * kept around the target. The maximal deviation is 0.5 %, which is not audible, and allows using a small buffer
+ * (about two video frames), thus a low latency.
  *
  * Note about terms used:
  * This class uses same terminology as miniaudio.h documentation - frame consists of samples, the count equals the number
  * of audio channels. This means stereo frame consists of a left speaker sample followed by the right speaker sample.
  * */
-class Sound {
+class Sound : public AudioSink {
 
 private:
     bool m_running = false;
@@ -41,17 +49,15 @@ private:
     // ===========================================
     // Audio parameters
     // ===========================================
-    /// Sample buffer size.
-    static const size_t SAMPLE_BUFFER_SIZE               = 32768;
-    /// Minimal distance between read and write buffer pointer.
-    static const size_t SAMPLE_BUFFER_MIN_PTR_DISTANCE   = 2048;
-    /// Maximal distance between read and write buffer pointer.
-    static const size_t SAMPLE_BUFFER_MAX_PTR_DISTANCE   = SAMPLE_BUFFER_SIZE - SAMPLE_BUFFER_MIN_PTR_DISTANCE;
-    /// Buffer pointer shift if the distance becomes too large (small)
-    static const size_t BUFFER_PTR_CORRECTION            = 16384;
-
     /// Number of PCM frames processed per second (two samples for stereo in a single frame).
     static const int SAMPLE_RATE   = 44100;
+
+    /// Sample buffer size.
+    static const size_t SAMPLE_BUFFER_SIZE      = 4096;
+    /// Buffer fill level maintained by the rate control (two video frames at 60 Hz).
+    static const size_t TARGET_BUFFERED_FRAMES  = SAMPLE_RATE / 30;
+    /// Maximal deviation of the rate ratio from 1.
+    static constexpr double MAX_RATE_DEVIATION  = 0.005;
     /// Audio channel count.
     static const int CHANNEL_COUNT = 2;
 
@@ -103,8 +109,9 @@ private:
     // ===========================================
     /// Frame buffers. Serve also as data source nodes.
     std::vector<std::unique_ptr<ma_pcm_rb, decltype(&deletePcmRb)>> m_sampleBuffers;
-    /// Temporary storage for audio frames if the shared ring buffer is not available at the moment of writing.
-    std::vector<std::vector<float>> m_sampleCaches;
+
+    /// Rate ratio, underruns (dataCallback calls with not enough frames) and overruns (dropped frames).
+    AudioRateControl m_rateControl{TARGET_BUFFERED_FRAMES, MAX_RATE_DEVIATION};
 
 public:
 
@@ -112,26 +119,57 @@ public:
      * Create sound device and prepare node graph with specified number of sources.
      *
      * @param outputCount Required number of input nodes. Equals the total amount of Components' audio outputs in the System.
+     * @throw std::runtime_error If the sound device can't be initialized (use NullAudioSink instead).
      * */
     explicit Sound(size_t outputCount);
-    ~Sound();
+    ~Sound() override;
 
     /**
      * Start the sound device (which executes dataCallback periodically to asks for more audio frames).
+     * The buffers are reset and prefilled with silence up to the target fill level.
      * */
-    void start();
+    void start() override;
 
     /**
      * Stop the sound device.
      * */
-    void stop();
+    void stop() override;
 
     /**
-     * Write audio frames to their respective buffers (or caches, if the buffer is currently used by the audio callback).
+     * Write a single audio frame of every source to the respective buffer.
+     * If the buffer is full, the frame is dropped and counted as an overrun.
      *
      * @param sources Sound sources to take frames from.
      * */
-    void writeFrames(const SoundSampleSources & sources);
+    void writeFrames(const SoundSampleSources & sources) override;
+
+    /**
+     * Get count of audio frames waiting in the output buffer to be played.
+     *
+     * @note Used by the audio-paced emulation (see FramePacer).
+     * @return Frames available to the audio device.
+     * */
+    [[nodiscard]] size_t getBufferedFrames() const override;
+
+    /**
+     * Get count of audio frames which should be kept in the output buffer.
+     * @return Optimal buffer fill level.
+     * */
+    [[nodiscard]] size_t getTargetBufferedFrames() const override;
+
+    /**
+     * Get the ratio by which the sample producer should multiply the sample rate, so the buffer stays
+     * around the target fill level. It is linearly mapped from the fill level and limited to 1 +- 0.5 %.
+     *
+     * @return Rate ratio, more than 1 if the buffer is draining, less than 1 if filling up.
+     * */
+    [[nodiscard]] double getRateRatio() const override;
+
+    /**
+     * Get buffer monitoring data.
+     * @return Buffer fill, underrun and overrun counters.
+     * */
+    [[nodiscard]] Statistics getStatistics() const override;
 
     /**
      * Get sample rate of the audio device.
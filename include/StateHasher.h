@@ -0,0 +1,78 @@
+/**
+ * @file StateHasher.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Emulation state hashing.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_STATEHASHER_H
+#define USE_STATEHASHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include "PagedMemory.h"
+
+/**
+ * Streaming 64-bit hash of the emulation state, used to find the first frame where two runs diverge.
+ *
+ * The data is processed in 32-byte stripes by four independent 64-bit lanes (the xxHash64 scheme),
+ * so the compiler can keep the lanes in parallel and bulk memory is hashed at memory speed.
+ * The result only depends on the concatenated bytes, not on how they were split between the add calls.
+ *
+ * Scalar fields are added one by one in little-endian order, never as raw structures,
+ * so neither padding nor the host byte order affect the hash.
+ * */
+class StateHasher {
+
+public:
+    static constexpr size_t STRIPE_SIZE = 32;
+
+private:
+    static constexpr size_t LANE_COUNT = 4;
+
+    uint64_t m_lanes[LANE_COUNT];
+    uint8_t m_stripe[STRIPE_SIZE] = {};
+    size_t m_stripeSize = 0;
+    uint64_t m_length = 0;
+
+    /// Mix a full stripe to the lanes.
+    void consume(const uint8_t * stripe);
+
+public:
+    StateHasher();
+
+    /**
+     * Hash a block of bytes.
+     * @param data Data to hash.
+     * */
+    void add(std::span<const uint8_t> data);
+
+    /**
+     * Hash the memory contents page by page, without copying them.
+     * @param memory Memory to hash.
+     * */
+    void add(const PagedMemory & memory);
+
+    /**
+     * Hash a scalar value (integer, bool or enumeration) as little-endian bytes.
+     * @param value Value to hash.
+     * */
+    template<class T>
+    requires std::is_integral_v<T> || std::is_enum_v<T>
+    void add(T value) {
+
+        uint8_t bytes[sizeof(T)];
+        auto bits = static_cast<uint64_t>(value);
+        for(size_t i = 0; i < sizeof(T); i++)
+            bytes[i] = static_cast<uint8_t>(bits >> (8 * i));
+
+        add(std::span<const uint8_t>(bytes));
+    }
+
+    /// Get hash of all the data so far, more data can still be added.
+    [[nodiscard]] uint64_t digest() const;
+};
+
+#endif //USE_STATEHASHER_H
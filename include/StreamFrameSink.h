@@ -0,0 +1,110 @@
+/**
+ * @file StreamFrameSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Video output to a raw RGB or Y4M stream.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_STREAMFRAMESINK_H
+#define USE_STREAMFRAMESINK_H
+
+#include <atomic>
+#include <fstream>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FrameSink.h"
+#include "SPSCQueue.h"
+
+/**
+ * Frame sink recording the frames to a file on a separate writer thread.
+ *
+ * The frames are copied into a fixed pool of preallocated slots and passed to the writer thread
+ * through lock-free queues. If the writer can't keep up and there is no free slot, the frame is dropped
+ * (and counted), so the recording never stalls the emulation.
+ *
+ * Supported formats:
+ * - RGB24: headerless packed 8-bit RGB frames (e.g. ffmpeg -f rawvideo -pixel_format rgb24 -video_size 256x240).
+ * - Y4M: YUV4MPEG2 stream with 4:4:4 chroma (BT.601 limited range), the frame size is taken from the first frame.
+ * */
+class StreamFrameSink : public FrameSink {
+
+public:
+    /// Output stream format.
+    enum class FORMAT {
+        RGB24,
+        Y4M
+    };
+
+private:
+    /// Count of frame slots, i.e. how many frames the writer may be behind.
+    static constexpr size_t SLOT_COUNT = 8;
+
+    std::ofstream m_file;
+    FORMAT m_format;
+    uint32_t m_frameRateNumerator;
+    uint32_t m_frameRateDenominator;
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    /// Packed RGB24 frames.
+    std::vector<uint8_t> m_slots[SLOT_COUNT];
+    /// Slots ready to be filled, returned by the writer thread.
+    SPSCQueue<uint32_t, SLOT_COUNT> m_freeSlots;
+    /// Slots ready to be written.
+    SPSCQueue<uint32_t, SLOT_COUNT> m_filledSlots;
+    /// Count of filled slots (+1 when stopping).
+    std::counting_semaphore<SLOT_COUNT + 1> m_pending{0};
+
+    std::atomic<bool> m_stop = false;
+    std::atomic<uint64_t> m_writtenFrames = 0;
+    std::atomic<uint64_t> m_droppedFrames = 0;
+    std::thread m_thread;
+
+    /// Writer thread main loop.
+    void run();
+
+    /**
+     * Write a single frame to the file (writer thread only).
+     * @param rgb Packed RGB24 pixels.
+     * @param buffer Conversion buffer.
+     * */
+    void writeFrame(const std::vector<uint8_t> & rgb, std::vector<uint8_t> & buffer);
+
+public:
+    /**
+     * Create the file and start the writer thread.
+     * @param path Output file path.
+     * @param format Stream format.
+     * @param frameRateNumerator Frame rate numerator (Y4M header only).
+     * @param frameRateDenominator Frame rate denominator (Y4M header only).
+     * @throw std::runtime_error If the file can't be opened.
+     * @throw std::invalid_argument If the frame rate is zero.
+     * */
+    StreamFrameSink(const std::string & path, FORMAT format,
+                    uint32_t frameRateNumerator = 60, uint32_t frameRateDenominator = 1);
+    ~StreamFrameSink() override;
+
+    StreamFrameSink(const StreamFrameSink &) = delete;
+    StreamFrameSink & operator=(const StreamFrameSink &) = delete;
+
+    /**
+     * Queue a frame for writing. The frame is dropped if the writer thread is too far behind
+     * or if its size differs from the first frame.
+     * */
+    void onFrame(const VideoFrame & frame) override;
+
+    /**
+     * Write all the queued frames and close the file. Further frames are dropped.
+     * */
+    void close();
+
+    /// Get count of frames written to the file.
+    [[nodiscard]] uint64_t getWrittenFrames() const;
+
+    /// Get count of dropped frames.
+    [[nodiscard]] uint64_t getDroppedFrames() const;
+};
+
+#endif //USE_STREAMFRAMESINK_H
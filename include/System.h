@@ -9,10 +9,12 @@
 #ifndef USE_SYSTEM_H
 #define USE_SYSTEM_H
 
+#include <memory>
 #include <vector>
 #include "Types.h"
 #include "Component.h"
 #include "ImInputBinder.h"
+#include "FrameSink.h"
 
 /**
  * This class is an abstraction of an emulated system.
@@ -25,6 +27,24 @@ protected:
     std::vector<Component *> m_components;
     unsigned long m_systemClockRate = 0;
     SoundSampleSources m_sampleSources;
+    /// Registered video outputs (not owned).
+    std::vector<FrameSink *> m_frameSinks;
+    /// Count of finished frames since the power-on (including skipped frames).
+    uint64_t m_frameCount = 0;
+    /// Take a state hash at the end of every frame (see setStateHashEnabled).
+    bool m_stateHashEnabled = false;
+    /// State hash taken at the end of the last frame.
+    uint64_t m_frameStateHash = 0;
+
+    /**
+     * Hand a composed frame to all the registered frame sinks.
+     *
+     * @note For System developer: call this once per composed frame, right after the GPU finishes it.
+     * Frames which are not composed (frame skip) should not be emitted.
+     *
+     * @param frame Frame data.
+     * */
+    void emitFrame(const VideoFrame & frame);
 
 public:
     System();
@@ -76,6 +96,97 @@ public:
      * */
     virtual void doRun(unsigned int updateFrequency)    = 0;
 
+    /**
+     * Set how many frames to skip between two rendered frames.
+     * Skipped frames are fully emulated, only the picture composition is omitted. Used by the fast-forward mode.
+     *
+     * @note For System developer: default implementation does nothing. If there is a GPU which supports
+     * skipping the composition, override the method and toggle it on frame boundaries.
+     *
+     * @param count Number of frames to skip after every rendered frame, 0 to render every frame.
+     * */
+    virtual void setFrameSkip(unsigned int count);
+
+    /**
+     * Check whether the last doClocks/doSteps/doFrames/doRun call was stopped early by a debugger breakpoint.
+     * The next call continues from the breakpoint.
+     *
+     * @note For System developer: default implementation returns false. If a component supports breakpoints,
+     * stop clocking once it reports a hit and override the method.
+     *
+     * @return True if a breakpoint was hit.
+     * */
+    [[nodiscard]] virtual bool breakpointHit() const;
+
+    /**
+     * Create an independent system in the same emulation state, e.g. to try several inputs from the same point.
+     * The memories are shared page by page until either of the systems writes them (see PagedMemory),
+     * so a fork costs roughly the size of the component registers. Frame sinks and debugging state are not copied.
+     * The system and its forks can then run on different threads. The fork itself gives up the ownership
+     * of the shared memory in this system too, so this system must not run on another thread during the call.
+     *
+     * @note For System developer: default implementation throws. Copy the state of every component
+     * into a newly constructed system, the wiring of the new system is kept.
+     *
+     * @param copyOnWrite False to copy all the memory right away (a full snapshot).
+     * @return The forked system.
+     * @throw std::logic_error If the system doesn't support forking.
+     * */
+    [[nodiscard]] virtual std::unique_ptr<System> fork(bool copyOnWrite = true) const;
+
+    /**
+     * Compute a 64-bit hash of the complete emulation state (CPU registers, RAM, VRAM, OAM, palettes, APU and mapper).
+     * Systems in the same state continue the same way, so comparing the hashes of two runs finds the first point
+     * where they diverge (a desync or a regression). The video output and the debugging state are not included.
+     *
+     * @note For System developer: default implementation throws. Feed the state of every component to a StateHasher,
+     * bring lazily emulated parts up to date first, so the hash doesn't depend on how the clocks were batched.
+     *
+     * @return State hash.
+     * @throw std::logic_error If the system doesn't support state hashing.
+     * */
+    [[nodiscard]] virtual uint64_t computeStateHash();
+
+    /**
+     * Take a state hash at the end of every frame (see getFrameStateHash), it costs about one pass over the RAM per frame.
+     *
+     * @note For System developer: when enabled, store computeStateHash() to m_frameStateHash right after
+     * every finished frame.
+     *
+     * @param enabled True to enable.
+     * @throw std::logic_error If the system doesn't support state hashing.
+     * */
+    void setStateHashEnabled(bool enabled);
+
+    /**
+     * Get the state hash taken at the end of the last frame (see setStateHashEnabled).
+     *
+     * @return State hash, the hash of the state at the time of enabling if no frame finished since.
+     * */
+    [[nodiscard]] uint64_t getFrameStateHash() const;
+
+    /**
+     * Register a video output. Every composed frame is handed to the sink (see FrameSink).
+     *
+     * @param sink Sink to register, must outlive the System or be removed before destroyed.
+     * @throw std::invalid_argument If the sink is null.
+     * */
+    void addFrameSink(FrameSink * sink);
+
+    /**
+     * Unregister a video output.
+     *
+     * @param sink Sink to remove, nothing happens if it is not registered.
+     * */
+    void removeFrameSink(FrameSink * sink);
+
+    /**
+     * Get a count of frames finished since the power-on.
+     *
+     * @return Frame count, including the skipped frames.
+     * */
+    [[nodiscard]] uint64_t getFrameCount() const;
+
     /**
      * Callback that is called on every new frame.
      * */
@@ -25,6 +25,19 @@ namespace USETools {
      * */
     void renderScalableBitmap(const std::vector<std::vector<RGBPixel>> & pixelData, float scale = 1.0f);
 
+    /**
+     * Render a bitmap stored in a contiguous buffer.
+     * Horizontal runs of the same color are merged into a single rectangle.
+     *
+     * @param pixels Bitmap data by rows => pixels[x + y * width].
+     * @param width Width of the bitmap.
+     * @param height Height of the bitmap.
+     * @param scale Scale of the bitmap.
+     *
+     * @throw std::invalid_argument When pixel data is null.
+     * */
+    void renderScalableBitmap(const RGBPixel * pixels, size_t width, size_t height, float scale = 1.0f);
+
     /**
      * Map value from one range to another.
      *
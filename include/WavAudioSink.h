@@ -0,0 +1,78 @@
+/**
+ * @file WavAudioSink.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief WAV file audio output.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_WAVAUDIOSINK_H
+#define USE_WAVAUDIOSINK_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "AudioSink.h"
+
+/**
+ * Audio sink streaming the mixed stereo output to a WAV file.
+ *
+ * The frames are collected in a large memory block which is written to the file at once when full,
+ * so the sink is much faster than real-time. The header sizes are updated when the file is closed
+ * (on close() or destruction, which ignores the write errors).
+ * */
+class WavAudioSink : public AudioSink {
+
+public:
+    /// Sample format of the file.
+    enum class FORMAT {
+        FLOAT32,    ///< 32-bit IEEE float.
+        PCM16       ///< 16-bit signed integer, the samples are clipped to [-1, 1].
+    };
+
+private:
+    /// Frames collected before writing to the file.
+    static constexpr size_t BLOCK_FRAMES = 65536;
+    static constexpr uint16_t CHANNEL_COUNT = 2;
+    static constexpr size_t HEADER_SIZE = 44;
+
+    std::ofstream m_file;
+    FORMAT m_format;
+    uint32_t m_sampleRate;
+
+    /// Block of encoded frames.
+    std::vector<char> m_block;
+    /// Count of frames written to the file so far (without the block).
+    uint64_t m_writtenFrames = 0;
+
+    [[nodiscard]] size_t bytesPerSample() const;
+    void writeHeader(uint64_t frameCount);
+    void flush();
+
+public:
+    /**
+     * Create the file and write a header.
+     * @param path Output file path.
+     * @param sampleRate Sample rate of the frames.
+     * @param format Sample format.
+     * @throw std::runtime_error If the file can't be opened or the header written.
+     * */
+    WavAudioSink(const std::string & path, uint32_t sampleRate, FORMAT format = FORMAT::FLOAT32);
+    ~WavAudioSink() override;
+
+    /**
+     * Encode the frame, the block is written to the file when full.
+     * @throw std::runtime_error If the block can't be written.
+     * */
+    void writeFrames(const SoundSampleSources & sources) override;
+
+    /**
+     * Write the remaining frames, finalize the header and close the file. Further writes are ignored.
+     * @throw std::runtime_error If the file can't be written.
+     * */
+    void close();
+
+    /// Get count of frames written (including the buffered ones).
+    [[nodiscard]] uint64_t getFrameCount() const;
+};
+
+#endif //USE_WAVAUDIOSINK_H
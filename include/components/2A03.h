@@ -1,5 +1,5 @@
 /**
- * @file 2A03.cpp
+ * @file 2A03.h
  * @author Ondrej Golasowski (golasowski.o@gmail.com)
  * @brief Ricoh 2A03 (MOS 6502 variant) emulation.
  * @copyright Copyright (c) 2023 Ondrej Golasowski
@@ -16,17 +16,59 @@
  *
  * Additional connectors: data "OAMDMA", which is used to trigger the DMA unit.
  *
+ * @tparam BusT Bus policy (see MOS6502).
  * @note Normally the 2A03 contains also the APU but that is separated for a sake of modularity in this project.
  * */
-class RP2A03 : public MOS6502 {
-
-protected:
+template<class BusT = DataPort>
+class RP2A03 : public MOS6502<BusT> {
 
 public:
-    RP2A03();
-    ~RP2A03() override;
+    /**
+     * Create a CPU.
+     * @param bus Bus policy instance.
+     * */
+    explicit RP2A03(BusT bus = {}) : MOS6502<BusT>(std::move(bus)) {
+
+        this->m_connectors["OAMDMA"] = std::make_shared<Connector>(DataInterface{
+                .read = [](uint32_t, uint32_t &) {
+                    return false;
+                },
+                .write = [this](uint32_t address, uint32_t data) {
+                    if(address == 0x4014)
+                        OAMDMA(data);
+                }
+        });
+    }
+
+    ~RP2A03() override = default;
+
+    void init() override {
+
+        // Init CPU part.
+        MOS6502<BusT>::init();
+
+        // Init 2A03-specific parts.
+        for(uint16_t i = 0; i <= 0xF; i++){
+            this->m_mainBus.write(0x4000 + i, 0x00);
+        }
+
+        for(uint16_t i : {0x4017, 0x4015, 0x4010, 0x4011, 0x4012, 0x4013}){
+            this->m_mainBus.write(i, 0x00);
+        }
+    }
+
+    /**
+     * Run the OAM DMA: dump contents of 0xXX00-0xXXFF to OAM memory through OAMDATA register.
+     * Normally triggered by a write to 0x4014.
+     * @param page High byte of the source address.
+     * */
+    void OAMDMA(uint8_t page) {
 
-    void init() override;
+        for(int index = 0; index <= 0xFF; index++) {
+            this->m_mainBus.write(0x2004, this->m_mainBus.read((page << 8) | index));
+        }
+        this->m_cycles += 513;
+    }
 };
 
 #endif //USE_2A03_H
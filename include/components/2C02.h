@@ -11,18 +11,31 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
 #include <vector>
 #include "Port.h"
 #include "Component.h"
 #include "Types.h"
+#include "FrameSink.h"
+#include "components/CodeDataLogger.h"
+#include "components/DebugHooks.h"
+
+class StateHasher;
 
 /**
  * NES PPU emulation. Both foreground and background cycle-accurate rendering implemented, sprite 0 bug
  * and other quirks are also emulated.
  *
- * Ports: data "ppuBus" to control a communication on the PPU's own bus; signal "INT" to send interrupts to the CPU (normally connected to the NMI).
+ * The PPU bus is accessed through the bus policy BusT (same as the MOS6502 bus): DataPort by default,
+ * or a system-specific memory map. The template definitions are in 2C02Impl.h, the DataPort variant is
+ * instantiated in 2C02.cpp.
+ *
+ * Ports: data "ppuBus" to control a communication on the PPU's own bus (DataPort bus only); signal "INT" to send interrupts to the CPU (normally connected to the NMI).
  * Connectors: data "cpuBus" to connect to the CPU, signal "CLK" to clock the PPU (standard rate is 21.477272 MHz ÷ 4).
 */
+template<class BusT = DataPort>
 class R2C02 : public Component {
 
 /**
@@ -40,6 +53,8 @@ class R2C02 : public Component {
  * - = invisible screen
 */
 protected:
+    /// The bus is a port of the component graph.
+    static constexpr bool PORT_BUS = std::is_same_v<BusT, DataPort>;
 
     // ===========================================
     // PPU memory addresses
@@ -57,6 +72,8 @@ protected:
     static const uint16_t PATTERN_TABLE_TILE_ROW_COUNT = 16;
     static const uint16_t PATTERN_TABLE_TILE_COLUMN_COUNT = 16;
     static const uint16_t PATTERN_TABLE_PLANE_SIZE = 8;
+    /// Pattern table bitmap is 16x16 tiles of 8x8 pixels.
+    static const uint16_t PATTERN_TABLE_BITMAP_SIZE = PATTERN_TABLE_TILE_COLUMN_COUNT * 8;
 
     /// Data lines sometimes act as a buffer because of their capacitance.
     uint8_t m_dataBuffer = 0x00;
@@ -254,6 +271,19 @@ protected:
     /// Background pixel placement enabled.
     bool m_settingsEnableBackground = true;
 
+    /**
+     * Skip the pixel composition (color lookup and framebuffer write).
+     * Everything visible to the rest of the system (sprite 0 hit, sprite overflow, VRAM address
+     * increments and PPU bus accesses) is still emulated. Used by the frame skipping.
+    */
+    bool m_renderSkip = false;
+
+    /// Code/Data Logger of the cartridge, told about the CPU reads through PPUDATA. Optional.
+    CodeDataLogger * m_codeDataLogger = nullptr;
+
+    /// The CLK connector runs clock<DebugHooks>, clock<NoHooks> otherwise.
+    bool m_debugHooks = true;
+
     /**
      * Suppress NMI generation and NMI flag setting.
      * Used by a special case during reading NMI flag near the clock 1 of the scanline 241,
@@ -263,9 +293,9 @@ protected:
     bool m_blockNMI = false;
 
     /**
-     * Default 2C02 color pallete.
+     * Default 2C02 color pallete, shared by all instances.
     */
-    const RGBPixel m_colors2C02[64] = {
+    static constexpr RGBPixel COLORS_2C02[64] = {
 
             {84, 84, 84},
             {0, 30, 116},
@@ -336,7 +366,7 @@ protected:
     //External PPU colors.
 
     // Current PPU rendering colors.
-    const RGBPixel *m_colors = m_colors2C02;
+    const RGBPixel *m_colors = COLORS_2C02;
 
     // ===============================================
     // Background rendering procedures.
@@ -367,8 +397,24 @@ protected:
     // Current rendering coordinates.
     int m_clock, m_scanline;
     // ===============================================
-    // NES screen.
-    std::vector<std::vector<RGBPixel>> m_screen{OUTPUT_BITMAP_HEIGHT, {OUTPUT_BITMAP_WIDTH, {0, 0, 0}}};
+    // NES screen, double buffered: pixels are composed into the back buffer,
+    // the front buffer holds the last finished frame and is handed to the frame sinks.
+    // The buffers are shared with the copies of the state (see copyState) and with the black frame,
+    // a shared back buffer is replaced before the composition (see prepareBackBuffer).
+    std::shared_ptr<RGBPixel[]> m_frameBuffers[2];
+    // Buffers owned by this PPU (never shared since allocated), only these are composed in place.
+    // Tracked explicitly rather than by the reference count, so the copies can run on different threads.
+    mutable bool m_frameBufferOwned[2] = {false, false};
+    // Index of the back buffer.
+    uint8_t m_backBuffer = 0;
+    /// Black frame shown before the first frame is finished, shared by all instances.
+    static const std::shared_ptr<RGBPixel[]> & blackFrame();
+    /**
+     * Make the back buffer private (copy it if not owned) before the pixels are composed to it.
+     * */
+    void prepareBackBuffer();
+    // Pattern table bitmap for the debugger, allocated on the first use and then reused every frame.
+    std::vector<RGBPixel> m_patternTableBitmap;
 
     // Internal PPU bus I/O.
     /**
@@ -398,7 +444,7 @@ protected:
     // I/O
     // ===========================================
     // Connection to the PPU bus (controlled by the PPU).
-    DataPort m_ppuBus;
+    BusT m_ppuBus;
     // Interrupt generator. Normally connected to the 6502's NMI pin.
     SignalPort m_INT;
 
@@ -407,8 +453,9 @@ public:
     /**
      * Default constructor.
      * Reset PPU status and rendering.
+     * @param bus PPU bus policy instance.
     */
-    R2C02();
+    explicit R2C02(BusT bus = {});
     /**
      * Default destructor.
     */
@@ -425,9 +472,35 @@ public:
      * Proceed one clock further in emulation.
      * Works as a physical CLK input.
      * 1 PPU cycle = 186 ns
+     * @tparam Hooks Hooks policy (see DebugHooks.h), NoHooks ignores the layer toggles of the settings window.
     */
+    template<class Hooks = DebugHooks>
     void clock();
 
+    /**
+     * Select the clock instantiation used by the CLK connector.
+     * @param enabled True to clock with DebugHooks, false with NoHooks.
+    */
+    void setDebugHooksEnabled(bool enabled);
+
+    [[nodiscard]] bool isDebugHooksEnabled() const;
+
+    // ===============================================
+    // CPU interface, used by the "cpuBus" connector.
+    /**
+     * Read a register.
+     * @param address CPU address.
+     * @param buffer Read data.
+     * @return True if the address belongs to the PPU ($2000-$3FFF and $4014).
+    */
+    bool cpuRead(uint16_t address, uint8_t & buffer);
+    /**
+     * Write a register.
+     * @param address CPU address, ignored outside $2000-$3FFF.
+     * @param data Data to write.
+    */
+    void cpuWrite(uint16_t address, uint8_t data);
+
     // ===============================================
     /**
      * PPU OAM DMA.
@@ -442,12 +515,21 @@ public:
     uint8_t *getPaletteRAM();
     /**
      * Get a pattern table.
+     * The bitmap is rendered to an internal buffer, it is overwritten by the next call.
+     * @return PATTERN_TABLE_BITMAP_SIZE x PATTERN_TABLE_BITMAP_SIZE pixels, row by row.
     */
-    std::vector<std::vector<RGBPixel>> getPatternTable(uint8_t colorType, uint8_t paletteId, uint8_t index, bool applyEffects = false);
+    const std::vector<RGBPixel> & getPatternTable(uint8_t colorType, uint8_t paletteId, uint8_t index, bool applyEffects = false);
     /**
      * Get a NES screen.
+     * @return The last finished frame (front buffer), valid until the next frame is finished.
     */
-    std::vector<RGBPixel> getScreen();
+    std::span<const RGBPixel> getScreen() const;
+    /**
+     * Get the last finished frame without copying.
+     * The data stays valid until the next composed frame is finished.
+     * @return View of the front buffer (frame number is not set).
+    */
+    VideoFrame getFrame() const;
     /**
      * Is a scanline finished?
      * @return true if clock index >= 341
@@ -459,8 +541,55 @@ public:
     */
     bool frameFinished() const;
 
+    /**
+     * Get the current scanline.
+     * @return Scanline index, -1 is the pre-render scanline.
+     * */
+    [[nodiscard]] int getScanline() const;
+
+    /**
+     * Get the next dot to be rendered on the current scanline.
+     * @return Dot index (0-340).
+     * */
+    [[nodiscard]] int getCycle() const;
+
+    /**
+     * Set the Code/Data Logger. CHR reads through PPUDATA are logged as read, the others as rendered.
+     * @param logger Logger, nullptr if none.
+     * */
+    void setCodeDataLogger(CodeDataLogger * logger);
+
+    /**
+     * Enable or disable the render-skip mode.
+     * In the render-skip mode, the PPU behaves exactly the same to the rest of the system but
+     * the pixels are not composed to the screen (the last composed frame is kept).
+     * @param skip true to skip the pixel composition.
+    */
+    void setRenderSkip(bool skip);
+    /**
+     * Is the render-skip mode enabled?
+     * @return true if the pixel composition is skipped.
+    */
+    bool renderSkip() const;
+
+    /**
+     * Copy the emulation state (registers, OAM, palettes, rendering position and the screen) of another PPU.
+     * The screen buffers are shared until composed to. The wiring and the debugging settings are kept.
+     * @param other PPU to copy.
+     * */
+    void copyState(const R2C02 & other);
+
+    /**
+     * Hash the emulation state. The screen is not included (see HashFrameSink), neither is the render-skip mode,
+     * which doesn't affect the emulation.
+     * @param hasher Hasher to feed.
+     * */
+    void hashState(StateHasher & hasher) const;
+
     std::vector<EmulatorWindow> getGUIs() override;
 
 };
 
+extern template class R2C02<DataPort>;
+
 #endif //USE_2C02_H
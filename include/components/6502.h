@@ -13,18 +13,55 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <memory>
+#include <type_traits>
 #include "Component.h"
+#include "Port.h"
 #include "Types.h"
+#include "components/Breakpoints.h"
+#include "components/CodeDataLogger.h"
+#include "components/DebugHooks.h"
+#include "components/GuestProfiler.h"
+#include "components/TraceLogger.h"
+
+class StateHasher;
+
+/**
+ * Bus policy of MOS6502: flat 64 KiB memory without any devices.
+ * Every access compiles to a plain array access.
+ * */
+struct FlatBus {
+    /// 64 KiB of memory, owned by the user.
+    uint8_t * memory = nullptr;
+
+    [[nodiscard]] uint8_t read(uint16_t address) const {
+        return memory[address];
+    }
+
+    void write(uint16_t address, uint8_t data) {
+        memory[address] = data;
+    }
+};
 
 /**
  * MOS 6502 CPU emulation. It is cycle-accurate, interrupts are implemented as precisely as possible but
  * there is no decimal mode.
  *
- * Ports: data "mainBus" to control a communication with other components.
+ * The memory is accessed through the bus policy BusT, which has read(address) and write(address, data):
+ * - DataPort (default): the "mainBus" port of the component graph, used by the GUI systems,
+ * - FlatBus: a flat 64 KiB array,
+ * - a system-specific memory map, so every access can be inlined.
+ * The template definitions are in 6502Impl.h, the DataPort and FlatBus variants are instantiated in 6502.cpp.
+ *
+ * Ports: data "mainBus" to control a communication with other components (DataPort bus only).
  * Connectors: signal "IRQ" (maskable interrupt), "NMI" (non-maskable interrupt), "CLK" (clock input, standard rate is 1.789773 MHz).
  * */
+template<class BusT = DataPort>
 class MOS6502 : public Component{
 protected:
+    /// The bus is a port of the component graph, watchpoints hook it.
+    static constexpr bool PORT_BUS = std::is_same_v<BusT, DataPort>;
+
     // ===========================================
     // CPU internals
     // ===========================================
@@ -49,28 +86,10 @@ protected:
 
     using m = MOS6502;
     /**
-     * Opcode lookup table.
+     * Opcode lookup table, shared by all instances (defined in 6502Impl.h).
      * Not defined opcodes are assigned mnemonic "???" and execute NOP instruction.
     */
-    const instruction_t lookup[256] =
-            {  //0                                1                                2                                3                                4                                5                                6                                7                                8                                9                                 A                               B                                C                                D                                E                                F
-                    /*0*/{"BRK", &m::IMP, &m::BRK, 1, 7}, {"ORA", &m::IDX, &m::ORA, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SLO", &m::IDX, &m::SLO, 2, 8}, {"NOP", &m::ZP0, &m::NOP, 2, 3}, {"ORA", &m::ZP0, &m::ORA, 2, 3}, {"ASL", &m::ZP0, &m::ASL, 2, 5}, {"SLO", &m::ZP0, &m::SLO, 2, 5}, {"PHP", &m::IMP, &m::PHP, 1, 3}, {"ORA", &m::IMM, &m::ORA, 2, 2}, {"ASL", &m::ACC, &m::ASL, 1, 2}, {"ANC", &m::IMM, &m::ANC, 2, 2}, {"NOP", &m::ABS, &m::NOP, 3, 4}, {"ORA", &m::ABS, &m::ORA, 3, 4}, {"ASL", &m::ABS, &m::ASL, 3, 6}, {"SLO", &m::ABS, &m::SLO, 3, 6},
-                    /*1*/{"BPL", &m::REL, &m::BPL, 2, 2}, {"ORA", &m::IDY, &m::ORA, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SLO", &m::IDY, &m::SLO, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"ORA", &m::ZPX, &m::ORA, 2, 4}, {"ASL", &m::ZPX, &m::ASL, 2, 6}, {"SLO", &m::ZPX, &m::SLO, 2, 6}, {"CLC", &m::IMP, &m::CLC, 1, 2}, {"ORA", &m::ABY, &m::ORA, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"SLO", &m::ABY, &m::SLO, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"ORA", &m::ABX, &m::ORA, 3, 4}, {"ASL", &m::ABX, &m::ASL, 3, 7}, {"SLO", &m::ABX, &m::SLO, 3, 7},
-                    /*2*/{"JSR", &m::ABS, &m::JSR, 3, 6}, {"AND", &m::IDX, &m::AND, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RLA", &m::IDX, &m::RLA, 2, 8}, {"BIT", &m::ZP0, &m::BIT, 2, 3}, {"AND", &m::ZP0, &m::AND, 2, 3}, {"ROL", &m::ZP0, &m::ROL, 2, 5}, {"RLA", &m::ZP0, &m::RLA, 2, 5}, {"PLP", &m::IMP, &m::PLP, 1, 4}, {"AND", &m::IMM, &m::AND, 2, 2}, {"ROL", &m::ACC, &m::ROL, 1, 2}, {"ANC", &m::IMM, &m::ANC, 2, 2}, {"BIT", &m::ABS, &m::BIT, 3, 4}, {"AND", &m::ABS, &m::AND, 3, 4}, {"ROL", &m::ABS, &m::ROL, 3, 6}, {"RLA", &m::ABS, &m::RLA, 3, 6},
-                    /*3*/{"BMI", &m::REL, &m::BMI, 2, 2}, {"AND", &m::IDY, &m::AND, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RLA", &m::IDY, &m::RLA, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"AND", &m::ZPX, &m::AND, 2, 4}, {"ROL", &m::ZPX, &m::ROL, 2, 6}, {"RLA", &m::ZPX, &m::RLA, 2, 6}, {"SEC", &m::IMP, &m::SEC, 1, 2}, {"AND", &m::ABY, &m::AND, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"RLA", &m::ABY, &m::RLA, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"AND", &m::ABX, &m::AND, 3, 4}, {"ROL", &m::ABX, &m::ROL, 3, 7}, {"RLA", &m::ABX, &m::RLA, 3, 7},
-                    /*4*/{"RTI", &m::IMP, &m::RTI, 1, 6}, {"EOR", &m::IDX, &m::EOR, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SRE", &m::IDX, &m::SRE, 2, 8}, {"NOP", &m::ZP0, &m::NOP, 2, 3}, {"EOR", &m::ZP0, &m::EOR, 2, 3}, {"LSR", &m::ZP0, &m::LSR, 2, 5}, {"SRE", &m::ZP0, &m::SRE, 2, 5}, {"PHA", &m::IMP, &m::PHA, 1, 3}, {"EOR", &m::IMM, &m::EOR, 2, 2}, {"LSR", &m::ACC, &m::LSR, 1, 2}, {"ALR", &m::IMM, &m::ALR, 2, 2}, {"JMP", &m::ABS, &m::JMP, 3, 3}, {"EOR", &m::ABS, &m::EOR, 3, 4}, {"LSR", &m::ABS, &m::LSR, 3, 6}, {"SRE", &m::ABS, &m::SRE, 3, 6},
-                    /*5*/{"BVC", &m::REL, &m::BVC, 2, 2}, {"EOR", &m::IDY, &m::EOR, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SRE", &m::IDY, &m::SRE, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"EOR", &m::ZPX, &m::EOR, 2, 4}, {"LSR", &m::ZPX, &m::LSR, 2, 6}, {"SRE", &m::ZPX, &m::SRE, 2, 6}, {"CLI", &m::IMP, &m::CLI, 1, 2}, {"EOR", &m::ABY, &m::EOR, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"SRE", &m::ABY, &m::SRE, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"EOR", &m::ABX, &m::EOR, 3, 4}, {"LSR", &m::ABX, &m::LSR, 3, 7}, {"SRE", &m::ABX, &m::SRE, 3, 7},
-                    /*6*/{"RTS", &m::IMP, &m::RTS, 1, 6}, {"ADC", &m::IDX, &m::ADC, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RRA", &m::IDX, &m::RRA, 2, 8}, {"NOP", &m::ZP0, &m::NOP, 2, 3}, {"ADC", &m::ZP0, &m::ADC, 2, 3}, {"ROR", &m::ZP0, &m::ROR, 2, 5}, {"RRA", &m::ZP0, &m::RRA, 2, 5}, {"PLA", &m::IMP, &m::PLA, 1, 4}, {"ADC", &m::IMM, &m::ADC, 2, 2}, {"ROR", &m::ACC, &m::ROR, 1, 2}, {"ARR", &m::IMM, &m::ARR, 2, 2}, {"JMP", &m::ID0, &m::JMP, 3, 5}, {"ADC", &m::ABS, &m::ADC, 3, 4}, {"ROR", &m::ABS, &m::ROR, 3, 6}, {"RRA", &m::ABS, &m::RRA, 3, 6},
-                    /*7*/{"BVS", &m::REL, &m::BVS, 2, 2}, {"ADC", &m::IDY, &m::ADC, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RRA", &m::IDY, &m::RRA, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"ADC", &m::ZPX, &m::ADC, 2, 4}, {"ROR", &m::ZPX, &m::ROR, 2, 6}, {"RRA", &m::ZPX, &m::RRA, 2, 6}, {"SEI", &m::IMP, &m::SEI, 1, 2}, {"ADC", &m::ABY, &m::ADC, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"RRA", &m::ABY, &m::RRA, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"ADC", &m::ABX, &m::ADC, 3, 4}, {"ROR", &m::ABX, &m::ROR, 3, 7}, {"RRA", &m::ABX, &m::RRA, 3, 7},
-                    /*8*/{"NOP", &m::IMM, &m::NOP, 2, 2}, {"STA", &m::IDX, &m::STA, 2, 6}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"SAX", &m::IDX, &m::SAX, 2, 6}, {"STY", &m::ZP0, &m::STY, 2, 3}, {"STA", &m::ZP0, &m::STA, 2, 3}, {"STX", &m::ZP0, &m::STX, 2, 3}, {"SAX", &m::ZP0, &m::SAX, 2, 3}, {"DEY", &m::IMP, &m::DEY, 1, 2}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"TXA", &m::IMP, &m::TXA, 1, 2}, {"ANE", &m::IMM, &m::ANE, 2, 2}, {"STY", &m::ABS, &m::STY, 3, 4}, {"STA", &m::ABS, &m::STA, 3, 4}, {"STX", &m::ABS, &m::STX, 3, 4}, {"SAX", &m::ABS, &m::SAX, 3, 4},
-                    /*9*/{"BCC", &m::REL, &m::BCC, 2, 2}, {"STA", &m::IDY, &m::STA, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SHA", &m::IDY, &m::SHA, 2, 6}, {"STY", &m::ZPX, &m::STY, 2, 4}, {"STA", &m::ZPX, &m::STA, 2, 4}, {"STX", &m::ZPY, &m::STX, 2, 4}, {"SAX", &m::ZPY, &m::SAX, 2, 4}, {"TYA", &m::IMP, &m::TYA, 1, 2}, {"STA", &m::ABY, &m::STA, 3, 5}, {"TXS", &m::IMP, &m::TXS, 1, 2}, {"TAS", &m::ABY, &m::TAS, 3, 5}, {"SHY", &m::ABX, &m::SHY, 3, 5}, {"STA", &m::ABX, &m::STA, 3, 5}, {"SHX", &m::ABY, &m::SHX, 3, 5}, {"SHA", &m::ABY, &m::SHA, 3, 5},
-                    /*A*/{"LDY", &m::IMM, &m::LDY, 2, 2}, {"LDA", &m::IDX, &m::LDA, 2, 6}, {"LDX", &m::IMM, &m::LDX, 2, 2}, {"LAX", &m::IDX, &m::LAX, 2, 6}, {"LDY", &m::ZP0, &m::LDY, 2, 3}, {"LDA", &m::ZP0, &m::LDA, 2, 3}, {"LDX", &m::ZP0, &m::LDX, 2, 3}, {"LAX", &m::ZP0, &m::LAX, 2, 3}, {"TAY", &m::IMP, &m::TAY, 1, 2}, {"LDA", &m::IMM, &m::LDA, 2, 2}, {"TAX", &m::IMP, &m::TAX, 1, 2}, {"LXA", &m::IMM, &m::LXA, 2, 2}, {"LDY", &m::ABS, &m::LDY, 3, 4}, {"LDA", &m::ABS, &m::LDA, 3, 4}, {"LDX", &m::ABS, &m::LDX, 3, 4}, {"LAX", &m::ABS, &m::LAX, 3, 4},
-                    /*B*/{"BCS", &m::REL, &m::BCS, 2, 2}, {"LDA", &m::IDY, &m::LDA, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"LAX", &m::IDY, &m::LAX, 2, 5}, {"LDY", &m::ZPX, &m::LDY, 2, 4}, {"LDA", &m::ZPX, &m::LDA, 2, 4}, {"LDX", &m::ZPY, &m::LDX, 2, 4}, {"LAX", &m::ZPY, &m::LAX, 2, 4}, {"CLV", &m::IMP, &m::CLV, 1, 2}, {"LDA", &m::ABY, &m::LDA, 3, 4}, {"TSX", &m::IMP, &m::TSX, 1, 2}, {"LAS", &m::ABY, &m::LAS, 3, 4}, {"LDY", &m::ABX, &m::LDY, 3, 4}, {"LDA", &m::ABX, &m::LDA, 3, 4}, {"LDX", &m::ABY, &m::LDX, 3, 4}, {"LAX", &m::ABY, &m::LAX, 3, 4},
-                    /*C*/{"CPY", &m::IMM, &m::CPY, 2, 2}, {"CMP", &m::IDX, &m::CMP, 2, 6}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"DCP", &m::IDX, &m::DCP, 2, 8}, {"CPY", &m::ZP0, &m::CPY, 2, 3}, {"CMP", &m::ZP0, &m::CMP, 2, 3}, {"DEC", &m::ZP0, &m::DEC, 2, 5}, {"DCP", &m::ZP0, &m::DCP, 2, 5}, {"INY", &m::IMP, &m::INY, 1, 2}, {"CMP", &m::IMM, &m::CMP, 2, 2}, {"DEX", &m::IMP, &m::DEX, 1, 2}, {"SBX", &m::IMM, &m::SBX, 2, 2}, {"CPY", &m::ABS, &m::CPY, 3, 4}, {"CMP", &m::ABS, &m::CMP, 3, 4}, {"DEC", &m::ABS, &m::DEC, 3, 6}, {"DCP", &m::ABS, &m::DCP, 3, 6},
-                    /*D*/{"BNE", &m::REL, &m::BNE, 2, 2}, {"CMP", &m::IDY, &m::CMP, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"DCP", &m::IDY, &m::DCP, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"CMP", &m::ZPX, &m::CMP, 2, 4}, {"DEC", &m::ZPX, &m::DEC, 2, 6}, {"DCP", &m::ZPX, &m::DCP, 2, 6}, {"CLD", &m::IMP, &m::CLD, 1, 2}, {"CMP", &m::ABY, &m::CMP, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"DCP", &m::ABY, &m::DCP, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"CMP", &m::ABX, &m::CMP, 3, 4}, {"DEC", &m::ABX, &m::DEC, 3, 7}, {"DCP", &m::ABX, &m::DCP, 3, 7},
-                    /*E*/{"CPX", &m::IMM, &m::CPX, 2, 2}, {"SBC", &m::IDX, &m::SBC, 2, 6}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"ISB", &m::IDX, &m::ISB, 2, 8}, {"CPX", &m::ZP0, &m::CPX, 2, 3}, {"SBC", &m::ZP0, &m::SBC, 2, 3}, {"INC", &m::ZP0, &m::INC, 2, 5}, {"ISB", &m::ZP0, &m::ISB, 2, 5}, {"INX", &m::IMP, &m::INX, 1, 2}, {"SBC", &m::IMM, &m::SBC, 2, 2}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"SBC", &m::IMM, &m::SBC, 2, 2}, {"CPX", &m::ABS, &m::CPX, 3, 4}, {"SBC", &m::ABS, &m::SBC, 3, 4}, {"INC", &m::ABS, &m::INC, 3, 6}, {"ISB", &m::ABS, &m::ISB, 3, 6},
-                    /*F*/{"BEQ", &m::REL, &m::BEQ, 2, 2}, {"SBC", &m::IDY, &m::SBC, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"ISB", &m::IDY, &m::ISB, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"SBC", &m::ZPX, &m::SBC, 2, 4}, {"INC", &m::ZPX, &m::INC, 2, 6}, {"ISB", &m::ZPX, &m::ISB, 2, 6}, {"SED", &m::IMP, &m::SED, 1, 2}, {"SBC", &m::ABY, &m::SBC, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"ISB", &m::ABY, &m::ISB, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"SBC", &m::ABX, &m::SBC, 3, 4}, {"INC", &m::ABX, &m::INC, 3, 7}, {"ISB", &m::ABX, &m::ISB, 3, 7}
-            };
+    static const instruction_t lookup[256];
 
     /// Status register flags. Not using bit fields to ease external manipulation.
     struct status_flags_t {
@@ -105,19 +124,18 @@ protected:
     // ===========================================
     // Emulation helper variables
     // ===========================================
+    // The fields used on every cycle are packed together after the registers.
     /// Absolute address.
     uint16_t m_addrAbs = false;
     /// Relative address.
     uint16_t m_addrRel = false;
     /// Currently remaining cycles.
     uint8_t m_cycles   = 0;
-    /// All cycles.
-    unsigned long long m_cycleCount = 0;
     /// Signalizes accumulator operation address mode.
     bool m_accOperation = false;
 
     /// Next CPU mode.
-    enum class nextMode_t {
+    enum class nextMode_t : uint8_t {
         /// Fetch next instruction.
         INSTRUCTION,
         /// Jump to NMI ISR.
@@ -137,16 +155,52 @@ protected:
     /// Previous interrupt mask flag state.
     bool m_oldInterruptMask = false;
 
-    /// Current instruction, initialized to NOP.
-    instruction_t m_currentInstruction;
     /// Current opcode (instruction index).
     uint8_t m_currentOpcode = 0xEA;
+    /// Current instruction (lookup table entry), initialized to NOP.
+    const instruction_t * m_currentInstruction;
+    /// All cycles.
+    unsigned long long m_cycleCount = 0;
+
+    /// Guest code profiler, only allocated while the profiler mode is enabled.
+    std::unique_ptr<GuestProfiler> m_guestProfiler;
+    /// Returns the PRG ROM bank mapped at an address (for the profiler), bank 0 is used if empty.
+    std::function<uint32_t(uint16_t)> m_bankResolver;
+
+    /// Instruction trace, only allocated while tracing.
+    std::unique_ptr<TraceLogger> m_traceLogger;
+    /// Side-effect free memory read for the trace and the breakpoint conditions, the main bus is used if empty.
+    TraceLogger::PeekFunction m_debugPeek;
+    /// PPU position for the trace, optional.
+    TraceLogger::PositionFunction m_tracePosition;
+    /// Trace file path in the GUI.
+    char m_tracePath[256] = "trace.log";
+    /// Error of the last trace start in the GUI.
+    std::string m_traceStatus;
+
+    /// Code/Data Logger of the ROM, which is told the kind of the following reads. Optional.
+    CodeDataLogger * m_codeDataLogger = nullptr;
+
+    /// Breakpoints and watchpoints.
+    Breakpoints m_breakpoints;
+    /// Memory read for the breakpoint conditions (see peek()).
+    Breakpoints::PeekFunction m_breakpointPeek;
+    /// Main bus wrapper checking the watchpoints, the main bus port is connected to it while any is enabled.
+    std::shared_ptr<Connector> m_watchConnector;
+    /// The original main bus connection while the watchpoints are hooked.
+    DataPort m_watchedBus;
+    bool m_watching = false;
+
+    /// The CLK connector runs CLK<DebugHooks>, CLK<NoHooks> otherwise.
+    bool m_debugHooks = true;
 
     // ===========================================
     // Emulator internal functions
     // ===========================================
-    /// Get current address mode description.
-    std::string getCurrentAddressString();
+    /// Address mode description, formatted in place so the debugger doesn't allocate.
+    char m_addressString[24] = {};
+    /// Get current address mode description, valid until the next call.
+    const char * getCurrentAddressString();
     /**
      * Process an IRQ.
      */
@@ -160,18 +214,49 @@ protected:
      * This function sets the CPU to a default power-on state.
      * */
     void hardReset();
+    /**
+     * Pass the executed instruction to the guest profiler.
+     * @param address Address of the instruction.
+     * @param cycles Cycles consumed by the instruction.
+     * */
+    void profileInstruction(uint16_t address, uint8_t cycles);
+    /**
+     * Pass the interrupt entry to the guest profiler.
+     * @param entry Interrupt type.
+     * */
+    void profileInterrupt(GuestProfiler::ENTRY entry);
+    /// Get the bank mapped at the address.
+    uint32_t getBank(uint16_t address) const;
+    /// Get the status register value as pushed by PHP without the B flag.
+    uint8_t getStatusByte() const;
+    /// Read memory for debugging, without side effects if the debug peek source is set.
+    uint8_t peek(uint16_t address);
+    /**
+     * Get the breakpoint condition values.
+     * @param address Accessed address.
+     * @param value Accessed data.
+     * */
+    Breakpoints::Context getBreakpointContext(uint16_t address, uint8_t value) const;
+    /// Check the execution breakpoints at the address of the next instruction or interrupt handler.
+    void checkExecutionBreakpoints();
+    /// Hook the main bus accesses if any watchpoint is enabled, unhook otherwise.
+    void updateWatchpoints();
 
     // ===========================================
     // I/O
     // ===========================================
     /// Connection to the main system bus.
-    DataPort m_mainBus;
+    BusT m_mainBus;
 
     /// Interrupt request signal.
     void IRQ(bool active);
     /// Non-maskable interrupt signal.
     void NMI();
-    /// Master clock.
+    /**
+     * Master clock.
+     * @tparam Hooks Hooks policy (see DebugHooks.h), NoHooks skips the trace, profiler, breakpoints and CDL.
+     * */
+    template<class Hooks = DebugHooks>
     void CLK();
 
     // ===========================================
@@ -297,7 +382,11 @@ protected:
 
 public:
 
-    explicit MOS6502();
+    /**
+     * Create a CPU.
+     * @param bus Bus policy instance (e.g. FlatBus with its memory set).
+     * */
+    explicit MOS6502(BusT bus = {});
     ~MOS6502() override;
 
     void init() override;
@@ -306,7 +395,130 @@ public:
 
     void softReset();
 
+    /**
+     * Copy the emulation state (registers and the state of the current instruction) of another CPU.
+     * The wiring and the debugging state (trace, profiler, breakpoints) are kept.
+     * @param other CPU to copy.
+     * */
+    void copyState(const MOS6502 & other);
+
+    /**
+     * Hash the emulation state, the same state as copyState copies.
+     * @param hasher Hasher to feed.
+     * */
+    void hashState(StateHasher & hasher) const;
+
+    /**
+     * Select the clock instantiation used by the CLK connector.
+     *
+     * With the debug hooks disabled, the instruction trace, guest profiler, breakpoints, watchpoints
+     * and the Code/Data Logger access kinds are not updated, but their configuration is kept.
+     *
+     * @param enabled True to clock with DebugHooks, false with NoHooks.
+     * */
+    void setDebugHooksEnabled(bool enabled);
+
+    [[nodiscard]] bool isDebugHooksEnabled() const;
+
+    /**
+     * Enable or disable the guest code profiler (see GuestProfiler).
+     * Enabling starts a new profile.
+     * @param enabled True to profile the executed code.
+     * */
+    void setGuestProfilerEnabled(bool enabled);
+
+    /**
+     * Get the guest code profiler.
+     * @return Pointer to the profiler, nullptr if disabled.
+     * */
+    [[nodiscard]] GuestProfiler * getGuestProfiler();
+
+    /**
+     * Set the function which reports the PRG ROM bank mapped at an address.
+     * Used to tell apart banked code in the guest profiler.
+     * @param resolver Function returning the 16 KiB PRG ROM bank index of an address.
+     * */
+    void setBankResolver(std::function<uint32_t(uint16_t)> resolver);
+
+    /**
+     * Set the Code/Data Logger, whose access kind is set before every instruction fetch and execution
+     * (code, data, indirect jump target, indirect data).
+     * @param logger Logger, nullptr if none.
+     * */
+    void setCodeDataLogger(CodeDataLogger * logger);
+
+    /**
+     * Set the data sources of the instruction trace (see TraceLogger) and the breakpoint conditions.
+     * @param peek Memory read without side effects, the main bus is read if empty.
+     * @param position PPU position source, the PPU field is omitted if empty.
+     * */
+    void setDebugSources(TraceLogger::PeekFunction peek, TraceLogger::PositionFunction position);
+
+    /**
+     * Start writing the instruction trace (one nestest.log line per instruction).
+     * A running trace is finished first.
+     * @param path Output file path.
+     * @throw std::runtime_error If the file can't be opened.
+     * */
+    void startTrace(const std::string & path);
+
+    /// Finish the instruction trace.
+    void stopTrace();
+
+    [[nodiscard]] bool isTracing() const;
+
+    /**
+     * Set the program counter (e.g. to start a test ROM at its automation entry).
+     * @param address New PC value.
+     * */
+    void setProgramCounter(uint16_t address);
+
+    [[nodiscard]] uint16_t getProgramCounter() const;
+
     [[nodiscard]] bool instrFinished() const;
+
+    /**
+     * Add a breakpoint (see Breakpoints). Execution breakpoints stop before the instruction at the address
+     * is fetched, watchpoints stop after the instruction which accessed the address (DataPort bus only).
+     * @param from First address.
+     * @param to Last address (inclusive).
+     * @param types Combination of Breakpoints::TYPE values.
+     * @param condition Condition expression, empty for an unconditional breakpoint.
+     * @return Index of the breakpoint.
+     * @throw std::invalid_argument If the breakpoint is invalid.
+     * */
+    size_t addBreakpoint(uint16_t from, uint16_t to, uint8_t types, const std::string & condition = "");
+
+    /**
+     * Remove a breakpoint.
+     * @param index Index of the breakpoint.
+     * @throw std::out_of_range If there is no such breakpoint.
+     * */
+    void removeBreakpoint(size_t index);
+
+    /**
+     * Enable or disable a breakpoint.
+     * @param index Index of the breakpoint.
+     * @param enabled False to ignore the breakpoint.
+     * @throw std::out_of_range If there is no such breakpoint.
+     * */
+    void setBreakpointEnabled(size_t index, bool enabled);
+
+    [[nodiscard]] const Breakpoints & getBreakpoints() const;
+
+    /**
+     * Check whether a breakpoint was hit. The system should stop clocking the CPU once it is set.
+     * @return True until clearBreakpointHit() is called.
+     * */
+    [[nodiscard]] bool breakpointHit() const {
+        return m_breakpoints.isHit();
+    }
+
+    /// Acknowledge the breakpoint hit to continue.
+    void clearBreakpointHit();
 };
 
+extern template class MOS6502<DataPort>;
+extern template class MOS6502<FlatBus>;
+
 #endif //USE_6502_H
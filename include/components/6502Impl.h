@@ -0,0 +1,1771 @@
+/**
+ * @file 6502Impl.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief MOS6502 CPU template definitions.
+ * @copyright Copyright (c) 2022 Ondrej Golasowski
+ *
+ * Included only by the translation units instantiating MOS6502 with their own bus policy.
+ * The DataPort and FlatBus variants are instantiated in 6502.cpp.
+ */
+
+#ifndef USE_6502IMPL_H
+#define USE_6502IMPL_H
+
+#include "components/6502.h"
+#include "Connector.h"
+#include "imgui.h"
+#include "Profiler.h"
+#include "StateHasher.h"
+#include <memory>
+#include <cstdio>
+
+template<class BusT>
+constexpr typename MOS6502<BusT>::instruction_t MOS6502<BusT>::lookup[256] =
+{  //0                                1                                2                                3                                4                                5                                6                                7                                8                                9                                 A                               B                                C                                D                                E                                F
+        /*0*/{"BRK", &m::IMP, &m::BRK, 1, 7}, {"ORA", &m::IDX, &m::ORA, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SLO", &m::IDX, &m::SLO, 2, 8}, {"NOP", &m::ZP0, &m::NOP, 2, 3}, {"ORA", &m::ZP0, &m::ORA, 2, 3}, {"ASL", &m::ZP0, &m::ASL, 2, 5}, {"SLO", &m::ZP0, &m::SLO, 2, 5}, {"PHP", &m::IMP, &m::PHP, 1, 3}, {"ORA", &m::IMM, &m::ORA, 2, 2}, {"ASL", &m::ACC, &m::ASL, 1, 2}, {"ANC", &m::IMM, &m::ANC, 2, 2}, {"NOP", &m::ABS, &m::NOP, 3, 4}, {"ORA", &m::ABS, &m::ORA, 3, 4}, {"ASL", &m::ABS, &m::ASL, 3, 6}, {"SLO", &m::ABS, &m::SLO, 3, 6},
+        /*1*/{"BPL", &m::REL, &m::BPL, 2, 2}, {"ORA", &m::IDY, &m::ORA, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SLO", &m::IDY, &m::SLO, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"ORA", &m::ZPX, &m::ORA, 2, 4}, {"ASL", &m::ZPX, &m::ASL, 2, 6}, {"SLO", &m::ZPX, &m::SLO, 2, 6}, {"CLC", &m::IMP, &m::CLC, 1, 2}, {"ORA", &m::ABY, &m::ORA, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"SLO", &m::ABY, &m::SLO, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"ORA", &m::ABX, &m::ORA, 3, 4}, {"ASL", &m::ABX, &m::ASL, 3, 7}, {"SLO", &m::ABX, &m::SLO, 3, 7},
+        /*2*/{"JSR", &m::ABS, &m::JSR, 3, 6}, {"AND", &m::IDX, &m::AND, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RLA", &m::IDX, &m::RLA, 2, 8}, {"BIT", &m::ZP0, &m::BIT, 2, 3}, {"AND", &m::ZP0, &m::AND, 2, 3}, {"ROL", &m::ZP0, &m::ROL, 2, 5}, {"RLA", &m::ZP0, &m::RLA, 2, 5}, {"PLP", &m::IMP, &m::PLP, 1, 4}, {"AND", &m::IMM, &m::AND, 2, 2}, {"ROL", &m::ACC, &m::ROL, 1, 2}, {"ANC", &m::IMM, &m::ANC, 2, 2}, {"BIT", &m::ABS, &m::BIT, 3, 4}, {"AND", &m::ABS, &m::AND, 3, 4}, {"ROL", &m::ABS, &m::ROL, 3, 6}, {"RLA", &m::ABS, &m::RLA, 3, 6},
+        /*3*/{"BMI", &m::REL, &m::BMI, 2, 2}, {"AND", &m::IDY, &m::AND, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RLA", &m::IDY, &m::RLA, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"AND", &m::ZPX, &m::AND, 2, 4}, {"ROL", &m::ZPX, &m::ROL, 2, 6}, {"RLA", &m::ZPX, &m::RLA, 2, 6}, {"SEC", &m::IMP, &m::SEC, 1, 2}, {"AND", &m::ABY, &m::AND, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"RLA", &m::ABY, &m::RLA, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"AND", &m::ABX, &m::AND, 3, 4}, {"ROL", &m::ABX, &m::ROL, 3, 7}, {"RLA", &m::ABX, &m::RLA, 3, 7},
+        /*4*/{"RTI", &m::IMP, &m::RTI, 1, 6}, {"EOR", &m::IDX, &m::EOR, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SRE", &m::IDX, &m::SRE, 2, 8}, {"NOP", &m::ZP0, &m::NOP, 2, 3}, {"EOR", &m::ZP0, &m::EOR, 2, 3}, {"LSR", &m::ZP0, &m::LSR, 2, 5}, {"SRE", &m::ZP0, &m::SRE, 2, 5}, {"PHA", &m::IMP, &m::PHA, 1, 3}, {"EOR", &m::IMM, &m::EOR, 2, 2}, {"LSR", &m::ACC, &m::LSR, 1, 2}, {"ALR", &m::IMM, &m::ALR, 2, 2}, {"JMP", &m::ABS, &m::JMP, 3, 3}, {"EOR", &m::ABS, &m::EOR, 3, 4}, {"LSR", &m::ABS, &m::LSR, 3, 6}, {"SRE", &m::ABS, &m::SRE, 3, 6},
+        /*5*/{"BVC", &m::REL, &m::BVC, 2, 2}, {"EOR", &m::IDY, &m::EOR, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SRE", &m::IDY, &m::SRE, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"EOR", &m::ZPX, &m::EOR, 2, 4}, {"LSR", &m::ZPX, &m::LSR, 2, 6}, {"SRE", &m::ZPX, &m::SRE, 2, 6}, {"CLI", &m::IMP, &m::CLI, 1, 2}, {"EOR", &m::ABY, &m::EOR, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"SRE", &m::ABY, &m::SRE, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"EOR", &m::ABX, &m::EOR, 3, 4}, {"LSR", &m::ABX, &m::LSR, 3, 7}, {"SRE", &m::ABX, &m::SRE, 3, 7},
+        /*6*/{"RTS", &m::IMP, &m::RTS, 1, 6}, {"ADC", &m::IDX, &m::ADC, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RRA", &m::IDX, &m::RRA, 2, 8}, {"NOP", &m::ZP0, &m::NOP, 2, 3}, {"ADC", &m::ZP0, &m::ADC, 2, 3}, {"ROR", &m::ZP0, &m::ROR, 2, 5}, {"RRA", &m::ZP0, &m::RRA, 2, 5}, {"PLA", &m::IMP, &m::PLA, 1, 4}, {"ADC", &m::IMM, &m::ADC, 2, 2}, {"ROR", &m::ACC, &m::ROR, 1, 2}, {"ARR", &m::IMM, &m::ARR, 2, 2}, {"JMP", &m::ID0, &m::JMP, 3, 5}, {"ADC", &m::ABS, &m::ADC, 3, 4}, {"ROR", &m::ABS, &m::ROR, 3, 6}, {"RRA", &m::ABS, &m::RRA, 3, 6},
+        /*7*/{"BVS", &m::REL, &m::BVS, 2, 2}, {"ADC", &m::IDY, &m::ADC, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"RRA", &m::IDY, &m::RRA, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"ADC", &m::ZPX, &m::ADC, 2, 4}, {"ROR", &m::ZPX, &m::ROR, 2, 6}, {"RRA", &m::ZPX, &m::RRA, 2, 6}, {"SEI", &m::IMP, &m::SEI, 1, 2}, {"ADC", &m::ABY, &m::ADC, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"RRA", &m::ABY, &m::RRA, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"ADC", &m::ABX, &m::ADC, 3, 4}, {"ROR", &m::ABX, &m::ROR, 3, 7}, {"RRA", &m::ABX, &m::RRA, 3, 7},
+        /*8*/{"NOP", &m::IMM, &m::NOP, 2, 2}, {"STA", &m::IDX, &m::STA, 2, 6}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"SAX", &m::IDX, &m::SAX, 2, 6}, {"STY", &m::ZP0, &m::STY, 2, 3}, {"STA", &m::ZP0, &m::STA, 2, 3}, {"STX", &m::ZP0, &m::STX, 2, 3}, {"SAX", &m::ZP0, &m::SAX, 2, 3}, {"DEY", &m::IMP, &m::DEY, 1, 2}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"TXA", &m::IMP, &m::TXA, 1, 2}, {"ANE", &m::IMM, &m::ANE, 2, 2}, {"STY", &m::ABS, &m::STY, 3, 4}, {"STA", &m::ABS, &m::STA, 3, 4}, {"STX", &m::ABS, &m::STX, 3, 4}, {"SAX", &m::ABS, &m::SAX, 3, 4},
+        /*9*/{"BCC", &m::REL, &m::BCC, 2, 2}, {"STA", &m::IDY, &m::STA, 2, 6}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"SHA", &m::IDY, &m::SHA, 2, 6}, {"STY", &m::ZPX, &m::STY, 2, 4}, {"STA", &m::ZPX, &m::STA, 2, 4}, {"STX", &m::ZPY, &m::STX, 2, 4}, {"SAX", &m::ZPY, &m::SAX, 2, 4}, {"TYA", &m::IMP, &m::TYA, 1, 2}, {"STA", &m::ABY, &m::STA, 3, 5}, {"TXS", &m::IMP, &m::TXS, 1, 2}, {"TAS", &m::ABY, &m::TAS, 3, 5}, {"SHY", &m::ABX, &m::SHY, 3, 5}, {"STA", &m::ABX, &m::STA, 3, 5}, {"SHX", &m::ABY, &m::SHX, 3, 5}, {"SHA", &m::ABY, &m::SHA, 3, 5},
+        /*A*/{"LDY", &m::IMM, &m::LDY, 2, 2}, {"LDA", &m::IDX, &m::LDA, 2, 6}, {"LDX", &m::IMM, &m::LDX, 2, 2}, {"LAX", &m::IDX, &m::LAX, 2, 6}, {"LDY", &m::ZP0, &m::LDY, 2, 3}, {"LDA", &m::ZP0, &m::LDA, 2, 3}, {"LDX", &m::ZP0, &m::LDX, 2, 3}, {"LAX", &m::ZP0, &m::LAX, 2, 3}, {"TAY", &m::IMP, &m::TAY, 1, 2}, {"LDA", &m::IMM, &m::LDA, 2, 2}, {"TAX", &m::IMP, &m::TAX, 1, 2}, {"LXA", &m::IMM, &m::LXA, 2, 2}, {"LDY", &m::ABS, &m::LDY, 3, 4}, {"LDA", &m::ABS, &m::LDA, 3, 4}, {"LDX", &m::ABS, &m::LDX, 3, 4}, {"LAX", &m::ABS, &m::LAX, 3, 4},
+        /*B*/{"BCS", &m::REL, &m::BCS, 2, 2}, {"LDA", &m::IDY, &m::LDA, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"LAX", &m::IDY, &m::LAX, 2, 5}, {"LDY", &m::ZPX, &m::LDY, 2, 4}, {"LDA", &m::ZPX, &m::LDA, 2, 4}, {"LDX", &m::ZPY, &m::LDX, 2, 4}, {"LAX", &m::ZPY, &m::LAX, 2, 4}, {"CLV", &m::IMP, &m::CLV, 1, 2}, {"LDA", &m::ABY, &m::LDA, 3, 4}, {"TSX", &m::IMP, &m::TSX, 1, 2}, {"LAS", &m::ABY, &m::LAS, 3, 4}, {"LDY", &m::ABX, &m::LDY, 3, 4}, {"LDA", &m::ABX, &m::LDA, 3, 4}, {"LDX", &m::ABY, &m::LDX, 3, 4}, {"LAX", &m::ABY, &m::LAX, 3, 4},
+        /*C*/{"CPY", &m::IMM, &m::CPY, 2, 2}, {"CMP", &m::IDX, &m::CMP, 2, 6}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"DCP", &m::IDX, &m::DCP, 2, 8}, {"CPY", &m::ZP0, &m::CPY, 2, 3}, {"CMP", &m::ZP0, &m::CMP, 2, 3}, {"DEC", &m::ZP0, &m::DEC, 2, 5}, {"DCP", &m::ZP0, &m::DCP, 2, 5}, {"INY", &m::IMP, &m::INY, 1, 2}, {"CMP", &m::IMM, &m::CMP, 2, 2}, {"DEX", &m::IMP, &m::DEX, 1, 2}, {"SBX", &m::IMM, &m::SBX, 2, 2}, {"CPY", &m::ABS, &m::CPY, 3, 4}, {"CMP", &m::ABS, &m::CMP, 3, 4}, {"DEC", &m::ABS, &m::DEC, 3, 6}, {"DCP", &m::ABS, &m::DCP, 3, 6},
+        /*D*/{"BNE", &m::REL, &m::BNE, 2, 2}, {"CMP", &m::IDY, &m::CMP, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"DCP", &m::IDY, &m::DCP, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"CMP", &m::ZPX, &m::CMP, 2, 4}, {"DEC", &m::ZPX, &m::DEC, 2, 6}, {"DCP", &m::ZPX, &m::DCP, 2, 6}, {"CLD", &m::IMP, &m::CLD, 1, 2}, {"CMP", &m::ABY, &m::CMP, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"DCP", &m::ABY, &m::DCP, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"CMP", &m::ABX, &m::CMP, 3, 4}, {"DEC", &m::ABX, &m::DEC, 3, 7}, {"DCP", &m::ABX, &m::DCP, 3, 7},
+        /*E*/{"CPX", &m::IMM, &m::CPX, 2, 2}, {"SBC", &m::IDX, &m::SBC, 2, 6}, {"NOP", &m::IMM, &m::NOP, 2, 2}, {"ISB", &m::IDX, &m::ISB, 2, 8}, {"CPX", &m::ZP0, &m::CPX, 2, 3}, {"SBC", &m::ZP0, &m::SBC, 2, 3}, {"INC", &m::ZP0, &m::INC, 2, 5}, {"ISB", &m::ZP0, &m::ISB, 2, 5}, {"INX", &m::IMP, &m::INX, 1, 2}, {"SBC", &m::IMM, &m::SBC, 2, 2}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"SBC", &m::IMM, &m::SBC, 2, 2}, {"CPX", &m::ABS, &m::CPX, 3, 4}, {"SBC", &m::ABS, &m::SBC, 3, 4}, {"INC", &m::ABS, &m::INC, 3, 6}, {"ISB", &m::ABS, &m::ISB, 3, 6},
+        /*F*/{"BEQ", &m::REL, &m::BEQ, 2, 2}, {"SBC", &m::IDY, &m::SBC, 2, 5}, {"JAM", &m::IMP, &m::JAM, 1, 1}, {"ISB", &m::IDY, &m::ISB, 2, 8}, {"NOP", &m::ZPX, &m::NOP, 2, 4}, {"SBC", &m::ZPX, &m::SBC, 2, 4}, {"INC", &m::ZPX, &m::INC, 2, 6}, {"ISB", &m::ZPX, &m::ISB, 2, 6}, {"SED", &m::IMP, &m::SED, 1, 2}, {"SBC", &m::ABY, &m::SBC, 3, 4}, {"NOP", &m::IMP, &m::NOP, 1, 2}, {"ISB", &m::ABY, &m::ISB, 3, 7}, {"NOP", &m::ABX, &m::NOP, 3, 4}, {"SBC", &m::ABX, &m::SBC, 3, 4}, {"INC", &m::ABX, &m::INC, 3, 7}, {"ISB", &m::ABX, &m::ISB, 3, 7}
+};
+
+template<class BusT>
+MOS6502<BusT>::MOS6502(BusT bus) : m_currentInstruction(&lookup[0xEA]), m_mainBus(std::move(bus)) {
+
+    m_connectors["CLK"] = std::make_shared<Connector>(SignalInterface{
+        .send = [this](){
+            CLK();
+        }
+    });
+
+    m_connectors["NMI"] = std::make_shared<Connector>(SignalInterface{
+        .send = [this](){
+            NMI();
+        }
+    });
+
+    m_connectors["IRQ"] = std::make_shared<Connector>(SignalInterface{
+        .set = [this](bool active) {
+            IRQ(active);
+        }
+    });
+
+    m_deviceName = "6502 CPU";
+
+    m_breakpointPeek = [this](uint16_t address) {
+        return peek(address);
+    };
+
+    // Only the port can be connected in the component graph and hooked by the watchpoints.
+    if constexpr(PORT_BUS) {
+
+        m_ports["mainBus"] = &m_mainBus;
+
+        m_watchConnector = std::make_shared<Connector>(DataInterface{
+            .read = [this](uint32_t address, uint32_t & buffer) {
+                bool confirmed = m_watchedBus.readConfirmed(address, buffer);
+                if(m_breakpoints.isMarked(address, Breakpoints::READ))
+                    m_breakpoints.check(Breakpoints::READ, getBreakpointContext(address, buffer), m_breakpointPeek);
+                return confirmed;
+            },
+            .write = [this](uint32_t address, uint32_t data) {
+                m_watchedBus.write(address, data);
+                if(m_breakpoints.isMarked(address, Breakpoints::WRITE))
+                    m_breakpoints.check(Breakpoints::WRITE, getBreakpointContext(address, data), m_breakpointPeek);
+            }
+        });
+    }
+
+    hardReset();
+}
+
+template<class BusT>
+MOS6502<BusT>::~MOS6502(){}
+
+template<class BusT>
+void MOS6502<BusT>::branch(bool condition){
+
+    if(condition){
+
+        m_cycles++;
+
+        if((m_addrAbs & 0xFF00) != (m_registers.pc & 0xFF00))
+            m_cycles++;
+
+        m_registers.pc = m_addrAbs; // Do not move above the 'if', old PC value is checked.
+    }
+}
+
+template<class BusT>
+const char * MOS6502<BusT>::getCurrentAddressString() {
+
+    char * str = m_addressString;
+    const size_t size = sizeof(m_addressString);
+
+    if(m_currentInstruction->addrMode == &MOS6502::ACC)
+        std::snprintf(str, size, "A");
+    else if(m_currentInstruction->addrMode == &MOS6502::IMM)
+        std::snprintf(str, size, "#$%x (IMM)", static_cast<unsigned int>(m_mainBus.read(m_registers.pc - 1)));
+    else if(m_currentInstruction->addrMode == &MOS6502::ABS)
+        std::snprintf(str, size, "$%x (ABS)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::ZP0)
+        std::snprintf(str, size, "$%x (ZP0)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::REL)
+        std::snprintf(str, size, "$%x (REL)", m_addrRel);
+    else if(m_currentInstruction->addrMode == &MOS6502::ID0)
+        std::snprintf(str, size, "($%x) (ID0)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::ABX)
+        std::snprintf(str, size, "$%x,X (ABX)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::ABY)
+        std::snprintf(str, size, "$%x,Y (ABY)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::ZPX)
+        std::snprintf(str, size, "$%x,X (ZPX)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::ZPY)
+        std::snprintf(str, size, "$%x,Y (ZPY)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::IDX)
+        std::snprintf(str, size, "($%x,X) (IDX)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::IDY)
+        std::snprintf(str, size, "($%x),Y (IDY)", m_addrAbs);
+    else if(m_currentInstruction->addrMode == &MOS6502::IMP)
+        std::snprintf(str, size, "(IMP)");
+    else
+        std::snprintf(str, size, "none");
+
+    return m_addressString;
+}
+
+template<class BusT>
+void MOS6502<BusT>::hardReset() {
+
+    // Initial status NVxBDIZC = 0x34
+    m_registers.status.c = 0;
+    m_registers.status.z = 0;
+    m_registers.status.i = 1;
+    m_registers.status.d = 0;
+    m_registers.status.b = 1;
+    m_registers.status.x = 1;
+    m_registers.status.n = 0;
+    m_registers.status.v = 0;
+
+    m_registers.acc = 0;
+    m_registers.x = 0;
+    m_registers.y = 0;
+    m_registers.sp = 0xFD;
+    m_registers.pc = m_mainBus.read(VECTOR_RST) | ((uint16_t)m_mainBus.read(VECTOR_RST + 1) << 8);
+
+    m_addrAbs = m_addrRel = 0;
+    m_accOperation = false;
+    m_cycles = 7;
+    m_cycleCount = 0;
+
+    m_nmi = false;
+    m_nmiPending = false;
+    m_irq = false;
+    m_irqPending = false;
+
+    m_currentOpcode = 0xEA;
+    m_currentInstruction = &lookup[m_currentOpcode];
+}
+
+template<class BusT>
+void MOS6502<BusT>::softReset(){
+
+    m_registers.sp -= 3;
+    m_registers.status.i = 1;
+    m_mainBus.write(0x4015, 0x00);
+
+    m_registers.pc = m_mainBus.read(0xFFFC) | ((uint16_t)m_mainBus.read(0xFFFD) << 8);
+
+    m_addrAbs = m_addrRel = 0;
+    m_accOperation = false;
+    m_cycles = 7;
+    m_cycleCount = 0;
+
+    m_currentInstruction = &lookup[0xEA];
+}
+
+template<class BusT>
+void MOS6502<BusT>::IRQ(bool active){
+    m_irq = active;
+}
+
+template<class BusT>
+void MOS6502<BusT>::irqHandler(){
+
+    m_mainBus.write(STACK_POSITION + m_registers.sp, (uint8_t)((m_registers.pc & 0xFF00) >> 8));
+    m_registers.sp--;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, (uint8_t)(m_registers.pc & 0xFF));
+    m_registers.sp--;
+
+    uint8_t status = m_registers.status.c;
+    status |= m_registers.status.z << 1;
+    status |= m_registers.status.i << 2;
+    status |= m_registers.status.d << 3;
+    status |= 0x0 << 4;
+    status |= 0x1 << 5; //Status 5 always 1.
+    status |= m_registers.status.v << 6;
+    status |= m_registers.status.n << 7;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, status);
+    m_registers.sp--;
+
+    m_registers.pc = m_mainBus.read(VECTOR_IRQ) | ((uint16_t)m_mainBus.read(VECTOR_IRQ + 1) << 8);
+
+    m_registers.status.i = 1;
+
+    m_cycles += 7;
+}
+
+template<class BusT>
+void MOS6502<BusT>::NMI(){
+    m_nmi = true;
+}
+
+template<class BusT>
+void MOS6502<BusT>::nmiHandler(){
+
+    m_mainBus.write(STACK_POSITION + m_registers.sp, (uint8_t)((m_registers.pc & 0xFF00) >> 8));
+    m_registers.sp--;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, (uint8_t)(m_registers.pc & 0xFF));
+    m_registers.sp--;
+
+    uint8_t status = m_registers.status.c;
+    status |= m_registers.status.z << 1;
+    status |= m_registers.status.i << 2;
+    status |= m_registers.status.d << 3;
+    status |= 0x0 << 4;
+    status |= 0x1 << 5; //Status 5 always 1.
+    status |= m_registers.status.v << 6;
+    status |= m_registers.status.n << 7;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, status);
+    m_registers.sp--;
+
+    m_registers.pc = m_mainBus.read(VECTOR_NMI) | ((uint16_t)m_mainBus.read(VECTOR_NMI + 1) << 8);
+
+    m_registers.status.i = 1;
+
+    m_cycles += 7;
+}
+
+template<class BusT>
+template<class Hooks>
+void MOS6502<BusT>::CLK(){
+
+    USE_PROFILE_SCOPE("CPU");
+
+    // ---------------------------------------------------------------
+    // During the final clock of the instruction the interrupt state is checked.
+    // If the interrupt is pending, the ISR is executed instead of the
+    // next instruction.
+    if(m_cycles == 1) {
+
+        // NMI has the highest priority. IRQ is cancelled.
+        if (m_nmiPending) {
+
+            m_next = nextMode_t::NMI_ISR;
+            m_irqPending = m_nmiPending = false;
+
+        // IRQ has the second-highest priority.
+        } else if (m_irqPending) {
+
+            bool interruptMask;
+
+            // All two-cycle instruction poll interrupts after changing the flags,
+            // so we need to check the old value.
+            if (
+                    m_currentOpcode == 0x78 || // SEI
+                    m_currentOpcode == 0x58 || // CLI
+                    m_currentOpcode == 0x28    // PLP
+                    ) {
+                interruptMask = m_oldInterruptMask;
+            } else {
+                interruptMask = m_registers.status.i;
+            }
+
+            if (!interruptMask) m_next = nextMode_t::IRQ_ISR;
+            else                m_next = nextMode_t::INSTRUCTION;
+
+            m_irqPending = false;
+
+        // No interrupt, next instruction will be executed.
+        } else {
+            m_next = nextMode_t::INSTRUCTION;
+        }
+
+        // Execution breakpoints are checked before the next fetch, so the system stops right before it.
+        // Only the page of the next instruction is looked up, unless an interrupt handler follows.
+        if constexpr(Hooks::ENABLED) {
+            if(m_breakpoints.isMarked(m_registers.pc, Breakpoints::EXECUTE)
+               || (m_next != nextMode_t::INSTRUCTION && m_breakpoints.hasType(Breakpoints::EXECUTE)))
+                checkExecutionBreakpoints();
+        }
+    }
+    // ---------------------------------------------------------------
+    // When no clocks are remaining, fetch and execute the next instruction
+    // or the ISR.
+    if(m_cycles == 0){
+
+        // Decide upon what will be executed next.
+        // The most important is the value of the program counter register.
+        // The handlers themselves do not poll for interrupts, so at least
+        // one instruction is always executed before next interrupt.
+        switch(m_next) {
+
+            case nextMode_t::INSTRUCTION:
+                // Nothing to do. Use current PC value.
+                break;
+            case nextMode_t::NMI_ISR:
+                // Backup PC + status and get a new PC from vector at 0xFFFA.
+                nmiHandler();
+                break;
+            case nextMode_t::IRQ_ISR:
+                // Backup PC + status and get a new PC from vector at 0xFFFE.
+                irqHandler();
+                break;
+        }
+
+        uint16_t instructionAddress = m_registers.pc;
+        uint8_t interruptCycles     = m_cycles;
+
+        if constexpr(Hooks::ENABLED) {
+            if(m_guestProfiler && m_next != nextMode_t::INSTRUCTION)
+                profileInterrupt(m_next == nextMode_t::NMI_ISR ? GuestProfiler::ENTRY::NMI : GuestProfiler::ENTRY::IRQ);
+
+            if(m_traceLogger)
+                m_traceLogger->log({
+                    .pc = m_registers.pc, .a = m_registers.acc, .x = m_registers.x, .y = m_registers.y,
+                    .p = getStatusByte(), .sp = m_registers.sp, .cycles = m_cycleCount
+                });
+
+            // The previous opcode is still set: an instruction after JMP (ind) was jumped to indirectly.
+            if(m_codeDataLogger)
+                m_codeDataLogger->setPRGAccess(
+                    CodeDataLogger::CODE | (m_next == nextMode_t::INSTRUCTION && m_currentOpcode == 0x6C ? CodeDataLogger::INDIRECT_CODE : 0)
+                );
+        }
+
+        m_oldInterruptMask      = m_registers.status.i;
+        m_currentOpcode         = m_mainBus.read(m_registers.pc++);
+        m_currentInstruction    = &lookup[m_currentOpcode];
+
+        if constexpr(Hooks::ENABLED) {
+            if(m_codeDataLogger)
+                m_codeDataLogger->setPRGAccess(CodeDataLogger::CODE);
+        }
+
+        uint8_t addrRet         = (this->*(m_currentInstruction->addrMode))();
+
+        if constexpr(Hooks::ENABLED) {
+            if(m_codeDataLogger) {
+                bool indirect = m_currentInstruction->addrMode == &MOS6502::IDX || m_currentInstruction->addrMode == &MOS6502::IDY;
+                m_codeDataLogger->setPRGAccess(CodeDataLogger::DATA | (indirect ? CodeDataLogger::INDIRECT_DATA : 0));
+            }
+        }
+
+        uint8_t instrRet        = (this->*(m_currentInstruction->instrCode))();
+        m_cycles                  += m_currentInstruction->cycles;
+        if (addrRet && instrRet) m_cycles++;
+
+        if constexpr(Hooks::ENABLED) {
+            if(m_guestProfiler)
+                profileInstruction(instructionAddress, m_cycles - interruptCycles);
+        }
+    }
+
+    // ---------------------------------------------------------------
+    // A state of the interrupt pins is checked on every clock.
+    // (The current detected state is valid during the next clock.)
+    // The state is checked by the edge/level detectors and sent to
+    // an internal signal for further processing.
+    if(m_nmi) {
+        m_nmiPending = true;
+        m_nmi = false;
+    }
+
+    if(m_irq) {
+        m_irqPending = true;
+    }
+    // ---------------------------------------------------------------
+
+    m_cycles--;
+    m_cycleCount++;
+}
+
+template<class BusT>
+void MOS6502<BusT>::setDebugHooksEnabled(bool enabled) {
+
+    if(enabled == m_debugHooks)
+        return;
+
+    m_debugHooks = enabled;
+
+    // Swap the clock instantiation, so the disabled hooks cost nothing.
+    if(enabled)
+        m_connectors["CLK"]->setInterface(SignalInterface{ .send = [this](){ CLK<DebugHooks>(); } });
+    else
+        m_connectors["CLK"]->setInterface(SignalInterface{ .send = [this](){ CLK<NoHooks>(); } });
+
+    updateWatchpoints();
+}
+
+template<class BusT>
+bool MOS6502<BusT>::isDebugHooksEnabled() const {
+    return m_debugHooks;
+}
+
+template<class BusT>
+uint32_t MOS6502<BusT>::getBank(uint16_t address) const {
+    return m_bankResolver ? m_bankResolver(address) : 0;
+}
+
+template<class BusT>
+void MOS6502<BusT>::profileInterrupt(GuestProfiler::ENTRY entry) {
+
+    // The handler already pushed PC and status and loaded the vector. Its cycles belong to the ISR.
+    uint32_t bank = getBank(m_registers.pc);
+    m_guestProfiler->call(m_registers.pc, bank, m_registers.sp + 3, entry);
+    m_guestProfiler->instruction(m_registers.pc, bank, m_cycles);
+}
+
+template<class BusT>
+void MOS6502<BusT>::profileInstruction(uint16_t address, uint8_t cycles) {
+
+    m_guestProfiler->instruction(address, getBank(address), cycles);
+
+    switch(m_currentOpcode) {
+        case 0x20: // JSR
+            m_guestProfiler->call(m_registers.pc, getBank(m_registers.pc), m_registers.sp + 2, GuestProfiler::ENTRY::CALL);
+            break;
+        case 0x00: // BRK
+            m_guestProfiler->call(m_registers.pc, getBank(m_registers.pc), m_registers.sp + 3, GuestProfiler::ENTRY::IRQ);
+            break;
+        case 0x60: // RTS
+        case 0x40: // RTI
+            m_guestProfiler->ret(m_registers.sp);
+            break;
+        default:
+            break;
+    }
+}
+
+template<class BusT>
+void MOS6502<BusT>::setGuestProfilerEnabled(bool enabled) {
+
+    if(enabled)
+        m_guestProfiler = std::make_unique<GuestProfiler>();
+    else
+        m_guestProfiler.reset();
+}
+
+template<class BusT>
+GuestProfiler * MOS6502<BusT>::getGuestProfiler() {
+    return m_guestProfiler.get();
+}
+
+template<class BusT>
+void MOS6502<BusT>::setBankResolver(std::function<uint32_t(uint16_t)> resolver) {
+    m_bankResolver = std::move(resolver);
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::getStatusByte() const {
+
+    return m_registers.status.c
+        | m_registers.status.z << 1
+        | m_registers.status.i << 2
+        | m_registers.status.d << 3
+        | 0x1 << 5
+        | m_registers.status.v << 6
+        | m_registers.status.n << 7;
+}
+
+template<class BusT>
+void MOS6502<BusT>::setCodeDataLogger(CodeDataLogger * logger) {
+    m_codeDataLogger = logger;
+}
+
+template<class BusT>
+void MOS6502<BusT>::setDebugSources(TraceLogger::PeekFunction peek, TraceLogger::PositionFunction position) {
+    m_debugPeek = std::move(peek);
+    m_tracePosition = std::move(position);
+}
+
+template<class BusT>
+void MOS6502<BusT>::startTrace(const std::string & path) {
+
+    using MODE = TraceLogger::ADDRESS_MODE;
+    const std::pair<uint8_t (MOS6502::*)(), MODE> modes[] = {
+        {&MOS6502::ACC, MODE::ACC}, {&MOS6502::IMM, MODE::IMM}, {&MOS6502::IMP, MODE::IMP},
+        {&MOS6502::ABS, MODE::ABS}, {&MOS6502::ZP0, MODE::ZP0}, {&MOS6502::REL, MODE::REL},
+        {&MOS6502::ID0, MODE::ID0}, {&MOS6502::ABX, MODE::ABX}, {&MOS6502::ABY, MODE::ABY},
+        {&MOS6502::ZPX, MODE::ZPX}, {&MOS6502::ZPY, MODE::ZPY}, {&MOS6502::IDX, MODE::IDX},
+        {&MOS6502::IDY, MODE::IDY}
+    };
+
+    std::array<TraceLogger::Opcode, 256> opcodes{};
+    for(size_t i = 0; i < opcodes.size(); i++) {
+        std::copy(std::begin(lookup[i].mnemonic), std::end(lookup[i].mnemonic), opcodes[i].mnemonic);
+        for(auto & [function, mode] : modes)
+            if(lookup[i].addrMode == function)
+                opcodes[i].mode = mode;
+    }
+
+    m_traceLogger.reset();
+    m_traceLogger = std::make_unique<TraceLogger>(path, opcodes, m_breakpointPeek, m_tracePosition);
+}
+
+template<class BusT>
+void MOS6502<BusT>::stopTrace() {
+    m_traceLogger.reset();
+}
+
+template<class BusT>
+bool MOS6502<BusT>::isTracing() const {
+    return m_traceLogger != nullptr;
+}
+
+template<class BusT>
+void MOS6502<BusT>::copyState(const MOS6502 & other) {
+
+    m_registers = other.m_registers;
+    m_addrAbs = other.m_addrAbs;
+    m_addrRel = other.m_addrRel;
+    m_cycles = other.m_cycles;
+    m_accOperation = other.m_accOperation;
+    m_next = other.m_next;
+    m_nmi = other.m_nmi;
+    m_nmiPending = other.m_nmiPending;
+    m_irq = other.m_irq;
+    m_irqPending = other.m_irqPending;
+    m_oldInterruptMask = other.m_oldInterruptMask;
+    m_currentOpcode = other.m_currentOpcode;
+    m_currentInstruction = other.m_currentInstruction;
+    m_cycleCount = other.m_cycleCount;
+}
+
+template<class BusT>
+void MOS6502<BusT>::hashState(StateHasher & hasher) const {
+
+    const status_flags_t & status = m_registers.status;
+    hasher.add(m_registers.x);
+    hasher.add(m_registers.y);
+    for(bool flag : {status.c, status.z, status.i, status.d, status.b, status.x, status.v, status.n})
+        hasher.add(flag);
+    hasher.add(m_registers.acc);
+    hasher.add(m_registers.sp);
+    hasher.add(m_registers.pc);
+
+    hasher.add(m_addrAbs);
+    hasher.add(m_addrRel);
+    hasher.add(m_cycles);
+    hasher.add(m_accOperation);
+    hasher.add(m_next);
+    hasher.add(m_nmi);
+    hasher.add(m_nmiPending);
+    hasher.add(m_irq);
+    hasher.add(m_irqPending);
+    hasher.add(m_oldInterruptMask);
+    hasher.add(m_currentOpcode);
+    // Soft reset replaces the instruction without changing the opcode, hash the table index.
+    hasher.add(static_cast<uint8_t>(m_currentInstruction - lookup));
+    hasher.add(m_cycleCount);
+}
+
+template<class BusT>
+void MOS6502<BusT>::setProgramCounter(uint16_t address) {
+    m_registers.pc = address;
+}
+
+template<class BusT>
+uint16_t MOS6502<BusT>::getProgramCounter() const {
+    return m_registers.pc;
+}
+
+template<class BusT>
+bool MOS6502<BusT>::instrFinished() const {
+    return m_cycles == 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::peek(uint16_t address) {
+
+    if(m_debugPeek)
+        return m_debugPeek(address);
+
+    // Don't trigger the watchpoints.
+    if constexpr(PORT_BUS) {
+        if(m_watching)
+            return static_cast<uint8_t>(m_watchedBus.read(address));
+    }
+    return static_cast<uint8_t>(m_mainBus.read(address));
+}
+
+template<class BusT>
+Breakpoints::Context MOS6502<BusT>::getBreakpointContext(uint16_t address, uint8_t value) const {
+
+    return {
+        .pc = m_registers.pc, .a = m_registers.acc, .x = m_registers.x, .y = m_registers.y,
+        .p = getStatusByte(), .sp = m_registers.sp, .address = address, .value = value
+    };
+}
+
+template<class BusT>
+void MOS6502<BusT>::checkExecutionBreakpoints() {
+
+    uint16_t address = m_registers.pc;
+    if(m_next != nextMode_t::INSTRUCTION) {
+        uint16_t vector = m_next == nextMode_t::NMI_ISR ? VECTOR_NMI : VECTOR_IRQ;
+        address = peek(vector) | (peek(vector + 1) << 8);
+    }
+
+    if(!m_breakpoints.isMarked(address, Breakpoints::EXECUTE))
+        return;
+
+    Breakpoints::Context context = getBreakpointContext(address, peek(address));
+    context.pc = address;
+    m_breakpoints.check(Breakpoints::EXECUTE, context, m_breakpointPeek);
+}
+
+template<class BusT>
+void MOS6502<BusT>::updateWatchpoints() {
+
+    // Other buses can't be hooked, the watchpoints are ignored.
+    if constexpr(PORT_BUS) {
+
+        bool watch = m_debugHooks && (m_breakpoints.hasType(Breakpoints::READ) || m_breakpoints.hasType(Breakpoints::WRITE));
+        if(watch == m_watching)
+            return;
+
+        // Swap the connection, so there is no cost while no watchpoint is enabled.
+        if(watch) {
+            m_watchedBus = m_mainBus;
+            m_mainBus.connect(m_watchConnector);
+        } else {
+            m_mainBus = m_watchedBus;
+        }
+        m_watching = watch;
+    }
+}
+
+template<class BusT>
+size_t MOS6502<BusT>::addBreakpoint(uint16_t from, uint16_t to, uint8_t types, const std::string & condition) {
+
+    size_t index = m_breakpoints.add(from, to, types, condition);
+    updateWatchpoints();
+    return index;
+}
+
+template<class BusT>
+void MOS6502<BusT>::removeBreakpoint(size_t index) {
+
+    m_breakpoints.remove(index);
+    updateWatchpoints();
+}
+
+template<class BusT>
+void MOS6502<BusT>::setBreakpointEnabled(size_t index, bool enabled) {
+
+    m_breakpoints.setEnabled(index, enabled);
+    updateWatchpoints();
+}
+
+template<class BusT>
+const Breakpoints & MOS6502<BusT>::getBreakpoints() const {
+    return m_breakpoints;
+}
+
+template<class BusT>
+void MOS6502<BusT>::clearBreakpointHit() {
+    m_breakpoints.clearHit();
+}
+
+template<class BusT>
+std::vector<EmulatorWindow> MOS6502<BusT>::getGUIs() {
+
+    std::function<void(void)> debugger = [this](){
+
+        // Window contents
+        // ===================================================================
+        ImGui::SeparatorText("Current instruction");
+        ImGui::Text("Mnemonic: %s", m_currentInstruction->mnemonic);
+        ImGui::Text("Cycles: %u/%u", m_cycles, m_currentInstruction->cycles);
+        ImGui::Text("Size: %u B", m_currentInstruction->instrLen);
+        ImGui::Text("Address mode: %s", getCurrentAddressString());
+        ImGui::Text("Remaining cycles: %u", m_cycles);
+
+        ImGui::SeparatorText("Registers");
+        ImGui::InputScalar("PC", ImGuiDataType_U16, &m_registers.pc, nullptr, nullptr, "%x", ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::InputScalar("SP", ImGuiDataType_U8, &m_registers.sp, nullptr, nullptr, "%x", ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::InputScalar("ACC", ImGuiDataType_U8, &m_registers.acc, nullptr, nullptr, "%x", ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::InputScalar("X", ImGuiDataType_U8, &m_registers.x, nullptr, nullptr, "%x", ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::InputScalar("Y", ImGuiDataType_U8, &m_registers.y, nullptr, nullptr, "%x", ImGuiInputTextFlags_CharsHexadecimal);
+
+        ImGui::SeparatorText("Status flags");
+        ImGui::Checkbox("C", &m_registers.status.c);
+        ImGui::SameLine();
+        ImGui::Checkbox("Z", &m_registers.status.z);
+        ImGui::SameLine();
+        ImGui::Checkbox("I", &m_registers.status.i);
+        ImGui::SameLine();
+        ImGui::Checkbox("D", &m_registers.status.d);
+        ImGui::Checkbox("B", &m_registers.status.b);
+        ImGui::SameLine();
+        ImGui::Checkbox("X", &m_registers.status.x);
+        ImGui::SameLine();
+        ImGui::Checkbox("V", &m_registers.status.v);
+        ImGui::SameLine();
+        ImGui::Checkbox("N", &m_registers.status.n);
+
+
+        ImGui::SeparatorText("Interrupt vectors");
+        ImGui::Text("NMI at: 0x%x", VECTOR_NMI);
+        ImGui::Text("RESET at: 0x%x", VECTOR_RST);
+        ImGui::Text("IRQ/BRK at: 0x%x", VECTOR_IRQ);
+        ImGui::SeparatorText("Interrupt status");
+        ImGui::BeginDisabled();
+        ImGui::Checkbox("NMI signal active", &m_nmi);
+        ImGui::Checkbox("NMI pending", &m_nmiPending);
+        ImGui::Checkbox("IRQ signal active", &m_nmi);
+        ImGui::Checkbox("IRQ pending", &m_nmiPending);
+        ImGui::EndDisabled();
+
+        ImGui::SeparatorText("Stack");
+        ImGui::Text("Stack position: 0x%x", STACK_POSITION);
+        ImGui::SeparatorText("Stats");
+        ImGui::Text("All cycles: %llu", m_cycleCount);
+
+        ImGui::SeparatorText("Trace");
+        ImGui::InputText("Trace file", m_tracePath, sizeof(m_tracePath));
+        if(!m_traceLogger) {
+            if(ImGui::Button("Start trace")) {
+                try {
+                    startTrace(m_tracePath);
+                    m_traceStatus.clear();
+                } catch(std::exception & e) {
+                    m_traceStatus = e.what();
+                }
+            }
+        } else {
+            if(ImGui::Button("Stop trace"))
+                stopTrace();
+            else
+                ImGui::Text("Lines written: %llu", (unsigned long long)m_traceLogger->getLineCount());
+        }
+        if(!m_traceStatus.empty())
+            ImGui::Text("%s", m_traceStatus.c_str());
+    };
+
+    return {
+            EmulatorWindow{
+                    .category = m_deviceName,
+                    .title = "Debugger",
+                    .id    = getDeviceID(),
+                    .dock  = DockSpace::LEFT,
+                    .guiFunction = debugger
+            },
+            EmulatorWindow{
+                    .category = m_deviceName,
+                    .title = "Guest profiler",
+                    .id    = getDeviceID(),
+                    .dock  = DockSpace::MAIN,
+                    .guiFunction = [this](){
+
+                        bool enabled = m_guestProfiler != nullptr;
+                        if(ImGui::Checkbox("Profile the executed code", &enabled))
+                            setGuestProfilerEnabled(enabled);
+
+                        if(m_guestProfiler)
+                            m_guestProfiler->drawGUI();
+                    }
+            },
+            EmulatorWindow{
+                    .category = m_deviceName,
+                    .title = "Breakpoints",
+                    .id    = getDeviceID(),
+                    .dock  = DockSpace::LEFT,
+                    .guiFunction = [this](){
+                        if(m_breakpoints.drawGUI())
+                            updateWatchpoints();
+                    }
+            }
+    };
+}
+// =========================================================================================
+//Addressing modes.
+template<class BusT>
+uint8_t MOS6502<BusT>::ACC(){
+    m_accOperation = true;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::IMP(){
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::IMM(){
+
+    m_addrAbs = m_registers.pc++;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ABS(){
+
+    m_addrAbs = m_mainBus.read(m_registers.pc) | (m_mainBus.read(m_registers.pc + 1) << 8);
+    m_registers.pc += 2;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ZP0(){
+
+    m_addrAbs = m_mainBus.read(m_registers.pc) & 0x00FF;
+    m_registers.pc++;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::REL(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc);
+    m_registers.pc++;
+
+    if(m_addrRel & 0x80) //If the byte was negative, make whole addr negative.
+        m_addrRel |= 0xFF00;
+
+    m_addrAbs = m_registers.pc + m_addrRel;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ID0(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc) | (m_mainBus.read(m_registers.pc + 1) << 8);
+
+    // The pointer is data.
+    if(m_codeDataLogger)
+        m_codeDataLogger->setPRGAccess(CodeDataLogger::DATA);
+
+    //HW bug implementation. If the lo byte of pointer is 0xFF,
+    //CPU wraps back to the same page.
+    if((m_addrRel & 0x00FF) == 0x00FF)
+        m_addrAbs = m_mainBus.read(m_addrRel) | (m_mainBus.read(m_addrRel & 0xFF00) << 8);
+    else
+        m_addrAbs = m_mainBus.read(m_addrRel) | (m_mainBus.read(m_addrRel + 1) << 8);
+
+    //pc increment is not needed, JMP will change pc anyways.
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ABX(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc) | (m_mainBus.read(m_registers.pc + 1) << 8);
+    m_addrAbs = m_addrRel + m_registers.x;
+    m_registers.pc += 2;
+
+    if((m_addrRel & 0xFF00) == (m_addrAbs & 0xFF00))
+        return 0;
+    else
+        return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ABY(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc) | (m_mainBus.read(m_registers.pc + 1) << 8);
+    m_addrAbs = m_addrRel + m_registers.y;
+    m_registers.pc += 2;
+
+    if((m_addrRel & 0xFF00) == (m_addrAbs & 0xFF00))
+        return 0;
+    else
+        return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ZPX(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc);
+    m_addrAbs = (m_addrRel + m_registers.x) & 0x00FF;
+    m_registers.pc++;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ZPY(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc);
+    m_addrAbs = (m_addrRel + m_registers.y) & 0x00FF;
+    m_registers.pc++;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::IDX(){
+
+    m_addrRel = (m_mainBus.read(m_registers.pc) + m_registers.x);
+    m_addrAbs = m_mainBus.read(m_addrRel & 0x00FF) | (m_mainBus.read((m_addrRel + 1) & 0x00FF) << 8);
+    m_registers.pc++;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::IDY(){
+
+    m_addrRel = m_mainBus.read(m_registers.pc);
+    uint16_t newAddr = (m_mainBus.read(m_addrRel) | ((uint16_t)m_mainBus.read((m_addrRel + 1) & 0x00FF) << 8));
+    m_addrAbs = newAddr + m_registers.y;
+    m_registers.pc++;
+
+    if((m_addrAbs & 0xFF00) == (newAddr & 0xFF00))
+        return 0;
+    else
+        return 1;
+}
+
+// =========================================================================================
+//Instructions.
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ADC(){
+
+    uint8_t memoryValue = m_mainBus.read(m_addrAbs);
+
+    bool memoryNegative = (memoryValue & 0x80) == 0x80;
+    bool accNegative = (m_registers.acc & 0x80) == 0x80;
+
+    uint16_t result = (uint16_t)m_registers.acc + (uint16_t)memoryValue + (uint16_t)m_registers.status.c;
+    m_registers.status.c = (result & 0x100) == 0x100;
+    result &= 0xFF;
+    m_registers.status.z = result == 0x0;
+    m_registers.status.n = (result & 0x80) == 0x80;
+
+    if(memoryNegative != accNegative)
+        m_registers.status.v = 0;
+    else
+        m_registers.status.v = memoryNegative == accNegative && memoryNegative != m_registers.status.n;
+
+    m_registers.acc = result;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::AND(){
+
+    m_registers.acc = m_registers.acc & m_mainBus.read(m_addrAbs);
+    m_registers.status.z = m_registers.acc == 0x0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ASL(){
+
+    if(m_accOperation){
+
+        m_registers.status.c = (m_registers.acc & 0x80) >> 7;
+        m_registers.acc <<= 1;
+        m_registers.status.z = m_registers.acc == 0x0;
+        m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+        m_accOperation = false;
+    } else {
+
+        uint8_t value = m_mainBus.read(m_addrAbs);
+        m_registers.status.c = (value & 0x80) >> 7;
+        value <<= 1;
+        m_registers.status.z = value == 0x0;
+        m_registers.status.n = (value & 0x80) == 0x80;
+        m_mainBus.write(m_addrAbs, value);
+    }
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BCC(){
+
+    branch(!m_registers.status.c);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BCS(){
+
+    branch(m_registers.status.c);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BEQ(){
+
+    branch(m_registers.status.z);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BIT(){
+
+    uint8_t value = m_mainBus.read(m_addrAbs);
+
+    m_registers.status.n = (value & 0x80) >> 7;
+    m_registers.status.v = (value & 0x40) >> 6;
+    m_registers.status.z = (value & m_registers.acc) == 0x0;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BMI(){
+
+    branch(m_registers.status.n);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BNE(){
+
+    branch(!m_registers.status.z);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BPL(){
+
+    branch(!m_registers.status.n);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BRK(){
+
+    m_registers.pc++;
+
+    m_mainBus.write(STACK_POSITION + m_registers.sp, (m_registers.pc & 0xFF00) >> 8);
+    m_registers.sp--;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, m_registers.pc & 0xFF);
+    m_registers.sp--;
+
+    uint8_t status = m_registers.status.c;
+    status |= m_registers.status.z << 1;
+    status |= m_registers.status.i << 2;
+    status |= m_registers.status.d << 3;
+    status |= 0x1 << 4;
+    status |= 0x1 << 5; //Status 5 always 1.
+    status |= m_registers.status.v << 6;
+    status |= m_registers.status.n << 7;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, status);
+    m_registers.sp--;
+
+    m_registers.status.i = 1;
+
+    m_registers.pc = m_mainBus.read(VECTOR_IRQ) | ((uint16_t)m_mainBus.read(VECTOR_IRQ + 1) << 8);
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BVC(){
+
+    branch(!m_registers.status.v);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::BVS(){
+
+    branch(m_registers.status.v);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CLC(){
+
+    m_registers.status.c = 0;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CLD(){
+
+    m_registers.status.d = 0;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CLI(){
+
+    m_registers.status.i = 0;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CLV(){
+
+    m_registers.status.v = 0;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CMP(){
+
+    uint8_t data = m_mainBus.read(m_addrAbs);
+    m_registers.status.c = (m_registers.acc >= data);
+    m_registers.status.z = ((m_registers.acc & 0x00FF) == data);
+    m_registers.status.n = (((m_registers.acc - data) & 0x80) == 0x80);
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CPX(){
+
+    uint8_t data = m_mainBus.read(m_addrAbs);
+    m_registers.status.c = (m_registers.x >= data);
+    m_registers.status.z = ((m_registers.x & 0x00FF) == data);
+    m_registers.status.n = (((m_registers.x - data) & 0x80) == 0x80);
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::CPY(){
+
+    uint8_t data = m_mainBus.read(m_addrAbs);
+    m_registers.status.c = (m_registers.y >= data);
+    m_registers.status.z = (m_registers.y == data);
+    m_registers.status.n = (((m_registers.y - data) & 0x80) == 0x80);
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::DEC(){
+
+    uint8_t newVal = m_mainBus.read(m_addrAbs) - 1;
+    m_mainBus.write(m_addrAbs, newVal);
+
+    m_registers.status.z = newVal == 0;
+    m_registers.status.n = (newVal & 0x80) == 0x80;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::DEX(){
+
+    m_registers.x--;
+
+    m_registers.status.z = m_registers.x == 0;
+    m_registers.status.n = (m_registers.x & 0x80) == 0x80;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::DEY(){
+
+    uint8_t newVal = --m_registers.y;
+
+    m_registers.status.z = newVal == 0;
+    m_registers.status.n = (newVal & 0x80) == 0x80;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::EOR(){
+
+    m_registers.acc = m_mainBus.read(m_addrAbs) ^ m_registers.acc;
+
+    m_registers.status.z = m_registers.acc == 0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::INC(){
+
+    uint8_t newVal = m_mainBus.read(m_addrAbs) + 1;
+    m_mainBus.write(m_addrAbs, newVal);
+
+    m_registers.status.z = newVal == 0;
+    m_registers.status.n = (newVal & 0x80) == 0x80;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::INX(){
+
+    m_registers.x++;
+
+    m_registers.status.z = m_registers.x == 0;
+    m_registers.status.n = (m_registers.x & 0x80) == 0x80;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::INY(){
+
+    m_registers.y++;
+
+    m_registers.status.z = m_registers.y == 0;
+    m_registers.status.n = (m_registers.y & 0x80) == 0x80;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::JMP(){
+
+    m_registers.pc = m_addrAbs;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::JSR(){
+
+    m_registers.pc--;
+
+    m_mainBus.write(STACK_POSITION + m_registers.sp, (m_registers.pc >> 8) & 0x00FF);
+    m_registers.sp--;
+    m_mainBus.write(STACK_POSITION + m_registers.sp, m_registers.pc & 0x00FF);
+    m_registers.sp--;
+
+    m_registers.pc = m_addrAbs;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LDA(){
+
+    m_registers.acc = m_mainBus.read(m_addrAbs);
+
+    m_registers.status.z = m_registers.acc == 0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LDX(){
+
+    m_registers.x = m_mainBus.read(m_addrAbs);
+
+    m_registers.status.z = m_registers.x == 0;
+    m_registers.status.n = (m_registers.x & 0x80) == 0x80;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LDY(){
+
+    m_registers.y = m_mainBus.read(m_addrAbs);
+
+    m_registers.status.z = m_registers.y == 0;
+    m_registers.status.n = (m_registers.y & 0x80) == 0x80;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LSR(){
+
+    if(m_accOperation){
+        m_registers.status.c = m_registers.acc & 0x1;
+        m_registers.acc >>= 1;
+        m_registers.status.z = m_registers.acc == 0;
+        m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+        m_accOperation = false;
+    } else {
+        m_registers.status.c = m_mainBus.read(m_addrAbs) & 0x1;
+        uint8_t newVal = m_mainBus.read(m_addrAbs) >> 1;
+        m_mainBus.write(m_addrAbs, newVal);
+        m_registers.status.z = newVal == 0;
+        m_registers.status.n = (newVal & 0x80) == 0x80;
+    }
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::NOP(){
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ORA(){
+
+    m_registers.acc |= m_mainBus.read(m_addrAbs);
+    m_registers.status.z = m_registers.acc == 0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::PHA(){
+
+    m_mainBus.write(STACK_POSITION + m_registers.sp, m_registers.acc);
+    m_registers.sp--;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::PHP(){
+
+    uint8_t status = m_registers.status.c;
+    status |= m_registers.status.z << 1;
+    status |= m_registers.status.i << 2;
+    status |= m_registers.status.d << 3;
+    status |= 0x1 << 4;
+    status |= 0x1 << 5; //Status 5 always 1.
+    status |= m_registers.status.v << 6;
+    status |= m_registers.status.n << 7;
+
+    m_mainBus.write(STACK_POSITION + m_registers.sp, status);
+    m_registers.sp--;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::PLA(){
+
+    m_registers.sp++;
+    m_registers.acc = m_mainBus.read(STACK_POSITION + m_registers.sp);
+    m_registers.status.z = m_registers.acc == 0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::PLP(){
+
+    m_registers.sp++;
+    uint8_t status = m_mainBus.read(STACK_POSITION + m_registers.sp);
+    m_registers.status.c = status & 0x1;
+    m_registers.status.z = (status & 0x2) >> 1;
+    m_registers.status.i = (status & 0x4) >> 2;
+    m_registers.status.d = (status & 0x8) >> 3;
+    m_registers.status.b = (status & 0x10) >> 4;
+    m_registers.status.v = (status & 0x40) >> 6;
+    m_registers.status.n = (status & 0x80) >> 7;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ROL(){
+
+    uint8_t oldCarry = m_registers.status.c;
+    // Accumulator operation.
+    if(m_accOperation){
+
+        m_registers.status.c = (m_registers.acc & 0x80) >> 7;
+        m_registers.acc <<= 1;
+        m_registers.acc |= oldCarry;
+        m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+        m_registers.status.z = m_registers.acc == 0x0;
+
+        m_accOperation = false;
+
+        // Memory operation.
+    } else {
+
+        uint8_t value = m_mainBus.read(m_addrAbs);
+
+        m_registers.status.c = (value & 0x80) >> 7;
+        value <<= 1;
+        value |= oldCarry;
+        m_registers.status.n = (value & 0x80) == 0x80;
+        m_registers.status.z = value == 0x0;
+
+        m_mainBus.write(m_addrAbs, value);
+    }
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ROR(){
+
+    uint8_t oldCarry = m_registers.status.c << 7;
+    // Accumulator operation.
+    if(m_accOperation){
+
+        m_registers.status.c = (m_registers.acc & 0x1);
+        m_registers.acc >>= 1;
+        m_registers.acc |= oldCarry;
+        m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+        m_registers.status.z = m_registers.acc == 0x0;
+
+        m_accOperation = false;
+        // Memory operation.
+    } else {
+
+        uint8_t value = m_mainBus.read(m_addrAbs);
+
+        m_registers.status.c = (value & 0x1);
+        value >>= 1;
+        value |= oldCarry;
+        m_registers.status.n = (value & 0x80) == 0x80;
+        m_registers.status.z = value == 0x0;
+
+        m_mainBus.write(m_addrAbs, value);
+    }
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::RTI(){
+
+    m_registers.sp++;
+    uint8_t flags = m_mainBus.read(STACK_POSITION + m_registers.sp);
+    m_registers.sp++;
+    m_registers.pc = m_mainBus.read(STACK_POSITION + m_registers.sp) | (m_mainBus.read(STACK_POSITION + m_registers.sp + 1) << 8);
+    m_registers.sp++;
+
+    m_registers.status.c = flags & 0x1;
+    m_registers.status.z = (flags & 0x2) >> 1;
+    m_registers.status.i = (flags & 0x4) >> 2;
+    m_registers.status.d = (flags & 0x8) >> 3;
+    m_registers.status.b = 0;
+    m_registers.status.x = 0;
+    m_registers.status.v = (flags & 0x40) >> 6;
+    m_registers.status.n = (flags & 0x80) >> 7;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::RTS(){
+
+    m_registers.sp++;
+    m_registers.pc = ((m_mainBus.read(STACK_POSITION + m_registers.sp) | ((uint16_t)m_mainBus.read(STACK_POSITION + m_registers.sp + 1) << 8))) + 1;
+    m_registers.sp++;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SBC(){
+
+    uint16_t memoryValue = (uint8_t)(~m_mainBus.read(m_addrAbs));
+
+    uint16_t result = (uint16_t)m_registers.acc + memoryValue + (uint16_t)(m_registers.status.c);
+    m_registers.status.c = result & 0xFF00;
+    result &= 0xFF;
+    m_registers.status.n = (result & 0x80) == 0x80;
+    m_registers.status.z = result == 0x0;
+    m_registers.status.v = (result ^ (uint16_t)m_registers.acc) & (result ^ memoryValue) & 0x0080;
+
+    m_registers.acc = result;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SEC(){
+
+    m_registers.status.c = 1;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SED(){
+
+    m_registers.status.d = 1;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SEI(){
+
+    m_registers.status.i = 1;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::STA(){
+
+    m_mainBus.write(m_addrAbs, m_registers.acc);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::STX(){
+
+    m_mainBus.write(m_addrAbs, m_registers.x);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::STY(){
+
+    m_mainBus.write(m_addrAbs, m_registers.y);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TAX(){
+
+    m_registers.x = m_registers.acc;
+    m_registers.status.z = m_registers.x == 0x0;
+    m_registers.status.n = (m_registers.x & 0x80) == 0x80;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TAY(){
+
+    m_registers.y = m_registers.acc;
+    m_registers.status.z = m_registers.y == 0x0;
+    m_registers.status.n = (m_registers.y & 0x80) == 0x80;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TSX(){
+
+    m_registers.x = m_registers.sp;
+    m_registers.status.z = m_registers.x == 0x0;
+    m_registers.status.n = (m_registers.x & 0x80) == 0x80;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TXA(){
+
+    m_registers.acc = m_registers.x;
+    m_registers.status.z = m_registers.acc == 0x0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TXS(){
+
+    m_registers.sp = m_registers.x;
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TYA(){
+
+    m_registers.acc = m_registers.y;
+    m_registers.status.z = m_registers.acc == 0x0;
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+    return 0;
+}
+
+// Illegal instructions.
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ALR(){
+
+    AND();
+    LSR();
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ANC(){
+
+    AND();
+    m_registers.status.c = (m_mainBus.read(m_addrAbs) & 0x80) >> 7;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ANE(){
+
+    m_registers.acc |= 0xFF;
+    m_registers.acc &= m_registers.x;
+    m_registers.acc &= m_mainBus.read(m_addrAbs);
+
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+    m_registers.status.z = m_registers.acc == 0x0;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ARR(){
+
+    AND();
+    ACC(); // Because ROR is performed on A.
+    ROR();
+    m_registers.status.c = (m_registers.acc & 0x40) >> 6;
+    m_registers.status.v = ((m_registers.acc & 0x40) >> 6) ^ ((m_registers.acc & 0x20) >> 5);
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::DCP(){
+
+    DEC();
+    CMP();
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::ISB(){
+
+    INC();
+    SBC();
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LAS(){
+
+    uint8_t value = m_mainBus.read(m_addrAbs) & m_registers.sp;
+    m_registers.acc = value;
+    m_registers.x = value;
+    m_registers.sp = value;
+
+    m_registers.status.n = (value & 0x80) == 0x80;
+    m_registers.status.z = value == 0x0;
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LAX(){
+
+    LDA();
+    LDX();
+
+    return 1;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::LXA(){
+
+    m_registers.acc |= 0xFF;
+    m_registers.acc &= m_mainBus.read(m_addrAbs);
+    m_registers.x = m_registers.acc;
+
+    m_registers.status.n = (m_registers.acc & 0x80) == 0x80;
+    m_registers.status.z = m_registers.acc == 0x0;
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::RLA(){
+
+    ROL();
+    AND();
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::RRA(){
+
+    ROR();
+    ADC();
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SAX(){
+
+    m_mainBus.write(m_addrAbs, m_registers.acc & m_registers.x);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SBX(){
+
+    m_registers.x = (m_registers.acc & m_registers.x) - m_mainBus.read(m_addrAbs);
+    m_registers.status.n = (m_registers.x & 0x80) == 0x80;
+    m_registers.status.z = m_registers.x == 0x0;
+    m_registers.status.c = (m_registers.acc >= m_registers.x);
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SHA(){
+
+    m_mainBus.write(m_addrAbs, m_registers.acc & m_registers.x & ((m_addrAbs & 0xFF00 >> 8) + 1));
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SHX(){
+
+    m_mainBus.write(m_addrAbs, m_registers.x & (((m_addrRel & 0xFF00) >> 8) + 1));
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SHY(){
+
+    m_mainBus.write(m_addrAbs, m_registers.y & (((m_addrRel & 0xFF00) >> 8) + 1));
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SLO(){
+
+    ASL();
+    ORA();
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::SRE(){
+
+    LSR();
+    EOR();
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::TAS(){
+
+    m_registers.sp = m_registers.acc & m_registers.x;
+    m_mainBus.write(m_addrAbs, m_registers.acc & m_registers.x & (((m_addrAbs & 0xFF00) >> 8) + 1));
+
+    return 0;
+}
+
+template<class BusT>
+uint8_t MOS6502<BusT>::JAM(){
+
+    m_registers.pc--; //Decreases the PC to the itself, effectively stopping the execution process.
+    return 0;
+}
+
+template<class BusT>
+void MOS6502<BusT>::init() {
+    hardReset();
+    m_breakpoints.clearHit();
+}
+
+#endif //USE_6502IMPL_H
@@ -9,8 +9,11 @@
 #define USE_APU_H
 
 #include <cstdint>
+#include <array>
 #include "Component.h"
 
+class StateHasher;
+
 /**
  * NES APU emulator. APU is normally a part of 2A03 but for the sake of modularity it is separated
  * in this project.
@@ -23,11 +26,48 @@
 class APU : public Component {
 
 private:
+    /// Non-linear mixer approximation of the pulse channels, index is the sum of both pulse channels' outputs.
+    static const std::array<float, 31> pulseTable;
+    /// Non-linear mixer approximation of the triangle, noise and DMC channels, index is 3 * triangle + 2 * noise + DMC.
+    static const std::array<float, 203> tndTable;
+
+    /// Cached mixer output.
+    float m_level = 0;
+    /// Set if any channel output may have changed since the last mixing.
+    bool m_levelDirty = true;
+    /// Fractional clock accumulator of the render function.
+    uint32_t m_renderPhase = 0;
+    /// Emulate only the state visible to the CPU (frame IRQ, length counters), see setTimingOnly.
+    bool m_timingOnly = false;
+
     bool m_internalIRQState = false;
 
     /// Main APU clock.
     uint16_t m_clock = 0;
 
+    /**
+     * Advance a channel timer by multiple cycles at once.
+     * The timer counts down and is reloaded with the period on the cycle after reaching zero.
+     *
+     * @param timer Timer to advance.
+     * @param period Timer reload value.
+     * @param cycles Cycles to advance.
+     * @return Count of reloads (sequencer clocks) during the cycles.
+    */
+    static uint32_t advanceTimer(uint16_t & timer, uint16_t period, uint32_t cycles);
+
+    /**
+     * Get the value of m_clock at which the frame sequencer has to be stopped,
+     * i.e. the nearest frame sequencer event or the sequence wrap.
+     * @return Boundary clock value, always larger than m_clock.
+    */
+    [[nodiscard]] uint32_t nextBoundary() const;
+
+    /**
+     * Process a frame sequencer step (envelopes, length counters, sweeps and IRQ) at the current m_clock, if any.
+    */
+    void frameSequencerStep();
+
     /// Toggles between 4 and 5 step FC sequences.
     bool frameCounterModeFlag = false;
 
@@ -37,7 +77,7 @@ private:
     /// Decremented on every APU cycle, except when == 0 or halted.
     struct apu_lengthCounter{
     private:
-        uint8_t lengths[0x20] = {
+        static constexpr uint8_t lengths[0x20] = {
                 10, 254, 20, 2, 40, 4, 80, 6, 160, 8, 60, 10, 14, 12, 26, 14,
                 12, 16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30
         };
@@ -51,6 +91,7 @@ private:
         void setLength(uint8_t lengthBits);
         void setEnableFlag(bool value);
         void setHaltFlag(bool value);
+        void hashState(StateHasher & hasher) const;
     };
 
     /**
@@ -107,6 +148,8 @@ private:
          * @return Volume value (0-15).
         */
         [[nodiscard]] uint8_t output() const;
+
+        void hashState(StateHasher & hasher) const;
     };
 
     // ================================================================================================
@@ -142,8 +185,8 @@ private:
          * 2: 0111 1000 (50 %)
          * 3: 1001 1111 (25 % negated)
         */
-        const uint8_t sequences[4] = {0x40, 0x60, 0x78, 0x9F};
-        const double sequencesOsc[4] = {0.125, 0.25, 0.5, 0.75};
+        static constexpr uint8_t sequences[4] = {0x40, 0x60, 0x78, 0x9F};
+        static constexpr double sequencesOsc[4] = {0.125, 0.25, 0.5, 0.75};
 
         /**
          * Current position in the sequence (value 0-7).
@@ -183,9 +226,16 @@ private:
         double phaseIndex = 0;
 
         void reset();
-        void clock();
+        /**
+         * Proceed multiple clocks in the emulation.
+         * @param cycles Clock count.
+         * @return True if the sequencer moved (channel output may have changed).
+        */
+        bool clock(uint32_t cycles);
         uint8_t output();
         float oscOutput();
+        /// The oscillator phase only shapes the oscillator output and is not hashed.
+        void hashState(StateHasher & hasher) const;
     } m_pulse1, m_pulse2;
 
     /// Noise channel.
@@ -193,7 +243,7 @@ private:
 
     private:
         uint8_t periodIndex = 0;
-        const uint16_t periods[0x10] = {
+        static constexpr uint16_t periods[0x10] = {
                 4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068
         };
         uint16_t timer = 0;
@@ -210,8 +260,14 @@ private:
         */
         void reset();
         void setPeriod(uint8_t bits);
-        void clock();
+        /**
+         * Proceed multiple clocks in the emulation.
+         * @param cycles Clock count.
+         * @return True if the shift register moved (channel output may have changed).
+        */
+        bool clock(uint32_t cycles);
         uint8_t output() const;
+        void hashState(StateHasher & hasher) const;
     } m_noise;
 
     /// Triangle channel.
@@ -225,6 +281,7 @@ private:
         apu_lengthCounter lengthCounter;
 
         void reset();
+        void hashState(StateHasher & hasher) const;
     } m_triangle;
 
     /// Outbound interrupt request flag.
@@ -242,15 +299,79 @@ public:
     /**
      * APU master clock. Emulates the APU Frame Counter (Sequencer).
      * APU is clocked on every other CPU cycle (2 CPU cycles == 1 APU cycle).
+     *
+     * Multiple cycles are processed at once: the time is advanced straight to the next frame sequencer event
+     * and the channel timers are advanced in bulk, so the cost does not depend on the cycle count much.
+     *
+     * @param cycles Count of APU cycles to proceed.
     */
-    void clock();
+    void clock(uint32_t cycles = 1);
+
+    /**
+     * Read a register, used by the "cpuBus" connector.
+     * @param address CPU address.
+     * @param buffer Read data.
+     * @return True if the register is readable ($4015).
+    */
+    bool cpuRead(uint16_t address, uint8_t & buffer);
+
+    /**
+     * Write a register, used by the "cpuBus" connector.
+     * @param address CPU address, other than $4000-$4017 is ignored.
+     * @param data Data to write.
+    */
+    void cpuWrite(uint16_t address, uint8_t data);
+
+    /**
+     * Get count of cycles which can be batched without delaying any frame sequencer event (including IRQ).
+     * Clocking the returned amount of cycles processes the nearest event.
+     * @return Cycle count, at least 1.
+    */
+    [[nodiscard]] uint32_t cyclesUntilEvent() const;
+
+    /**
+     * Enable or disable the timing-only mode.
+     * In the timing-only mode, the channel timers are not clocked and the output is not mixed. Only the frame sequencer,
+     * length counters and IRQ are emulated cycle exactly, so the status reads and interrupts behave as usual.
+     * Used when the sound is synthesized by another APU instance (see APUSynthesizer).
+     *
+     * @param enabled True to enable.
+    */
+    void setTimingOnly(bool enabled);
+
+    /**
+     * Copy the emulation state (frame sequencer, channels and mixer) of another APU.
+     * The timing-only mode and the wiring are kept.
+     * @param other APU to copy.
+    */
+    void copyState(const APU & other);
+
+    /**
+     * Hash the emulation state (frame sequencer and channels). The mixer cache and the render phase are not included.
+     * In the timing-only mode, the channel timers don't run, so the hash differs from a fully emulated APU.
+     * @param hasher Hasher to feed.
+    */
+    void hashState(StateHasher & hasher) const;
 
     /**
      * Raw audio output.
+     * The channels are mixed using lookup tables only if any channel output changed since the last call.
      * @return Approx audio level from 0.0 to 1.0.
     */
     float output();
 
+    /**
+     * Render a block of audio samples.
+     * The APU is clocked by itself in a tight loop, while sampling the output at the specified rate.
+     * Register writes should be done between the blocks.
+     *
+     * @param buffer Output buffer, at least count samples long.
+     * @param count Number of samples to render.
+     * @param clockRate APU clock rate in Hz.
+     * @param sampleRate Output sample rate in Hz.
+    */
+    void render(float * buffer, size_t count, uint32_t clockRate, uint32_t sampleRate);
+
     std::vector<EmulatorWindow> getGUIs() override;
     SoundSampleSources  getSoundSampleSources() override;
 };
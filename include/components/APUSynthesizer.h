@@ -0,0 +1,135 @@
+/**
+ * @file APUSynthesizer.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief NES APU sound synthesis on a separate thread.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_APUSYNTHESIZER_H
+#define USE_APUSYNTHESIZER_H
+
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "SPSCQueue.h"
+#include "components/APU.h"
+
+/**
+ * APU sound synthesizer running on its own thread.
+ *
+ * The emulation thread only records the APU register writes with their timestamps (APU cycle count)
+ * and periodically publishes the emulated time. The synthesizer thread replays the writes into its own APU instance
+ * at the right time and renders the audio blocks in between. The rendered samples are then picked one by one
+ * by the emulation thread (Sound sample source), which is cheap.
+ *
+ * The emulation-side APU should run in the timing-only mode (see APU::setTimingOnly) to keep the frame IRQ and
+ * status reads exact.
+ *
+ * Register writes are applied with a sub-sample precision (the write is applied at the nearest sample boundary).
+ * The output is delayed by OUTPUT_LATENCY samples to absorb the thread scheduling jitter.
+ * */
+class APUSynthesizer {
+
+public:
+    /// Logged APU register write.
+    struct RegisterWrite {
+        /// APU cycle of the write.
+        uint64_t timestamp;
+        uint16_t address;
+        uint8_t data;
+    };
+
+private:
+    /// Count of samples buffered before the output starts.
+    static constexpr size_t OUTPUT_LATENCY = 512;
+    /// Samples rendered at once.
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    const uint32_t m_clockRate;
+    const uint32_t m_sampleRate;
+
+    /// APU owned by the synthesizer thread.
+    APU m_apu;
+    /// Register writes from the emulation thread.
+    SPSCQueue<RegisterWrite, 4096> m_writes;
+    /// Rendered samples for the emulation thread.
+    SPSCQueue<float, 8192> m_samples;
+
+    /// Emulated time (APU cycles) published by the emulation thread.
+    std::atomic<uint64_t> m_time = 0;
+    std::atomic<bool> m_stop = false;
+    std::thread m_thread;
+
+    // Synthesizer thread data.
+    uint64_t m_samplesRendered = 0;
+
+    // Emulation thread data.
+    bool m_outputStarted = false;
+    float m_lastSample = 0;
+    std::atomic<uint64_t> m_underruns = 0;
+    std::atomic<uint64_t> m_overruns = 0;
+
+    /// Synthesizer thread main loop.
+    void run();
+
+    /**
+     * Render samples up to the specified time.
+     * @param time APU cycle.
+     * */
+    void renderUntil(uint64_t time);
+
+public:
+    /**
+     * Create and start the synthesizer.
+     * @param clockRate APU clock rate in Hz.
+     * @param sampleRate Output sample rate in Hz.
+     * */
+    APUSynthesizer(uint32_t clockRate, uint32_t sampleRate);
+
+    /**
+     * Create and start the synthesizer continuing from a running APU, e.g. when the audio thread is enabled mid-run.
+     * @param clockRate APU clock rate in Hz.
+     * @param sampleRate Output sample rate in Hz.
+     * @param state APU to continue from, its registers and channels are copied.
+     * @param timestamp Current APU cycle, the following writes and syncs continue from it.
+     * */
+    APUSynthesizer(uint32_t clockRate, uint32_t sampleRate, const APU & state, uint64_t timestamp);
+    ~APUSynthesizer();
+
+    APUSynthesizer(const APUSynthesizer &) = delete;
+    APUSynthesizer & operator=(const APUSynthesizer &) = delete;
+
+    /**
+     * Record a register write (emulation thread only).
+     * The writes must be recorded in a chronological order.
+     *
+     * @param timestamp APU cycle of the write.
+     * @param address Register address ($4000-$4017).
+     * @param data Written value.
+     * */
+    void write(uint64_t timestamp, uint16_t address, uint8_t data);
+
+    /**
+     * Publish the emulated time, so the synthesizer can render the samples up to this point (emulation thread only).
+     * @param timestamp Current APU cycle.
+     * */
+    void sync(uint64_t timestamp);
+
+    /**
+     * Take the next rendered sample (emulation thread only).
+     * If there are no samples available, the last one is repeated.
+     * @return Audio sample.
+     * */
+    float nextSample();
+
+    /// Count of rendered samples waiting to be taken.
+    [[nodiscard]] size_t availableSamples() const;
+
+    /// Count of nextSample calls with no sample available.
+    [[nodiscard]] uint64_t getUnderruns() const;
+
+    /// Count of samples dropped because the output queue was full.
+    [[nodiscard]] uint64_t getOverruns() const;
+};
+
+#endif //USE_APUSYNTHESIZER_H
@@ -0,0 +1,215 @@
+/**
+ * @file Breakpoints.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief CPU breakpoints and watchpoints.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_BREAKPOINTS_H
+#define USE_BREAKPOINTS_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Execution breakpoints and read/write watchpoints of a 16-bit address space, with optional conditions.
+ *
+ * Every 256 B page has a mask of the breakpoint types set in it. The CPU looks up the page first and
+ * evaluates the breakpoints only if the page is marked, so a program running outside the marked pages
+ * pays only for a single table lookup per instruction fetch (or per access for watchpoints).
+ *
+ * Conditions are C-like expressions compiled once to a stack bytecode, e.g. `A==3 && [$00FF]>10`:
+ * - values: decimal, $hex, 0xhex and %binary numbers, registers A, X, Y, P, SP, PC,
+ *   ADDR and VALUE (the accessed address and data), [address] (a byte of memory),
+ * - operators (by precedence): unary ! ~ -, binary + -, < <= > >=, == !=, &, ^, |, &&, ||.
+ * */
+class Breakpoints {
+
+public:
+    /// Breakpoint types, can be combined.
+    enum TYPE : uint8_t {
+        EXECUTE = 1 << 0,
+        READ    = 1 << 1,
+        WRITE   = 1 << 2
+    };
+
+    /// Values the conditions can refer to.
+    struct Context {
+        uint16_t pc;
+        uint8_t a, x, y, p, sp;
+        /// Accessed address (the instruction address for execution breakpoints).
+        uint16_t address;
+        /// Accessed data (the opcode for execution breakpoints).
+        uint8_t value;
+    };
+
+    /// Memory read without side effects.
+    using PeekFunction = std::function<uint8_t(uint16_t)>;
+
+    /**
+     * Breakpoint condition compiled to a stack bytecode.
+     * */
+    class Condition {
+
+    public:
+        enum class OP : uint8_t {
+            PUSH, A, X, Y, P, SP, PC, ADDR, VALUE, PEEK,
+            NOT, INVERT, NEGATE,
+            ADD, SUB, LT, LE, GT, GE, EQ, NE, BIT_AND, BIT_XOR, BIT_OR, AND, OR
+        };
+
+        struct Instruction {
+            OP op;
+            int32_t operand;
+        };
+
+        /// Maximal depth of the evaluation stack.
+        static constexpr size_t MAX_STACK = 16;
+
+    private:
+        std::vector<Instruction> m_code;
+
+    public:
+        /// Empty condition, always true.
+        Condition() = default;
+
+        /**
+         * Compile an expression.
+         * @param expression Condition expression, always true if empty.
+         * @throw std::invalid_argument If the expression is malformed or too complex.
+         * */
+        explicit Condition(const std::string & expression);
+
+        /**
+         * Evaluate the condition.
+         * @param context Register and access values.
+         * @param peek Memory read function.
+         * @return True if the result is non-zero.
+         * */
+        [[nodiscard]] bool evaluate(const Context & context, const PeekFunction & peek) const;
+
+        /// Check whether the condition is always true.
+        [[nodiscard]] bool empty() const;
+
+        /// Get the compiled bytecode.
+        [[nodiscard]] const std::vector<Instruction> & getCode() const;
+    };
+
+    struct Breakpoint {
+        /// First address.
+        uint16_t from;
+        /// Last address (inclusive).
+        uint16_t to;
+        /// Combination of TYPE values.
+        uint8_t types;
+        std::string expression;
+        Condition condition;
+        bool enabled;
+        uint64_t hits;
+    };
+
+    /// Description of the last triggered breakpoint.
+    struct Hit {
+        size_t index;
+        TYPE type;
+        uint16_t address;
+        uint8_t value;
+    };
+
+private:
+    std::vector<Breakpoint> m_breakpoints;
+    /// Types of the enabled breakpoints per page.
+    std::array<uint8_t, 256> m_pages{};
+    /// Types of all the enabled breakpoints.
+    uint8_t m_types = 0;
+
+    bool m_hit = false;
+    Hit m_lastHit{};
+
+    // GUI settings.
+    char m_guiFrom[8] = "";
+    char m_guiTo[8] = "";
+    char m_guiCondition[128] = "";
+    bool m_guiTypes[3] = {true, false, false};
+    std::string m_guiStatus;
+
+    /// Rebuild the page masks.
+    void update();
+
+public:
+    /**
+     * Add a breakpoint.
+     * @param from First address.
+     * @param to Last address (inclusive).
+     * @param types Combination of TYPE values.
+     * @param expression Condition, the breakpoint is unconditional if empty.
+     * @return Index of the breakpoint.
+     * @throw std::invalid_argument If the range or types are invalid or the condition is malformed.
+     * */
+    size_t add(uint16_t from, uint16_t to, uint8_t types, const std::string & expression = "");
+
+    /**
+     * Remove a breakpoint. Indices of the following breakpoints are decreased.
+     * @param index Index of the breakpoint.
+     * @throw std::out_of_range If there is no such breakpoint.
+     * */
+    void remove(size_t index);
+
+    /**
+     * Enable or disable a breakpoint.
+     * @param index Index of the breakpoint.
+     * @param enabled False to ignore the breakpoint.
+     * @throw std::out_of_range If there is no such breakpoint.
+     * */
+    void setEnabled(size_t index, bool enabled);
+
+    /// Remove all the breakpoints.
+    void clear();
+
+    [[nodiscard]] const std::vector<Breakpoint> & getBreakpoints() const;
+
+    /**
+     * Check whether the page of an address has an enabled breakpoint of a type.
+     * @param address Address.
+     * @param type Breakpoint type.
+     * */
+    [[nodiscard]] bool isMarked(uint16_t address, TYPE type) const {
+        return m_pages[address >> 8] & type;
+    }
+
+    /// Check whether any breakpoint of a type is enabled.
+    [[nodiscard]] bool hasType(TYPE type) const {
+        return m_types & type;
+    }
+
+    /**
+     * Evaluate the breakpoints matching an access. The first one which matches is reported as the hit.
+     * @param type Access type.
+     * @param context Register and access values.
+     * @param peek Memory read function for the conditions.
+     * @return True if a breakpoint was hit.
+     * */
+    bool check(TYPE type, const Context & context, const PeekFunction & peek);
+
+    /// Check whether a breakpoint was hit since the last clearHit().
+    [[nodiscard]] bool isHit() const {
+        return m_hit;
+    }
+
+    /// Acknowledge the hit.
+    void clearHit();
+
+    /// Get the last hit.
+    [[nodiscard]] const Hit & getLastHit() const;
+
+    /**
+     * Draw the breakpoint list and editor.
+     * @return True if the breakpoints were changed.
+     * */
+    bool drawGUI();
+};
+
+#endif //USE_BREAKPOINTS_H
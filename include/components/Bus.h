@@ -12,16 +12,33 @@
 #include <memory>
 #include "Types.h"
 #include "Component.h"
+#include "components/BusStatistics.h"
+#include "components/DebugHooks.h"
 
 /**
  * @brief A simple bus abstraction class with a primitive arbitration mechanism.
  *
+ * Writes are sent to all the devices. A read is answered by the first responding device (lowest slot),
+ * or by all of them merged (see ARBITRATION), which joins several devices sharing an address range into
+ * a single slot of another bus.
+ *
  * Available ports: data "slot x" where x is in range [0, portCount].
  * Available connectors: data "master" to access all devices on the bus.
  * */
 class Bus : public Component{
 
+public:
+    /// Read arbitration of the devices responding to the same address.
+    enum class ARBITRATION {
+        /// The first responding device (lowest slot) drives the data.
+        FIRST,
+        /// The data of all the responding devices are ORed (e.g. NES $4017: APU and controller 2).
+        MERGE
+    };
+
 private:
+    /// Read arbitration.
+    ARBITRATION m_arbitration;
     /// Address lane mask.
     uint32_t m_addrMask;
     /// Data lane mask.
@@ -29,15 +46,44 @@ private:
     /// Data connections to the devices on the bus.
     std::vector<DataPort> m_devices;
 
-    /// Last access type.
-    enum class lastAccess {NONE, READ, WRITE} m_lastAccess = lastAccess::NONE;
-    /// Last address accessed (debug info).
-    uint32_t m_lastAddress = 0x00;
-    /// Last data read/written.
-    uint32_t m_lastData = 0x00;
+    /// Access statistics, only allocated while enabled.
+    std::unique_ptr<BusStatistics> m_statistics;
+
+    /**
+     * Create the master interface.
+     * @tparam Hooks Hooks policy (see DebugHooks.h), DebugHooks records every access into m_statistics.
+     * */
+    template<class Hooks>
+    DataInterface masterInterface();
 
 public:
-    Bus(int portCount, int addrWidth, int dataWidth);
+    /**
+     * Create a bus.
+     * @param portCount Count of device slots.
+     * @param addrWidth Address width in bits.
+     * @param dataWidth Data width in bits.
+     * @param arbitration Read arbitration.
+     * @throw std::invalid_argument If a width is not in range [0,32].
+     * */
+    Bus(int portCount, int addrWidth, int dataWidth, ARBITRATION arbitration = ARBITRATION::FIRST);
+
+    /**
+     * Enable or disable the access statistics (see BusStatistics).
+     *
+     * The master connector interface is swapped, so there is no overhead while disabled.
+     * Enabling resets the collected statistics.
+     *
+     * @param enabled True to collect the statistics.
+     * */
+    void setStatisticsEnabled(bool enabled);
+
+    [[nodiscard]] bool isStatisticsEnabled() const;
+
+    /**
+     * Get the collected statistics.
+     * @return Pointer to the statistics, nullptr if disabled.
+     * */
+    [[nodiscard]] const BusStatistics * getStatistics() const;
 
     void init() override;
     std::vector<EmulatorWindow> getGUIs() override;
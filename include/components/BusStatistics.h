@@ -0,0 +1,143 @@
+/**
+ * @file BusStatistics.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Bus access statistics collector.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_BUSSTATISTICS_H
+#define USE_BUSSTATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Access statistics of a single Bus.
+ *
+ * Keeps read and write counts of every address (up to MAX_TRACKED_ADDRESSES, the rest is counted as untracked),
+ * read hits of every device slot and the last access. Page counts are summed from the address counts on demand,
+ * so the recording itself is just a few increments.
+ *
+ * The collector is owned by the Bus and only exists while enabled (see Bus::setStatisticsEnabled).
+ * */
+class BusStatistics {
+
+public:
+    /// Page size for the page counts.
+    static constexpr uint32_t PAGE_SIZE = 0x100;
+    /// Size of the per-address counters, enough for the whole 6502 address space.
+    static constexpr uint32_t MAX_TRACKED_ADDRESSES = 0x10000;
+
+    /// Access type.
+    enum class ACCESS {NONE, READ, WRITE};
+
+    /// Last access on the bus.
+    struct LastAccess {
+        ACCESS type = ACCESS::NONE;
+        uint32_t address = 0;
+        uint32_t data = 0;
+    };
+
+private:
+    std::vector<uint64_t> m_reads;
+    std::vector<uint64_t> m_writes;
+    std::vector<uint64_t> m_deviceReads;
+    uint64_t m_unclaimedReads = 0;
+    uint64_t m_totalReads = 0;
+    uint64_t m_totalWrites = 0;
+    uint64_t m_untrackedAccesses = 0;
+    LastAccess m_lastAccess;
+
+    // GUI settings.
+    int m_heatmapCellSize = 16;
+    int m_heatmapMode = 0;
+
+public:
+    /**
+     * @param addressSpaceSize Count of addresses on the bus (address mask + 1).
+     * @param deviceCount Count of device slots.
+     * */
+    BusStatistics(uint64_t addressSpaceSize, size_t deviceCount);
+
+    /**
+     * Record a read.
+     * @param address Masked address.
+     * @param data Read data.
+     * @param device Index of the device which responded, -1 if none.
+     * */
+    void recordRead(uint32_t address, uint32_t data, int device) {
+
+        if(address < m_reads.size())
+            m_reads[address]++;
+        else
+            m_untrackedAccesses++;
+
+        if(device >= 0)
+            m_deviceReads[device]++;
+        else
+            m_unclaimedReads++;
+
+        m_totalReads++;
+        m_lastAccess = {ACCESS::READ, address, data};
+    }
+
+    /**
+     * Record a write.
+     * @param address Masked address.
+     * @param data Written data.
+     * */
+    void recordWrite(uint32_t address, uint32_t data) {
+
+        if(address < m_writes.size())
+            m_writes[address]++;
+        else
+            m_untrackedAccesses++;
+
+        m_totalWrites++;
+        m_lastAccess = {ACCESS::WRITE, address, data};
+    }
+
+    /// Clear all the counters.
+    void reset();
+
+    /// Get count of the tracked addresses.
+    [[nodiscard]] size_t getTrackedSize() const;
+
+    /// Get count of the tracked pages.
+    [[nodiscard]] size_t getPageCount() const;
+
+    /// Get count of reads of an address (0 if not tracked).
+    [[nodiscard]] uint64_t getReads(uint32_t address) const;
+
+    /// Get count of writes to an address (0 if not tracked).
+    [[nodiscard]] uint64_t getWrites(uint32_t address) const;
+
+    /// Get count of reads of a page.
+    [[nodiscard]] uint64_t getPageReads(uint32_t page) const;
+
+    /// Get count of writes to a page.
+    [[nodiscard]] uint64_t getPageWrites(uint32_t page) const;
+
+    /// Get count of reads handled by a device slot.
+    [[nodiscard]] uint64_t getDeviceReads(size_t device) const;
+
+    /// Get count of reads not handled by any device (open bus).
+    [[nodiscard]] uint64_t getUnclaimedReads() const;
+
+    [[nodiscard]] uint64_t getTotalReads() const;
+    [[nodiscard]] uint64_t getTotalWrites() const;
+
+    /// Get count of accesses out of the tracked address range.
+    [[nodiscard]] uint64_t getUntrackedAccesses() const;
+
+    [[nodiscard]] const LastAccess & getLastAccess() const;
+
+    /// Draw the summary: last access, device hit ratios and the hottest pages.
+    void drawSummary() const;
+
+    /// Draw the address space heatmap.
+    void drawHeatmap();
+};
+
+#endif //USE_BUSSTATISTICS_H
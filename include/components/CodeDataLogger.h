@@ -0,0 +1,130 @@
+/**
+ * @file CodeDataLogger.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Code/Data Logger of the cartridge ROMs.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_CODEDATALOGGER_H
+#define USE_CODEDATALOGGER_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * Code/Data Logger (CDL): records how every byte of PRG and CHR ROM was used.
+ *
+ * The flags are stored in the FCEUX .cdl layout, one byte per ROM byte (PRG ROM followed by CHR ROM).
+ * The mapper marks the bytes when they are read, the current access kind is set by the CPU (code, data,
+ * indirect) and by the PPU (rendering, $2007 reads), so marking is a single OR at the access site.
+ * */
+class CodeDataLogger {
+
+public:
+    /// PRG ROM byte flags.
+    enum PRG_FLAG : uint8_t {
+        /// Executed (opcode or operand).
+        CODE          = 0x01,
+        /// Read as data.
+        DATA          = 0x02,
+        /// CPU window the byte was mapped to (00 = $8000, 01 = $A000, 10 = $C000, 11 = $E000).
+        WINDOW_MASK   = 0x0C,
+        /// Target of an indirect jump.
+        INDIRECT_CODE = 0x10,
+        /// Read through an indirect addressing mode.
+        INDIRECT_DATA = 0x20,
+        /// Read as DPCM sample data.
+        PCM_DATA      = 0x40
+    };
+
+    /// CHR ROM byte flags.
+    enum CHR_FLAG : uint8_t {
+        /// Fetched by the rendering.
+        RENDERED = 0x01,
+        /// Read by the CPU through PPUDATA.
+        READ     = 0x02
+    };
+
+    /// Count of bytes by their use.
+    struct Summary {
+        size_t code;
+        size_t data;
+        size_t unusedPRG;
+        size_t rendered;
+        size_t read;
+        size_t unusedCHR;
+    };
+
+private:
+    std::vector<uint8_t> m_PRG;
+    std::vector<uint8_t> m_CHR;
+
+    uint8_t m_PRGAccess = DATA;
+    uint8_t m_CHRAccess = RENDERED;
+
+public:
+    /**
+     * Set the ROM sizes, all the flags are cleared.
+     * @param PRGSize PRG ROM size.
+     * @param CHRSize CHR ROM size, 0 for CHR RAM.
+     * */
+    void resize(size_t PRGSize, size_t CHRSize);
+
+    /// Clear all the flags.
+    void clear();
+
+    /// Set the flags of the following PRG ROM reads (CODE, DATA, INDIRECT_*).
+    void setPRGAccess(uint8_t flags) {
+        m_PRGAccess = flags;
+    }
+
+    /// Set the flags of the following CHR ROM reads.
+    void setCHRAccess(uint8_t flags) {
+        m_CHRAccess = flags;
+    }
+
+    /**
+     * Mark a PRG ROM read.
+     * @param offset PRG ROM offset.
+     * @param address CPU address the byte is mapped at.
+     * */
+    void markPRG(size_t offset, uint16_t address) {
+        m_PRG[offset] |= m_PRGAccess | ((address >> 11) & WINDOW_MASK);
+    }
+
+    /**
+     * Mark a CHR read, ignored for CHR RAM.
+     * @param offset CHR ROM offset.
+     * */
+    void markCHR(size_t offset) {
+        if(offset < m_CHR.size())
+            m_CHR[offset] |= m_CHRAccess;
+    }
+
+    /// Get the PRG ROM flags (see PRG_FLAG).
+    [[nodiscard]] std::span<const uint8_t> getPRG() const;
+
+    /// Get the CHR ROM flags (see CHR_FLAG).
+    [[nodiscard]] std::span<const uint8_t> getCHR() const;
+
+    [[nodiscard]] Summary getSummary() const;
+
+    /**
+     * Save the log as an FCEUX .cdl file.
+     * @param path Output file path.
+     * @throw std::runtime_error If the file can't be written.
+     * */
+    void save(const std::string & path) const;
+
+    /**
+     * Load an FCEUX .cdl file to continue logging. The flags are merged with the current ones.
+     * @param path Input file path.
+     * @throw std::runtime_error If the file can't be read.
+     * @throw std::invalid_argument If the size doesn't match the ROM.
+     * */
+    void load(const std::string & path);
+};
+
+#endif //USE_CODEDATALOGGER_H
@@ -0,0 +1,30 @@
+/**
+ * @file DebugHooks.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Debug hook policies of the emulated cores.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_DEBUGHOOKS_H
+#define USE_DEBUGHOOKS_H
+
+/**
+ * Hooks policy without any debug call sites.
+ *
+ * The hot paths of the cores (MOS6502::CLK, R2C02::clock, Bus master interface) are templates
+ * over a hooks policy and test ENABLED with if constexpr, so this instantiation contains pure emulation.
+ * The cores switch between the instantiations by swapping their connector interfaces.
+ * */
+struct NoHooks {
+    static constexpr bool ENABLED = false;
+};
+
+/**
+ * Hooks policy with all the debug call sites: instruction trace, guest profiler, breakpoints, watchpoints,
+ * Code/Data Logger access kinds, bus statistics and the PPU layer toggles.
+ * */
+struct DebugHooks {
+    static constexpr bool ENABLED = true;
+};
+
+#endif //USE_DEBUGHOOKS_H
@@ -10,11 +10,13 @@
 #define USE_GAMEPAK_H
 
 #include <fstream>
+#include <functional>
 #include <istream>
 #include <vector>
 #include <memory>
 #include "Types.h"
 #include "Mapper.h"
+#include "components/CodeDataLogger.h"
 #include "Port.h"
 #include "Component.h"
 
@@ -26,7 +28,11 @@
  * There are two virtual connectors, this corresponds to the real hardware, where the
  * cartridge is directly connected to the CPU's and PPU's buses.
  *
- * Connectors: data "cpuBus" for CPU and data "ppuBus" for PPU.
+ * Connectors: data "cpuBus" for CPU and data "ppuBus" for PPU. The same accesses are available as member functions
+ * for the systems wired at compile time.
+ *
+ * The Code/Data Logger (see CodeDataLogger) records the use of the ROM bytes while enabled. The access kinds
+ * are set by the CPU and PPU, which are given the logger by the listener (see setCodeDataLoggerListener).
 */
 class Gamepak : public Component {
 
@@ -121,10 +127,10 @@ protected:
 
     /// Trainer data.
     std::vector<uint8_t> m_trainer;
-    /// Program data.
-    std::vector<uint8_t> m_PRGROM;
-    /// Character (picture) data.
-    std::vector<uint8_t> m_CHRROM;
+    /// Program data, shared with the copies of the gamepak (see copyState).
+    std::shared_ptr<std::vector<uint8_t>> m_PRGROM;
+    /// Character (picture) data, shared with the copies of the gamepak.
+    std::shared_ptr<std::vector<uint8_t>> m_CHRROM;
 
 //    std::vector<uint8_t> m_INSTROM;
 //    std::vector<uint8_t> m_PROM;
@@ -135,6 +141,19 @@ protected:
     /// Gamepak's mapper.
     std::unique_ptr<Mapper> m_mapper;
 
+    // ===========================================
+    // Debugging
+    // ===========================================
+    /// Code/Data Logger, sized to the loaded ROMs.
+    CodeDataLogger m_codeDataLogger;
+    bool m_codeDataLogging = false;
+    /// Called with the logger when logging is enabled and with nullptr when disabled.
+    std::function<void(CodeDataLogger *)> m_codeDataLoggerListener;
+    /// CDL file path in the GUI.
+    char m_codeDataLogPath[256] = "game.cdl";
+    /// Result of the last CDL file operation in the GUI.
+    std::string m_codeDataLogStatus;
+
 public:
     Gamepak();
     ~Gamepak() override;
@@ -152,6 +171,98 @@ public:
      * */
     void load(std::ifstream & ifs);
 
+    /**
+     * CPU read, used by the "cpuBus" connector.
+     * @param address CPU address.
+     * @param data Read data.
+     * @return True if the mapper responded.
+     * */
+    bool cpuRead(uint16_t address, uint8_t & data) {
+        return m_mapper && m_mapper->cpuRead(address, data);
+    }
+
+    /**
+     * CPU write, used by the "cpuBus" connector.
+     * @param address CPU address.
+     * @param data Data to write.
+     * */
+    void cpuWrite(uint16_t address, uint8_t data) {
+        if(m_mapper)
+            m_mapper->cpuWrite(address, data);
+    }
+
+    /**
+     * PPU read, used by the "ppuBus" connector.
+     * @param address PPU address.
+     * @param data Read data.
+     * @return True if the mapper responded.
+     * */
+    bool ppuRead(uint16_t address, uint8_t & data) {
+        return m_mapper && m_mapper->ppuRead(address, data);
+    }
+
+    /**
+     * PPU write, used by the "ppuBus" connector.
+     * @param address PPU address.
+     * @param data Data to write.
+     * */
+    void ppuWrite(uint16_t address, uint8_t data) {
+        if(m_mapper)
+            m_mapper->ppuWrite(address, data);
+    }
+
+    /**
+     * Get the PRG RAM contents.
+     *
+     * @return PRG RAM data, empty if there is no cartridge or it has no PRG RAM.
+     * */
+    [[nodiscard]] const PagedMemory & getPRGRAM() const;
+
+    /**
+     * Copy the state of another gamepak: the ROMs are shared, the mapper is copied with
+     * its RAM pages shared until written. The Code/Data Logger is not copied.
+     *
+     * @param other Gamepak to copy.
+     * @param copyOnWrite False to copy the RAM pages right away.
+     * @throw std::logic_error If the mapper doesn't support copying.
+     * */
+    void copyState(const Gamepak & other, bool copyOnWrite = true);
+
+    /**
+     * Hash the emulation state of the mapper (see Mapper::hashState), nothing if no cartridge is loaded.
+     * @param hasher Hasher to feed.
+     * */
+    void hashState(StateHasher & hasher) const;
+
+    /**
+     * Get the PRG ROM bank mapped at a CPU address (see Mapper::getPRGBank).
+     * @param addr CPU address.
+     * @return 16 KiB PRG ROM bank index, 0 if there is no cartridge.
+     * */
+    [[nodiscard]] uint32_t getPRGBank(uint16_t addr) const;
+
+    /**
+     * Enable or disable the Code/Data Logger. The collected flags are kept when disabled and cleared
+     * when a new ROM is loaded.
+     * @param enabled True to mark the ROM reads.
+     * */
+    void setCodeDataLoggerEnabled(bool enabled);
+
+    [[nodiscard]] bool isCodeDataLoggerEnabled() const;
+
+    /**
+     * Set the function which installs the Code/Data Logger in the CPU and PPU. It is called on every
+     * enable or disable (including from the GUI), so the cores only mark the accesses while logging.
+     * @param listener Function given the logger, or nullptr when logging is disabled.
+     * */
+    void setCodeDataLoggerListener(std::function<void(CodeDataLogger *)> listener);
+
+    /**
+     * Get the Code/Data Logger. The object is the same for the whole Gamepak lifetime.
+     * @return Code/Data Logger.
+     * */
+    [[nodiscard]] CodeDataLogger & getCodeDataLogger();
+
     /**
      * Render a debugging GUI.
      * Shows Gamepak parameters and mapper's internal state.
@@ -8,7 +8,11 @@
 #ifndef USE_MAPPER_H
 #define USE_MAPPER_H
 
+#include <memory>
+#include "PagedMemory.h"
+#include "StateHasher.h"
 #include "Types.h"
+#include "components/CodeDataLogger.h"
 
 /**
  * "Mapper" base class.
@@ -41,7 +45,7 @@ protected:
     // ===========================================
     mirroringType_t m_mirroringType = mirroringType_t::HORIZONTAL;
     /// PPU's built-in video memory (VRAM/CIRAM) emulation.
-    std::array<uint8_t, 0x800> m_CIRAM {0x00};
+    PagedMemory m_CIRAM{0x800};
     /**
      * Write to CIRAM if used.
      *
@@ -58,6 +62,9 @@ protected:
      * */
     virtual uint8_t CIRAMRead(uint16_t address);
 
+    /// Code/Data Logger, ROM reads are marked while it is set.
+    CodeDataLogger * m_codeDataLogger = nullptr;
+
 public:
     Mapper() = default;
     virtual ~Mapper() = default;
@@ -99,6 +106,44 @@ public:
      * */
     virtual bool ppuWrite(uint16_t addr, uint8_t data)  = 0;
 
+    /**
+     * Get the PRG RAM contents (e.g. for external tools).
+     * @return PRG RAM data, empty if the mapper has no PRG RAM.
+     * */
+    [[nodiscard]] virtual const PagedMemory & getPRGRAM() const;
+
+    /**
+     * Copy the mapper with its current state, the RAM pages are shared until written.
+     * The ROM is shared, the Code/Data Logger is not set in the copy.
+     * @return Mapper copy.
+     * @throw std::logic_error If the mapper doesn't support copying.
+     * */
+    [[nodiscard]] virtual std::unique_ptr<Mapper> clone() const;
+
+    /**
+     * Stop sharing the RAM pages with the copies (see PagedMemory::unshare).
+     * */
+    virtual void unshare();
+
+    /**
+     * Hash the emulation state: the mirroring, the RAMs and the registers. The ROM is not included.
+     * @param hasher Hasher to feed.
+     * */
+    virtual void hashState(StateHasher & hasher) const;
+
+    /**
+     * Get the PRG ROM bank mapped at a CPU address (e.g. for profilers and debuggers).
+     * @param addr CPU address.
+     * @return Index of the 16 KiB PRG ROM bank (PRG ROM offset / 0x4000), 0 for addresses outside PRG ROM.
+     * */
+    [[nodiscard]] virtual uint32_t getPRGBank(uint16_t addr) const;
+
+    /**
+     * Set the Code/Data Logger. Every PRG and CHR ROM read is marked in it.
+     * @param logger Logger sized to the ROMs, nullptr to stop logging.
+     * */
+    void setCodeDataLogger(CodeDataLogger * logger);
+
     /**
      * Draw a debugging GUI.
      * */
@@ -11,7 +11,6 @@
 #define USE_MAPPER000_H
 
 #include <vector>
-#include <array>
 #include <cstdint>
 #include "Types.h"
 #include "Mapper.h"
@@ -22,18 +21,18 @@
  * PRG ROM: 16 or 32 KiB.
  * PRG RAM: 2 or 4 KiB, this implementation provides always 8 KiB for compatibility.
  * CHR ROM: 8 KiB
- * If no CHR ROM present (0 KiB), m_CHRRAM will be mapped to CHR ROM and 8 KiB of memory provided.
+ * If no CHR ROM present (0 KiB), m_CHRRAM will be mapped instead and 8 KiB of memory provided.
  *
  * Mirroring settings: via solder pads.
  * This mapper has no bankswitching support.
  * */
 class Mapper000 : public Mapper {
 protected:
-    std::vector<uint8_t> & m_PRGROM;
-    std::vector<uint8_t> & m_CHRROM;
+    const std::vector<uint8_t> & m_PRGROM;
+    const std::vector<uint8_t> & m_CHRROM;
 
-    std::array<uint8_t, 0x2000> m_PRGRAM{0x00};
-    std::vector<uint8_t> m_CHRRAM;
+    PagedMemory m_PRGRAM{0x2000};
+    PagedMemory m_CHRRAM;
     bool m_CHRWritable = false;
 
 public:
@@ -45,7 +44,7 @@ public:
      * @throw std::invalid_argument If PRGROM has invalid size (not 0x4000 nor 0x8000).
      * @throw std::invalid_argument If CHRROM has invalid size (not 0x8000).
      * */
-    Mapper000(std::vector<uint8_t> & PRGROM, std::vector<uint8_t> & CHRROM, mirroringType_t mirroringType);
+    Mapper000(const std::vector<uint8_t> & PRGROM, const std::vector<uint8_t> & CHRROM, mirroringType_t mirroringType);
     ~Mapper000() override = default;
 
     void init() override;
@@ -54,6 +53,12 @@ public:
     bool ppuRead(uint16_t addr, uint8_t & data) override;
     bool ppuWrite(uint16_t addr, uint8_t data)  override;
 
+    [[nodiscard]] const PagedMemory & getPRGRAM() const override;
+    [[nodiscard]] std::unique_ptr<Mapper> clone() const override;
+    void unshare() override;
+    void hashState(StateHasher & hasher) const override;
+    [[nodiscard]] uint32_t getPRGBank(uint16_t addr) const override;
+
     void drawGUI() override;
 
 };
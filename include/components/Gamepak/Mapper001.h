@@ -19,7 +19,7 @@
  * PRG RAM: 8-32 KiB (default 32 KiB, selectable only with NES 2.0 dumps).
  * CHR ROM: 8-128 KiB
  *
- * If no CHR ROM present (0 KiB), m_CHRRAM will be mapped to CHR ROM and 8 KiB of memory provided.
+ * If no CHR ROM present (0 KiB), m_CHRRAM will be mapped instead and 8 KiB of memory provided.
  *
  * Mirroring settings: H, V, single or switchable.
  * Both PRG and CHR ROMs support banking.
@@ -53,12 +53,12 @@ private:
         SWITCH4KB = 1
     };
 
-    std::vector<uint8_t> & m_CHRROM;
-    std::vector<uint8_t> & m_PRGROM;
-    std::vector<uint8_t> m_CHRRAM;
+    const std::vector<uint8_t> & m_CHRROM;
+    const std::vector<uint8_t> & m_PRGROM;
+    PagedMemory m_CHRRAM;
     bool m_CHRWritable = false;
 
-    std::vector<uint8_t> m_PRGRAM;
+    PagedMemory m_PRGRAM;
     /// Shift register accessible via serial port at $8000-$FFFF.
     uint8_t m_loadRegister = 0;
     /// Count of writes to the shift register.
@@ -96,12 +96,23 @@ private:
             CHRROMLoSelect = 0;
             CHRROMHiSelect = 0;
             enablePRGRAM = true;
+            PRGRAMSelect = 0;
         };
 
     } m_registers;
 
     void setMirroring(uint8_t rawValue);
 
+    /// Size of the mapped CHR memory, ROM or RAM.
+    [[nodiscard]] size_t CHRSize() const {
+        return m_CHRWritable ? m_CHRRAM.size() : m_CHRROM.size();
+    }
+
+    /// Read the mapped CHR memory, ROM or RAM.
+    [[nodiscard]] uint8_t CHRRead(size_t offset) const {
+        return m_CHRWritable ? m_CHRRAM.read(offset) : m_CHRROM[offset];
+    }
+
 public:
     /**
      * Create instance of Mapper 001.
@@ -109,7 +120,7 @@ public:
      * PRG RAM size can be selected in NES 2.0 headers, default of 32 KiB is provided for
      * backwards compatibility.
      * */
-    Mapper001(std::vector<uint8_t> & PRGROM, std::vector<uint8_t> & CHRROM, size_t PRGRAMSize = 0x8000);
+    Mapper001(const std::vector<uint8_t> & PRGROM, const std::vector<uint8_t> & CHRROM, size_t PRGRAMSize = 0x8000);
     ~Mapper001() override = default;
 
     void init() override;
@@ -118,6 +129,12 @@ public:
     bool ppuRead(uint16_t addr, uint8_t & data) override;
     bool ppuWrite(uint16_t addr, uint8_t data)  override;
 
+    [[nodiscard]] const PagedMemory & getPRGRAM() const override;
+    [[nodiscard]] std::unique_ptr<Mapper> clone() const override;
+    void unshare() override;
+    void hashState(StateHasher & hasher) const override;
+    [[nodiscard]] uint32_t getPRGBank(uint16_t addr) const override;
+
     void drawGUI() override;
 };
 
@@ -0,0 +1,260 @@
+/**
+ * @file GuestProfiler.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief Cycle profiler of the emulated 6502 program.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_GUESTPROFILER_H
+#define USE_GUESTPROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Profiler of the emulated program (not of the emulator itself, see Profiler).
+ *
+ * Fed by the MOS6502 while its profiler mode is enabled. Every executed instruction is charged with its cycles
+ * at a location, which is the PC combined with the PRG ROM bank mapped at the PC (16 KiB banks,
+ * same as the FCEUX symbol files). The call tree is built from JSR/RTS, NMI/IRQ/BRK and RTI.
+ * Routines are identified by their entry location, every routine has exclusive (own instructions) and inclusive
+ * (including the called routines) cycles, averaged and maximal per frame.
+ *
+ * Returns are matched by the stack pointer: a routine ends once the stack unwinds to the level it was called
+ * from, so RTS used as an indirect jump (pushed address) doesn't break the tree.
+ *
+ * All the per-location data are flat arrays indexed by the location, the hot path is just a few increments.
+ * */
+class GuestProfiler {
+
+public:
+    /// Count of locations in every bank (the whole 6502 address space).
+    static constexpr uint32_t BANK_SIZE = 0x10000;
+    /// Maximal count of banks, higher banks are merged into the last one.
+    static constexpr uint32_t MAX_BANKS = 256;
+    /// Maximal call depth, deeper calls are charged to the deepest tracked routine.
+    static constexpr size_t MAX_DEPTH = 128;
+
+    /// How a routine is entered.
+    enum class ENTRY : uint8_t {ROOT, CALL, NMI, IRQ};
+
+    /// Summary of a single routine.
+    struct RoutineReport {
+        uint32_t bank;
+        uint16_t address;
+        std::string name;
+        ENTRY entry;
+        uint64_t calls;
+        /// Total cycles of the routine's own instructions.
+        uint64_t exclusive;
+        /// Total cycles including the called routines.
+        uint64_t inclusive;
+        double exclusivePerFrame;
+        double inclusivePerFrame;
+        /// Worst frame.
+        uint64_t maxExclusive;
+        uint64_t maxInclusive;
+    };
+
+private:
+    struct Routine {
+        uint32_t location;
+        ENTRY entry;
+        uint64_t calls = 0;
+        uint64_t exclusive = 0;
+        uint64_t inclusive = 0;
+        uint64_t maxExclusive = 0;
+        uint64_t maxInclusive = 0;
+        // Current frame.
+        uint64_t frameExclusive = 0;
+        uint64_t frameInclusive = 0;
+        /// Count of active (not returned) calls, inclusive cycles are only counted by the outermost one.
+        uint32_t active = 0;
+        bool touched = false;
+    };
+
+    /// Call tree node, a unique call path.
+    struct Node {
+        uint32_t routine;
+        uint32_t parent;
+        uint32_t firstChild;
+        uint32_t nextSibling;
+        uint64_t cycles;
+    };
+
+    /// Active call.
+    struct Frame {
+        uint32_t routine;
+        uint32_t node;
+        /// Time of the call or of the frame start, whichever is later.
+        uint64_t start;
+        /// Stack pointer before the call.
+        uint8_t callerSP;
+        bool outermost;
+    };
+
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+
+    /// Cycles per location.
+    std::vector<uint64_t> m_cycles;
+    /// Routine index per location, 0 if the location is not a routine entry (index 0 is the root).
+    std::vector<uint32_t> m_routineIndex;
+    std::vector<Routine> m_routines;
+    /// Routines with non-zero counters in the current frame.
+    std::vector<uint32_t> m_touched;
+    std::vector<Node> m_nodes;
+
+    std::array<Frame, MAX_DEPTH> m_stack{};
+    size_t m_depth = 0;
+
+    /// Cycles elapsed.
+    uint64_t m_time = 0;
+    uint64_t m_frames = 0;
+    /// Calls not tracked because of MAX_DEPTH.
+    uint64_t m_droppedCalls = 0;
+
+    /// Symbol names by location.
+    std::map<uint32_t, std::string> m_symbols;
+
+    // GUI settings.
+    char m_symbolPath[256] = "";
+    char m_flameGraphPath[256] = "profile.folded";
+    std::string m_guiStatus;
+
+    /// Get the location index, grows the arrays if needed.
+    uint32_t locate(uint16_t address, uint32_t bank) {
+
+        if(bank >= MAX_BANKS)
+            bank = MAX_BANKS - 1;
+
+        uint32_t location = (bank << 16) | address;
+        if(location >= m_cycles.size())
+            grow(bank);
+
+        return location;
+    }
+
+    void grow(uint32_t bank);
+
+    void touch(uint32_t routine) {
+        if(!m_routines[routine].touched) {
+            m_routines[routine].touched = true;
+            m_touched.push_back(routine);
+        }
+    }
+
+    /// Get the routine entered at the location, create it if needed.
+    uint32_t getRoutine(uint32_t location, ENTRY entry);
+
+    /// Get the child node of the node, create it if needed.
+    uint32_t getChild(uint32_t node, uint32_t routine);
+
+    /// Pop the topmost call.
+    void pop();
+
+    /// Get routine name: symbol or address.
+    [[nodiscard]] std::string getName(uint32_t location) const;
+
+    void loadFCEUXSymbols(std::istream & is, uint32_t bank);
+    void loadCA65Symbols(std::istream & is);
+
+public:
+    GuestProfiler();
+
+    /**
+     * Charge cycles to an instruction.
+     * @param address PC of the instruction.
+     * @param bank PRG ROM bank mapped at the PC.
+     * @param cycles Count of consumed cycles.
+     * */
+    void instruction(uint16_t address, uint32_t bank, uint32_t cycles) {
+
+        uint32_t location = locate(address, bank);
+        m_cycles[location] += cycles;
+        m_time += cycles;
+
+        const Frame & frame = m_stack[m_depth - 1];
+        m_routines[frame.routine].frameExclusive += cycles;
+        touch(frame.routine);
+        m_nodes[frame.node].cycles += cycles;
+    }
+
+    /**
+     * Enter a routine.
+     * @param address Routine entry address.
+     * @param bank PRG ROM bank mapped at the entry.
+     * @param callerSP Stack pointer before the return address was pushed.
+     * @param entry Call or interrupt.
+     * */
+    void call(uint16_t address, uint32_t bank, uint8_t callerSP, ENTRY entry);
+
+    /**
+     * Return from routines (RTS/RTI). All calls the stack unwound from are finished.
+     * @param sp Stack pointer after the return.
+     * */
+    void ret(uint8_t sp) {
+
+        while(m_depth > 1 && sp >= m_stack[m_depth - 1].callerSP)
+            pop();
+    }
+
+    /// Finish the current frame.
+    void endFrame();
+
+    /// Clear all the collected data (symbols are kept).
+    void reset();
+
+    /**
+     * Load symbol names. Supported are the ca65/ld65 debug info (.dbg) and FCEUX name lists (.nl).
+     * The bank of an FCEUX file is taken from its name (game.nes.<hex bank>.nl, game.nes.ram.nl).
+     * @param path Symbol file path.
+     * @throw std::invalid_argument If the format is not supported.
+     * @throw std::runtime_error If the file can't be opened.
+     * */
+    void loadSymbols(const std::string & path);
+
+    /**
+     * Add a single symbol.
+     * @param address Symbol address.
+     * @param bank PRG ROM bank, 0 for addresses outside PRG ROM.
+     * @param name Symbol name.
+     * */
+    void addSymbol(uint16_t address, uint32_t bank, const std::string & name);
+
+    /// Get count of loaded symbols.
+    [[nodiscard]] size_t getSymbolCount() const;
+
+    /// Get cycles charged to a location.
+    [[nodiscard]] uint64_t getCycles(uint16_t address, uint32_t bank = 0) const;
+
+    /// Get total count of profiled cycles.
+    [[nodiscard]] uint64_t getTotalCycles() const;
+
+    /// Get count of finished frames.
+    [[nodiscard]] uint64_t getFrameCount() const;
+
+    /// Get current call depth (1 = root).
+    [[nodiscard]] size_t getDepth() const;
+
+    /**
+     * Get the routine summaries including the current frame.
+     * @return Routines sorted by inclusive cycles (descending).
+     * */
+    [[nodiscard]] std::vector<RoutineReport> getReport() const;
+
+    /**
+     * Write the call tree as folded stacks ("root;caller;callee cycles" per line),
+     * which is the input of flamegraph.pl, speedscope and similar tools.
+     * @param os Output stream.
+     * */
+    void writeFlameGraph(std::ostream & os) const;
+
+    /// Draw the profiler contents.
+    void drawGUI();
+};
+
+#endif //USE_GUESTPROFILER_H
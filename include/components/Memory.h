@@ -10,7 +10,10 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include "Component.h"
+#include "PagedMemory.h"
+#include "StateHasher.h"
 #include "Types.h"
 
 /**
@@ -22,16 +25,29 @@
  *
  * @note Please note that the address range can be larger than the size, then the memory will be mirrored
  * across the whole range.
+ *
+ * The data are stored in copy-on-write pages (see PagedMemory), so a copied state shares the unwritten pages.
  * */
 class Memory : public Component{
 
 private:
-    std::vector<uint8_t> m_data;
+    PagedMemory m_data;
     AddressRange m_addressRange;
     uint8_t m_defaultValue;
+    /// Offset mask used instead of the modulo if the size is a power of two, 0 otherwise.
+    uint32_t m_offsetMask;
+
+    /// Get the data offset of an address inside the range (including the mirrors).
+    [[nodiscard]] uint32_t offset(uint32_t address) const {
+        uint32_t relative = address - m_addressRange.from;
+        return m_offsetMask ? relative & m_offsetMask : relative % m_data.size();
+    }
 
     void memoryInit();
 
+    /// Contiguous copy of the data for the memory editor in the GUI.
+    std::vector<uint8_t> m_editorView;
+
 public:
     /**
      * Construct a memory.
@@ -49,6 +65,64 @@ public:
     std::vector<EmulatorWindow> getGUIs() override;
 
     void load(uint32_t from, std::ifstream & src);
+
+    /**
+     * Copy data to the memory.
+     *
+     * @param from Start offset.
+     * @param data Data to copy, the part which doesn't fit is ignored.
+     * @throw std::invalid_argument If the offset is bigger than the memory size.
+     * */
+    void load(uint32_t from, std::span<const uint8_t> data);
+
+    /**
+     * Get the memory contents without copying.
+     *
+     * @return Memory data.
+     * */
+    [[nodiscard]] const PagedMemory & getData() const;
+
+    /**
+     * Copy the contents of another memory, the pages are shared until written.
+     *
+     * @param other Memory of the same size.
+     * @param copyOnWrite False to copy the pages right away.
+     * @throw std::invalid_argument If the sizes differ.
+     * */
+    void copyState(const Memory & other, bool copyOnWrite = true);
+
+    /**
+     * Hash the memory contents.
+     * @param hasher Hasher to feed.
+     * */
+    void hashState(StateHasher & hasher) const;
+
+    /**
+     * Read from the memory, used by the "data" connector.
+     *
+     * @param address Address to read from.
+     * @param data Read data.
+     * @return True if the address is inside the range.
+     * */
+    bool read(uint32_t address, uint8_t & data) const {
+
+        if(!m_addressRange.has(address))
+            return false;
+
+        data = m_data.read(offset(address));
+        return true;
+    }
+
+    /**
+     * Write to the memory, used by the "data" connector. Addresses outside the range are ignored.
+     *
+     * @param address Address to write to.
+     * @param data Data to write.
+     * */
+    void write(uint32_t address, uint8_t data) {
+        if(m_addressRange.has(address))
+            m_data.write(offset(address), data);
+    }
 };
 
 #endif //USE_MEMORY_H
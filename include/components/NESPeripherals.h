@@ -9,6 +9,8 @@
 
 #include "Component.h"
 
+class StateHasher;
+
 /**
  * NES Peripherals emulation. For now, there is only emulation of two standard controllers implemented.
  *
@@ -68,6 +70,34 @@ public:
     ~NESPeripherals() override = default;
 
     void init() override;
+
+    /**
+     * Read the controller data, used by the "cpuBus" connector.
+     * @param address CPU address.
+     * @param buffer Read data.
+     * @return True for the controller ports ($4016 and $4017).
+     * */
+    bool cpuRead(uint16_t address, uint8_t & buffer);
+
+    /**
+     * Write the controller strobe, used by the "cpuBus" connector.
+     * @param address CPU address, other than $4016 is ignored.
+     * @param data Data to write.
+     * */
+    void cpuWrite(uint16_t address, uint8_t data);
+
+    /**
+     * Copy the state of the controllers (buttons and shift registers) of another instance.
+     * @param other Peripherals to copy.
+     * */
+    void copyState(const NESPeripherals & other);
+
+    /**
+     * Hash the state of the controllers.
+     * @param hasher Hasher to feed.
+     * */
+    void hashState(StateHasher & hasher) const;
+
     std::vector<EmulatorWindow> getGUIs() override;
     std::vector<ImInputBinder::action_t> getInputs() override;
 };
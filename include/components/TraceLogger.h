@@ -0,0 +1,133 @@
+/**
+ * @file TraceLogger.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief 6502 instruction trace in the nestest.log format.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_TRACELOGGER_H
+#define USE_TRACELOGGER_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * Writer of a CPU instruction trace, one line per instruction, in the format of the nestest.log reference
+ * (Nintendulator):
+ *
+ * C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+ *
+ * Unofficial opcodes are marked by '*', memory operands show the effective address and the value before
+ * the instruction is executed. The PPU position is only written if the position source is set.
+ *
+ * Lines are formatted directly into a preallocated buffer, which is written by a single large fwrite
+ * when full (the stream itself is unbuffered). No iostreams or allocations are used per line.
+ * */
+class TraceLogger {
+
+public:
+    /// Addressing modes, same as the MOS6502 ones.
+    enum class ADDRESS_MODE : uint8_t {ACC, IMM, IMP, ABS, ZP0, REL, ID0, ABX, ABY, ZPX, ZPY, IDX, IDY};
+
+    /// Opcode description.
+    struct Opcode {
+        char mnemonic[4];
+        ADDRESS_MODE mode;
+    };
+
+    /// CPU state before the instruction execution.
+    struct CPUState {
+        uint16_t pc;
+        uint8_t a, x, y;
+        /// Status register as pushed by PHP (without the B flag).
+        uint8_t p;
+        uint8_t sp;
+        /// Cycles since power-up.
+        uint64_t cycles;
+    };
+
+    /// PPU position.
+    struct PPUPosition {
+        int scanline;
+        int dot;
+    };
+
+    /// Memory read without side effects.
+    using PeekFunction = std::function<uint8_t(uint16_t)>;
+    /// PPU position of the current CPU cycle.
+    using PositionFunction = std::function<PPUPosition()>;
+
+    /// Output buffer size.
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+    /// Maximal length of a single line.
+    static constexpr size_t MAX_LINE_LENGTH = 128;
+
+private:
+    std::FILE * m_file;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_used = 0;
+    uint64_t m_lines = 0;
+
+    std::array<Opcode, 256> m_opcodes;
+    PeekFunction m_peek;
+    PositionFunction m_position;
+
+public:
+    /**
+     * Open the trace file.
+     * @param path Output file path.
+     * @param opcodes Opcode table of the CPU.
+     * @param peek Memory read function, must not have side effects.
+     * @param position PPU position source, the PPU field is omitted if empty.
+     * @throw std::runtime_error If the file can't be opened.
+     * @throw std::invalid_argument If the peek function is empty.
+     * */
+    TraceLogger(const std::string & path, const std::array<Opcode, 256> & opcodes, PeekFunction peek, PositionFunction position = {});
+    ~TraceLogger();
+
+    TraceLogger(const TraceLogger &) = delete;
+    TraceLogger & operator=(const TraceLogger &) = delete;
+
+    /**
+     * Write a line of an instruction which is about to be executed.
+     * @param state CPU state before the instruction.
+     * */
+    void log(const CPUState & state) {
+
+        if(m_used + MAX_LINE_LENGTH > BUFFER_SIZE)
+            flush();
+
+        m_used += formatLine(m_buffer.get() + m_used, state);
+        m_lines++;
+    }
+
+    /**
+     * Format a single line (including the line feed).
+     * @param out Output, at least MAX_LINE_LENGTH bytes.
+     * @param state CPU state before the instruction.
+     * @return Count of characters written.
+     * */
+    size_t formatLine(char * out, const CPUState & state) const;
+
+    /**
+     * Write the buffered lines to the file.
+     * @throw std::runtime_error If the write fails.
+     * */
+    void flush();
+
+    /// Get count of logged lines.
+    [[nodiscard]] uint64_t getLineCount() const;
+
+    /**
+     * Check whether an opcode is an official (documented) 6502 instruction.
+     * @param opcode Opcode.
+     * @return False for the unofficial opcodes, which are marked in the trace.
+     * */
+    static bool isOfficial(uint8_t opcode);
+};
+
+#endif //USE_TRACELOGGER_H
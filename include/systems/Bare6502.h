@@ -8,32 +8,123 @@
 #ifndef USE_BARE6502_H
 #define USE_BARE6502_H
 
+#include <optional>
 #include "System.h"
 #include "components/6502.h"
 #include "components/Memory.h"
 #include "components/Bus.h"
 
 /**
- * Bare 6502 system. Unfinished.
+ * Bare 6502 system: the CPU with 64 KiB of RAM and no interrupt sources.
+ *
+ * Used to run plain 6502 binaries (e.g. Klaus Dormann's functional test) and as a CPU throughput benchmark.
+ * By default the CPU is connected straight to the memory, optionally through a bus to see its statistics.
+ *
+ * An instruction jumping to itself (JMP *, BNE * etc.) is detected as a trap: without interrupts the CPU
+ * can't leave it, so the system stops there the same way as on a breakpoint (see trapped()).
  * */
 class Bare6502 : public System{
 protected:
-    MOS6502 m_cpu;
-    Memory m_RAM{0x800, {0x0000, 0x1FFF}, 0xFF};
-    Bus m_bus{2, 8, 16};
+    // ===========================================
+    // Constants
+    // ===========================================
+    /// Same CPU clock as in NES.
+    static constexpr unsigned int CPU_CLOCK_HZ = 1789773;
+    /// CPU cycles of a frame, there is no video so it is just a time unit of doFrames.
+    static constexpr unsigned int FRAME_CLOCKS = CPU_CLOCK_HZ / 60;
+
+    // ===========================================
+    // System components
+    // ===========================================
+    MOS6502<> m_cpu;
+    Memory m_RAM{0x10000, {0x0000, 0xFFFF}, 0x00};
+    Bus m_bus{1, 16, 8};
+
+    SignalPort m_cpuClock;
+
+    // ===========================================
+    // Emulation helper data
+    // ===========================================
+    /// Program loaded to the memory on init.
+    std::vector<uint8_t> m_program;
+    /// Memory offset of the program.
+    uint32_t m_programOffset = 0;
+    /// Initial PC, the reset vector is used if empty.
+    std::optional<uint16_t> m_startAddress;
+    /// CPU connected directly to the memory.
+    bool m_flatMemory = true;
+
+    unsigned long long m_clockCount = 0;
+    /// Address of the last started instruction, empty before the first one.
+    std::optional<uint16_t> m_instructionAddress;
+    bool m_trapped = false;
+
+    // ===========================================
+    // Emulation helper functions
+    // ===========================================
+    /// Clock the CPU once unless it is trapped.
+    void clock();
 
 public:
     Bare6502();
     ~Bare6502() override = default;
 
+    /**
+     * Fill the memory with zeros, load the program and reset the CPU.
+     * */
     void init() override;
 
+    /**
+     * Load a binary to the memory and reset the system.
+     * @param path Binary file path.
+     * @param from Memory offset to load the binary to.
+     * @throw std::runtime_error If the file can't be opened.
+     * @throw std::invalid_argument If the binary doesn't fit the memory.
+     * */
+    void loadBinary(const std::string & path, uint32_t from = 0x0000);
+
+    /**
+     * Set the initial program counter, used by the next init.
+     * @param address Start address, empty to start at the reset vector.
+     * */
+    void setStartAddress(std::optional<uint16_t> address);
+
+    /**
+     * Connect the CPU directly to the memory, or through the bus.
+     * @param enabled True to bypass the bus.
+     * */
+    void setFlatMemory(bool enabled);
+
+    [[nodiscard]] bool isFlatMemory() const;
+
+    /**
+     * Select the CPU clock instantiation (see DebugHooks.h).
+     * @param enabled True to clock the CPU with DebugHooks (default).
+     * */
+    void setDebugHooksEnabled(bool enabled);
+
+    /**
+     * Check whether the CPU is stuck on an instruction jumping to itself.
+     * @return True until the next init.
+     * */
+    [[nodiscard]] bool trapped() const;
+
+    /**
+     * Get the address of the trap.
+     * @return Address of the instruction jumping to itself, valid if trapped() is true.
+     * */
+    [[nodiscard]] uint16_t getTrapAddress() const;
+
+    /// Get the count of emulated CPU cycles since init.
+    [[nodiscard]] unsigned long long getClockCount() const;
+
     void doClocks(unsigned int count) override;
     void doSteps(unsigned int count) override;
     void doFrames(unsigned int count) override;
     void doRun(unsigned int updateFrequency) override;
 
-//    std::vector<EmulatorWindow> getGUIs() override;
+    [[nodiscard]] bool breakpointHit() const override;
+    std::vector<EmulatorWindow> getGUIs() override;
 };
 
 #endif //USE_BARE6502_H
@@ -9,8 +9,11 @@
 #define USE_NES_H
 
 #include "System.h"
+#include "GuiFrameSink.h"
+#include "SharedMemoryExport.h"
 #include "components/2A03.h"
 #include "components/APU.h"
+#include "components/APUSynthesizer.h"
 #include "components/2C02.h"
 #include "components/Bus.h"
 #include "components/Memory.h"
@@ -27,39 +30,161 @@ protected:
     // ===========================================
     const unsigned int MASTER_CLOCK_HZ = 21477272;
     const unsigned int PPU_CLOCK_HZ = MASTER_CLOCK_HZ / 4;
+    const unsigned int APU_CLOCK_HZ = MASTER_CLOCK_HZ / 24;
+    /// Minimal emulated time between two APUSynthesizer sync calls (in APU cycles).
+    static constexpr uint64_t APU_SYNC_INTERVAL = 1024;
+    /// Shared memory region name used when the export is enabled from GUI.
+    static constexpr const char * DEFAULT_EXPORT_NAME = "/use-nes";
 
     // ===========================================
     // System components
     // ===========================================
-    RP2A03 m_cpu;
+    RP2A03<> m_cpu;
     APU m_apu;
-    R2C02 m_ppu;
+    R2C02<> m_ppu;
     Memory m_RAM{0x800, {.from = 0x0000, .to = 0x1FFF}, 0xFF};
     Gamepak m_cart;
     Bus m_cpuBus{5, 16, 8};
     Bus m_ppuBus{1, 14, 8};
     NESPeripherals m_peripherals;
-    std::shared_ptr<Connector> m_apuPeripheralConnector;
+    /// APU and peripherals merged into a single slot of the CPU bus.
+    Bus m_apuPeripheralBus{2, 16, 8, Bus::ARBITRATION::MERGE};
+    /// APU registers, updating the batched APU before every access.
+    std::shared_ptr<Connector> m_apuConnector;
 
-    SignalPort m_cpuClock, m_ppuClock, m_apuClock;
+    SignalPort m_cpuClock, m_ppuClock;
+
+    /// Screen window contents.
+    GuiFrameSink m_screen;
 
     // ===========================================
     // Emulation helper data
     // ===========================================
     unsigned long long m_clockCount = 0;
+    /// Count of frames to skip after every rendered frame.
+    unsigned int m_frameSkip = 0;
+    /// Count of frames already skipped since the last rendered frame.
+    unsigned int m_skippedFrames = 0;
+    /// APU cycles elapsed but not yet emulated.
+    uint32_t m_apuPendingCycles = 0;
+    /// APU cycles which can be batched before the next APU event (e.g. frame IRQ).
+    uint32_t m_apuBatchLimit = 1;
+    /// Total count of emulated APU cycles, used as a timestamp of APU register writes.
+    uint64_t m_apuCycles = 0;
+    /// APU cycle of the last synthesizer sync.
+    uint64_t m_apuLastSync = 0;
+    /// Sound synthesis on a separate thread, empty if the sound is synthesized by m_apu.
+    std::unique_ptr<APUSynthesizer> m_synthesizer;
+    /// State export for external tools, empty if disabled.
+    std::unique_ptr<SharedMemoryExport> m_export;
+    /// Contiguous copies of the RAM and PRG RAM pages for the export, reused every frame.
+    std::vector<uint8_t> m_exportRAM, m_exportPRGRAM;
+    /// Reason of the last failed export attempt (shown in GUI).
+    std::string m_exportError;
 
     // ===========================================
     // Emulation helper functions
     // ===========================================
     void clock();
+
+    /**
+     * Emulate all pending APU cycles at once.
+     * The APU is advanced lazily: only before its registers are accessed, before its next event
+     * and at the end of the doClocks call (so the audio output is up-to-date).
+     * */
+    void flushAPU();
+
+    /**
+     * Enable or disable the APU sound synthesis on a separate thread.
+     * @param enabled True to synthesize on a separate thread.
+     * */
+    void setAudioThread(bool enabled);
+
+    /**
+     * Publish the frame and the RAMs to the state export.
+     * @param frame Finished frame.
+     * */
+    void publishState(const VideoFrame & frame);
 public:
     NES();
     ~NES() override = default;
 
+    void init() override;
+
+    /**
+     * Insert a cartridge and reset the system.
+     * @param path iNES/NES 2.0 file path.
+     * @throw std::runtime_error If the file can't be opened.
+     * @throw std::invalid_argument If the file is malformed.
+     * */
+    void loadCartridge(const std::string & path);
+
     void doClocks(unsigned int count) override;
     void doSteps(unsigned int count) override;
     void doFrames(unsigned int count) override;
     void doRun(unsigned int updateFrequency) override;
+    void setFrameSkip(unsigned int count) override;
+    /**
+     * Fork the system (see System::fork). The fork synthesizes the sound by its own APU, without the audio
+     * thread, state export and debugging outputs. The debug hooks setting is kept.
+     * */
+    [[nodiscard]] std::unique_ptr<System> fork(bool copyOnWrite = true) const override;
+    /**
+     * Hash the emulation state (see System::computeStateHash), including the master clock count.
+     * With the audio thread, the APU channels run in the synthesizer, so the hash differs from a run without it.
+     * */
+    [[nodiscard]] uint64_t computeStateHash() override;
+
+    /**
+     * Enable or disable the state export to shared memory (see SharedMemoryExport).
+     * The audio block is filled only when the sample sources are consumed by an audio sink.
+     * @param name Region name (e.g. "/use-nes"), empty to disable the export.
+     * @throw std::invalid_argument If the name is invalid.
+     * @throw std::runtime_error If the region can't be created.
+     * */
+    void setSharedMemoryExport(const std::string & name);
+
+    /**
+     * Select the clock instantiations of the CPU and PPU (see DebugHooks.h).
+     * Without the debug hooks, the trace, guest profiler, breakpoints, CDL access kinds and PPU layer toggles
+     * are compiled out of the emulation loop.
+     * @param enabled True to clock the cores with DebugHooks (default).
+     * */
+    void setDebugHooksEnabled(bool enabled);
+
+    /**
+     * Enable or disable the CPU guest code profiler (see GuestProfiler).
+     * @param enabled True to profile the executed code.
+     * */
+    void setGuestProfilerEnabled(bool enabled);
+
+    /**
+     * Get the CPU guest code profiler.
+     * @return Pointer to the profiler, nullptr if disabled.
+     * */
+    GuestProfiler * getGuestProfiler();
+
+    /**
+     * Start writing the CPU instruction trace in the nestest.log format (see TraceLogger).
+     * @param path Output file path.
+     * @throw std::runtime_error If the file can't be opened.
+     * */
+    void startCPUTrace(const std::string & path);
+
+    /// Finish the CPU instruction trace.
+    void stopCPUTrace();
+
+    /**
+     * Enable or disable the Code/Data Logger of the cartridge (see CodeDataLogger).
+     * @param enabled True to log the ROM usage.
+     * */
+    void setCodeDataLoggerEnabled(bool enabled);
+
+    /// Get the Code/Data Logger of the cartridge.
+    const CodeDataLogger & getCodeDataLogger();
+
+    [[nodiscard]] bool breakpointHit() const override;
+    std::vector<EmulatorWindow> getGUIs() override;
 };
 
 #endif //USE_NES_H
@@ -0,0 +1,147 @@
+/**
+ * @file StaticNES.h
+ * @author Ondrej Golasowski (golasowski.o@gmail.com)
+ * @brief NES wired at compile time.
+ * @copyright Copyright (c) 2023 Ondrej Golasowski
+ */
+
+#ifndef USE_STATICNES_H
+#define USE_STATICNES_H
+
+#include "System.h"
+#include "components/2A03.h"
+#include "components/APU.h"
+#include "components/2C02.h"
+#include "components/Memory.h"
+#include "components/Gamepak/Gamepak.h"
+#include "components/NESPeripherals.h"
+
+class StaticNES;
+
+/**
+ * CPU bus policy of StaticNES: the NES memory map resolved by address ranges.
+ * The accesses are defined in StaticNES.cpp together with the CPU instantiation, so they are inlined.
+ * */
+struct StaticNESCPUBus {
+    StaticNES * nes = nullptr;
+
+    uint8_t read(uint16_t address);
+    void write(uint16_t address, uint8_t data);
+};
+
+/**
+ * PPU bus policy of StaticNES: the cartridge is the only device on the PPU bus.
+ * */
+struct StaticNESPPUBus {
+    Gamepak * cart = nullptr;
+
+    uint8_t read(uint16_t address) {
+        uint8_t data;
+        return cart->ppuRead(address, data) ? data : 0;
+    }
+
+    void write(uint16_t address, uint8_t data) {
+        cart->ppuWrite(address, data);
+    }
+};
+
+/**
+ * Nintendo Entertainment System emulation (NTSC version) with the buses wired at compile time.
+ *
+ * The components are the same as in NES, but the CPU and PPU are instantiated with the bus policies above
+ * and clocked directly, so there are no Bus slots, Connector calls or std::function indirections
+ * in the emulation loop. Only the mapper stays a virtual call (it is selected by the ROM)
+ * and the interrupt lines stay connectors (a few calls per frame).
+ *
+ * The emulation is the same as in NES cycle by cycle (frames and audio are bit-identical),
+ * but there are no debugging features: the cores always run the NoHooks instantiations.
+ * */
+class StaticNES : public System {
+
+    friend struct StaticNESCPUBus;
+
+protected:
+    // ===========================================
+    // Constants
+    // ===========================================
+    static constexpr unsigned int MASTER_CLOCK_HZ = 21477272;
+    static constexpr unsigned int PPU_CLOCK_HZ = MASTER_CLOCK_HZ / 4;
+
+    /// The CPU clock is protected in MOS6502, the system clocks the CPU directly.
+    class CPU : public RP2A03<StaticNESCPUBus> {
+    public:
+        using RP2A03<StaticNESCPUBus>::RP2A03;
+        using MOS6502<StaticNESCPUBus>::CLK;
+    };
+
+    // ===========================================
+    // System components
+    // ===========================================
+    // The cores access their buses on construction (e.g. the CPU reads the reset vector),
+    // so they are declared after the devices on the buses.
+    APU m_apu;
+    Memory m_RAM{0x800, {.from = 0x0000, .to = 0x1FFF}, 0xFF};
+    Gamepak m_cart;
+    NESPeripherals m_peripherals;
+    R2C02<StaticNESPPUBus> m_ppu{StaticNESPPUBus{&m_cart}};
+    CPU m_cpu{StaticNESCPUBus{this}};
+
+    // ===========================================
+    // Emulation helper data
+    // ===========================================
+    unsigned long long m_clockCount = 0;
+    /// Count of frames to skip after every rendered frame.
+    unsigned int m_frameSkip = 0;
+    /// Count of frames already skipped since the last rendered frame.
+    unsigned int m_skippedFrames = 0;
+    /// APU cycles elapsed but not yet emulated.
+    uint32_t m_apuPendingCycles = 0;
+    /// APU cycles which can be batched before the next APU event (e.g. frame IRQ).
+    uint32_t m_apuBatchLimit = 1;
+
+    // ===========================================
+    // Emulation helper functions
+    // ===========================================
+    void clock();
+
+    /// Emulate all pending APU cycles at once, same as NES::flushAPU.
+    void flushAPU();
+
+    /**
+     * CPU bus read, same device priority as the NES bus slots.
+     * @param address CPU address.
+     * @return Read data, 0 if no device responded.
+     * */
+    uint8_t cpuRead(uint16_t address);
+
+    /**
+     * CPU bus write.
+     * @param address CPU address.
+     * @param data Data to write.
+     * */
+    void cpuWrite(uint16_t address, uint8_t data);
+
+public:
+    StaticNES();
+    ~StaticNES() override = default;
+
+    void init() override;
+
+    /**
+     * Insert a cartridge and reset the system.
+     * @param path iNES/NES 2.0 file path.
+     * @throw std::runtime_error If the file can't be opened.
+     * @throw std::invalid_argument If the file is malformed.
+     * */
+    void loadCartridge(const std::string & path);
+
+    void doClocks(unsigned int count) override;
+    void doSteps(unsigned int count) override;
+    void doFrames(unsigned int count) override;
+    void doRun(unsigned int updateFrequency) override;
+    void setFrameSkip(unsigned int count) override;
+    [[nodiscard]] std::unique_ptr<System> fork(bool copyOnWrite = true) const override;
+    [[nodiscard]] uint64_t computeStateHash() override;
+};
+
+#endif //USE_STATICNES_H
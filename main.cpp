@@ -2,10 +2,28 @@
 // Created by golas on 21.2.23.
 //
 
+#include <iostream>
+#include <cstring>
 #include "Emulator.h"
+#include "Headless.h"
 
-int main(int, char**) {
+int main(int argc, char** argv) {
+
+    if(argc > 1 && std::strcmp(argv[1], "--headless") == 0) {
+
+        try {
+            Headless headless(Headless::parseArguments(argc, argv));
+            return headless.run(std::cout);
+        } catch(std::invalid_argument & e) {
+            std::cerr << e.what() << std::endl;
+            Headless::printUsage(std::cerr);
+            return 1;
+        } catch(std::exception & e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
 
     Emulator emu;
     return emu.run();
-}
\ No newline at end of file
+}
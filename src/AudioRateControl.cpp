@@ -0,0 +1,33 @@
+#include <algorithm>
+#include "AudioRateControl.h"
+
+AudioRateControl::AudioRateControl(size_t targetFrames, double maxDeviation)
+    : m_targetFrames(targetFrames), m_maxDeviation(maxDeviation) {}
+
+void AudioRateControl::read(size_t bufferedFrames, size_t requestedFrames) {
+
+    if(bufferedFrames < requestedFrames)
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioRateControl::overrun() {
+    m_overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+double AudioRateControl::getRateRatio(size_t bufferedFrames) const {
+
+    double error = (static_cast<double>(m_targetFrames) - static_cast<double>(bufferedFrames)) / m_targetFrames;
+    return 1.0 + m_maxDeviation * std::clamp(error, -1.0, 1.0);
+}
+
+size_t AudioRateControl::getTargetFrames() const {
+    return m_targetFrames;
+}
+
+uint64_t AudioRateControl::getUnderruns() const {
+    return m_underruns.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioRateControl::getOverruns() const {
+    return m_overruns.load(std::memory_order_relaxed);
+}
@@ -4,9 +4,13 @@
 
 #include <memory>
 #include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
 #include "immapp/immapp.h"
 #include "imgui.h"
 #include "Emulator.h"
+#include "Profiler.h"
 #include "systems/Bare6502.h"
 #include "systems/NES.h"
 #include "Types.h"
@@ -34,6 +38,33 @@ std::string Emulator::getKeybindingsSaveFileName() const {
     }
 }
 
+unsigned int Emulator::fastForwardFactor(FASTFORWARD mode) {
+
+    switch(mode) {
+        case FASTFORWARD::OFF:      return 1;
+        case FASTFORWARD::X2:       return 2;
+        case FASTFORWARD::X4:       return 4;
+        case FASTFORWARD::X8:       return 8;
+        case FASTFORWARD::UNCAPPED: return 0;
+        default:                    return 1;
+    }
+}
+
+void Emulator::setFastForward(FASTFORWARD mode) {
+
+    m_fastForward = mode;
+
+    if(m_pacer && fastForwardFactor(mode))
+        m_pacer->setSpeed(fastForwardFactor(mode));
+
+    // Frames are skipped only while running, so the single frame stepping always shows the result.
+    if(m_system && m_runState == STATE::RUNNING) {
+        unsigned int factor = fastForwardFactor(mode);
+        // Render only every Nth frame, as the GUI can't show more frames anyway.
+        m_system->setFrameSkip(factor ? factor - 1 : UNCAPPED_FRAME_SKIP);
+    }
+}
+
 void Emulator::loadSystem(std::unique_ptr<System> system) {
 
     m_runState = STATE::STOPPED;
@@ -59,8 +90,22 @@ void Emulator::loadSystem(std::unique_ptr<System> system) {
     // Try to load existing inputs.
     m_inputs.loadBindings(getKeybindingsSaveFileName());
 
-    // Configure sound.
-    m_sound = std::make_unique<Sound>(m_system->soundOutputCount());
+    // Configure sound, keep running without sound if there is no sound device.
+    try {
+        m_sound = std::make_unique<Sound>(m_system->soundOutputCount());
+    } catch(std::runtime_error & e) {
+        m_sound = std::make_unique<NullAudioSink>();
+    }
+
+    // Configure pacing.
+    m_pacer = std::make_unique<FramePacer>(m_system->getClockRate());
+    // Audio can be the master clock only if it is played in real-time.
+    if(m_sound->getTargetBufferedFrames() == 0)
+        m_syncToAudio = false;
+    else
+        m_pacer->setAudioMaster(Sound::getSampleRate(), m_sound->getTargetBufferedFrames());
+    m_pacer->setMode(m_syncToAudio ? FramePacer::MODE::AUDIO : FramePacer::MODE::WALLCLOCK);
+    m_sampleTimer = 0;
 
     // Add debugging windows from the new System.
     for(auto & windowConfig : m_system->getGUIs()) {
@@ -80,29 +125,85 @@ void Emulator::loadSystem(std::unique_ptr<System> system) {
         // Reset the layout, so the windows are properly docked.
         params->dockingParams.layoutReset = true;
     }
+
+#ifdef USE_PROFILING
+    EmulatorWindow performance = Profiler::instance().getGUI();
+    HelloImGui::DockableWindow performanceWindow;
+    performanceWindow.label = "[" + performance.category + "] " + performance.title;
+    performanceWindow.dockSpaceName = dockSpaceToString(performance.dock);
+    performanceWindow.GuiFunction = performance.guiFunction;
+    params->dockingParams.dockableWindows.push_back(performanceWindow);
+    Profiler::instance().reset();
+#endif
+}
+
+void Emulator::stopSystem() {
+
+    setIdling(true);
+    m_sampleTimer = 0;
+    m_sound->stop();
+    m_runState = STATE::STOPPED;
+    m_system->setFrameSkip(0);
 }
 
 void Emulator::runSystem() {
 
+    USE_PROFILE_SCOPE("Emulator run");
+
     // Update user input states.
     m_inputs.update();
 
     if(m_runState == STATE::RUNNING && m_system) {
 
-        unsigned long remainingClocks = m_system->getClockRate() / ImGui::GetIO().Framerate;
-        unsigned long clocksPerFrame = m_system->getClockRate() / Sound::getSampleRate();
+        unsigned int factor = fastForwardFactor(m_fastForward);
+
+        // Uncapped: emulate as much as possible in the GUI frame time, without sound.
+        if(factor == 0) {
+
+            auto budget = std::chrono::duration<float>(UNCAPPED_TIME_BUDGET / ImGui::GetIO().Framerate);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+
+            while(std::chrono::steady_clock::now() < deadline) {
+                m_system->doClocks(UNCAPPED_CLOCK_CHUNK);
+                if(m_system->breakpointHit()) {
+                    stopSystem();
+                    return;
+                }
+            }
+
+            // Don't catch up the uncapped run when returning to the paced mode.
+            m_pacer->start();
+            return;
+        }
+
+        uint64_t remainingClocks = (m_pacer->getMode() == FramePacer::MODE::AUDIO)
+                ? m_pacer->clocksDueAudio(m_sound->getBufferedFrames())
+                : m_pacer->clocksDue();
+
+        // Keep the sound output rate at real-time speed by decimating the samples when fast-forwarding.
+        // The sample rate is adjusted by the dynamic rate control to keep the sound buffer fill level steady.
+        const uint64_t sampleStep = std::llround(Sound::getSampleRate() * SAMPLE_TIMER_SCALE * m_sound->getRateRatio());
+        const uint64_t samplePeriod = m_system->getClockRate() * factor * SAMPLE_TIMER_SCALE;
 
         while(remainingClocks) {
 
-            if(m_clockCounter % clocksPerFrame == 0) {
+            // Emulate in chunks up to the next audio sample.
+            uint64_t clocksToSample = (m_sampleTimer >= samplePeriod) ? 0 : (samplePeriod - m_sampleTimer + sampleStep - 1) / sampleStep;
+            uint64_t chunk = std::min(remainingClocks, clocksToSample);
+
+            m_system->doClocks(chunk);
+            if(m_system->breakpointHit()) {
+                stopSystem();
+                return;
+            }
+            remainingClocks -= chunk;
+            m_sampleTimer += chunk * sampleStep;
+
+            if(m_sampleTimer >= samplePeriod) {
+                m_sampleTimer -= samplePeriod;
                 // Flush all frames to all outputs.
                 m_sound->writeFrames(m_system->getSampleSources());
             }
-
-            m_system->doClocks(1);
-            remainingClocks--;
-
-            m_clockCounter++;
         }
 
     }
@@ -123,7 +224,20 @@ void Emulator::guiStatusBar() {
     if(m_system) {
         switch(m_runState) {
             case STATE::RUNNING:
-                ImGui::Text("Running...");
+                if(m_fastForward == FASTFORWARD::OFF)
+                    ImGui::Text("Running...");
+                else
+                    ImGui::Text("Fast-forwarding...");
+
+                if(m_sound) {
+                    AudioSink::Statistics stats = m_sound->getStatistics();
+                    ImGui::SameLine();
+                    ImGui::Text(
+                            "| Audio buffer: %zu/%zu, rate: %.4f, underruns: %llu, overruns: %llu",
+                            stats.bufferedFrames, stats.bufferSize, stats.rateRatio,
+                            (unsigned long long)stats.underruns, (unsigned long long)stats.overruns
+                            );
+                }
                 break;
             case STATE::STOPPED:
                 ImGui::Text("Stopped.");
@@ -149,21 +263,29 @@ void Emulator::guiToolbar() {
                     if (ImGui::MenuItem("Run...")) {
                         setIdling(false);
                         m_sound->start();
+                        m_pacer->start();
                         m_runState = STATE::RUNNING;
+                        setFastForward(m_fastForward);
                     }
                     ImGui::Separator();
                     if (ImGui::MenuItem("Hard reset")) m_system->init();
                     break;
                 case STATE::RUNNING:
-                    if (ImGui::MenuItem("Stop")) {
-                        setIdling(true);
-                        m_clockCounter = 0;
-                        m_sound->stop();
-                        m_runState = STATE::STOPPED;
-                    }
+                    if (ImGui::MenuItem("Stop"))
+                        stopSystem();
                     break;
             }
 
+            ImGui::Separator();
+            if(ImGui::BeginMenu("Fast-forward")) {
+                if(ImGui::MenuItem("Off", nullptr, m_fastForward == FASTFORWARD::OFF)) setFastForward(FASTFORWARD::OFF);
+                if(ImGui::MenuItem("x2", nullptr, m_fastForward == FASTFORWARD::X2)) setFastForward(FASTFORWARD::X2);
+                if(ImGui::MenuItem("x4", nullptr, m_fastForward == FASTFORWARD::X4)) setFastForward(FASTFORWARD::X4);
+                if(ImGui::MenuItem("x8", nullptr, m_fastForward == FASTFORWARD::X8)) setFastForward(FASTFORWARD::X8);
+                if(ImGui::MenuItem("Uncapped", nullptr, m_fastForward == FASTFORWARD::UNCAPPED)) setFastForward(FASTFORWARD::UNCAPPED);
+                ImGui::EndMenu();
+            }
+
         } else {
             ImGui::Text("Please select a system");
         }
@@ -174,6 +296,10 @@ void Emulator::guiToolbar() {
     if(ImGui::BeginMenu("Settings")) {
 
         if(m_system) {
+            if(ImGui::MenuItem("Sync to audio", nullptr, m_syncToAudio, m_sound->getTargetBufferedFrames() > 0)) {
+                m_syncToAudio = !m_syncToAudio;
+                m_pacer->setMode(m_syncToAudio ? FramePacer::MODE::AUDIO : FramePacer::MODE::WALLCLOCK);
+            }
             if(ImGui::MenuItem("Key bindings", nullptr, m_showBindingsWindow)) {
                 m_showBindingsWindow = !m_showBindingsWindow;
 
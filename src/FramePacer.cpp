@@ -0,0 +1,111 @@
+#include <stdexcept>
+#include "FramePacer.h"
+
+FramePacer::FramePacer(uint64_t clockRate) {
+    setClockRate(clockRate);
+    start();
+}
+
+void FramePacer::start() {
+    start(clock_t::now());
+}
+
+void FramePacer::start(clock_t::time_point now) {
+    m_lastUpdate = now;
+    m_clockRemainder = 0;
+    m_audioRemainder = 0;
+}
+
+uint64_t FramePacer::clocksDue() {
+    return clocksDue(clock_t::now());
+}
+
+uint64_t FramePacer::clocksDue(clock_t::time_point now) {
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastUpdate);
+    m_lastUpdate = now;
+
+    if(elapsed.count() <= 0)
+        return 0;
+
+    // Limit the catch-up, so a long stall does not freeze the GUI by emulating a huge amount of clocks.
+    // This also keeps the multiplication below far from overflowing.
+    if(elapsed > m_maxCatchUp) {
+        m_droppedTime += elapsed - m_maxCatchUp;
+        elapsed = m_maxCatchUp;
+    }
+
+    // Exact conversion: whole clocks are returned, the rest stays in the accumulator for the next call.
+    m_clockRemainder += static_cast<uint64_t>(elapsed.count()) * m_clockRate * m_speed;
+    uint64_t clocks = m_clockRemainder / NS_PER_SECOND;
+    m_clockRemainder %= NS_PER_SECOND;
+
+    return clocks;
+}
+
+uint64_t FramePacer::clocksDueAudio(uint64_t bufferedFrames) {
+
+    // Keep the wall-clock timeline running.
+    m_lastUpdate = clock_t::now();
+    m_clockRemainder = 0;
+
+    if(bufferedFrames >= m_targetFrames)
+        return 0;
+
+    uint64_t missingFrames = m_targetFrames - bufferedFrames;
+
+    m_audioRemainder += missingFrames * m_clockRate * m_speed;
+    uint64_t clocks = m_audioRemainder / m_sampleRate;
+    m_audioRemainder %= m_sampleRate;
+
+    return clocks;
+}
+
+void FramePacer::setClockRate(uint64_t clockRate) {
+
+    if(clockRate == 0)
+        throw std::invalid_argument("Clock rate must be positive.");
+
+    m_clockRate = clockRate;
+    m_clockRemainder = 0;
+    m_audioRemainder = 0;
+}
+
+void FramePacer::setSpeed(unsigned int speed) {
+
+    if(speed == 0)
+        throw std::invalid_argument("Speed must be positive.");
+
+    m_speed = speed;
+}
+
+void FramePacer::setMaxCatchUp(std::chrono::nanoseconds maxCatchUp) {
+    m_maxCatchUp = maxCatchUp;
+}
+
+void FramePacer::setAudioMaster(uint64_t sampleRate, uint64_t targetFrames) {
+
+    if(sampleRate == 0)
+        throw std::invalid_argument("Sample rate must be positive.");
+
+    m_sampleRate = sampleRate;
+    m_targetFrames = targetFrames;
+    m_audioRemainder = 0;
+    m_mode = MODE::AUDIO;
+}
+
+void FramePacer::setMode(MODE mode) {
+
+    if(mode == MODE::AUDIO && m_sampleRate == 0)
+        throw std::logic_error("Audio mode is not configured.");
+
+    m_mode = mode;
+}
+
+FramePacer::MODE FramePacer::getMode() const {
+    return m_mode;
+}
+
+std::chrono::nanoseconds FramePacer::getDroppedTime() const {
+    return m_droppedTime;
+}
@@ -0,0 +1,21 @@
+#include "imgui.h"
+#include "GuiFrameSink.h"
+#include "Tools.h"
+
+void GuiFrameSink::onFrame(const VideoFrame & frame) {
+    m_frame = frame;
+}
+
+void GuiFrameSink::render(float scale) const {
+
+    if(!m_frame.pixels) {
+        ImGui::TextDisabled("No signal");
+        return;
+    }
+
+    USETools::renderScalableBitmap(m_frame.pixels, m_frame.width, m_frame.height, scale);
+}
+
+const VideoFrame & GuiFrameSink::getFrame() const {
+    return m_frame;
+}
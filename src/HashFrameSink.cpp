@@ -0,0 +1,52 @@
+#include "HashFrameSink.h"
+
+namespace {
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3;
+}
+
+HashFrameSink::HashFrameSink(bool keepHashes)
+    : m_keepHashes(keepHashes) {}
+
+void HashFrameSink::onFrame(const VideoFrame & frame) {
+
+    m_lastHash = hash(frame);
+    m_frameCount++;
+
+    for(int i = 0; i < 8; i++) {
+        m_combinedHash ^= (m_lastHash >> (8 * i)) & 0xFF;
+        m_combinedHash *= FNV_PRIME;
+    }
+
+    if(m_keepHashes)
+        m_hashes.push_back(m_lastHash);
+}
+
+uint64_t HashFrameSink::hash(const VideoFrame & frame) {
+
+    uint64_t hash = FNV_OFFSET;
+    const RGBPixel * end = frame.pixels + static_cast<size_t>(frame.width) * frame.height;
+    for(const RGBPixel * pixel = frame.pixels; pixel != end; pixel++) {
+        hash = (hash ^ pixel->red) * FNV_PRIME;
+        hash = (hash ^ pixel->green) * FNV_PRIME;
+        hash = (hash ^ pixel->blue) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t HashFrameSink::getLastHash() const {
+    return m_lastHash;
+}
+
+uint64_t HashFrameSink::getCombinedHash() const {
+    return m_combinedHash;
+}
+
+const std::vector<uint64_t> & HashFrameSink::getHashes() const {
+    return m_hashes;
+}
+
+uint64_t HashFrameSink::getFrameCount() const {
+    return m_frameCount;
+}
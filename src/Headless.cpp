@@ -0,0 +1,500 @@
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include "Headless.h"
+#include "Sound.h"
+#include "Profiler.h"
+
+Headless::Headless(Options options) : m_options(std::move(options)) {
+
+    if(!m_options.binaryPath.empty()) {
+        m_bare = std::make_unique<Bare6502>();
+        m_bare->setStartAddress(m_options.startAddress);
+        m_bare->loadBinary(m_options.binaryPath);
+        m_bare->setDebugHooksEnabled(false);
+        return;
+    }
+
+    if(m_options.staticNES) {
+        auto system = std::make_unique<StaticNES>();
+        system->loadCartridge(m_options.romPath);
+        m_system = std::move(system);
+    } else {
+        auto system = std::make_unique<NES>();
+        system->loadCartridge(m_options.romPath);
+        m_nes = system.get();
+        m_system = std::move(system);
+    }
+
+    if(m_options.wavPath.empty())
+        m_sound = std::make_unique<NullAudioSink>();
+    else
+        m_sound = std::make_unique<WavAudioSink>(m_options.wavPath, Sound::getSampleRate(), m_options.wavFormat);
+
+    if(m_nes) {
+        if(!m_options.shmName.empty())
+            m_nes->setSharedMemoryExport(m_options.shmName);
+
+        if(!m_options.guestProfilePath.empty()) {
+            m_nes->setGuestProfilerEnabled(true);
+            for(auto & path : m_options.symbolPaths)
+                m_nes->getGuestProfiler()->loadSymbols(path);
+        }
+
+        if(!m_options.cpuTracePath.empty())
+            m_nes->startCPUTrace(m_options.cpuTracePath);
+
+        if(!m_options.cdlPath.empty())
+            m_nes->setCodeDataLoggerEnabled(true);
+
+        // The cores run without any debug bookkeeping unless a debug output is requested.
+        m_nes->setDebugHooksEnabled(!m_options.guestProfilePath.empty() || !m_options.cpuTracePath.empty()
+                                    || !m_options.cdlPath.empty());
+    }
+
+    m_system->addFrameSink(&m_frameHash);
+    if(!m_options.videoPath.empty()) {
+        m_video = std::make_unique<StreamFrameSink>(m_options.videoPath, m_options.videoFormat,
+                                                    FRAME_RATE_NUMERATOR, FRAME_RATE_DENOMINATOR);
+        m_system->addFrameSink(m_video.get());
+    }
+
+    if(!m_options.stateHashPath.empty()) {
+        m_stateHashes.open(m_options.stateHashPath);
+        if(!m_stateHashes)
+            throw std::runtime_error("State hash file couldn't be opened!");
+        m_system->setStateHashEnabled(true);
+    }
+}
+
+Headless::Options Headless::parseArguments(int argc, char ** argv) {
+
+    Options options;
+
+    for(int i = 1; i < argc; i++) {
+
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if(i + 1 >= argc)
+                throw std::invalid_argument("Missing value of " + arg + ".");
+            return argv[++i];
+        };
+
+        if(arg == "--headless") {
+            continue;
+        } else if(arg == "--rom") {
+            options.romPath = value();
+        } else if(arg == "--seconds") {
+            try {
+                options.seconds = std::stod(value());
+            } catch(std::exception & e) {
+                throw std::invalid_argument("Invalid number of seconds.");
+            }
+            if(options.seconds <= 0)
+                throw std::invalid_argument("Number of seconds must be positive.");
+        } else if(arg == "--frames") {
+            try {
+                options.frames = std::stoull(value());
+            } catch(std::exception & e) {
+                throw std::invalid_argument("Invalid number of frames.");
+            }
+            if(options.frames == 0)
+                throw std::invalid_argument("Number of frames must be positive.");
+        } else if(arg == "--wav") {
+            options.wavPath = value();
+        } else if(arg == "--wav-format") {
+            std::string format = value();
+            if(format == "f32")
+                options.wavFormat = WavAudioSink::FORMAT::FLOAT32;
+            else if(format == "s16")
+                options.wavFormat = WavAudioSink::FORMAT::PCM16;
+            else
+                throw std::invalid_argument("Unknown WAV format: " + format + ".");
+        } else if(arg == "--video") {
+            options.videoPath = value();
+        } else if(arg == "--video-format") {
+            std::string format = value();
+            if(format == "y4m")
+                options.videoFormat = StreamFrameSink::FORMAT::Y4M;
+            else if(format == "rgb")
+                options.videoFormat = StreamFrameSink::FORMAT::RGB24;
+            else
+                throw std::invalid_argument("Unknown video format: " + format + ".");
+        } else if(arg == "--shm") {
+            options.shmName = value();
+        } else if(arg == "--guest-profile") {
+            options.guestProfilePath = value();
+        } else if(arg == "--symbols") {
+            options.symbolPaths.push_back(value());
+        } else if(arg == "--cpu-trace") {
+            options.cpuTracePath = value();
+        } else if(arg == "--cdl") {
+            options.cdlPath = value();
+        } else if(arg == "--6502") {
+            options.binaryPath = value();
+        } else if(arg == "--static") {
+            options.staticNES = true;
+        } else if(arg == "--start" || arg == "--success") {
+            uint16_t address;
+            try {
+                size_t length;
+                std::string text = value();
+                unsigned long parsed = std::stoul(text, &length, 16);
+                if(length != text.size() || parsed > 0xFFFF)
+                    throw std::out_of_range(text);
+                address = static_cast<uint16_t>(parsed);
+            } catch(std::exception & e) {
+                throw std::invalid_argument("Invalid address of " + arg + ".");
+            }
+            (arg == "--start" ? options.startAddress : options.successAddress) = address;
+        } else if(arg == "--fork-bench") {
+            try {
+                options.forkBenchmark = std::stoull(value());
+            } catch(std::exception & e) {
+                throw std::invalid_argument("Invalid number of forks.");
+            }
+            if(options.forkBenchmark == 0)
+                throw std::invalid_argument("Number of forks must be positive.");
+        } else if(arg == "--state-hashes") {
+            options.stateHashPath = value();
+        } else if(arg == "--perf") {
+            options.perfCounters = true;
+        } else if(arg == "--trace") {
+#ifdef USE_PROFILING
+            options.tracePath = value();
+#else
+            throw std::invalid_argument("Tracing requires a build with USE_PROFILING.");
+#endif
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg + ".");
+        }
+    }
+
+    if(!options.binaryPath.empty()) {
+        if(!options.romPath.empty())
+            throw std::invalid_argument("Use either --rom or --6502.");
+        if(options.frames || !options.wavPath.empty() || !options.videoPath.empty() || !options.shmName.empty()
+           || !options.guestProfilePath.empty() || !options.cpuTracePath.empty() || !options.cdlPath.empty()
+           || options.forkBenchmark || !options.stateHashPath.empty())
+            throw std::invalid_argument("Only --seconds, --start and --success can be used with --6502.");
+        if(options.staticNES)
+            throw std::invalid_argument("Use either --static or --6502.");
+        return options;
+    }
+
+    if(options.startAddress || options.successAddress)
+        throw std::invalid_argument("--start and --success are only used with --6502.");
+    if(options.romPath.empty())
+        throw std::invalid_argument("No cartridge specified.");
+    if(!options.symbolPaths.empty() && options.guestProfilePath.empty())
+        throw std::invalid_argument("Symbols are only used with --guest-profile.");
+    if(options.staticNES && (!options.shmName.empty() || !options.guestProfilePath.empty()
+                             || !options.cpuTracePath.empty() || !options.cdlPath.empty()))
+        throw std::invalid_argument("--shm, --guest-profile, --cpu-trace and --cdl can't be used with --static.");
+
+    return options;
+}
+
+void Headless::printUsage(std::ostream & os) {
+
+    os << "Usage: use --headless --rom <file.nes> [options]\n"
+       << "       use --headless --6502 <file.bin> [--start <hex>] [--success <hex>] [--seconds <n>]\n"
+       << "  --seconds <n>          Emulated time to run (default 10).\n"
+       << "  --frames <n>           Count of frames to run (overrides --seconds).\n"
+       << "  --wav <file.wav>       Render the audio to a WAV file.\n"
+       << "  --wav-format f32|s16   WAV sample format (default f32).\n"
+       << "  --video <file>         Record the video to a file.\n"
+       << "  --video-format y4m|rgb Video stream format (default y4m).\n"
+       << "  --shm </name>          Export the state to a shared memory region.\n"
+       << "  --cpu-trace <file>     Write a nestest.log style line per executed instruction.\n"
+       << "  --cdl <file.cdl>       Log the ROM usage, save it in the FCEUX Code/Data Logger format.\n"
+       << "  --trace <file.json>    Save a Chrome trace of the last frames (USE_PROFILING builds).\n"
+       << "  --perf                 Report hardware performance counters per frame (and per\n"
+       << "                         profiler section in USE_PROFILING builds, Linux only).\n"
+       << "  --guest-profile <file> Profile the emulated program, save a folded stacks flame graph.\n"
+       << "  --symbols <file>       Routine names for the guest profile (ca65 .dbg or FCEUX .nl),\n"
+       << "                         can be repeated.\n"
+       << "  --static               Run the NES wired at compile time (same output, no debugging).\n"
+       << "  --fork-bench <n>       Fork the final state n times, run each fork for a frame and report\n"
+       << "                         the cost of copy-on-write and full copy forks.\n"
+       << "  --state-hashes <file>  Write a hash of the emulation state at the end of every frame.\n"
+       << "  --6502 <file.bin>      Run a plain 6502 binary loaded at $0000 until it jumps to itself.\n"
+       << "  --start <hex>          Initial PC of the binary (default: reset vector).\n"
+       << "  --success <hex>        Address of the success trap, other traps fail the run.\n";
+}
+
+int Headless::run(std::ostream & log) {
+
+    if(m_bare)
+        return runBinary(log);
+
+    const uint64_t clockRate = m_system->getClockRate();
+    const uint64_t sampleRate = Sound::getSampleRate();
+    uint64_t remainingClocks = static_cast<uint64_t>(m_options.seconds * static_cast<double>(clockRate));
+    uint64_t totalClocks = 0;
+
+    // Same fractional sample timing as in the Emulator, see Emulator::m_sampleTimer.
+    uint64_t sampleTimer = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // Hardware counters are read on every frame boundary.
+    std::unique_ptr<PerfCounters> counters;
+    std::vector<PerfCounters::Values> frameEvents;
+    PerfCounters::Values frameStartEvents{};
+    uint64_t countedFrame = 0;
+    if(m_options.perfCounters) {
+        counters = std::make_unique<PerfCounters>();
+        if(counters->fastReadAvailable())
+            Profiler::instance().setPerfCounters(counters.get());
+        frameStartEvents = counters->read();
+        countedFrame = m_system->getFrameCount();
+    }
+
+    // The chunks are shorter than a frame, so every finished frame is seen.
+    uint64_t hashedFrame = m_system->getFrameCount();
+
+    Profiler::instance().reset();
+    m_sound->start();
+    while(m_options.frames ? m_system->getFrameCount() < m_options.frames : remainingClocks > 0) {
+
+        uint64_t clocksToSample = (clockRate - sampleTimer + sampleRate - 1) / sampleRate;
+        uint64_t chunk = m_options.frames ? clocksToSample : std::min(remainingClocks, clocksToSample);
+
+        m_system->doClocks(chunk);
+        remainingClocks -= std::min(remainingClocks, chunk);
+        totalClocks += chunk;
+        sampleTimer += chunk * sampleRate;
+
+        if(sampleTimer >= clockRate) {
+            sampleTimer -= clockRate;
+            m_sound->writeFrames(m_system->getSampleSources());
+        }
+
+        if(counters && m_system->getFrameCount() != countedFrame) {
+            PerfCounters::Values events = counters->read();
+            PerfCounters::Values & frame = frameEvents.emplace_back();
+            for(size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+                frame[i] = events[i] - frameStartEvents[i];
+            frameStartEvents = events;
+            countedFrame = m_system->getFrameCount();
+        }
+
+        if(m_stateHashes.is_open() && m_system->getFrameCount() != hashedFrame) {
+            hashedFrame = m_system->getFrameCount();
+            uint64_t hash = m_system->getFrameStateHash();
+            m_stateHashes << std::dec << hashedFrame << ' ' << std::hex << std::setw(16) << std::setfill('0') << hash << '\n';
+            m_stateHash.add(hash);
+        }
+    }
+    m_sound->stop();
+    Profiler::instance().setPerfCounters(nullptr);
+
+    // Finalize the outputs.
+    if(auto * wav = dynamic_cast<WavAudioSink *>(m_sound.get()))
+        wav->close();
+    m_sound.reset();
+    if(m_nes)
+        m_nes->stopCPUTrace();
+    if(m_video) {
+        m_system->removeFrameSink(m_video.get());
+        m_video->close();
+    }
+    if(m_stateHashes.is_open()) {
+        m_stateHashes.close();
+        if(!m_stateHashes)
+            throw std::runtime_error("State hash file couldn't be written!");
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double emulated = static_cast<double>(totalClocks) / static_cast<double>(clockRate);
+    log << "Emulated " << emulated << " s in " << elapsed.count() << " s ("
+        << emulated / elapsed.count() << "x real-time)." << std::endl;
+    log << "Frames: " << m_system->getFrameCount() << ", frame hash: "
+        << std::hex << m_frameHash.getCombinedHash() << std::dec << "." << std::endl;
+    if(!m_options.stateHashPath.empty())
+        log << "State hash: " << std::hex << m_stateHash.digest() << std::dec << "." << std::endl;
+    if(!m_options.tracePath.empty()) {
+        std::ofstream trace(m_options.tracePath);
+        if(!trace)
+            throw std::runtime_error("Trace file couldn't be opened!");
+        Profiler::instance().writeChromeTrace(trace);
+    }
+    if(m_video)
+        log << "Video frames written: " << m_video->getWrittenFrames()
+            << ", dropped: " << m_video->getDroppedFrames() << "." << std::endl;
+    if(counters)
+        reportPerfCounters(log, *counters, frameEvents);
+    if(GuestProfiler * profiler = m_nes ? m_nes->getGuestProfiler() : nullptr) {
+        std::ofstream flameGraph(m_options.guestProfilePath);
+        if(!flameGraph)
+            throw std::runtime_error("Guest profile file couldn't be opened!");
+        profiler->writeFlameGraph(flameGraph);
+        reportGuestProfile(log, *profiler);
+    }
+    if(!m_options.cdlPath.empty()) {
+        const CodeDataLogger & logger = m_nes->getCodeDataLogger();
+        logger.save(m_options.cdlPath);
+        CodeDataLogger::Summary summary = logger.getSummary();
+        log << "CDL: PRG " << summary.code << " code, " << summary.data << " data, " << summary.unusedPRG
+            << " unused bytes; CHR " << summary.rendered << " rendered, " << summary.read << " read, "
+            << summary.unusedCHR << " unused bytes." << std::endl;
+    }
+    if(m_options.forkBenchmark)
+        benchmarkForks(log);
+
+    return 0;
+}
+
+void Headless::benchmarkForks(std::ostream & log) {
+
+    using Clock = std::chrono::steady_clock;
+    const double count = static_cast<double>(m_options.forkBenchmark);
+
+    log << "Fork benchmark (" << m_options.forkBenchmark << " forks, each run for 1 frame):" << std::endl;
+    for(bool copyOnWrite : {true, false}) {
+
+        std::chrono::duration<double, std::micro> forking{0}, total{0};
+        for(uint64_t i = 0; i < m_options.forkBenchmark; i++) {
+
+            auto start = Clock::now();
+            std::unique_ptr<System> fork = m_system->fork(copyOnWrite);
+            forking += Clock::now() - start;
+
+            fork->doFrames(1);
+            fork.reset();
+            total += Clock::now() - start;
+        }
+
+        log << "  " << std::left << std::setw(14) << (copyOnWrite ? "copy-on-write" : "full copy") << std::right
+            << std::fixed << std::setprecision(1) << " fork " << forking.count() / count << " us, fork + frame "
+            << total.count() / count << " us." << std::defaultfloat << std::endl;
+    }
+}
+
+void Headless::reportPerfCounters(std::ostream & log, const PerfCounters & counters,
+                                  const std::vector<PerfCounters::Values> & frameEvents) {
+
+    using EVENT = PerfCounters::EVENT;
+    auto at = [](const PerfCounters::Values & values, EVENT event) {
+        return static_cast<double>(values[static_cast<size_t>(event)]);
+    };
+
+    // Print events per frame, IPC and misses per 1000 instructions.
+    auto printEvents = [&](const std::string & label, const PerfCounters::Values & total, double frames) {
+
+        log << "  " << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(0);
+        for(size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+            if(counters.available(static_cast<EVENT>(i)))
+                log << " " << PerfCounters::name(static_cast<EVENT>(i)) << " " << total[i] / frames;
+
+        double instructions = at(total, EVENT::INSTRUCTIONS);
+        log << std::setprecision(2);
+        if(instructions > 0) {
+            if(counters.available(EVENT::CYCLES) && at(total, EVENT::CYCLES) > 0)
+                log << " | IPC " << instructions / at(total, EVENT::CYCLES);
+            for(EVENT miss : {EVENT::BRANCH_MISSES, EVENT::L1D_MISSES, EVENT::LLC_MISSES})
+                if(counters.available(miss))
+                    log << " | " << PerfCounters::name(miss) << "/1k instr " << 1000.0 * at(total, miss) / instructions;
+        }
+        log << std::defaultfloat << std::setprecision(6) << std::endl;
+    };
+
+    log << "Hardware counters: " << counters.getStatus() << std::endl;
+    if(!counters.anyAvailable() || frameEvents.empty())
+        return;
+
+    PerfCounters::Values total{};
+    double minIPC = 0, maxIPC = 0;
+    for(size_t frame = 0; frame < frameEvents.size(); frame++) {
+
+        for(size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+            total[i] += frameEvents[frame][i];
+
+        double cycles = at(frameEvents[frame], EVENT::CYCLES);
+        double ipc = cycles > 0 ? at(frameEvents[frame], EVENT::INSTRUCTIONS) / cycles : 0;
+        minIPC = frame ? std::min(minIPC, ipc) : ipc;
+        maxIPC = frame ? std::max(maxIPC, ipc) : ipc;
+    }
+
+    auto frames = static_cast<double>(frameEvents.size());
+    log << "Per frame (" << frameEvents.size() << " frames):" << std::endl;
+    printEvents("Whole frame", total, frames);
+    if(counters.available(EVENT::INSTRUCTIONS) && counters.available(EVENT::CYCLES))
+        log << "  IPC range " << minIPC << " - " << maxIPC << std::endl;
+
+    // Profiler sections, only counted in the profiling builds with rdpmc.
+    Profiler & profiler = Profiler::instance();
+    bool header = false;
+    for(size_t section = 0; section < profiler.getSectionCount(); section++) {
+
+        PerfCounters::Values events = profiler.getSectionEvents(section);
+        if(std::all_of(events.begin(), events.end(), [](uint64_t value){ return value == 0; }))
+            continue;
+
+        if(!header) {
+            log << "Per component region, per frame (inclusive):" << std::endl;
+            header = true;
+        }
+        printEvents(profiler.getSectionName(section), events, frames);
+    }
+}
+
+void Headless::reportGuestProfile(std::ostream & log, const GuestProfiler & profiler) {
+
+    static constexpr size_t SHOWN_ROUTINES = 15;
+
+    log << "Guest routines by inclusive CPU cycles per frame (" << profiler.getFrameCount() << " frames):" << std::endl;
+    log << "  " << std::left << std::setw(24) << "Routine" << std::right << std::setw(10) << "Calls"
+        << std::setw(12) << "Exclusive" << std::setw(12) << "Inclusive" << std::setw(12) << "Max incl." << std::endl;
+
+    std::vector<GuestProfiler::RoutineReport> report = profiler.getReport();
+    log << std::fixed << std::setprecision(0);
+    for(size_t i = 0; i < std::min(report.size(), SHOWN_ROUTINES); i++) {
+        const auto & routine = report[i];
+        log << "  " << std::left << std::setw(24) << routine.name << std::right << std::setw(10) << routine.calls
+            << std::setw(12) << routine.exclusivePerFrame << std::setw(12) << routine.inclusivePerFrame
+            << std::setw(12) << routine.maxInclusive << std::endl;
+    }
+    log << std::defaultfloat << std::setprecision(6);
+}
+
+int Headless::runBinary(std::ostream & log) {
+
+    // Run in 1 ms slices of the emulated time.
+    const uint64_t clockRate = m_bare->getClockRate();
+    const uint64_t slice = clockRate / 1000;
+    const auto totalClocks = static_cast<uint64_t>(m_options.seconds * static_cast<double>(clockRate));
+
+    auto start = std::chrono::steady_clock::now();
+    while(!m_bare->trapped() && m_bare->getClockCount() < totalClocks)
+        m_bare->doClocks(static_cast<unsigned int>(std::min<uint64_t>(slice, totalClocks - m_bare->getClockCount())));
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double cycles = static_cast<double>(m_bare->getClockCount());
+    log << "Emulated " << m_bare->getClockCount() << " CPU cycles in " << elapsed.count() << " s ("
+        << cycles / elapsed.count() / 1e6 << " MHz, " << cycles / static_cast<double>(clockRate) / elapsed.count()
+        << "x real-time)." << std::endl;
+
+    auto hex = [](uint16_t address) {
+        std::ostringstream text;
+        text << '$' << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << address;
+        return text.str();
+    };
+
+    // Without a success address, the run is just a benchmark.
+    if(!m_bare->trapped()) {
+        log << "No trap reached." << std::endl;
+        return m_options.successAddress ? 1 : 0;
+    }
+
+    log << "Trapped at " << hex(m_bare->getTrapAddress()) << "." << std::endl;
+    if(m_options.successAddress && m_bare->getTrapAddress() != *m_options.successAddress) {
+        log << "Failed, the success trap is at " << hex(*m_options.successAddress) << "." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include <cstring>
+#include "MemoryAudioSink.h"
+
+void MemoryAudioSink::writeFrames(const SoundSampleSources & sources) {
+
+    SoundStereoFrame frame = mix(sources);
+    m_samples.push_back(frame.left);
+    m_samples.push_back(frame.right);
+}
+
+const std::vector<float> & MemoryAudioSink::getSamples() const {
+    return m_samples;
+}
+
+size_t MemoryAudioSink::getFrameCount() const {
+    return m_samples.size() / 2;
+}
+
+uint64_t MemoryAudioSink::hash() const {
+
+    uint64_t hash = 0xcbf29ce484222325;
+    for(float sample : m_samples) {
+
+        uint32_t bits;
+        std::memcpy(&bits, &sample, sizeof(bits));
+        for(int i = 0; i < 4; i++) {
+            hash ^= (bits >> (8 * i)) & 0xFF;
+            hash *= 0x100000001b3;
+        }
+    }
+
+    return hash;
+}
+
+void MemoryAudioSink::clear() {
+    m_samples.clear();
+}
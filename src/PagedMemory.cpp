@@ -0,0 +1,81 @@
+#include <algorithm>
+#include "PagedMemory.h"
+
+PagedMemory::PagedMemory(size_t size, uint8_t value) {
+    assign(size, value);
+}
+
+PagedMemory::PagedMemory(const PagedMemory & other)
+    : m_pages(other.m_pages), m_owned(other.m_pages.size(), false), m_size(other.m_size) {
+
+    other.m_owned.assign(other.m_owned.size(), false);
+}
+
+PagedMemory & PagedMemory::operator=(const PagedMemory & other) {
+
+    if(this != &other) {
+        m_pages = other.m_pages;
+        m_owned.assign(m_pages.size(), false);
+        m_size = other.m_size;
+        other.m_owned.assign(other.m_owned.size(), false);
+    }
+
+    return *this;
+}
+
+void PagedMemory::detach(size_t index) {
+
+    m_pages[index] = std::make_shared<Page>(*m_pages[index]);
+    m_owned[index] = true;
+}
+
+void PagedMemory::assign(size_t size, uint8_t value) {
+
+    m_size = size;
+    m_pages.clear();
+    m_pages.resize((size + PAGE_MASK) >> PAGE_BITS);
+    m_owned.assign(m_pages.size(), true);
+
+    for(auto & page : m_pages) {
+        page = std::make_shared<Page>();
+        page->fill(value);
+    }
+}
+
+void PagedMemory::fill(uint8_t value) {
+
+    for(size_t i = 0; i < m_pages.size(); i++) {
+        if(!m_owned[i]) {
+            m_pages[i] = std::make_shared<Page>();
+            m_owned[i] = true;
+        }
+        m_pages[i]->fill(value);
+    }
+}
+
+void PagedMemory::load(size_t offset, std::span<const uint8_t> data) {
+
+    size_t count = offset < m_size ? std::min(data.size(), m_size - offset) : 0;
+    for(size_t i = 0; i < count; i++)
+        write(offset + i, data[i]);
+}
+
+void PagedMemory::copyTo(std::span<uint8_t> destination) const {
+
+    size_t count = std::min(destination.size(), m_size);
+    for(size_t offset = 0; offset < count; offset += PAGE_SIZE) {
+        const Page & page = *m_pages[offset >> PAGE_BITS];
+        std::copy_n(page.begin(), std::min(PAGE_SIZE, count - offset), destination.begin() + offset);
+    }
+}
+
+void PagedMemory::unshare() {
+
+    for(size_t i = 0; i < m_pages.size(); i++)
+        if(!m_owned[i])
+            detach(i);
+}
+
+size_t PagedMemory::sharedPageCount() const {
+    return std::count_if(m_pages.begin(), m_pages.end(), [](const auto & page) { return page.use_count() != 1; });
+}
@@ -0,0 +1,212 @@
+#include <cerrno>
+#include <cstring>
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+    /// perf_event_attr type and config of every EVENT.
+    struct EventConfig {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    constexpr uint64_t cacheConfig(uint64_t cache, uint64_t op, uint64_t result) {
+        return cache | (op << 8) | (result << 16);
+    }
+
+    constexpr std::array<EventConfig, PerfCounters::EVENT_COUNT> EVENT_CONFIGS{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    }};
+
+    /**
+     * Read a counter in user space.
+     * @param page Mapped perf_event_mmap_page.
+     * @param value Counter value.
+     * @return False if the counter is not currently readable by rdpmc.
+     * */
+    bool readUserCounter(const void * page, uint64_t & value) {
+
+#if defined(__x86_64__)
+        auto * pc = static_cast<const volatile perf_event_mmap_page *>(page);
+        uint32_t sequence, index;
+        int64_t count;
+
+        do {
+            sequence = pc->lock;
+            __asm__ __volatile__("" ::: "memory");
+
+            index = pc->index;
+            count = pc->offset;
+            if(!pc->cap_user_rdpmc || !index)
+                return false;
+
+            uint32_t low, high;
+            __asm__ __volatile__("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+            // Sign-extend the counter width.
+            uint16_t width = pc->pmc_width;
+            int64_t pmc = static_cast<int64_t>((static_cast<uint64_t>(high) << 32 | low) << (64 - width)) >> (64 - width);
+            count += pmc;
+
+            __asm__ __volatile__("" ::: "memory");
+        } while(pc->lock != sequence);
+
+        value = static_cast<uint64_t>(count);
+        return true;
+#else
+        return false;
+#endif
+    }
+#endif
+}
+
+PerfCounters::PerfCounters() {
+
+#ifdef __linux__
+    std::string failed;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    m_fastRead = true;
+
+    for(size_t i = 0; i < EVENT_COUNT; i++) {
+
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = EVENT_CONFIGS[i].type;
+        attr.config = EVENT_CONFIGS[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if(fd < 0) {
+            failed += std::string(failed.empty() ? "" : ", ") + name(static_cast<EVENT>(i)) + " (" + std::strerror(errno) + ")";
+            continue;
+        }
+        m_counters[i].fd = fd;
+
+        void * page = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, fd, 0);
+        if(page != MAP_FAILED && static_cast<perf_event_mmap_page *>(page)->cap_user_rdpmc)
+            m_counters[i].page = page;
+        else {
+            if(page != MAP_FAILED)
+                munmap(page, pageSize);
+            m_fastRead = false;
+        }
+    }
+
+    if(!anyAvailable()) {
+        m_fastRead = false;
+        m_status = "No hardware counters available: " + failed + ".";
+    } else if(!failed.empty()) {
+        m_status = "Some counters not available: " + failed + ".";
+    } else {
+        m_status = m_fastRead ? "All counters available (rdpmc enabled)." : "All counters available.";
+    }
+#else
+    m_status = "Hardware counters are only supported on Linux.";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+
+#ifdef __linux__
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for(auto & counter : m_counters) {
+        if(counter.page)
+            munmap(counter.page, pageSize);
+        if(counter.fd >= 0)
+            close(counter.fd);
+    }
+#endif
+}
+
+bool PerfCounters::available(EVENT event) const {
+    return m_counters[static_cast<size_t>(event)].fd >= 0;
+}
+
+bool PerfCounters::anyAvailable() const {
+
+    for(auto & counter : m_counters)
+        if(counter.fd >= 0)
+            return true;
+
+    return false;
+}
+
+bool PerfCounters::fastReadAvailable() const {
+    return m_fastRead;
+}
+
+const std::string & PerfCounters::getStatus() const {
+    return m_status;
+}
+
+PerfCounters::Values PerfCounters::read() const {
+    return readCounters(true);
+}
+
+PerfCounters::Values PerfCounters::readCounters(bool scale) const {
+
+    Values values{};
+
+#ifdef __linux__
+    for(size_t i = 0; i < EVENT_COUNT; i++) {
+
+        if(m_counters[i].fd < 0)
+            continue;
+
+        // Value, time enabled, time running.
+        uint64_t data[3];
+        if(::read(m_counters[i].fd, data, sizeof(data)) != sizeof(data))
+            continue;
+
+        // Scale if the counter was multiplexed with others.
+        values[i] = (scale && data[2] && data[2] < data[1])
+                ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                : data[0];
+    }
+#endif
+
+    return values;
+}
+
+PerfCounters::Values PerfCounters::readFast() const {
+
+    if(!m_fastRead)
+        return readCounters(false);
+
+    Values values{};
+
+#ifdef __linux__
+    for(size_t i = 0; i < EVENT_COUNT; i++) {
+        // The counter is not scheduled on the PMU at the moment, use the syscall.
+        if(m_counters[i].page && !readUserCounter(m_counters[i].page, values[i]))
+            return readCounters(false);
+    }
+#endif
+
+    return values;
+}
+
+const char * PerfCounters::name(EVENT event) {
+
+    switch(event) {
+        case EVENT::INSTRUCTIONS:  return "instructions";
+        case EVENT::CYCLES:        return "cycles";
+        case EVENT::BRANCH_MISSES: return "branch-misses";
+        case EVENT::L1D_MISSES:    return "L1D-misses";
+        case EVENT::LLC_MISSES:    return "LLC-misses";
+    }
+
+    return "unknown";
+}
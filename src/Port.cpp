@@ -21,6 +21,7 @@ void DataPort::connect(std::weak_ptr<Connector> connector) {
     if(!connector.lock()->hasDataInterface())
         throw std::invalid_argument("Provided connector doesn't have a data interface.");
 
+    m_interface = &connector.lock()->getDataInterface();
     m_connector.swap(connector);
 }
 
@@ -30,7 +31,7 @@ uint32_t DataPort::read(uint32_t address) {
         return 0;
     } else {
         uint32_t buffer;
-        if(m_connector.lock()->getDataInterface().read(address, buffer)) {
+        if(m_interface->read(address, buffer)) {
             return buffer;
         } else {
             return 0;
@@ -43,13 +44,13 @@ bool DataPort::readConfirmed(uint32_t address, uint32_t &buffer) {
     if(empty())
         return false;
     else
-        return m_connector.lock()->getDataInterface().read(address, buffer);
+        return m_interface->read(address, buffer);
 }
 
 void DataPort::write(uint32_t address, uint32_t data) {
 
     if(!empty())
-        return m_connector.lock()->getDataInterface().write(address, data);
+        m_interface->write(address, data);
 }
 
 // =============================================================================
@@ -61,16 +62,17 @@ void SignalPort::connect(std::weak_ptr<Connector> connector) {
     if(!connector.lock()->hasSignalInterface())
         throw std::invalid_argument("Provided connector doesn't have a signal interface.");
 
+    m_interface = &connector.lock()->getSignalInterface();
     m_connector.swap(connector);
 }
 
 void SignalPort::send() {
 
     if(!empty())
-        m_connector.lock()->getSignalInterface().send();
+        m_interface->send();
 }
 
 void SignalPort::set(bool active) {
     if(!empty())
-        m_connector.lock()->getSignalInterface().set(active);
+        m_interface->set(active);
 }
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include <stdexcept>
+#include "imgui.h"
+#include "Profiler.h"
+
+Profiler::Profiler() : m_history(HISTORY_FRAMES), m_frameStart(now()) {}
+
+Profiler & Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+size_t Profiler::registerSection(const std::string & name) {
+
+    std::lock_guard lock(m_registerMutex);
+
+    size_t count = m_sectionCount.load();
+    for(size_t i = 0; i < count; i++)
+        if(m_sections[i].name == name)
+            return i;
+
+    if(count >= MAX_SECTIONS)
+        throw std::length_error("Too many profiler sections.");
+
+    m_sections[count].name = name;
+    m_sectionCount.store(count + 1);
+    return count;
+}
+
+void Profiler::frame() {
+
+    uint64_t end = now();
+    FrameRecord & record = m_history[m_historyPosition];
+
+    record.startNs = m_frameStart;
+    record.durationNs = end - m_frameStart;
+    for(size_t i = 0; i < MAX_SECTIONS; i++) {
+        record.sectionNs[i] = m_sections[i].ns.exchange(0, std::memory_order_relaxed);
+        record.sectionCalls[i] = m_sections[i].calls.exchange(0, std::memory_order_relaxed);
+    }
+
+    m_historyPosition = (m_historyPosition + 1) % HISTORY_FRAMES;
+    m_historyCount = std::min(m_historyCount + 1, HISTORY_FRAMES);
+    m_frameStart = end;
+}
+
+void Profiler::setPerfCounters(const PerfCounters * counters) {
+    // Changed only while no other thread enters a section with the counters.
+    m_counters.store(nullptr, std::memory_order_release);
+    m_countersThread = std::this_thread::get_id();
+    m_counters.store(counters, std::memory_order_release);
+}
+
+size_t Profiler::getSectionCount() const {
+    return m_sectionCount.load();
+}
+
+const std::string & Profiler::getSectionName(size_t section) const {
+    return m_sections[section].name;
+}
+
+PerfCounters::Values Profiler::getSectionEvents(size_t section) const {
+
+    PerfCounters::Values values{};
+    for(size_t i = 0; i < PerfCounters::EVENT_COUNT; i++)
+        values[i] = m_sections[section].events[i].load(std::memory_order_relaxed);
+
+    return values;
+}
+
+void Profiler::reset() {
+
+    for(auto & section : m_sections) {
+        section.ns = 0;
+        section.calls = 0;
+        for(auto & events : section.events)
+            events = 0;
+    }
+
+    m_historyPosition = 0;
+    m_historyCount = 0;
+    m_frameStart = now();
+}
+
+const Profiler::FrameRecord & Profiler::historyRecord(size_t age) const {
+    return m_history[(m_historyPosition + HISTORY_FRAMES - 1 - age) % HISTORY_FRAMES];
+}
+
+void Profiler::writeChromeTrace(std::ostream & os) const {
+
+    size_t sectionCount = m_sectionCount.load();
+    uint64_t origin = m_historyCount ? historyRecord(m_historyCount - 1).startNs : 0;
+    bool first = true;
+
+    auto separator = [&]() -> std::ostream & {
+        if(!first)
+            os << ",\n";
+        first = false;
+        return os;
+    };
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    // Track names: track 0 = frames, track n = section n - 1.
+    separator() << R"({"name":"thread_name","ph":"M","pid":1,"tid":0,"args":{"name":"Frame"}})";
+    for(size_t i = 0; i < sectionCount; i++)
+        separator() << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << i + 1
+                    << R"(,"args":{"name":")" << m_sections[i].name << "\"}}";
+
+    for(size_t age = m_historyCount; age-- > 0;) {
+
+        const FrameRecord & record = historyRecord(age);
+        double start = static_cast<double>(record.startNs - origin) / 1000.0;
+
+        separator() << R"({"name":"Frame","ph":"X","pid":1,"tid":0,"ts":)" << start
+                    << ",\"dur\":" << static_cast<double>(record.durationNs) / 1000.0 << "}";
+
+        for(size_t i = 0; i < sectionCount; i++) {
+
+            if(record.sectionNs[i])
+                separator() << R"({"name":")" << m_sections[i].name << R"(","ph":"X","pid":1,"tid":)" << i + 1
+                            << ",\"ts\":" << start << ",\"dur\":" << static_cast<double>(record.sectionNs[i]) / 1000.0 << "}";
+
+            separator() << R"({"name":")" << m_sections[i].name << R"( calls","ph":"C","pid":1,"ts":)" << start
+                        << R"(,"args":{"calls":)" << record.sectionCalls[i] << "}}";
+        }
+    }
+
+    os << "\n]}\n";
+}
+
+EmulatorWindow Profiler::getGUI() {
+
+    return EmulatorWindow{
+        .category = "Emulator",
+        .title = "Performance",
+        .id = reinterpret_cast<uintptr_t>(this),
+        .dock = DockSpace::RIGHT,
+        .guiFunction = [this](){
+
+            ImGui::SliderInt("Averaged frames", &m_averagedFrames, 1, static_cast<int>(HISTORY_FRAMES));
+            if(ImGui::Button("Reset"))
+                reset();
+
+            ImGui::InputText("Trace file", m_tracePath, sizeof(m_tracePath));
+            ImGui::SameLine();
+            if(ImGui::Button("Save Chrome trace")) {
+                std::ofstream file(m_tracePath);
+                if(file) {
+                    writeChromeTrace(file);
+                    m_traceStatus = "Saved.";
+                } else {
+                    m_traceStatus = "File couldn't be opened!";
+                }
+            }
+            if(!m_traceStatus.empty())
+                ImGui::Text("%s", m_traceStatus.c_str());
+
+            size_t frames = std::min<size_t>(m_averagedFrames, m_historyCount);
+            if(!frames) {
+                ImGui::Text("No frames recorded yet.");
+                return;
+            }
+
+            uint64_t frameNs = 0;
+            for(size_t age = 0; age < frames; age++)
+                frameNs += historyRecord(age).durationNs;
+            ImGui::Text("Frame: %.3f ms (%.1f FPS)", frameNs / 1e6 / frames, 1e9 * frames / frameNs);
+
+            size_t sectionCount = m_sectionCount.load();
+            if(ImGui::BeginTable("sections", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+
+                ImGui::TableSetupColumn("Section");
+                ImGui::TableSetupColumn("us/frame");
+                ImGui::TableSetupColumn("calls/frame");
+                ImGui::TableSetupColumn("ns/call");
+                ImGui::TableHeadersRow();
+
+                for(size_t i = 0; i < sectionCount; i++) {
+
+                    uint64_t ns = 0, calls = 0;
+                    for(size_t age = 0; age < frames; age++) {
+                        ns += historyRecord(age).sectionNs[i];
+                        calls += historyRecord(age).sectionCalls[i];
+                    }
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(m_sections[i].name.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", ns / 1e3 / frames);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.0f", static_cast<double>(calls) / frames);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", calls ? static_cast<double>(ns) / calls : 0.0);
+                }
+
+                ImGui::EndTable();
+            }
+
+            // Per-frame time histograms, the oldest frame first.
+            ImGui::SeparatorText("Time per frame (us)");
+            std::vector<float> values(frames);
+            for(size_t i = 0; i < sectionCount; i++) {
+
+                for(size_t age = 0; age < frames; age++)
+                    values[frames - 1 - age] = static_cast<float>(historyRecord(age).sectionNs[i]) / 1e3f;
+
+                ImGui::PlotHistogram(m_sections[i].name.c_str(), values.data(), static_cast<int>(frames),
+                                     0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+            }
+        }
+    };
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include "SharedMemoryExport.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define USE_SHM_SUPPORTED
+#endif
+
+static_assert(sizeof(RGBPixel) == 3, "RGBPixel must be packed RGB24.");
+
+SharedMemoryExport::SharedMemoryExport(std::string name, uint32_t sampleRate) : m_name(std::move(name)) {
+
+    if(m_name.size() < 2 || m_name[0] != '/' || m_name.find('/', 1) != std::string::npos)
+        throw std::invalid_argument("Shared memory name must be a single slash followed by a name!");
+
+#ifdef USE_SHM_SUPPORTED
+    // Never take over an existing region, it may belong to another instance.
+    int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0 && errno == EEXIST)
+        throw std::runtime_error("Shared memory region " + m_name + " already exists!");
+    if(fd < 0)
+        throw std::runtime_error("Shared memory region couldn't be created!");
+
+    if(ftruncate(fd, sizeof(SharedMemory::Layout)) != 0) {
+        close(fd);
+        shm_unlink(m_name.c_str());
+        throw std::runtime_error("Shared memory region couldn't be resized!");
+    }
+
+    void * region = mmap(nullptr, sizeof(SharedMemory::Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(region == MAP_FAILED) {
+        shm_unlink(m_name.c_str());
+        throw std::runtime_error("Shared memory region couldn't be mapped!");
+    }
+
+    m_layout = new(region) SharedMemory::Layout{};
+    m_layout->audioSampleRate = sampleRate;
+    m_layout->version = SharedMemory::VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_layout->magic = SharedMemory::MAGIC;
+#else
+    throw std::runtime_error("Shared memory export is not supported on this platform!");
+#endif
+}
+
+SharedMemoryExport::~SharedMemoryExport() {
+
+#ifdef USE_SHM_SUPPORTED
+    munmap(m_layout, sizeof(SharedMemory::Layout));
+    shm_unlink(m_name.c_str());
+#endif
+}
+
+void SharedMemoryExport::publish(const VideoFrame & frame, std::span<const uint8_t> ram, std::span<const uint8_t> prgRam) {
+
+    SharedMemory::Layout & layout = *m_layout;
+
+    uint64_t sequence = layout.sequence.load(std::memory_order_relaxed);
+    layout.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    layout.frameNumber = frame.number;
+    layout.frameWidth = std::min<uint32_t>(frame.width, SharedMemory::FRAME_WIDTH);
+    layout.frameHeight = std::min<uint32_t>(frame.height, SharedMemory::FRAME_HEIGHT);
+    for(size_t y = 0; y < layout.frameHeight; y++)
+        std::memcpy(layout.frame + y * layout.frameWidth * 3, frame.pixels + y * frame.width, layout.frameWidth * 3);
+
+    std::memcpy(layout.ram, ram.data(), std::min(ram.size(), SharedMemory::RAM_SIZE));
+
+    layout.prgRamSize = std::min(prgRam.size(), SharedMemory::PRG_RAM_SIZE);
+    if(layout.prgRamSize)
+        std::memcpy(layout.prgRam, prgRam.data(), layout.prgRamSize);
+
+    // Unroll the ring, so the newest sample is the last one.
+    size_t oldest = (m_audioPosition + m_audio.size() - m_audioCount) % m_audio.size();
+    size_t firstPart = std::min(m_audioCount, m_audio.size() - oldest);
+    std::memcpy(layout.audio, m_audio.data() + oldest, firstPart * sizeof(float));
+    std::memcpy(layout.audio + firstPart, m_audio.data(), (m_audioCount - firstPart) * sizeof(float));
+    layout.audioSampleCount = m_audioCount;
+
+    layout.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+const std::string & SharedMemoryExport::getName() const {
+    return m_name;
+}
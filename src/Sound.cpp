@@ -1,10 +1,12 @@
 #include <stdexcept>
+#include <algorithm>
 
 // We include implementation part of the miniaudio here.
 #define MINIAUDIO_IMPLEMENTATION
 #include "miniaudio.h"
 
 #include "Sound.h"
+#include "Profiler.h"
 
 Sound::Sound(size_t outputCount) {
 
@@ -37,7 +39,6 @@ Sound::Sound(size_t outputCount) {
 
     for(size_t i = 0; i < outputCount; i++) {
 
-        m_sampleCaches.emplace_back();
         m_sampleBuffers.emplace_back(new ma_pcm_rb, &deletePcmRb);
         if(ma_pcm_rb_init(ma_format_f32, CHANNEL_COUNT, SAMPLE_BUFFER_SIZE, nullptr, nullptr, m_sampleBuffers.back().get()) != MA_SUCCESS) {
             m_sampleBuffers.clear();
@@ -100,12 +101,9 @@ void Sound::dataCallback(ma_device *pDevice, void *pOutput, const void *pInput,
     auto *instance = static_cast<Sound*>(pDevice->pUserData);
     assert(pDevice->playback.channels == Sound::CHANNEL_COUNT);
 
-    // Correcting buffers read pointer position.
-    for(auto & buf : instance->m_sampleBuffers) {
-        if(ma_pcm_rb_pointer_distance(buf.get()) > Sound::SAMPLE_BUFFER_MAX_PTR_DISTANCE) {
-            ma_pcm_rb_seek_read(buf.get(), Sound::BUFFER_PTR_CORRECTION);
-        }
-    }
+    // Not enough frames, the missing part is played as silence.
+    if(!instance->m_sampleBuffers.empty())
+        instance->m_rateControl.read(ma_pcm_rb_available_read(instance->m_sampleBuffers.front().get()), frameCount);
 
     ma_node_graph_read_pcm_frames(instance->m_maNodeGraph.get(), pOutput, frameCount, nullptr);
 }
@@ -115,8 +113,18 @@ void Sound::start() {
     if(m_running)
         return;
 
-    // Making enough space between read and write pointers.
-    ma_pcm_rb_seek_write(m_sampleBuffers[0].get(), Sound::SAMPLE_BUFFER_SIZE / 2);
+    // Start with the target latency.
+    for(auto & buf : m_sampleBuffers) {
+
+        ma_pcm_rb_reset(buf.get());
+
+        void* mappedBuffer;
+        ma_uint32 mappedFrameCount = TARGET_BUFFERED_FRAMES;
+        if(ma_pcm_rb_acquire_write(buf.get(), &mappedFrameCount, &mappedBuffer) == MA_SUCCESS) {
+            ma_silence_pcm_frames(mappedBuffer, mappedFrameCount, buf->format, buf->channels);
+            ma_pcm_rb_commit_write(buf.get(), mappedFrameCount);
+        }
+    }
 
     if(ma_device_start(m_maDevice.get()) != MA_SUCCESS)
         throw std::runtime_error("Couldn't start sound device!");
@@ -136,38 +144,58 @@ void Sound::stop() {
 
 void Sound::writeFrames(const SoundSampleSources & sources) {
 
+    USE_PROFILE_SCOPE("Sound output");
+
     if(sources.size() != m_sampleBuffers.size())
         throw std::invalid_argument("Sample sources and sample buffers size mismatch.");
 
+    bool overrun = false;
     auto bufferIt = m_sampleBuffers.begin();
-    auto cacheIt  = m_sampleCaches.begin();
     for(auto & getSample : sources) {
 
-        // Correcting write pointer position.
-        if(ma_pcm_rb_pointer_distance(bufferIt->get()) < Sound::SAMPLE_BUFFER_MIN_PTR_DISTANCE) {
-            ma_pcm_rb_seek_write(bufferIt->get(), Sound::BUFFER_PTR_CORRECTION);
-        }
+        SoundStereoFrame sample = getSample();
+        float frame[CHANNEL_COUNT] = {sample.left, sample.right};
 
         void* mappedBuffer;
-        ma_uint32 mappedFrameCount;
+        ma_uint32 mappedFrameCount = 1;
+
+        if(ma_pcm_rb_acquire_write(bufferIt->get(), &mappedFrameCount, &mappedBuffer) == MA_SUCCESS && mappedFrameCount == 1) {
+            ma_copy_pcm_frames(mappedBuffer, frame, 1, (*bufferIt)->format, (*bufferIt)->channels);
+            ma_pcm_rb_commit_write(bufferIt->get(), 1);
+        } else {
+            overrun = true;
+        }
 
-        cacheIt->push_back(getSample().left);
-        cacheIt->push_back(getSample().right);
+        bufferIt++;
+    }
 
-        ma_uint32 expectedWriteCount = cacheIt->size() / 2;
+    if(overrun)
+        m_rateControl.overrun();
+}
 
-        if(ma_pcm_rb_acquire_write(bufferIt->get(), &mappedFrameCount, &mappedBuffer) != MA_SUCCESS)
-            continue;
+size_t Sound::getBufferedFrames() const {
 
-        if(mappedFrameCount < expectedWriteCount)
-            continue;
+    if(m_sampleBuffers.empty())
+        return 0;
 
-        ma_copy_pcm_frames(mappedBuffer, cacheIt->data(), expectedWriteCount, bufferIt->get()->format, bufferIt->get()->channels);
-        if(ma_pcm_rb_commit_write(bufferIt->get(), expectedWriteCount) != MA_SUCCESS)
-            continue;
+    return ma_pcm_rb_available_read(m_sampleBuffers.front().get());
+}
 
-        // Flushed the cache to the ring buffer successfully, clear the cache.
-        cacheIt->clear();
-        bufferIt++;
-    }
-}
\ No newline at end of file
+size_t Sound::getTargetBufferedFrames() const {
+    return m_rateControl.getTargetFrames();
+}
+
+double Sound::getRateRatio() const {
+    return m_rateControl.getRateRatio(getBufferedFrames());
+}
+
+AudioSink::Statistics Sound::getStatistics() const {
+
+    return {
+        .bufferedFrames = getBufferedFrames(),
+        .bufferSize     = SAMPLE_BUFFER_SIZE,
+        .underruns      = m_rateControl.getUnderruns(),
+        .overruns       = m_rateControl.getOverruns(),
+        .rateRatio      = getRateRatio()
+    };
+}
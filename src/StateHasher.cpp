@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "StateHasher.h"
+
+namespace {
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4F;
+    constexpr uint64_t PRIME_3 = 0x165667B19E3779F9;
+    constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63;
+    constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5;
+
+    /// Little-endian load, compiles to a single load on little-endian hosts.
+    uint64_t load64(const uint8_t * data) {
+
+        uint64_t value = 0;
+        for(int i = 7; i >= 0; i--)
+            value = (value << 8) | data[i];
+
+        return value;
+    }
+
+    uint64_t round(uint64_t lane, uint64_t input) {
+        lane += input * PRIME_2;
+        return std::rotl(lane, 31) * PRIME_1;
+    }
+
+    uint64_t merge(uint64_t hash, uint64_t lane) {
+        hash ^= round(0, lane);
+        return hash * PRIME_1 + PRIME_4;
+    }
+}
+
+StateHasher::StateHasher()
+    : m_lanes{PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1} {}
+
+void StateHasher::consume(const uint8_t * stripe) {
+
+    for(size_t i = 0; i < LANE_COUNT; i++)
+        m_lanes[i] = round(m_lanes[i], load64(stripe + 8 * i));
+}
+
+void StateHasher::add(std::span<const uint8_t> data) {
+
+    m_length += data.size();
+
+    // Complete the pending stripe first.
+    if(m_stripeSize) {
+        size_t count = std::min(data.size(), STRIPE_SIZE - m_stripeSize);
+        std::memcpy(m_stripe + m_stripeSize, data.data(), count);
+        m_stripeSize += count;
+        data = data.subspan(count);
+
+        if(m_stripeSize < STRIPE_SIZE)
+            return;
+
+        consume(m_stripe);
+        m_stripeSize = 0;
+    }
+
+    while(data.size() >= STRIPE_SIZE) {
+        consume(data.data());
+        data = data.subspan(STRIPE_SIZE);
+    }
+
+    std::memcpy(m_stripe, data.data(), data.size());
+    m_stripeSize = data.size();
+}
+
+void StateHasher::add(const PagedMemory & memory) {
+
+    for(size_t i = 0; i < memory.pageCount(); i++)
+        add(memory.page(i));
+}
+
+uint64_t StateHasher::digest() const {
+
+    uint64_t hash;
+    if(m_length >= STRIPE_SIZE) {
+        hash = std::rotl(m_lanes[0], 1) + std::rotl(m_lanes[1], 7) + std::rotl(m_lanes[2], 12) + std::rotl(m_lanes[3], 18);
+        for(uint64_t lane : m_lanes)
+            hash = merge(hash, lane);
+    }
+    else
+        hash = m_lanes[2] + PRIME_5;
+
+    hash += m_length;
+
+    // The remaining bytes of the pending stripe.
+    size_t offset = 0;
+    for(; offset + 8 <= m_stripeSize; offset += 8)
+        hash = std::rotl(hash ^ round(0, load64(m_stripe + offset)), 27) * PRIME_1 + PRIME_4;
+
+    for(; offset < m_stripeSize; offset++)
+        hash = std::rotl(hash ^ (m_stripe[offset] * PRIME_5), 11) * PRIME_1;
+
+    // Avalanche.
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
@@ -0,0 +1,119 @@
+#include <cstring>
+#include <stdexcept>
+#include "StreamFrameSink.h"
+
+static_assert(sizeof(RGBPixel) == 3, "RGBPixel must be packed RGB24.");
+
+StreamFrameSink::StreamFrameSink(const std::string & path, FORMAT format,
+                                 uint32_t frameRateNumerator, uint32_t frameRateDenominator)
+    : m_format(format), m_frameRateNumerator(frameRateNumerator), m_frameRateDenominator(frameRateDenominator) {
+
+    if(!frameRateNumerator || !frameRateDenominator)
+        throw std::invalid_argument("Frame rate can't be zero!");
+
+    m_file.open(path, std::ios_base::binary | std::ios_base::trunc);
+    if(!m_file)
+        throw std::runtime_error("Video output file couldn't be opened!");
+
+    for(uint32_t slot = 0; slot < SLOT_COUNT; slot++)
+        m_freeSlots.push(slot);
+
+    m_thread = std::thread(&StreamFrameSink::run, this);
+}
+
+StreamFrameSink::~StreamFrameSink() {
+    close();
+}
+
+void StreamFrameSink::onFrame(const VideoFrame & frame) {
+
+    if(m_stop)
+        return;
+
+    // The slots are allocated once, on the first frame.
+    if(!m_width) {
+        m_width = frame.width;
+        m_height = frame.height;
+        for(auto & slot : m_slots)
+            slot.resize(static_cast<size_t>(m_width) * m_height * 3);
+    }
+
+    uint32_t slot;
+    if(frame.width != m_width || frame.height != m_height || !m_freeSlots.pop(slot)) {
+        m_droppedFrames++;
+        return;
+    }
+
+    std::memcpy(m_slots[slot].data(), frame.pixels, m_slots[slot].size());
+    m_filledSlots.push(slot);
+    m_pending.release();
+}
+
+void StreamFrameSink::run() {
+
+    std::vector<uint8_t> buffer;
+
+    while(true) {
+
+        m_pending.acquire();
+
+        uint32_t slot;
+        if(!m_filledSlots.pop(slot))
+            break;  // Woken up by close() with nothing left to write.
+
+        writeFrame(m_slots[slot], buffer);
+        m_freeSlots.push(slot);
+        m_writtenFrames++;
+    }
+}
+
+void StreamFrameSink::writeFrame(const std::vector<uint8_t> & rgb, std::vector<uint8_t> & buffer) {
+
+    if(m_format == FORMAT::RGB24) {
+        m_file.write(reinterpret_cast<const char *>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+        return;
+    }
+
+    if(m_writtenFrames == 0) {
+        m_file << "YUV4MPEG2 W" << m_width << " H" << m_height
+               << " F" << m_frameRateNumerator << ":" << m_frameRateDenominator
+               << " Ip A1:1 C444\n";
+    }
+
+    // Planar Y, U, V.
+    const size_t pixelCount = static_cast<size_t>(m_width) * m_height;
+    buffer.resize(pixelCount * 3);
+    uint8_t * y = buffer.data();
+    uint8_t * u = y + pixelCount;
+    uint8_t * v = u + pixelCount;
+
+    for(size_t i = 0; i < pixelCount; i++) {
+        int r = rgb[i * 3], g = rgb[i * 3 + 1], b = rgb[i * 3 + 2];
+        y[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        u[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+
+    m_file << "FRAME\n";
+    m_file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
+
+void StreamFrameSink::close() {
+
+    if(m_stop.exchange(true))
+        return;
+
+    m_pending.release();
+    if(m_thread.joinable())
+        m_thread.join();
+
+    m_file.close();
+}
+
+uint64_t StreamFrameSink::getWrittenFrames() const {
+    return m_writtenFrames;
+}
+
+uint64_t StreamFrameSink::getDroppedFrames() const {
+    return m_droppedFrames;
+}
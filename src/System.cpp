@@ -2,6 +2,8 @@
 // Created by golas on 17.3.23.
 //
 
+#include <algorithm>
+#include <stdexcept>
 #include "System.h"
 
 System::System() { }
@@ -9,6 +11,8 @@ System::System() { }
 void System::init() {
     for(auto & component : m_components)
         component->init();
+
+    m_frameCount = 0;
 }
 
 std::vector<EmulatorWindow> System::getGUIs() {
@@ -22,6 +26,54 @@ std::vector<EmulatorWindow> System::getGUIs() {
     return mergedGUIs;
 }
 
+void System::setFrameSkip(unsigned int /*count*/) { }
+
+bool System::breakpointHit() const {
+    return false;
+}
+
+std::unique_ptr<System> System::fork(bool /*copyOnWrite*/) const {
+    throw std::logic_error("The system doesn't support forking.");
+}
+
+uint64_t System::computeStateHash() {
+    throw std::logic_error("The system doesn't support state hashing.");
+}
+
+void System::setStateHashEnabled(bool enabled) {
+
+    if(enabled)
+        m_frameStateHash = computeStateHash();
+
+    m_stateHashEnabled = enabled;
+}
+
+uint64_t System::getFrameStateHash() const {
+    return m_frameStateHash;
+}
+
+void System::addFrameSink(FrameSink * sink) {
+
+    if(!sink)
+        throw std::invalid_argument("Frame sink can't be null!");
+
+    if(std::find(m_frameSinks.begin(), m_frameSinks.end(), sink) == m_frameSinks.end())
+        m_frameSinks.push_back(sink);
+}
+
+void System::removeFrameSink(FrameSink * sink) {
+    std::erase(m_frameSinks, sink);
+}
+
+uint64_t System::getFrameCount() const {
+    return m_frameCount;
+}
+
+void System::emitFrame(const VideoFrame & frame) {
+    for(auto sink : m_frameSinks)
+        sink->onFrame(frame);
+}
+
 void System::onRefresh() {
 
     for(auto & component : m_components) {
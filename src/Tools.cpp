@@ -54,6 +54,44 @@ namespace USETools {
         ImGui::Dummy({dummyWidth, dummyHeight});
     }
 
+    void renderScalableBitmap(const RGBPixel * pixels, size_t width, size_t height, float scale) {
+
+        if(!pixels)
+            throw std::invalid_argument("Pixel data can't be empty!");
+
+        ImDrawList * dl = ImGui::GetWindowDrawList();
+        const ImVec2 defaultScreenPos = ImGui::GetCursorScreenPos();
+
+        for(size_t y = 0; y < height; y++) {
+
+            const RGBPixel * row = pixels + y * width;
+            float screenY = defaultScreenPos.y + scale * static_cast<float>(y);
+
+            size_t runStart = 0;
+            while(runStart < width) {
+
+                // Find the end of a run of the same color.
+                const RGBPixel & pixel = row[runStart];
+                size_t runEnd = runStart + 1;
+                while(runEnd < width
+                      && row[runEnd].red == pixel.red
+                      && row[runEnd].green == pixel.green
+                      && row[runEnd].blue == pixel.blue)
+                    runEnd++;
+
+                ImColor color = ImColor(pixel.red, pixel.green, pixel.blue, 255);
+                float screenX = defaultScreenPos.x + scale * static_cast<float>(runStart);
+                float screenXEnd = defaultScreenPos.x + scale * static_cast<float>(runEnd);
+                dl->AddRectFilled({screenX, screenY}, {screenXEnd, screenY + scale}, color);
+
+                runStart = runEnd;
+            }
+        }
+
+        // Dummy widget is needed for scrollbars to work and to allow to place more elements below correctly.
+        ImGui::Dummy({scale * static_cast<float>(width), scale * static_cast<float>(height)});
+    }
+
     double map(double val, double iStart, double iEnd, double oStart, double oEnd){
         return oStart + std::round((oEnd - oStart) / (iEnd - iStart) * (val - iStart));
     }
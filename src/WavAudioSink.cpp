@@ -0,0 +1,114 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include "WavAudioSink.h"
+
+namespace {
+
+    /// Append a little-endian integer.
+    template<typename T>
+    void putLE(char * dst, T value) {
+        for(size_t i = 0; i < sizeof(T); i++)
+            dst[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+WavAudioSink::WavAudioSink(const std::string & path, uint32_t sampleRate, FORMAT format)
+    : m_format(format), m_sampleRate(sampleRate) {
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if(!m_file.is_open())
+        throw std::runtime_error("Couldn't open the WAV file for writing.");
+
+    m_block.reserve(BLOCK_FRAMES * CHANNEL_COUNT * bytesPerSample());
+    writeHeader(0);
+}
+
+WavAudioSink::~WavAudioSink() {
+
+    // The destructor can't report a write error, close() has to be called to get it.
+    try {
+        close();
+    } catch(const std::runtime_error &) {}
+}
+
+size_t WavAudioSink::bytesPerSample() const {
+    return m_format == FORMAT::FLOAT32 ? 4 : 2;
+}
+
+void WavAudioSink::writeHeader(uint64_t frameCount) {
+
+    auto dataSize = static_cast<uint32_t>(std::min<uint64_t>(frameCount * CHANNEL_COUNT * bytesPerSample(), UINT32_MAX - HEADER_SIZE));
+    auto sampleBytes = static_cast<uint16_t>(bytesPerSample());
+
+    char header[HEADER_SIZE];
+    std::memcpy(header, "RIFF", 4);
+    putLE<uint32_t>(header + 4, dataSize + HEADER_SIZE - 8);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    putLE<uint32_t>(header + 16, 16);                                           // fmt chunk size
+    putLE<uint16_t>(header + 20, m_format == FORMAT::FLOAT32 ? 3 : 1);          // IEEE float / PCM
+    putLE<uint16_t>(header + 22, CHANNEL_COUNT);
+    putLE<uint32_t>(header + 24, m_sampleRate);
+    putLE<uint32_t>(header + 28, m_sampleRate * CHANNEL_COUNT * sampleBytes);  // byte rate
+    putLE<uint16_t>(header + 32, CHANNEL_COUNT * sampleBytes);                 // block align
+    putLE<uint16_t>(header + 34, sampleBytes * 8);                             // bits per sample
+    std::memcpy(header + 36, "data", 4);
+    putLE<uint32_t>(header + 40, dataSize);
+
+    m_file.seekp(0);
+    m_file.write(header, HEADER_SIZE);
+    m_file.seekp(0, std::ios::end);
+    if(!m_file)
+        throw std::runtime_error("WAV file header couldn't be written!");
+}
+
+void WavAudioSink::flush() {
+
+    if(m_block.empty())
+        return;
+
+    m_file.write(m_block.data(), static_cast<std::streamsize>(m_block.size()));
+    if(!m_file)
+        throw std::runtime_error("WAV file couldn't be written!");
+
+    m_writtenFrames += m_block.size() / (CHANNEL_COUNT * bytesPerSample());
+    m_block.clear();
+}
+
+void WavAudioSink::writeFrames(const SoundSampleSources & sources) {
+
+    if(!m_file.is_open())
+        return;
+
+    SoundStereoFrame frame = mix(sources);
+    size_t offset = m_block.size();
+
+    if(m_format == FORMAT::FLOAT32) {
+        m_block.resize(offset + 2 * sizeof(float));
+        std::memcpy(m_block.data() + offset, &frame.left, sizeof(float));
+        std::memcpy(m_block.data() + offset + sizeof(float), &frame.right, sizeof(float));
+    } else {
+        m_block.resize(offset + 2 * sizeof(int16_t));
+        putLE<uint16_t>(m_block.data() + offset,     static_cast<uint16_t>(static_cast<int16_t>(std::clamp(frame.left,  -1.0f, 1.0f) * 32767.0f)));
+        putLE<uint16_t>(m_block.data() + offset + 2, static_cast<uint16_t>(static_cast<int16_t>(std::clamp(frame.right, -1.0f, 1.0f) * 32767.0f)));
+    }
+
+    if(m_block.size() >= m_block.capacity())
+        flush();
+}
+
+void WavAudioSink::close() {
+
+    if(!m_file.is_open())
+        return;
+
+    flush();
+    writeHeader(m_writtenFrames);
+    m_file.close();
+    if(!m_file)
+        throw std::runtime_error("WAV file couldn't be closed!");
+}
+
+uint64_t WavAudioSink::getFrameCount() const {
+    return m_writtenFrames + m_block.size() / (CHANNEL_COUNT * bytesPerSample());
+}
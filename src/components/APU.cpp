@@ -3,7 +3,48 @@
 #include <cstdio>
 #include <cmath>
 #include "Tools.h"
+#include "Profiler.h"
+#include "StateHasher.h"
 #include <cassert>
+#include <algorithm>
+
+namespace {
+
+    /**
+     * Generate pulse channels mixer lookup table.
+     * @return Table of output levels.
+     * */
+    constexpr std::array<float, 31> makePulseTable() {
+        std::array<float, 31> table{};
+        for(int i = 1; i < 31; i++)
+            table[i] = 95.52f / (8128.0f / static_cast<float>(i) + 100.0f);
+        return table;
+    }
+
+    /**
+     * Generate triangle, noise and DMC mixer lookup table.
+     * @return Table of output levels.
+     * */
+    constexpr std::array<float, 203> makeTndTable() {
+        std::array<float, 203> table{};
+        for(int i = 1; i < 203; i++)
+            table[i] = 163.67f / (24329.0f / static_cast<float>(i) + 100.0f);
+        return table;
+    }
+
+    /// Values of the APU clock at which the frame sequencer does something.
+    constexpr uint16_t FRAME_SEQUENCER_EVENTS[] = {3728, 7456, 11185, 14914, 14915, 18640};
+
+    constexpr bool isFrameSequencerEvent(uint16_t clock) {
+        for(auto event : FRAME_SEQUENCER_EVENTS)
+            if(clock == event)
+                return true;
+        return false;
+    }
+}
+
+constinit const std::array<float, 31> APU::pulseTable = makePulseTable();
+constinit const std::array<float, 203> APU::tndTable = makeTndTable();
 
 APU::APU() : m_pulse1(false), m_pulse2(true) {
 
@@ -16,129 +57,141 @@ APU::APU() : m_pulse1(false), m_pulse2(true) {
     });
 
     m_connectors["cpuBus"] = std::make_shared<Connector>(DataInterface{
+            .read = [this](uint32_t address, uint32_t & buffer) {
+                uint8_t data;
+                if(!cpuRead(address, data))
+                    return false;
+                buffer = data;
+                return true;
+            },
+            .write = [this](uint32_t address, uint32_t data) {
+                cpuWrite(address, data);
+            }
+    });
 
-            .read = [&](uint32_t address, uint32_t & buffer) -> bool {
+    m_ports["IRQ"] = &m_IRQ;
+}
 
-                if(address == 0x4015){
-                        buffer =
-                                (m_pulse1.lengthCounter.counterValue > 0) |
-                                ((m_pulse2.lengthCounter.counterValue > 0) << 1) |
-                                //((m_noise.lengthCounter.value > 0) << 3) |
-                                (m_internalIRQState << 6);
+bool APU::cpuRead(uint16_t address, uint8_t & buffer) {
 
-                        m_IRQ.set(false);
-                        m_internalIRQState = false;
+    if(address == 0x4015){
+        buffer =
+                (m_pulse1.lengthCounter.counterValue > 0) |
+                ((m_pulse2.lengthCounter.counterValue > 0) << 1) |
+                //((m_noise.lengthCounter.value > 0) << 3) |
+                (m_internalIRQState << 6);
 
-                        return true;
-                } else {
-                    return false;
-                }
-            },
+        m_IRQ.set(false);
+        m_internalIRQState = false;
 
-            .write = [&](uint32_t address, uint32_t data){
-
-                switch(address){
-
-                    // Pulse 1 envelope configuration and duty bits.
-                    case 0x4000:
-                        m_pulse1.envelope.configure(data);
-                        m_pulse1.dutyCycle = (data & 0xC0) >> 6;
-                        m_pulse1.lengthCounter.setHaltFlag(data & 0x20);
-                        break;
-
-                        // Pulse 1 sweep setup.
-                    case 0x4001:
-                        m_pulse1.setupSweep(data);
-                        break;
-
-                        // Pulse 1 timer low.
-                    case 0x4002:
-                        m_pulse1.timerPeriod &= 0x700;
-                        m_pulse1.timerPeriod |= data;
-                        m_pulse1.updateTargetPeriod();
-                        break;
-
-                    case 0x4003:
-                        m_pulse1.envelope.setStart(true);
-                        m_pulse1.sequencerPos = 0;
-                        m_pulse1.timerPeriod &= 0xFF;
-                        m_pulse1.timerPeriod |= (data & 0x7) << 8;
-                        m_pulse1.timer = m_pulse1.timerPeriod;
-                        m_pulse1.lengthCounter.setLength((data & 0xF8) >> 3);
-                        m_pulse1.updateTargetPeriod();
-                        break;
-
-                        // Pulse 2 envelope configuration and duty bits.
-                    case 0x4004:
-                        m_pulse2.envelope.configure(data);
-                        m_pulse2.dutyCycle = (data & 0xC0) >> 6;
-                        m_pulse2.lengthCounter.setHaltFlag(data & 0x20);
-                        break;
-
-                        // Pulse 2 sweep setup.
-                    case 0x4005:
-                        m_pulse2.setupSweep(data);
-                        break;
-
-                        // Pulse 2 timer low.
-                    case 0x4006:
-                        m_pulse2.timerPeriod &= 0x700;
-                        m_pulse2.timerPeriod |= data;
-                        m_pulse2.updateTargetPeriod();
-                        break;
-
-                    case 0x4007:
-                        m_pulse2.envelope.setStart(true);
-                        m_pulse2.sequencerPos = 0;
-                        m_pulse2.timerPeriod &= 0xFF;
-                        m_pulse2.timerPeriod |= (data & 0x7) << 8;
-                        m_pulse2.timer = m_pulse2.timerPeriod;
-                        m_pulse2.lengthCounter.setLength((data & 0xF8) >> 3);
-                        m_pulse2.updateTargetPeriod();
-                        break;
-
-                    case 0x400B:
-                        m_triangle.lengthCounter.setLength((data & 0xF8) >> 3);
-                        break;
-
-                        // Noise envelope configuration and duty bits.
-                    case 0x400C:
-                        m_noise.envelope.configure(data);
-                        break;
-
-                    case 0x400E:
-                        m_noise.modeFlag = (data & 0x80);
-                        m_noise.setPeriod(data & 0xF);
-                        break;
-
-                    case 0x400F:
-                        m_noise.lengthCounter.setLength((data & 0xF8) >> 3);
-                        m_noise.envelope.setStart(true);
-                        break;
-
-                    case 0x4015:
-
-                        m_pulse1.lengthCounter.setEnableFlag(data & 0x1);
-                        m_pulse2.lengthCounter.setEnableFlag(data & 0x2);
-                        m_noise.lengthCounter.setEnableFlag(data & 0x8);
-                        break;
-
-                    case 0x4017:
-                        frameCounterModeFlag = data & 0x80;
-                        disableFrameInterruptFlag = data & 0x40;
-                        if(disableFrameInterruptFlag) {
-                            m_IRQ.set(false);
-                            m_internalIRQState = false;
-                        }
-                        break;
-
-                    default:
-                        break;
-                }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void APU::cpuWrite(uint16_t address, uint8_t data) {
+
+    m_levelDirty = true;
+
+    switch(address){
+
+        // Pulse 1 envelope configuration and duty bits.
+        case 0x4000:
+            m_pulse1.envelope.configure(data);
+            m_pulse1.dutyCycle = (data & 0xC0) >> 6;
+            m_pulse1.lengthCounter.setHaltFlag(data & 0x20);
+            break;
+
+            // Pulse 1 sweep setup.
+        case 0x4001:
+            m_pulse1.setupSweep(data);
+            break;
+
+            // Pulse 1 timer low.
+        case 0x4002:
+            m_pulse1.timerPeriod &= 0x700;
+            m_pulse1.timerPeriod |= data;
+            m_pulse1.updateTargetPeriod();
+            break;
+
+        case 0x4003:
+            m_pulse1.envelope.setStart(true);
+            m_pulse1.sequencerPos = 0;
+            m_pulse1.timerPeriod &= 0xFF;
+            m_pulse1.timerPeriod |= (data & 0x7) << 8;
+            m_pulse1.timer = m_pulse1.timerPeriod;
+            m_pulse1.lengthCounter.setLength((data & 0xF8) >> 3);
+            m_pulse1.updateTargetPeriod();
+            break;
+
+            // Pulse 2 envelope configuration and duty bits.
+        case 0x4004:
+            m_pulse2.envelope.configure(data);
+            m_pulse2.dutyCycle = (data & 0xC0) >> 6;
+            m_pulse2.lengthCounter.setHaltFlag(data & 0x20);
+            break;
+
+            // Pulse 2 sweep setup.
+        case 0x4005:
+            m_pulse2.setupSweep(data);
+            break;
+
+            // Pulse 2 timer low.
+        case 0x4006:
+            m_pulse2.timerPeriod &= 0x700;
+            m_pulse2.timerPeriod |= data;
+            m_pulse2.updateTargetPeriod();
+            break;
+
+        case 0x4007:
+            m_pulse2.envelope.setStart(true);
+            m_pulse2.sequencerPos = 0;
+            m_pulse2.timerPeriod &= 0xFF;
+            m_pulse2.timerPeriod |= (data & 0x7) << 8;
+            m_pulse2.timer = m_pulse2.timerPeriod;
+            m_pulse2.lengthCounter.setLength((data & 0xF8) >> 3);
+            m_pulse2.updateTargetPeriod();
+            break;
+
+        case 0x400B:
+            m_triangle.lengthCounter.setLength((data & 0xF8) >> 3);
+            break;
+
+            // Noise envelope configuration and duty bits.
+        case 0x400C:
+            m_noise.envelope.configure(data);
+            break;
+
+        case 0x400E:
+            m_noise.modeFlag = (data & 0x80);
+            m_noise.setPeriod(data & 0xF);
+            break;
+
+        case 0x400F:
+            m_noise.lengthCounter.setLength((data & 0xF8) >> 3);
+            m_noise.envelope.setStart(true);
+            break;
+
+        case 0x4015:
+
+            m_pulse1.lengthCounter.setEnableFlag(data & 0x1);
+            m_pulse2.lengthCounter.setEnableFlag(data & 0x2);
+            m_noise.lengthCounter.setEnableFlag(data & 0x8);
+            break;
+
+        case 0x4017:
+            frameCounterModeFlag = data & 0x80;
+            disableFrameInterruptFlag = data & 0x40;
+            if(disableFrameInterruptFlag) {
+                m_IRQ.set(false);
+                m_internalIRQState = false;
             }
-    });
+            break;
 
-    m_ports["IRQ"] = &m_IRQ;
+        default:
+            break;
+    }
 }
 
 void APU::init(){
@@ -146,6 +199,9 @@ void APU::init(){
     m_clock = 0;
     frameCounterModeFlag = false;
     disableFrameInterruptFlag = false;
+    m_level = 0;
+    m_levelDirty = true;
+    m_renderPhase = 0;
 
     m_pulse1.reset();
     m_pulse2.reset();
@@ -153,7 +209,35 @@ void APU::init(){
     m_triangle.reset();
 }
 
-void APU::clock(){
+uint32_t APU::advanceTimer(uint16_t & timer, uint16_t period, uint32_t cycles){
+
+    if(cycles <= timer){
+        timer -= cycles;
+        return 0;
+    }
+
+    // First reload happens on the cycle after the timer reaches zero, then every period + 1 cycles.
+    cycles -= timer + 1;
+    uint32_t reloads = 1 + cycles / (period + 1);
+    timer = period - cycles % (period + 1);
+
+    return reloads;
+}
+
+uint32_t APU::nextBoundary() const{
+
+    uint32_t maxClock = frameCounterModeFlag ? 18641 : 14915;
+    // Sequence wraps after the max clock (or immediately if the mode was changed to a shorter sequence).
+    uint32_t wrap = std::max<uint32_t>(maxClock, m_clock) + 1;
+
+    for(uint32_t event : FRAME_SEQUENCER_EVENTS)
+        if(event > m_clock)
+            return std::min(event, wrap);
+
+    return wrap;
+}
+
+void APU::frameSequencerStep(){
 
     if(m_clock == 3728){ // Actually should be 3728.5.
 
@@ -218,35 +302,105 @@ void APU::clock(){
         m_pulse1.clockSweep();
         m_pulse2.clockSweep();
     }
+}
 
-    m_pulse1.clock();
-    m_pulse2.clock();
-    m_noise.clock();
+void APU::clock(uint32_t cycles){
 
-    uint16_t maxClock;
-    if(frameCounterModeFlag){
-        maxClock = 18641;
-    } else {
-        maxClock = 14915;
+    USE_PROFILE_SCOPE("APU");
+    USE_PROFILE_COUNT("APU cycles", cycles);
+
+    while(cycles){
+
+        if(isFrameSequencerEvent(m_clock)){
+            // Envelope, length counter and sweep clocking changes channel outputs.
+            m_levelDirty = true;
+            frameSequencerStep();
+        }
+
+        // Advance straight to the next event (or by the requested cycles).
+        uint32_t boundary = nextBoundary();
+        uint32_t step = std::min(cycles, boundary - m_clock);
+
+        if(!m_timingOnly) {
+            if(m_pulse1.clock(step)) m_levelDirty = true;
+            if(m_pulse2.clock(step)) m_levelDirty = true;
+            if(m_noise.clock(step))  m_levelDirty = true;
+        }
+
+        cycles -= step;
+
+        uint32_t maxClock = frameCounterModeFlag ? 18641 : 14915;
+        if(m_clock + step > maxClock)
+            m_clock = 0;
+        else
+            m_clock += step;
     }
+}
 
-    if(m_clock >= maxClock)
-        m_clock = 0;
-    else
-        m_clock++;
+void APU::setTimingOnly(bool enabled){
+    m_timingOnly = enabled;
+    m_levelDirty = true;
+}
+
+void APU::copyState(const APU & other){
+
+    m_level = other.m_level;
+    m_levelDirty = true;
+    m_renderPhase = other.m_renderPhase;
+    m_internalIRQState = other.m_internalIRQState;
+    m_clock = other.m_clock;
+    frameCounterModeFlag = other.frameCounterModeFlag;
+    disableFrameInterruptFlag = other.disableFrameInterruptFlag;
+
+    m_pulse1 = other.m_pulse1;
+    m_pulse2 = other.m_pulse2;
+    m_noise = other.m_noise;
+    m_triangle = other.m_triangle;
+}
+
+void APU::hashState(StateHasher & hasher) const{
+
+    hasher.add(m_internalIRQState);
+    hasher.add(m_clock);
+    hasher.add(frameCounterModeFlag);
+    hasher.add(disableFrameInterruptFlag);
+
+    m_pulse1.hashState(hasher);
+    m_pulse2.hashState(hasher);
+    m_noise.hashState(hasher);
+    m_triangle.hashState(hasher);
+}
+
+uint32_t APU::cyclesUntilEvent() const{
+
+    // Event at the current clock is not processed yet.
+    if(isFrameSequencerEvent(m_clock))
+        return 1;
+
+    return nextBoundary() - m_clock + 1;
 }
 
 float APU::output(){
 
-    float pulse;
-    if(m_pulse1.output() + m_pulse2.output()  == 0)
-        pulse = 0;
-    else
-        pulse = 95.88f / ((8128.0f / (m_pulse1.output() + m_pulse2.output())) + 100);
+    if(m_levelDirty) {
+        // Triangle and DMC channels are not emulated yet.
+        m_level = pulseTable[m_pulse1.output() + m_pulse2.output()] + tndTable[2 * m_noise.output()];
+        m_levelDirty = false;
+    }
+
+    return m_level;
+}
+
+void APU::render(float * buffer, size_t count, uint32_t clockRate, uint32_t sampleRate){
 
-    float tnd = 159.79f / ( (1.0f / (m_noise.output() / 12241.0f)) + 100.0f );
+    for(size_t i = 0; i < count; i++) {
 
-    return pulse + tnd;
+        m_renderPhase += clockRate;
+        clock(m_renderPhase / sampleRate);
+        m_renderPhase %= sampleRate;
+
+        buffer[i] = output();
+    }
 }
 
 std::vector<EmulatorWindow> APU::getGUIs() {
@@ -272,6 +426,13 @@ void APU::apu_lengthCounter::reset(){
     counterValue = 0;
 }
 
+void APU::apu_lengthCounter::hashState(StateHasher & hasher) const{
+
+    hasher.add(haltFlag);
+    hasher.add(enableFlag);
+    hasher.add(counterValue);
+}
+
 void APU::apu_lengthCounter::clock(){
 
     if(counterValue > 0 && !haltFlag)
@@ -308,6 +469,16 @@ void APU::apu_envelope::reset(){
     dividerPeriodReloadValue = 0;
 }
 
+void APU::apu_envelope::hashState(StateHasher & hasher) const{
+
+    hasher.add(decayLevelCounter);
+    hasher.add(divider);
+    hasher.add(startFlag);
+    hasher.add(loopFlag);
+    hasher.add(constantVolumeFlag);
+    hasher.add(dividerPeriodReloadValue);
+}
+
 void APU::apu_envelope::setStart(bool value){
     startFlag = value;
 }
@@ -375,6 +546,24 @@ void APU::apu_pulse::reset(){
     phaseIndex = 0;
 }
 
+void APU::apu_pulse::hashState(StateHasher & hasher) const{
+
+    hasher.add(sequencerPos);
+    hasher.add(timer);
+    hasher.add(timerPeriod);
+    hasher.add(dutyCycle);
+    envelope.hashState(hasher);
+    lengthCounter.hashState(hasher);
+    hasher.add(useTwosComplement);
+    hasher.add(sweepReload);
+    hasher.add(sweepEnabled);
+    hasher.add(sweepNegate);
+    hasher.add(sweepShiftCount);
+    hasher.add(sweepPeriod);
+    hasher.add(sweepCounter);
+    hasher.add(targetPeriod);
+}
+
 void APU::apu_pulse::setupSweep(uint8_t value){
 
     sweepEnabled = value & 0x80;
@@ -416,20 +605,15 @@ void APU::apu_pulse::updateTargetPeriod(){
     }
 }
 
-void APU::apu_pulse::clock(){
+bool APU::apu_pulse::clock(uint32_t cycles){
 
     // Timer clocking.
-    if(timer == 0){
-        timer = timerPeriod;
+    uint32_t reloads = advanceTimer(timer, timerPeriod, cycles);
 
-        // Sequencer clocking.
-        if(sequencerPos >= 7)
-            sequencerPos = 0;
-        else
-            sequencerPos++;
-    } else {
-        timer--;
-    }
+    // Sequencer clocking.
+    sequencerPos = (sequencerPos + reloads) % 8;
+
+    return reloads > 0;
 }
 
 uint8_t APU::apu_pulse::output(){
@@ -438,7 +622,7 @@ uint8_t APU::apu_pulse::output(){
             ((sequences[dutyCycle] << sequencerPos) & 0x80) == 0 ||
             targetPeriod > 0x7FF ||
             lengthCounter.counterValue == 0 ||
-            timer < 8
+            timerPeriod < 8
             )
         return 0;
     else{
@@ -456,25 +640,35 @@ void APU::apu_noise::reset(){
     modeFlag = false;
 }
 
+void APU::apu_noise::hashState(StateHasher & hasher) const{
+
+    hasher.add(periodIndex);
+    hasher.add(timer);
+    hasher.add(shiftRegister);
+    envelope.hashState(hasher);
+    lengthCounter.hashState(hasher);
+    hasher.add(modeFlag);
+}
+
 void APU::apu_noise::setPeriod(uint8_t bits){
 
     periodIndex = bits & 0xF; // Max index is 15.
     timer = periods[periodIndex];
 }
 
-void APU::apu_noise::clock(){
+bool APU::apu_noise::clock(uint32_t cycles){
 
-    if(timer == 0){
-        timer = periods[periodIndex];
+    uint32_t reloads = advanceTimer(timer, periods[periodIndex], cycles);
 
-        // Shift register clock.
+    // Shift register clock.
+    for(uint32_t i = 0; i < reloads; i++){
         uint16_t feedback = ((shiftRegister & 0x1) ^ (( shiftRegister >> (1 + (modeFlag * 5)) ) & 0x1)) & 0x1;
         shiftRegister >>= 1;
         shiftRegister &= 0x3FFF;
         shiftRegister |= (uint16_t)feedback << 14;
-    } else {
-        timer--;
     }
+
+    return reloads > 0;
 }
 
 uint8_t APU::apu_noise::output() const{
@@ -493,3 +687,12 @@ void APU::apu_triangle::reset(){
     envelope.reset();
     lengthCounter.reset();
 }
+
+void APU::apu_triangle::hashState(StateHasher & hasher) const{
+
+    hasher.add(timerPeriod);
+    hasher.add(timer);
+    hasher.add(linearCounter);
+    envelope.hashState(hasher);
+    lengthCounter.hashState(hasher);
+}
@@ -0,0 +1,122 @@
+#include <limits>
+#include <algorithm>
+#include "components/APUSynthesizer.h"
+
+APUSynthesizer::APUSynthesizer(uint32_t clockRate, uint32_t sampleRate)
+    : m_clockRate(clockRate), m_sampleRate(sampleRate) {
+
+    m_apu.init();
+    m_thread = std::thread(&APUSynthesizer::run, this);
+}
+
+APUSynthesizer::APUSynthesizer(uint32_t clockRate, uint32_t sampleRate, const APU & state, uint64_t timestamp)
+    : m_clockRate(clockRate), m_sampleRate(sampleRate), m_time(timestamp) {
+
+    m_apu.init();
+    m_apu.copyState(state);
+    m_samplesRendered = timestamp * m_sampleRate / m_clockRate;
+    m_thread = std::thread(&APUSynthesizer::run, this);
+}
+
+APUSynthesizer::~APUSynthesizer() {
+
+    m_stop = true;
+    // Wake up the thread.
+    m_time.store(std::numeric_limits<uint64_t>::max());
+    m_time.notify_one();
+
+    if(m_thread.joinable())
+        m_thread.join();
+}
+
+void APUSynthesizer::run() {
+
+    auto apuBus = m_apu.getConnector("cpuBus").lock()->getDataInterface();
+
+    // The time may be published before the thread starts, so it is processed first and waited for afterwards.
+    while(true) {
+
+        uint64_t time = m_time.load(std::memory_order_acquire);
+        if(m_stop)
+            break;
+
+        // Replay the writes which already happened.
+        while(const RegisterWrite * write = m_writes.front()) {
+
+            if(write->timestamp > time)
+                break;
+
+            renderUntil(write->timestamp);
+            apuBus.write(write->address, write->data);
+
+            RegisterWrite done;
+            m_writes.pop(done);
+        }
+
+        renderUntil(time);
+        m_time.wait(time);
+    }
+}
+
+void APUSynthesizer::renderUntil(uint64_t time) {
+
+    uint64_t samplesDue = time * m_sampleRate / m_clockRate;
+    float block[BLOCK_SIZE];
+
+    while(m_samplesRendered < samplesDue) {
+
+        size_t count = std::min<uint64_t>(BLOCK_SIZE, samplesDue - m_samplesRendered);
+        m_apu.render(block, count, m_clockRate, m_sampleRate);
+        m_samplesRendered += count;
+
+        for(size_t i = 0; i < count; i++)
+            if(!m_samples.push(block[i]))
+                m_overruns++;
+    }
+}
+
+void APUSynthesizer::write(uint64_t timestamp, uint16_t address, uint8_t data) {
+
+    // Writes can't be dropped, wait for the synthesizer to catch up.
+    while(!m_writes.push({.timestamp = timestamp, .address = address, .data = data})) {
+        sync(timestamp);
+        std::this_thread::yield();
+    }
+}
+
+void APUSynthesizer::sync(uint64_t timestamp) {
+
+    m_time.store(timestamp, std::memory_order_release);
+    m_time.notify_one();
+}
+
+float APUSynthesizer::nextSample() {
+
+    // Wait for the latency buffer to fill up.
+    if(!m_outputStarted) {
+        if(m_samples.size() < OUTPUT_LATENCY)
+            return m_lastSample;
+        m_outputStarted = true;
+    }
+
+    // Sample consumption rate differs slightly from the emulation (see Sound rate control), skip a sample if too far behind.
+    if(m_samples.size() > 2 * OUTPUT_LATENCY)
+        m_samples.pop(m_lastSample);
+
+    if(!m_samples.pop(m_lastSample))
+        m_underruns++;
+
+    return m_lastSample;
+}
+
+size_t APUSynthesizer::availableSamples() const {
+    return m_samples.size();
+}
+
+uint64_t APUSynthesizer::getUnderruns() const {
+    return m_underruns;
+}
+
+uint64_t APUSynthesizer::getOverruns() const {
+    return m_overruns;
+}
@@ -0,0 +1,470 @@
+#include <cctype>
+#include <stdexcept>
+#include "imgui.h"
+#include "components/Breakpoints.h"
+
+namespace {
+
+    using OP = Breakpoints::Condition::OP;
+    using Instruction = Breakpoints::Condition::Instruction;
+
+    /// Recursive descent compiler of the condition expressions.
+    class Compiler {
+
+        struct Operator {
+            const char * token;
+            OP op;
+        };
+
+        /// Binary operators by precedence, from the lowest.
+        static constexpr size_t LEVELS = 8;
+        static constexpr Operator OPERATORS[LEVELS][4] = {
+            {{"||", OP::OR}},
+            {{"&&", OP::AND}},
+            {{"|", OP::BIT_OR}},
+            {{"^", OP::BIT_XOR}},
+            {{"&", OP::BIT_AND}},
+            {{"==", OP::EQ}, {"!=", OP::NE}},
+            {{"<=", OP::LE}, {">=", OP::GE}, {"<", OP::LT}, {">", OP::GT}},
+            {{"+", OP::ADD}, {"-", OP::SUB}}
+        };
+
+        const std::string & m_source;
+        size_t m_position = 0;
+        std::vector<Instruction> & m_code;
+        size_t m_depth = 0;
+
+        [[noreturn]] void fail(const std::string & message) const {
+            throw std::invalid_argument("Condition error at " + std::to_string(m_position + 1) + ": " + message);
+        }
+
+        void skipSpaces() {
+            while(m_position < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_position])))
+                m_position++;
+        }
+
+        /// Consume a token if it follows.
+        bool accept(const char * token) {
+
+            skipSpaces();
+            size_t length = std::char_traits<char>::length(token);
+            if(m_source.compare(m_position, length, token) != 0)
+                return false;
+
+            // Don't split the longer operators (& vs &&, | vs ||).
+            if(length == 1 && (token[0] == '&' || token[0] == '|')
+               && m_position + 1 < m_source.size() && m_source[m_position + 1] == token[0])
+                return false;
+
+            m_position += length;
+            return true;
+        }
+
+        void emit(OP op, int32_t operand = 0) {
+
+            switch(op) {
+                case OP::PUSH: case OP::A: case OP::X: case OP::Y: case OP::P: case OP::SP: case OP::PC:
+                case OP::ADDR: case OP::VALUE:
+                    if(++m_depth > Breakpoints::Condition::MAX_STACK)
+                        fail("expression too complex");
+                    break;
+                case OP::PEEK: case OP::NOT: case OP::INVERT: case OP::NEGATE:
+                    break;
+                default:
+                    m_depth--;
+                    break;
+            }
+
+            m_code.push_back({op, operand});
+        }
+
+        void number() {
+
+            int base = 10;
+            if(m_source[m_position] == '$') {
+                base = 16;
+                m_position++;
+            } else if(m_source[m_position] == '%') {
+                base = 2;
+                m_position++;
+            } else if(m_source.compare(m_position, 2, "0x") == 0 || m_source.compare(m_position, 2, "0X") == 0) {
+                base = 16;
+                m_position += 2;
+            }
+
+            size_t start = m_position;
+            int32_t value = 0;
+            while(m_position < m_source.size()) {
+                char c = static_cast<char>(std::toupper(static_cast<unsigned char>(m_source[m_position])));
+                int digit = std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : (c >= 'A' && c <= 'F' ? c - 'A' + 10 : base);
+                if(digit >= base)
+                    break;
+                value = value * base + digit;
+                if(value > 0xFFFF)
+                    fail("number out of range");
+                m_position++;
+            }
+
+            if(start == m_position)
+                fail("number expected");
+
+            emit(OP::PUSH, value);
+        }
+
+        void identifier() {
+
+            size_t start = m_position;
+            std::string name;
+            while(m_position < m_source.size() && std::isalpha(static_cast<unsigned char>(m_source[m_position])))
+                name += static_cast<char>(std::toupper(static_cast<unsigned char>(m_source[m_position++])));
+
+            const std::pair<const char *, OP> registers[] = {
+                {"A", OP::A}, {"X", OP::X}, {"Y", OP::Y}, {"P", OP::P}, {"SP", OP::SP}, {"PC", OP::PC},
+                {"ADDR", OP::ADDR}, {"VALUE", OP::VALUE}
+            };
+            for(auto & [registerName, op] : registers)
+                if(name == registerName) {
+                    emit(op);
+                    return;
+                }
+
+            m_position = start;
+            fail("unknown name " + name);
+        }
+
+        void primary() {
+
+            skipSpaces();
+            if(m_position >= m_source.size())
+                fail("value expected");
+
+            if(accept("(")) {
+                expression(0);
+                if(!accept(")"))
+                    fail("')' expected");
+            } else if(accept("[")) {
+                expression(0);
+                if(!accept("]"))
+                    fail("']' expected");
+                emit(OP::PEEK);
+            } else if(std::isalpha(static_cast<unsigned char>(m_source[m_position]))) {
+                identifier();
+            } else {
+                number();
+            }
+        }
+
+        void unary() {
+
+            if(accept("!")) {
+                unary();
+                emit(OP::NOT);
+            } else if(accept("~")) {
+                unary();
+                emit(OP::INVERT);
+            } else if(accept("-")) {
+                unary();
+                emit(OP::NEGATE);
+            } else {
+                primary();
+            }
+        }
+
+        void expression(size_t level) {
+
+            if(level == LEVELS) {
+                unary();
+                return;
+            }
+
+            expression(level + 1);
+            for(bool found = true; found;) {
+                found = false;
+                for(auto & [token, op] : OPERATORS[level]) {
+                    if(token && accept(token)) {
+                        expression(level + 1);
+                        emit(op);
+                        found = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+    public:
+        Compiler(const std::string & source, std::vector<Instruction> & code)
+            : m_source(source), m_code(code) {}
+
+        void compile() {
+
+            expression(0);
+            skipSpaces();
+            if(m_position != m_source.size())
+                fail("unexpected character");
+        }
+    };
+}
+
+Breakpoints::Condition::Condition(const std::string & expression) {
+
+    // Whitespace only is the same as no condition.
+    if(expression.find_first_not_of(" \t") == std::string::npos)
+        return;
+
+    Compiler(expression, m_code).compile();
+}
+
+bool Breakpoints::Condition::evaluate(const Context & context, const PeekFunction & peek) const {
+
+    if(m_code.empty())
+        return true;
+
+    int32_t stack[MAX_STACK];
+    size_t top = 0;
+
+    for(const Instruction & instruction : m_code) {
+
+        int32_t * operand = top ? &stack[top - 1] : nullptr;
+
+        switch(instruction.op) {
+            case OP::PUSH:    stack[top++] = instruction.operand; break;
+            case OP::A:       stack[top++] = context.a; break;
+            case OP::X:       stack[top++] = context.x; break;
+            case OP::Y:       stack[top++] = context.y; break;
+            case OP::P:       stack[top++] = context.p; break;
+            case OP::SP:      stack[top++] = context.sp; break;
+            case OP::PC:      stack[top++] = context.pc; break;
+            case OP::ADDR:    stack[top++] = context.address; break;
+            case OP::VALUE:   stack[top++] = context.value; break;
+            case OP::PEEK:    *operand = peek(static_cast<uint16_t>(*operand)); break;
+            case OP::NOT:     *operand = !*operand; break;
+            case OP::INVERT:  *operand = ~*operand; break;
+            case OP::NEGATE:  *operand = -*operand; break;
+            default: {
+                int32_t right = stack[--top];
+                int32_t & left = stack[top - 1];
+                switch(instruction.op) {
+                    case OP::ADD:     left = left + right; break;
+                    case OP::SUB:     left = left - right; break;
+                    case OP::LT:      left = left < right; break;
+                    case OP::LE:      left = left <= right; break;
+                    case OP::GT:      left = left > right; break;
+                    case OP::GE:      left = left >= right; break;
+                    case OP::EQ:      left = left == right; break;
+                    case OP::NE:      left = left != right; break;
+                    case OP::BIT_AND: left = left & right; break;
+                    case OP::BIT_XOR: left = left ^ right; break;
+                    case OP::BIT_OR:  left = left | right; break;
+                    case OP::AND:     left = left && right; break;
+                    case OP::OR:      left = left || right; break;
+                    default: break;
+                }
+                break;
+            }
+        }
+    }
+
+    return stack[0] != 0;
+}
+
+bool Breakpoints::Condition::empty() const {
+    return m_code.empty();
+}
+
+const std::vector<Breakpoints::Condition::Instruction> & Breakpoints::Condition::getCode() const {
+    return m_code;
+}
+
+void Breakpoints::update() {
+
+    m_pages.fill(0);
+    m_types = 0;
+
+    for(auto & breakpoint : m_breakpoints) {
+        if(!breakpoint.enabled)
+            continue;
+
+        for(unsigned int page = breakpoint.from >> 8; page <= static_cast<unsigned int>(breakpoint.to >> 8); page++)
+            m_pages[page] |= breakpoint.types;
+        m_types |= breakpoint.types;
+    }
+}
+
+size_t Breakpoints::add(uint16_t from, uint16_t to, uint8_t types, const std::string & expression) {
+
+    if(from > to)
+        throw std::invalid_argument("Breakpoint range is empty.");
+    if(!types || (types & ~(EXECUTE | READ | WRITE)))
+        throw std::invalid_argument("Invalid breakpoint type.");
+
+    m_breakpoints.push_back({
+        .from = from, .to = to, .types = types,
+        .expression = expression, .condition = Condition(expression),
+        .enabled = true, .hits = 0
+    });
+    update();
+
+    return m_breakpoints.size() - 1;
+}
+
+void Breakpoints::remove(size_t index) {
+
+    if(index >= m_breakpoints.size())
+        throw std::out_of_range("No such breakpoint.");
+
+    m_breakpoints.erase(m_breakpoints.begin() + static_cast<std::ptrdiff_t>(index));
+    update();
+}
+
+void Breakpoints::setEnabled(size_t index, bool enabled) {
+
+    m_breakpoints.at(index).enabled = enabled;
+    update();
+}
+
+void Breakpoints::clear() {
+
+    m_breakpoints.clear();
+    update();
+}
+
+const std::vector<Breakpoints::Breakpoint> & Breakpoints::getBreakpoints() const {
+    return m_breakpoints;
+}
+
+bool Breakpoints::check(TYPE type, const Context & context, const PeekFunction & peek) {
+
+    for(size_t i = 0; i < m_breakpoints.size(); i++) {
+
+        Breakpoint & breakpoint = m_breakpoints[i];
+        if(!breakpoint.enabled || !(breakpoint.types & type)
+           || context.address < breakpoint.from || context.address > breakpoint.to
+           || !breakpoint.condition.evaluate(context, peek))
+            continue;
+
+        breakpoint.hits++;
+        m_hit = true;
+        m_lastHit = {.index = i, .type = type, .address = context.address, .value = context.value};
+        return true;
+    }
+
+    return false;
+}
+
+void Breakpoints::clearHit() {
+    m_hit = false;
+}
+
+const Breakpoints::Hit & Breakpoints::getLastHit() const {
+    return m_lastHit;
+}
+
+bool Breakpoints::drawGUI() {
+
+    bool changed = false;
+
+    if(m_hit) {
+        const Breakpoint * breakpoint = m_lastHit.index < m_breakpoints.size() ? &m_breakpoints[m_lastHit.index] : nullptr;
+        const char * type = m_lastHit.type == EXECUTE ? "Execution" : (m_lastHit.type == READ ? "Read" : "Write");
+        ImGui::Text("%s breakpoint #%zu hit at $%04X (value $%02X)%s%s",
+                    type, m_lastHit.index, m_lastHit.address, m_lastHit.value,
+                    breakpoint && !breakpoint->expression.empty() ? ", condition: " : "",
+                    breakpoint ? breakpoint->expression.c_str() : "");
+    }
+
+    ImGui::SeparatorText("New breakpoint");
+    ImGui::SetNextItemWidth(60);
+    ImGui::InputText("From", m_guiFrom, sizeof(m_guiFrom), ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(60);
+    ImGui::InputText("To (optional)", m_guiTo, sizeof(m_guiTo), ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::Checkbox("Execute", &m_guiTypes[0]);
+    ImGui::SameLine();
+    ImGui::Checkbox("Read", &m_guiTypes[1]);
+    ImGui::SameLine();
+    ImGui::Checkbox("Write", &m_guiTypes[2]);
+    ImGui::InputText("Condition", m_guiCondition, sizeof(m_guiCondition));
+
+    if(ImGui::Button("Add")) {
+        try {
+            size_t parsed;
+            unsigned long from = std::stoul(m_guiFrom, &parsed, 16);
+            unsigned long to = m_guiTo[0] ? std::stoul(m_guiTo, &parsed, 16) : from;
+            if(from > 0xFFFF || to > 0xFFFF)
+                throw std::invalid_argument("Address out of range.");
+
+            uint8_t types = (m_guiTypes[0] ? EXECUTE : 0) | (m_guiTypes[1] ? READ : 0) | (m_guiTypes[2] ? WRITE : 0);
+            add(static_cast<uint16_t>(from), static_cast<uint16_t>(to), types, m_guiCondition);
+            m_guiStatus.clear();
+            changed = true;
+        } catch(std::invalid_argument & e) {
+            m_guiStatus = m_guiFrom[0] ? e.what() : "Address expected.";
+        } catch(std::out_of_range &) {
+            m_guiStatus = "Address out of range.";
+        }
+    }
+    ImGui::SameLine();
+    if(ImGui::Button("Remove all")) {
+        clear();
+        changed = true;
+    }
+    if(!m_guiStatus.empty())
+        ImGui::Text("%s", m_guiStatus.c_str());
+
+    if(ImGui::BeginTable("breakpoints", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+
+        ImGui::TableSetupColumn("On");
+        ImGui::TableSetupColumn("Range");
+        ImGui::TableSetupColumn("Type");
+        ImGui::TableSetupColumn("Condition");
+        ImGui::TableSetupColumn("Hits");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        for(size_t i = 0; i < m_breakpoints.size(); i++) {
+
+            Breakpoint & breakpoint = m_breakpoints[i];
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            bool enabled = breakpoint.enabled;
+            if(ImGui::Checkbox("##enabled", &enabled)) {
+                setEnabled(i, enabled);
+                changed = true;
+            }
+
+            ImGui::TableNextColumn();
+            if(breakpoint.from == breakpoint.to)
+                ImGui::Text("$%04X", breakpoint.from);
+            else
+                ImGui::Text("$%04X-$%04X", breakpoint.from, breakpoint.to);
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%c%c%c",
+                        breakpoint.types & EXECUTE ? 'X' : '-',
+                        breakpoint.types & READ ? 'R' : '-',
+                        breakpoint.types & WRITE ? 'W' : '-');
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(breakpoint.expression.c_str());
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)breakpoint.hits);
+
+            ImGui::TableNextColumn();
+            bool removed = ImGui::SmallButton("Remove");
+            ImGui::PopID();
+
+            if(removed) {
+                remove(i);
+                changed = true;
+                break;
+            }
+        }
+
+        ImGui::EndTable();
+    }
+
+    return changed;
+}
@@ -4,8 +4,10 @@
 
 #include "imgui.h"
 #include "components/Bus.h"
+#include "Profiler.h"
 
-Bus::Bus(int portCount, int addrWidth, int dataWidth) : m_devices(portCount) {
+Bus::Bus(int portCount, int addrWidth, int dataWidth, ARBITRATION arbitration)
+    : m_arbitration(arbitration), m_devices(portCount) {
 
     if(addrWidth < 0 || addrWidth > 32)
         throw std::invalid_argument("Address width not in range [0,32].");
@@ -19,39 +21,86 @@ Bus::Bus(int portCount, int addrWidth, int dataWidth) : m_devices(portCount) {
 
     m_deviceName = "Bus";
 
-    Connector masterConnector(
-        DataInterface{
-            .read = [&](uint32_t address, uint32_t & buffer) {
+    m_connectors["master"] = std::make_shared<Connector>(masterInterface<NoHooks>());
 
-                for(auto & device : m_devices)
-                    if(device.readConfirmed(address & m_addrMask, buffer)) {
-                        buffer &= m_dataMask;
+    for(size_t i = 0; i < m_devices.size(); i++)
+        m_ports["slot " + std::to_string(i)] = &m_devices[i];
 
-                        m_lastAccess = lastAccess::READ;
-                        m_lastAddress = address & m_addrMask;
-                        m_lastData = buffer;
-                        return true;
-                    }
+}
 
-                return false;
-            },
-            .write = [&](uint32_t address, uint32_t data) {
+template<class Hooks>
+DataInterface Bus::masterInterface() {
 
-                for(auto & device : m_devices)
-                    device.write(address & m_addrMask, data & m_dataMask);
+    return {
+        .read = [this](uint32_t address, uint32_t & buffer) {
+
+            USE_PROFILE_SCOPE("Bus read");
+            address &= m_addrMask;
+
+            if(m_arbitration == ARBITRATION::MERGE) {
+
+                // All the responding devices drive the data lines at once.
+                uint32_t merged = 0;
+                int responder = -1;
+                for(size_t i = 0; i < m_devices.size(); i++) {
+                    uint32_t data;
+                    if(m_devices[i].readConfirmed(address, data)) {
+                        merged |= data;
+                        if(responder < 0)
+                            responder = static_cast<int>(i);
+                    }
+                }
 
-                m_lastAccess = lastAccess::WRITE;
-                m_lastAddress = address & m_addrMask;
-                m_lastData = data & m_dataMask;
+                if(responder >= 0)
+                    buffer = merged & m_dataMask;
+                if constexpr(Hooks::ENABLED)
+                    m_statistics->recordRead(address, buffer, responder);
+                return responder >= 0;
             }
+
+            for(size_t i = 0; i < m_devices.size(); i++)
+                if(m_devices[i].readConfirmed(address, buffer)) {
+                    buffer &= m_dataMask;
+                    if constexpr(Hooks::ENABLED)
+                        m_statistics->recordRead(address, buffer, static_cast<int>(i));
+                    return true;
+                }
+
+            if constexpr(Hooks::ENABLED)
+                m_statistics->recordRead(address, buffer, -1);
+            return false;
+        },
+        .write = [this](uint32_t address, uint32_t data) {
+
+            USE_PROFILE_SCOPE("Bus write");
+            address &= m_addrMask;
+            data &= m_dataMask;
+            for(auto & device : m_devices)
+                device.write(address, data);
+
+            if constexpr(Hooks::ENABLED)
+                m_statistics->recordWrite(address, data);
         }
-    );
+    };
+}
 
-    m_connectors["master"] = std::make_shared<Connector>(masterConnector);
+void Bus::setStatisticsEnabled(bool enabled) {
 
-    for(size_t i = 0; i < m_devices.size(); i++)
-        m_ports["slot " + std::to_string(i)] = &m_devices[i];
+    if(enabled) {
+        m_statistics = std::make_unique<BusStatistics>(static_cast<uint64_t>(m_addrMask) + 1, m_devices.size());
+        m_connectors["master"]->setInterface(masterInterface<DebugHooks>());
+    } else {
+        m_connectors["master"]->setInterface(masterInterface<NoHooks>());
+        m_statistics.reset();
+    }
+}
+
+bool Bus::isStatisticsEnabled() const {
+    return m_statistics != nullptr;
+}
 
+const BusStatistics * Bus::getStatistics() const {
+    return m_statistics.get();
 }
 
 void Bus::init() {
@@ -67,24 +116,27 @@ std::vector<EmulatorWindow> Bus::getGUIs() {
         ImGui::Text("Address mask: 0x%x", m_addrMask);
         ImGui::Text("Data mask: 0x%x", m_dataMask);
         ImGui::Text("Connected devices: %lu", m_devices.size());
+        ImGui::Text("Read arbitration: %s", m_arbitration == ARBITRATION::MERGE ? "merged (OR)" : "first device");
         ImGui::Separator();
-        ImGui::Text("Last access");
-        if(m_lastAccess != lastAccess::NONE) {
 
-            ImGui::Text("Type: ");
-            ImGui::SameLine();
-            switch (m_lastAccess) {
-                case lastAccess::READ: ImGui::Text("read"); break;
-                case lastAccess::WRITE: ImGui::Text("write"); break;
-                default: ImGui::Text("unknown"); break;
-            }
+        bool enabled = isStatisticsEnabled();
+        if(ImGui::Checkbox("Collect statistics", &enabled))
+            setStatisticsEnabled(enabled);
 
-            ImGui::Text("At address: 0x%x", m_lastAddress);
-            ImGui::Text("Data: 0x%x", m_lastData);
-        } else {
-            ImGui::Text("There was no operation on the bus.");
+        if(m_statistics) {
+            ImGui::SameLine();
+            if(ImGui::Button("Reset"))
+                m_statistics->reset();
+            m_statistics->drawSummary();
         }
+    };
+
+    std::function<void(void)> heatmap = [this](){
 
+        if(m_statistics)
+            m_statistics->drawHeatmap();
+        else
+            ImGui::Text("Enable the statistics collection in the bus debugger.");
     };
 
     return {
@@ -94,6 +146,13 @@ std::vector<EmulatorWindow> Bus::getGUIs() {
                     .id    = getDeviceID(),
                     .dock  = DockSpace::LEFT,
                     .guiFunction = debugger
+            },
+            EmulatorWindow{
+                    .category = m_deviceName,
+                    .title = "Heatmap",
+                    .id    = getDeviceID(),
+                    .dock  = DockSpace::MAIN,
+                    .guiFunction = heatmap
             }
     };
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "imgui.h"
+#include "components/BusStatistics.h"
+
+BusStatistics::BusStatistics(uint64_t addressSpaceSize, size_t deviceCount)
+    : m_reads(std::min<uint64_t>(addressSpaceSize, MAX_TRACKED_ADDRESSES)),
+      m_writes(std::min<uint64_t>(addressSpaceSize, MAX_TRACKED_ADDRESSES)),
+      m_deviceReads(deviceCount) {}
+
+void BusStatistics::reset() {
+
+    std::fill(m_reads.begin(), m_reads.end(), 0);
+    std::fill(m_writes.begin(), m_writes.end(), 0);
+    std::fill(m_deviceReads.begin(), m_deviceReads.end(), 0);
+    m_unclaimedReads = 0;
+    m_totalReads = 0;
+    m_totalWrites = 0;
+    m_untrackedAccesses = 0;
+    m_lastAccess = {};
+}
+
+size_t BusStatistics::getTrackedSize() const {
+    return m_reads.size();
+}
+
+size_t BusStatistics::getPageCount() const {
+    return (m_reads.size() + PAGE_SIZE - 1) / PAGE_SIZE;
+}
+
+uint64_t BusStatistics::getReads(uint32_t address) const {
+    return address < m_reads.size() ? m_reads[address] : 0;
+}
+
+uint64_t BusStatistics::getWrites(uint32_t address) const {
+    return address < m_writes.size() ? m_writes[address] : 0;
+}
+
+uint64_t BusStatistics::getPageReads(uint32_t page) const {
+
+    size_t from = std::min<size_t>(static_cast<size_t>(page) * PAGE_SIZE, m_reads.size());
+    size_t to = std::min<size_t>(from + PAGE_SIZE, m_reads.size());
+    return std::accumulate(m_reads.begin() + from, m_reads.begin() + to, uint64_t{0});
+}
+
+uint64_t BusStatistics::getPageWrites(uint32_t page) const {
+
+    size_t from = std::min<size_t>(static_cast<size_t>(page) * PAGE_SIZE, m_writes.size());
+    size_t to = std::min<size_t>(from + PAGE_SIZE, m_writes.size());
+    return std::accumulate(m_writes.begin() + from, m_writes.begin() + to, uint64_t{0});
+}
+
+uint64_t BusStatistics::getDeviceReads(size_t device) const {
+    return m_deviceReads.at(device);
+}
+
+uint64_t BusStatistics::getUnclaimedReads() const {
+    return m_unclaimedReads;
+}
+
+uint64_t BusStatistics::getTotalReads() const {
+    return m_totalReads;
+}
+
+uint64_t BusStatistics::getTotalWrites() const {
+    return m_totalWrites;
+}
+
+uint64_t BusStatistics::getUntrackedAccesses() const {
+    return m_untrackedAccesses;
+}
+
+const BusStatistics::LastAccess & BusStatistics::getLastAccess() const {
+    return m_lastAccess;
+}
+
+void BusStatistics::drawSummary() const {
+
+    ImGui::Text("Last access");
+    if(m_lastAccess.type != ACCESS::NONE) {
+        ImGui::Text("Type: %s", m_lastAccess.type == ACCESS::READ ? "read" : "write");
+        ImGui::Text("At address: 0x%x", m_lastAccess.address);
+        ImGui::Text("Data: 0x%x", m_lastAccess.data);
+    } else {
+        ImGui::Text("There was no operation on the bus.");
+    }
+
+    ImGui::SeparatorText("Totals");
+    ImGui::Text("Reads: %llu, writes: %llu", (unsigned long long)m_totalReads, (unsigned long long)m_totalWrites);
+    if(m_untrackedAccesses)
+        ImGui::Text("Out of the tracked range: %llu", (unsigned long long)m_untrackedAccesses);
+
+    ImGui::SeparatorText("Device read hits");
+    double total = m_totalReads ? static_cast<double>(m_totalReads) : 1.0;
+    for(size_t i = 0; i < m_deviceReads.size(); i++)
+        ImGui::Text("Slot %zu: %llu (%.1f %%)", i, (unsigned long long)m_deviceReads[i], 100.0 * m_deviceReads[i] / total);
+    ImGui::Text("Open bus: %llu (%.1f %%)", (unsigned long long)m_unclaimedReads, 100.0 * m_unclaimedReads / total);
+
+    // Hottest pages by total accesses.
+    ImGui::SeparatorText("Hottest pages");
+    std::vector<std::pair<uint64_t, uint32_t>> pages;
+    for(uint32_t page = 0; page < getPageCount(); page++) {
+        uint64_t accesses = getPageReads(page) + getPageWrites(page);
+        if(accesses)
+            pages.emplace_back(accesses, page);
+    }
+    size_t shown = std::min<size_t>(pages.size(), 16);
+    std::partial_sort(pages.begin(), pages.begin() + shown, pages.end(), std::greater<>());
+
+    if(ImGui::BeginTable("pages", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+
+        ImGui::TableSetupColumn("Page");
+        ImGui::TableSetupColumn("Reads");
+        ImGui::TableSetupColumn("Writes");
+        ImGui::TableHeadersRow();
+
+        for(size_t i = 0; i < shown; i++) {
+            uint32_t page = pages[i].second;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("$%04X", page * PAGE_SIZE);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)getPageReads(page));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)getPageWrites(page));
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+void BusStatistics::drawHeatmap() {
+
+    static const char * cellSizes[] = {"1", "4", "16", "64", "256"};
+    static const int cellSizeValues[] = {1, 4, 16, 64, 256};
+    int cellSizeIndex = static_cast<int>(std::find(std::begin(cellSizeValues), std::end(cellSizeValues), m_heatmapCellSize) - std::begin(cellSizeValues));
+
+    ImGui::RadioButton("Reads + writes", &m_heatmapMode, 0); ImGui::SameLine();
+    ImGui::RadioButton("Reads", &m_heatmapMode, 1); ImGui::SameLine();
+    ImGui::RadioButton("Writes", &m_heatmapMode, 2);
+    if(ImGui::Combo("Bytes per cell", &cellSizeIndex, cellSizes, IM_ARRAYSIZE(cellSizes)))
+        m_heatmapCellSize = cellSizeValues[cellSizeIndex];
+
+    // Sum the cells.
+    const size_t cellSize = m_heatmapCellSize;
+    const size_t cellCount = (m_reads.size() + cellSize - 1) / cellSize;
+    std::vector<uint64_t> cells(cellCount, 0);
+    for(size_t address = 0; address < m_reads.size(); address++) {
+        uint64_t & cell = cells[address / cellSize];
+        if(m_heatmapMode != 2) cell += m_reads[address];
+        if(m_heatmapMode != 1) cell += m_writes[address];
+    }
+    uint64_t maxCell = cells.empty() ? 0 : *std::max_element(cells.begin(), cells.end());
+
+    // Square-ish grid, rows of a power of two cells.
+    size_t columns = 1;
+    while(columns * columns < cellCount)
+        columns *= 2;
+    const size_t rows = (cellCount + columns - 1) / columns;
+    const float cellPixels = std::max(2.0f, 512.0f / static_cast<float>(columns));
+
+    ImDrawList * dl = ImGui::GetWindowDrawList();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const double logMax = std::log1p(static_cast<double>(maxCell));
+
+    for(size_t i = 0; i < cellCount; i++) {
+
+        // Logarithmic scale from dark blue (cold) to red (hot).
+        float heat = (cells[i] && logMax > 0) ? static_cast<float>(std::log1p(static_cast<double>(cells[i])) / logMax) : 0.0f;
+        ImColor color = cells[i] ? ImColor(heat, 0.2f * (1.0f - heat), 1.0f - heat) : ImColor(0.05f, 0.05f, 0.05f);
+
+        float x = origin.x + cellPixels * static_cast<float>(i % columns);
+        float y = origin.y + cellPixels * static_cast<float>(i / columns);
+        dl->AddRectFilled({x, y}, {x + cellPixels, y + cellPixels}, color);
+    }
+
+    ImGui::Dummy({cellPixels * static_cast<float>(columns), cellPixels * static_cast<float>(rows)});
+
+    // Cell details on hover.
+    if(ImGui::IsItemHovered()) {
+        ImVec2 mouse = ImGui::GetMousePos();
+        auto column = static_cast<size_t>((mouse.x - origin.x) / cellPixels);
+        auto row = static_cast<size_t>((mouse.y - origin.y) / cellPixels);
+        size_t cell = row * columns + column;
+        if(column < columns && cell < cellCount) {
+            uint64_t reads = 0, writes = 0;
+            for(size_t address = cell * cellSize; address < std::min((cell + 1) * cellSize, m_reads.size()); address++) {
+                reads += m_reads[address];
+                writes += m_writes[address];
+            }
+            ImGui::SetTooltip("$%04zX-$%04zX\nReads: %llu\nWrites: %llu", cell * cellSize, (cell + 1) * cellSize - 1,
+                              (unsigned long long)reads, (unsigned long long)writes);
+        }
+    }
+
+    ImGui::Text("Each row is $%04zX bytes, logarithmic color scale.", columns * cellSize);
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include "components/CodeDataLogger.h"
+
+void CodeDataLogger::resize(size_t PRGSize, size_t CHRSize) {
+
+    m_PRG.assign(PRGSize, 0);
+    m_CHR.assign(CHRSize, 0);
+}
+
+void CodeDataLogger::clear() {
+
+    std::fill(m_PRG.begin(), m_PRG.end(), 0);
+    std::fill(m_CHR.begin(), m_CHR.end(), 0);
+}
+
+std::span<const uint8_t> CodeDataLogger::getPRG() const {
+    return m_PRG;
+}
+
+std::span<const uint8_t> CodeDataLogger::getCHR() const {
+    return m_CHR;
+}
+
+CodeDataLogger::Summary CodeDataLogger::getSummary() const {
+
+    Summary summary{};
+    for(uint8_t flags : m_PRG) {
+        if(flags & CODE)
+            summary.code++;
+        if(flags & DATA)
+            summary.data++;
+        if(!(flags & (CODE | DATA)))
+            summary.unusedPRG++;
+    }
+
+    for(uint8_t flags : m_CHR) {
+        if(flags & RENDERED)
+            summary.rendered++;
+        if(flags & READ)
+            summary.read++;
+        if(!flags)
+            summary.unusedCHR++;
+    }
+
+    return summary;
+}
+
+void CodeDataLogger::save(const std::string & path) const {
+
+    std::ofstream file(path, std::ios_base::binary);
+    if(!file)
+        throw std::runtime_error("CDL file couldn't be opened!");
+
+    file.write(reinterpret_cast<const char *>(m_PRG.data()), static_cast<std::streamsize>(m_PRG.size()));
+    file.write(reinterpret_cast<const char *>(m_CHR.data()), static_cast<std::streamsize>(m_CHR.size()));
+    if(!file)
+        throw std::runtime_error("CDL file couldn't be written!");
+}
+
+void CodeDataLogger::load(const std::string & path) {
+
+    std::ifstream file(path, std::ios_base::binary);
+    if(!file)
+        throw std::runtime_error("CDL file couldn't be opened!");
+
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if(data.size() != m_PRG.size() + m_CHR.size())
+        throw std::invalid_argument("CDL file size doesn't match the ROM.");
+
+    for(size_t i = 0; i < m_PRG.size(); i++)
+        m_PRG[i] |= static_cast<uint8_t>(data[i]);
+    for(size_t i = 0; i < m_CHR.size(); i++)
+        m_CHR[i] |= static_cast<uint8_t>(data[m_PRG.size() + i]);
+}
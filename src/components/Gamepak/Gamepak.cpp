@@ -22,42 +22,28 @@ Gamepak::Gamepak() {
     m_deviceName = "Gamepak";
 
     Connector cpuConnector(DataInterface{
-        .read = [&](uint32_t address, uint32_t & buffer)-> bool {
-
-            if(m_mapper) {
-                uint8_t mapperResult;
-                bool mapperState = m_mapper->cpuRead(static_cast<uint16_t>(address), mapperResult);
-                buffer = mapperResult;
-                return mapperState;
-            } else
+        .read = [this](uint32_t address, uint32_t & buffer) {
+            uint8_t data;
+            if(!cpuRead(address, data))
                 return false;
+            buffer = data;
+            return true;
         },
-
-        .write = [&](uint32_t address, uint32_t data) {
-            if(m_mapper)
-                m_mapper->cpuWrite(static_cast<uint16_t>(address), static_cast<uint8_t>(data));
+        .write = [this](uint32_t address, uint32_t data) {
+            cpuWrite(address, data);
         }
     });
 
     Connector ppuConnector(DataInterface{
-            .read = [&](uint32_t address, uint32_t & buffer)-> bool {
-
-                if(m_mapper) {
-
-                    uint8_t mapperResult;
-                    bool mapperState = m_mapper->ppuRead(static_cast<uint16_t>(address), mapperResult);
-                    buffer = mapperResult;
-                    return mapperState;
-
-                } else {
+            .read = [this](uint32_t address, uint32_t & buffer) {
+                uint8_t data;
+                if(!ppuRead(address, data))
                     return false;
-                }
+                buffer = data;
+                return true;
             },
-
-            .write = [&](uint32_t address, uint32_t data) {
-                if(m_mapper) {
-                    m_mapper->ppuWrite(static_cast<uint16_t>(address), static_cast<uint8_t>(data));
-                }
+            .write = [this](uint32_t address, uint32_t data) {
+                ppuWrite(address, data);
             }
     });
 
@@ -73,13 +59,77 @@ void Gamepak::init(){
         m_mapper->init();
 }
 
+const PagedMemory & Gamepak::getPRGRAM() const {
+
+    static const PagedMemory empty;
+    return m_mapper ? m_mapper->getPRGRAM() : empty;
+}
+
+void Gamepak::copyState(const Gamepak & other, bool copyOnWrite) {
+
+    m_mapper.reset();
+    m_params = other.m_params;
+    m_trainer = other.m_trainer;
+    m_PRGROM = other.m_PRGROM;
+    m_CHRROM = other.m_CHRROM;
+
+    if(other.m_mapper) {
+        m_mapper = other.m_mapper->clone();
+        if(!copyOnWrite)
+            m_mapper->unshare();
+    }
+
+    // The log is not copied, it is only allocated if this gamepak logs (see setCodeDataLoggerEnabled).
+    m_codeDataLogger.resize(0, 0);
+    setCodeDataLoggerEnabled(m_codeDataLogging);
+}
+
+void Gamepak::hashState(StateHasher & hasher) const {
+
+    if(m_mapper)
+        m_mapper->hashState(hasher);
+}
+
+uint32_t Gamepak::getPRGBank(uint16_t addr) const {
+    return m_mapper ? m_mapper->getPRGBank(addr) : 0;
+}
+
+void Gamepak::setCodeDataLoggerEnabled(bool enabled) {
+
+    m_codeDataLogging = enabled;
+    if(enabled && (m_codeDataLogger.getPRG().size() != m_params.PRGROMsize
+                   || m_codeDataLogger.getCHR().size() != m_params.CHRROMsize))
+        m_codeDataLogger.resize(m_params.PRGROMsize, m_params.CHRROMsize);
+
+    if(m_mapper)
+        m_mapper->setCodeDataLogger(enabled ? &m_codeDataLogger : nullptr);
+    if(m_codeDataLoggerListener)
+        m_codeDataLoggerListener(enabled ? &m_codeDataLogger : nullptr);
+}
+
+void Gamepak::setCodeDataLoggerListener(std::function<void(CodeDataLogger *)> listener) {
+
+    m_codeDataLoggerListener = std::move(listener);
+    if(m_codeDataLoggerListener)
+        m_codeDataLoggerListener(m_codeDataLogging ? &m_codeDataLogger : nullptr);
+}
+
+bool Gamepak::isCodeDataLoggerEnabled() const {
+    return m_codeDataLogging;
+}
+
+CodeDataLogger & Gamepak::getCodeDataLogger() {
+    return m_codeDataLogger;
+}
+
 void Gamepak::load(std::ifstream & ifs){
 
     // Clear data.
     m_mapper.reset();
     m_trainer.clear();
-    m_PRGROM.clear();
-    m_CHRROM.clear();
+    // New vectors, the old ones may be shared with copies of this gamepak.
+    m_PRGROM = std::make_shared<std::vector<uint8_t>>();
+    m_CHRROM = std::make_shared<std::vector<uint8_t>>();
 
     // Init metadata to values common for all iNES file types.
     m_params.init();
@@ -224,8 +274,8 @@ void Gamepak::load(std::ifstream & ifs){
     // Load PRG ROM contents.
     // ============================================================
     if(m_params.PRGROMsize > 0) {
-        m_PRGROM.resize(m_params.PRGROMsize);
-        ifs.read((char*)m_PRGROM.data(), m_params.PRGROMsize);
+        m_PRGROM->resize(m_params.PRGROMsize);
+        ifs.read((char*)m_PRGROM->data(), m_params.PRGROMsize);
         if(!ifs || ifs.gcount() != m_params.PRGROMsize)
             throw std::runtime_error("File I/O error.");
     }
@@ -233,8 +283,8 @@ void Gamepak::load(std::ifstream & ifs){
     // Load CHR ROM contents.
     // ============================================================
     if(m_params.CHRROMsize > 0) {
-        m_CHRROM.resize(m_params.CHRROMsize);
-        ifs.read((char*)m_CHRROM.data(), m_params.CHRROMsize);
+        m_CHRROM->resize(m_params.CHRROMsize);
+        ifs.read((char*)m_CHRROM->data(), m_params.CHRROMsize);
         if(!ifs || ifs.gcount() != m_params.CHRROMsize)
             throw std::runtime_error("File I/O error.");
     }
@@ -247,13 +297,16 @@ void Gamepak::load(std::ifstream & ifs){
     // ============================================================
     switch(m_params.mapperNumber){
 
-        case 0x0000: m_mapper = std::make_unique<Mapper000>(m_PRGROM, m_CHRROM, m_params.mirroringType); break;
-        case 0x0001: m_mapper = std::make_unique<Mapper001>(m_PRGROM, m_CHRROM, m_params.PRGRAMsize); break;
+        case 0x0000: m_mapper = std::make_unique<Mapper000>(*m_PRGROM, *m_CHRROM, m_params.mirroringType); break;
+        case 0x0001: m_mapper = std::make_unique<Mapper001>(*m_PRGROM, *m_CHRROM, m_params.PRGRAMsize); break;
 
         using namespace std::literals;
         default: throw std::runtime_error("Mapper "s + std::to_string(m_params.mapperNumber) + " is not supported.");
     }
 
+    m_codeDataLogger.resize(m_params.PRGROMsize, m_params.CHRROMsize);
+    setCodeDataLoggerEnabled(m_codeDataLogging);
+
     // Get mapper's VRAM mode.
     // a) use CIRAM with fixed mirroring (soldered pad on original HW)
     // b) use CIRAM with switchable mirroring
@@ -323,6 +376,45 @@ std::vector<EmulatorWindow> Gamepak::getGUIs() {
         if(m_mapper) {
             m_mapper->drawGUI();
         }
+
+        ImGui::SeparatorText("Code/Data Logger");
+        bool logging = m_codeDataLogging;
+        if(ImGui::Checkbox("Log ROM usage", &logging))
+            setCodeDataLoggerEnabled(logging);
+        ImGui::SameLine();
+        if(ImGui::Button("Clear"))
+            m_codeDataLogger.clear();
+
+        CodeDataLogger::Summary summary = m_codeDataLogger.getSummary();
+        size_t PRGSize = m_codeDataLogger.getPRG().size(), CHRSize = m_codeDataLogger.getCHR().size();
+        ImGui::Text("PRG: %zu code, %zu data, %zu unused (%.1f %% used)",
+                    summary.code, summary.data, summary.unusedPRG,
+                    PRGSize ? 100.0 * (PRGSize - summary.unusedPRG) / PRGSize : 0.0);
+        if(CHRSize)
+            ImGui::Text("CHR: %zu rendered, %zu read, %zu unused (%.1f %% used)",
+                        summary.rendered, summary.read, summary.unusedCHR,
+                        100.0 * (CHRSize - summary.unusedCHR) / CHRSize);
+
+        ImGui::InputText("CDL file", m_codeDataLogPath, sizeof(m_codeDataLogPath));
+        if(ImGui::Button("Save")) {
+            try {
+                m_codeDataLogger.save(m_codeDataLogPath);
+                m_codeDataLogStatus = "Saved.";
+            } catch(std::exception & e) {
+                m_codeDataLogStatus = e.what();
+            }
+        }
+        ImGui::SameLine();
+        if(ImGui::Button("Load")) {
+            try {
+                m_codeDataLogger.load(m_codeDataLogPath);
+                m_codeDataLogStatus = "Loaded.";
+            } catch(std::exception & e) {
+                m_codeDataLogStatus = e.what();
+            }
+        }
+        if(!m_codeDataLogStatus.empty())
+            ImGui::Text("%s", m_codeDataLogStatus.c_str());
     };
 
     return {
@@ -5,12 +5,39 @@
  * @copyright Copyright (c) 2022 Ondrej Golasowski
  *
  */
+#include <stdexcept>
 #include "components/Gamepak/Mapper.h"
 
 void Mapper::init() {
     m_CIRAM.fill(0x00);
 }
 
+const PagedMemory & Mapper::getPRGRAM() const {
+    static const PagedMemory empty;
+    return empty;
+}
+
+std::unique_ptr<Mapper> Mapper::clone() const {
+    throw std::logic_error("The mapper can't be copied.");
+}
+
+void Mapper::unshare() {
+    m_CIRAM.unshare();
+}
+
+void Mapper::hashState(StateHasher & hasher) const {
+    hasher.add(m_mirroringType);
+    hasher.add(m_CIRAM);
+}
+
+uint32_t Mapper::getPRGBank(uint16_t /*addr*/) const {
+    return 0;
+}
+
+void Mapper::setCodeDataLogger(CodeDataLogger * logger) {
+    m_codeDataLogger = logger;
+}
+
 uint8_t Mapper::CIRAMRead(uint16_t address) {
 
     // We are interested in the bottom 12 bits, because the nametable addr range is (partially) mirrored.
@@ -33,13 +60,13 @@ uint8_t Mapper::CIRAMRead(uint16_t address) {
     if(m_mirroringType == mirroringType_t::HORIZONTAL){
 
         if(address >= 0x000 && address <= 0x3FF)
-            return m_CIRAM[address & 0x3FF];
+            return m_CIRAM.read(address & 0x3FF);
         else if(address >= 0x400 && address <= 0x7FF)
-            return m_CIRAM[address & 0x3FF];
+            return m_CIRAM.read(address & 0x3FF);
         else if(address >= 0x800 && address <= 0xBFF)
-            return m_CIRAM[0x400 + (address & 0x3FF)];
+            return m_CIRAM.read(0x400 + (address & 0x3FF));
         else if(address >= 0xC00 && address <= 0xFFF)
-            return m_CIRAM[0x400 + (address & 0x3FF)];
+            return m_CIRAM.read(0x400 + (address & 0x3FF));
 
     // Vertical mirroring
     // A | B
@@ -48,27 +75,27 @@ uint8_t Mapper::CIRAMRead(uint16_t address) {
     } else if(m_mirroringType == mirroringType_t::VERTICAL) {
 
         if(address >= 0x000 && address <= 0x3FF)
-            return m_CIRAM[address & 0x3FF];
+            return m_CIRAM.read(address & 0x3FF);
         else if(address >= 0x400 && address <= 0x7FF)
-            return m_CIRAM[0x400 + (address & 0x3FF)];
+            return m_CIRAM.read(0x400 + (address & 0x3FF));
         else if(address >= 0x800 && address <= 0xBFF)
-            return m_CIRAM[address & 0x3FF];
+            return m_CIRAM.read(address & 0x3FF);
         else if(address >= 0xC00 && address <= 0xFFF)
-            return m_CIRAM[0x400 + (address & 0x3FF)];
+            return m_CIRAM.read(0x400 + (address & 0x3FF));
 
     // One screen low.
     // A | A
     // --+--
     // A | A
     } else if(m_mirroringType == mirroringType_t::SINGLE_LO){
-        return m_CIRAM[address & 0x3FF];
+        return m_CIRAM.read(address & 0x3FF);
 
     // One screen high.
     // B | B
     // --+--
     // B | B
     } else if(m_mirroringType == mirroringType_t::SINGLE_HI){
-        return m_CIRAM[0x400 + (address & 0x3FF)];
+        return m_CIRAM.read(0x400 + (address & 0x3FF));
     }
 
     return 0x00;
@@ -82,32 +109,32 @@ void Mapper::CIRAMWrite(uint16_t address, uint8_t data) {
     if(m_mirroringType == mirroringType_t::HORIZONTAL){
 
         if(address >= 0x000 && address <= 0x3FF)
-            m_CIRAM[address & 0x3FF] = data;
+            m_CIRAM.write(address & 0x3FF, data);
         else if(address >= 0x400 && address <= 0x7FF)
-            m_CIRAM[address & 0x3FF] = data;
+            m_CIRAM.write(address & 0x3FF, data);
         else if(address >= 0x800 && address <= 0xBFF)
-            m_CIRAM[0x400 + (address & 0x3FF)] = data;
+            m_CIRAM.write(0x400 + (address & 0x3FF), data);
         else if(address >= 0xC00 && address <= 0xFFF)
-            m_CIRAM[0x400 + (address & 0x3FF)]  = data;
+            m_CIRAM.write(0x400 + (address & 0x3FF), data);
 
     // Vertical mirroring.
     } else if(m_mirroringType == mirroringType_t::VERTICAL) {
 
         if(address >= 0x000 && address <= 0x3FF)
-            m_CIRAM[address & 0x3FF] = data;
+            m_CIRAM.write(address & 0x3FF, data);
         else if(address >= 0x400 && address <= 0x7FF)
-            m_CIRAM[0x400 + (address & 0x3FF)] = data;
+            m_CIRAM.write(0x400 + (address & 0x3FF), data);
         else if(address >= 0x800 && address <= 0xBFF)
-            m_CIRAM[address & 0x3FF] = data;
+            m_CIRAM.write(address & 0x3FF, data);
         else if(address >= 0xC00 && address <= 0xFFF)
-            m_CIRAM[0x400 + (address & 0x3FF)] = data;
+            m_CIRAM.write(0x400 + (address & 0x3FF), data);
 
     // Only low NT used.
     } else if(m_mirroringType == mirroringType_t::SINGLE_LO){
-        m_CIRAM[address & 0x3FF] = data;
+        m_CIRAM.write(address & 0x3FF, data);
 
     // Only high NT used.
     } else if(m_mirroringType == mirroringType_t::SINGLE_HI){
-        m_CIRAM[0x400 + (address & 0x3FF)] = data;
+        m_CIRAM.write(0x400 + (address & 0x3FF), data);
     }
 }
\ No newline at end of file
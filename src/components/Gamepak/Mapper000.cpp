@@ -10,7 +10,7 @@
 #include "imgui.h"
 #include "components/Gamepak/Mapper000.h"
 
-Mapper000::Mapper000(std::vector<uint8_t> &PRGROM, std::vector<uint8_t> &CHRROM, mirroringType_t mirroringType)
+Mapper000::Mapper000(const std::vector<uint8_t> &PRGROM, const std::vector<uint8_t> &CHRROM, mirroringType_t mirroringType)
     : m_PRGROM(PRGROM), m_CHRROM(CHRROM) {
 
     if(mirroringType != mirroringType_t::HORIZONTAL && mirroringType != mirroringType_t::VERTICAL)
@@ -28,8 +28,7 @@ Mapper000::Mapper000(std::vector<uint8_t> &PRGROM, std::vector<uint8_t> &CHRROM,
 
     // Empty CHR ROM = there is no ROM, use CHR RAM.
     if(m_CHRROM.empty()) {
-        m_CHRRAM.resize(0x2000, 0x0);
-        m_CHRROM = m_CHRRAM;
+        m_CHRRAM.assign(0x2000);
         m_CHRWritable = true;
     // If there is CHR ROM, its size has to be 0x2000.
     } else if (m_CHRROM.size() != 0x2000) {
@@ -42,16 +41,19 @@ void Mapper000::init() {
     Mapper::init();
 
     m_PRGRAM.fill(0x00);
-    std::fill(m_CHRRAM.begin(), m_CHRRAM.end(), 0x0);
+    m_CHRRAM.fill(0x00);
 }
 
 bool Mapper000::cpuRead(uint16_t addr, uint8_t &data) {
 
     if(addr >= 0x6000 && addr <= 0x7FFF){
-        data = m_PRGRAM[addr & (m_PRGRAM.size() - 1)];
+        data = m_PRGRAM.read(addr & (m_PRGRAM.size() - 1));
         return true;
     } else if(addr >= 0x8000 && addr <= 0xFFFF){
-        data = m_PRGROM[addr & (m_PRGROM.size() - 1)];
+        size_t offset = addr & (m_PRGROM.size() - 1);
+        data = m_PRGROM[offset];
+        if(m_codeDataLogger)
+            m_codeDataLogger->markPRG(offset, addr);
         return true;
     }
 
@@ -61,7 +63,7 @@ bool Mapper000::cpuRead(uint16_t addr, uint8_t &data) {
 bool Mapper000::cpuWrite(uint16_t addr, uint8_t data) {
 
     if(addr >= 0x6000 && addr <= 0x7FFF){
-        m_PRGRAM[addr & (m_PRGRAM.size() - 1)] = data;
+        m_PRGRAM.write(addr & (m_PRGRAM.size() - 1), data);
         return true;
     } else if(addr >= 0x8000 && addr <= 0xFFFF){
         // PRG ROM not writable.
@@ -75,7 +77,9 @@ bool Mapper000::ppuRead(uint16_t addr, uint8_t &data) {
 
     if(addr >= 0x0000 && addr <= 0x1FFF) {
 
-        data = m_CHRROM[addr];
+        data = m_CHRWritable ? m_CHRRAM.read(addr) : m_CHRROM[addr];
+        if(m_codeDataLogger)
+            m_codeDataLogger->markCHR(addr);
         return true;
     } else if (addr >= 0x2000 && addr <= 0x3EFF) {
 
@@ -90,7 +94,7 @@ bool Mapper000::ppuWrite(uint16_t addr, uint8_t data) {
 
     if(m_CHRWritable && addr >= 0x0000 && addr <= 0x1FFF) {
 
-        m_CHRROM[addr] = data;
+        m_CHRRAM.write(addr, data);
         return true;
     } else if (addr >= 0x2000 && addr <= 0x3EFF) {
 
@@ -101,6 +105,35 @@ bool Mapper000::ppuWrite(uint16_t addr, uint8_t data) {
     return false;
 }
 
+const PagedMemory & Mapper000::getPRGRAM() const {
+    return m_PRGRAM;
+}
+
+std::unique_ptr<Mapper> Mapper000::clone() const {
+
+    auto copy = std::make_unique<Mapper000>(*this);
+    copy->m_codeDataLogger = nullptr;
+    return copy;
+}
+
+void Mapper000::unshare() {
+
+    Mapper::unshare();
+    m_PRGRAM.unshare();
+    m_CHRRAM.unshare();
+}
+
+void Mapper000::hashState(StateHasher & hasher) const {
+
+    Mapper::hashState(hasher);
+    hasher.add(m_PRGRAM);
+    hasher.add(m_CHRRAM);
+}
+
+uint32_t Mapper000::getPRGBank(uint16_t addr) const {
+    return addr >= 0x8000 ? (addr & (m_PRGROM.size() - 1)) >> 14 : 0;
+}
+
 void Mapper000::drawGUI() {
 
     ImGui::Text("Type: iNES 000 (NROM)");
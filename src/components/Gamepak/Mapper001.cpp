@@ -2,7 +2,7 @@
 #include "Types.h"
 #include <stdexcept>
 
-Mapper001::Mapper001(std::vector<uint8_t> & PRGROM, std::vector<uint8_t> & CHRROM, size_t PRGRAMSize)
+Mapper001::Mapper001(const std::vector<uint8_t> & PRGROM, const std::vector<uint8_t> & CHRROM, size_t PRGRAMSize)
         : m_PRGROM(PRGROM), m_CHRROM(CHRROM) {
 
     if(m_PRGROM.empty())
@@ -10,8 +10,7 @@ Mapper001::Mapper001(std::vector<uint8_t> & PRGROM, std::vector<uint8_t> & CHRRO
 
     // Check CHR ROM size
     if(m_CHRROM.empty()) {
-        m_CHRRAM.resize(0x2000, 0x0);
-        m_CHRROM = m_CHRRAM;
+        m_CHRRAM.assign(0x2000);
         m_CHRWritable = true;
     } else if(m_CHRROM.size() > 0x20000) {
         throw std::invalid_argument("CHR ROM invalid size: allowed max 128 KiB");
@@ -23,7 +22,7 @@ Mapper001::Mapper001(std::vector<uint8_t> & PRGROM, std::vector<uint8_t> & CHRRO
     }
 
     Mapper::init();
-    m_PRGRAM.resize(PRGRAMSize, 0x00);
+    m_PRGRAM.assign(PRGRAMSize);
     m_registers.init();
 }
 
@@ -41,7 +40,7 @@ void Mapper001::init(){
 
     Mapper::init();
     m_registers.init();
-    std::fill(m_PRGRAM.begin(), m_PRGRAM.end(), 0x00);
+    m_PRGRAM.fill(0x00);
 
     m_loadRegister = 0;
     m_writeCounter = 0;
@@ -51,50 +50,53 @@ bool Mapper001::cpuRead(uint16_t addr, uint8_t & data) {
 
     // PRG RAM bank.
     if(addr >= 0x6000 && addr <= 0x7FFF){
-        data = m_PRGRAM[(m_registers.PRGRAMSelect << 13) | (addr & 0x1FFF)];
+        data = m_PRGRAM.read((m_registers.PRGRAMSelect << 13) | (addr & 0x1FFF));
         return true;
 
     // PRG ROM bank 0.
     } else if(addr >= 0x8000 && addr <= 0xBFFF) {
 
-        addr &= 0x3FFF;
+        size_t offset = addr & 0x3FFF;
 
         switch(m_registers.PRGMode) {
             case PRGMode_t::SWITCH_BOTH0:
             [[fallthrough]];
             case PRGMode_t::SWITCH_BOTH1:
-                data = m_PRGROM[addr | ((m_registers.PRGROMSelect & 0x1E) << 14)];
+                offset |= (m_registers.PRGROMSelect & 0x1E) << 14;
                 break;
             case PRGMode_t::FIX_LOW_SWITCH_HIGH:
-                data = m_PRGROM[addr];
                 break;
             case PRGMode_t::SWITCH_LOW_FIX_HIGH:
-                data = m_PRGROM[addr | (m_registers.PRGROMSelect << 14)];
+                offset |= m_registers.PRGROMSelect << 14;
                 break;
         }
 
+        data = m_PRGROM[offset];
+        if(m_codeDataLogger)
+            m_codeDataLogger->markPRG(offset, addr);
         return true;
 
     } else if(addr >= 0xC000 && addr <= 0xFFFF) {
 
-        addr &= 0x7FFF;
+        size_t offset = addr & 0x7FFF;
 
         switch(m_registers.PRGMode) {
             case PRGMode_t::SWITCH_BOTH0:
                 [[fallthrough]];
             case PRGMode_t::SWITCH_BOTH1:
-                data = m_PRGROM[addr | ((m_registers.PRGROMSelect & 0x1E) << 14)];
+                offset |= (m_registers.PRGROMSelect & 0x1E) << 14;
                 break;
             case PRGMode_t::FIX_LOW_SWITCH_HIGH:
-                addr &= 0x3FFF;
-                data = m_PRGROM[addr | (m_registers.PRGROMSelect << 14)];
+                offset = (offset & 0x3FFF) | (m_registers.PRGROMSelect << 14);
                 break;
             case PRGMode_t::SWITCH_LOW_FIX_HIGH:
-                addr &= 0x3FFF;
-                data = m_PRGROM[addr | (((m_PRGROM.size() / 0x4000) - 1) << 14)];
+                offset = (offset & 0x3FFF) | (((m_PRGROM.size() / 0x4000) - 1) << 14);
                 break;
         }
 
+        data = m_PRGROM[offset];
+        if(m_codeDataLogger)
+            m_codeDataLogger->markPRG(offset, addr);
         return true;
     }
 
@@ -112,7 +114,7 @@ bool Mapper001::cpuWrite(uint16_t addr, uint8_t data){
     // Built-in PRG RAM area.
     if(addr >= 0x6000 && addr <= 0x7FFF){
 
-        m_PRGRAM[(m_registers.PRGRAMSelect << 13) | (addr & 0x1FFF)] = data;
+        m_PRGRAM.write((m_registers.PRGRAMSelect << 13) | (addr & 0x1FFF), data);
         return true;
 
     // Switchable PRG ROM bank.
@@ -207,8 +209,8 @@ bool Mapper001::cpuWrite(uint16_t addr, uint8_t data){
                 // A13-A14 = Select 8 KB bank
                 m_registers.PRGRAMSelect %= m_PRGRAM.size() / 0x2000;
                 // A12-A16 = Select 4 KB bank.
-                m_registers.CHRROMLoSelect %= m_CHRROM.size() / 0x1000;
-                m_registers.CHRROMHiSelect %= m_CHRROM.size() / 0x1000;
+                m_registers.CHRROMLoSelect %= CHRSize() / 0x1000;
+                m_registers.CHRROMHiSelect %= CHRSize() / 0x1000;
 
                 m_writeCounter = 0;
                 m_loadRegister = 0;
@@ -226,22 +228,30 @@ bool Mapper001::ppuRead(uint16_t addr, uint8_t & data){
 
     if(addr >= 0x0000 && addr <= 0x0FFF){
 
+        size_t offset;
         if(m_registers.CHRMode == CHRMode_t::SWITCH4KB){
-            data = m_CHRROM[addr | (m_registers.CHRROMLoSelect << 12)];
+            offset = addr | (m_registers.CHRROMLoSelect << 12);
         } else {
-            data = m_CHRROM[addr | ((m_registers.CHRROMLoSelect & 0x1E) << 12)];
+            offset = addr | ((m_registers.CHRROMLoSelect & 0x1E) << 12);
         }
 
+        data = CHRRead(offset);
+        if(m_codeDataLogger)
+            m_codeDataLogger->markCHR(offset);
         return true;
 
     } else if(addr >= 0x1000 && addr <= 0x1FFF){
 
+        size_t offset;
         if(m_registers.CHRMode == CHRMode_t::SWITCH4KB){
-            data = m_CHRROM[(addr & 0xFFF) | (m_registers.CHRROMHiSelect << 12)];
+            offset = (addr & 0xFFF) | (m_registers.CHRROMHiSelect << 12);
         } else {
-            data = m_CHRROM[addr | ((m_registers.CHRROMLoSelect & 0x1E) << 12)];
+            offset = addr | ((m_registers.CHRROMLoSelect & 0x1E) << 12);
         }
 
+        data = CHRRead(offset);
+        if(m_codeDataLogger)
+            m_codeDataLogger->markCHR(offset);
         return true;
     } else if (addr >= 0x2000 && addr <= 0x3EFF) {
 
@@ -255,7 +265,7 @@ bool Mapper001::ppuRead(uint16_t addr, uint8_t & data){
 bool Mapper001::ppuWrite(uint16_t addr, uint8_t data){
 
     if(m_CHRWritable && addr >= 0x0000 && addr <= 0x1FFF){
-        m_CHRROM[addr] = data;
+        m_CHRRAM.write(addr, data);
         return true;
     } else if (addr >= 0x2000 && addr <= 0x3EFF) {
 
@@ -266,6 +276,62 @@ bool Mapper001::ppuWrite(uint16_t addr, uint8_t data){
     return false;
 }
 
+const PagedMemory & Mapper001::getPRGRAM() const {
+    return m_PRGRAM;
+}
+
+std::unique_ptr<Mapper> Mapper001::clone() const {
+
+    auto copy = std::make_unique<Mapper001>(*this);
+    copy->m_codeDataLogger = nullptr;
+    return copy;
+}
+
+void Mapper001::unshare() {
+
+    Mapper::unshare();
+    m_PRGRAM.unshare();
+    m_CHRRAM.unshare();
+}
+
+void Mapper001::hashState(StateHasher & hasher) const {
+
+    Mapper::hashState(hasher);
+    hasher.add(m_PRGRAM);
+    hasher.add(m_CHRRAM);
+    hasher.add(m_loadRegister);
+    hasher.add(m_writeCounter);
+
+    hasher.add(m_registers.PRGMode);
+    hasher.add(m_registers.PRGROMSelect);
+    hasher.add(m_registers.CHRMode);
+    hasher.add(m_registers.CHRROMLoSelect);
+    hasher.add(m_registers.CHRROMHiSelect);
+    hasher.add(m_registers.enablePRGRAM);
+    hasher.add(m_registers.PRGRAMSelect);
+}
+
+uint32_t Mapper001::getPRGBank(uint16_t addr) const {
+
+    if(addr < 0x8000)
+        return 0;
+
+    // Same mapping as in cpuRead.
+    bool high = addr >= 0xC000;
+    switch(m_registers.PRGMode) {
+        case PRGMode_t::SWITCH_BOTH0:
+            [[fallthrough]];
+        case PRGMode_t::SWITCH_BOTH1:
+            return (m_registers.PRGROMSelect & 0x1E) | high;
+        case PRGMode_t::FIX_LOW_SWITCH_HIGH:
+            return high ? m_registers.PRGROMSelect : 0;
+        case PRGMode_t::SWITCH_LOW_FIX_HIGH:
+            return high ? (m_PRGROM.size() / 0x4000) - 1 : m_registers.PRGROMSelect;
+    }
+
+    return 0;
+}
+
 void Mapper001::drawGUI() {
 
 }
\ No newline at end of file
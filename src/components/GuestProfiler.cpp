@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include "imgui.h"
+#include "components/GuestProfiler.h"
+
+GuestProfiler::GuestProfiler() {
+    reset();
+}
+
+void GuestProfiler::grow(uint32_t bank) {
+
+    m_cycles.resize(static_cast<size_t>(bank + 1) * BANK_SIZE, 0);
+    m_routineIndex.resize(static_cast<size_t>(bank + 1) * BANK_SIZE, 0);
+}
+
+uint32_t GuestProfiler::getRoutine(uint32_t location, ENTRY entry) {
+
+    uint32_t & index = m_routineIndex[location];
+    if(!index) {
+        index = static_cast<uint32_t>(m_routines.size());
+        m_routines.push_back(Routine{.location = location, .entry = entry});
+    }
+
+    return index;
+}
+
+uint32_t GuestProfiler::getChild(uint32_t node, uint32_t routine) {
+
+    uint32_t child = m_nodes[node].firstChild;
+    while(child != NO_NODE) {
+        if(m_nodes[child].routine == routine)
+            return child;
+        child = m_nodes[child].nextSibling;
+    }
+
+    child = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node{.routine = routine, .parent = node, .firstChild = NO_NODE,
+                           .nextSibling = m_nodes[node].firstChild, .cycles = 0});
+    m_nodes[node].firstChild = child;
+
+    return child;
+}
+
+void GuestProfiler::call(uint16_t address, uint32_t bank, uint8_t callerSP, ENTRY entry) {
+
+    uint32_t routine = getRoutine(locate(address, bank), entry);
+
+    if(m_depth == MAX_DEPTH) {
+        m_droppedCalls++;
+        return;
+    }
+
+    Routine & r = m_routines[routine];
+    m_stack[m_depth] = Frame{
+        .routine = routine,
+        .node = getChild(m_stack[m_depth - 1].node, routine),
+        .start = m_time,
+        .callerSP = callerSP,
+        .outermost = r.active == 0
+    };
+    m_depth++;
+
+    r.calls++;
+    r.active++;
+}
+
+void GuestProfiler::pop() {
+
+    const Frame & frame = m_stack[--m_depth];
+    Routine & r = m_routines[frame.routine];
+
+    r.active--;
+    if(frame.outermost) {
+        r.frameInclusive += m_time - frame.start;
+        touch(frame.routine);
+    }
+}
+
+void GuestProfiler::endFrame() {
+
+    // Calls spanning over the frame boundary are split.
+    for(size_t i = 0; i < m_depth; i++) {
+        Frame & frame = m_stack[i];
+        if(frame.outermost) {
+            m_routines[frame.routine].frameInclusive += m_time - frame.start;
+            touch(frame.routine);
+        }
+        frame.start = m_time;
+    }
+
+    for(uint32_t index : m_touched) {
+        Routine & r = m_routines[index];
+        r.exclusive += r.frameExclusive;
+        r.inclusive += r.frameInclusive;
+        r.maxExclusive = std::max(r.maxExclusive, r.frameExclusive);
+        r.maxInclusive = std::max(r.maxInclusive, r.frameInclusive);
+        r.frameExclusive = r.frameInclusive = 0;
+        r.touched = false;
+    }
+    m_touched.clear();
+
+    m_frames++;
+}
+
+void GuestProfiler::reset() {
+
+    std::fill(m_cycles.begin(), m_cycles.end(), 0);
+    std::fill(m_routineIndex.begin(), m_routineIndex.end(), 0);
+    m_routines.clear();
+    m_touched.clear();
+    m_nodes.clear();
+
+    // Code running before the first tracked call (reset handler, main loop).
+    m_routines.push_back(Routine{.location = 0, .entry = ENTRY::ROOT, .calls = 1, .active = 1});
+    m_nodes.push_back(Node{.routine = 0, .parent = NO_NODE, .firstChild = NO_NODE, .nextSibling = NO_NODE, .cycles = 0});
+    m_stack[0] = Frame{.routine = 0, .node = 0, .start = 0, .callerSP = 0, .outermost = true};
+    m_depth = 1;
+
+    m_time = 0;
+    m_frames = 0;
+    m_droppedCalls = 0;
+}
+
+void GuestProfiler::addSymbol(uint16_t address, uint32_t bank, const std::string & name) {
+    m_symbols.emplace((std::min(bank, MAX_BANKS - 1) << 16) | address, name);
+}
+
+void GuestProfiler::loadSymbols(const std::string & path) {
+
+    std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+    if(extension != ".dbg" && extension != ".nl")
+        throw std::invalid_argument("Unsupported symbol file format: " + extension + ".");
+
+    std::ifstream file(path);
+    if(!file)
+        throw std::runtime_error("Symbol file couldn't be opened!");
+
+    if(extension == ".dbg") {
+        loadCA65Symbols(file);
+        return;
+    }
+
+    // FCEUX names the files game.nes.<bank>.nl and game.nes.ram.nl.
+    uint32_t bank = 0;
+    std::string stem = path.substr(0, path.size() - extension.size());
+    std::string bankName = stem.substr(std::min(stem.size(), stem.find_last_of('.') + 1));
+    if(!bankName.empty() && bankName != "ram" && std::all_of(bankName.begin(), bankName.end(), [](char c){ return std::isxdigit(static_cast<unsigned char>(c)); }))
+        bank = std::stoul(bankName, nullptr, 16);
+
+    loadFCEUXSymbols(file, bank);
+}
+
+void GuestProfiler::loadFCEUXSymbols(std::istream & is, uint32_t bank) {
+
+    // Format: $ADDR#name#comment, optionally $ADDR/size#name#comment for arrays.
+    std::string line;
+    while(std::getline(is, line)) {
+
+        if(line.size() < 2 || line[0] != '$')
+            continue;
+
+        size_t nameStart = line.find('#');
+        if(nameStart == std::string::npos)
+            continue;
+        size_t nameEnd = line.find('#', nameStart + 1);
+        std::string name = line.substr(nameStart + 1, nameEnd == std::string::npos ? std::string::npos : nameEnd - nameStart - 1);
+
+        uint16_t address;
+        try {
+            address = std::stoul(line.substr(1, line.find_first_of("/#") - 1), nullptr, 16);
+        } catch(std::exception &) {
+            continue;
+        }
+
+        if(!name.empty())
+            addSymbol(address, address >= 0x8000 ? bank : 0, name);
+    }
+}
+
+void GuestProfiler::loadCA65Symbols(std::istream & is) {
+
+    // ld65 --dbgfile format: a record type, a tab and comma separated key=value pairs.
+    //   seg  id=1,name="CODE",start=0x008000,size=0x0100,addrsize=absolute,type=ro,oname="game.nes",ooffs=16
+    //   sym  id=0,name="reset",addrsize=absolute,scope=0,def=1,val=0x8000,seg=1,type=lab
+    auto parse = [](const std::string & fields) {
+        std::map<std::string, std::string> values;
+        std::stringstream ss(fields);
+        std::string field;
+        while(std::getline(ss, field, ',')) {
+            size_t eq = field.find('=');
+            if(eq == std::string::npos)
+                continue;
+            std::string value = field.substr(eq + 1);
+            if(value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                value = value.substr(1, value.size() - 2);
+            values[field.substr(0, eq)] = value;
+        }
+        return values;
+    };
+
+    struct Segment { uint32_t start; int64_t romOffset; };
+    std::map<std::string, Segment> segments;
+    std::vector<std::map<std::string, std::string>> symbols;
+
+    std::string line;
+    while(std::getline(is, line)) {
+
+        size_t tab = line.find('\t');
+        if(tab == std::string::npos)
+            continue;
+        std::string type = line.substr(0, tab);
+
+        if(type == "seg") {
+            auto values = parse(line.substr(tab + 1));
+            if(!values.count("id") || !values.count("start"))
+                continue;
+            // Segments in the ROM image: offset in PRG ROM (without the 16 B iNES header).
+            int64_t romOffset = values.count("ooffs") ? std::stoll(values["ooffs"], nullptr, 0) - 16 : -1;
+            segments[values["id"]] = Segment{static_cast<uint32_t>(std::stoul(values["start"], nullptr, 0)), romOffset};
+        } else if(type == "sym") {
+            symbols.push_back(parse(line.substr(tab + 1)));
+        }
+    }
+
+    for(auto & symbol : symbols) {
+
+        if(symbol["type"] != "lab" || !symbol.count("val") || symbol["name"].empty())
+            continue;
+
+        auto address = static_cast<uint32_t>(std::stoul(symbol["val"], nullptr, 0));
+        if(address > 0xFFFF)
+            continue;
+
+        uint32_t bank = 0;
+        auto segment = segments.find(symbol["seg"]);
+        if(address >= 0x8000 && segment != segments.end() && segment->second.romOffset >= 0)
+            bank = static_cast<uint32_t>((segment->second.romOffset + address - segment->second.start) / 0x4000);
+
+        addSymbol(address, bank, symbol["name"]);
+    }
+}
+
+size_t GuestProfiler::getSymbolCount() const {
+    return m_symbols.size();
+}
+
+std::string GuestProfiler::getName(uint32_t location) const {
+
+    auto symbol = m_symbols.find(location);
+    if(symbol != m_symbols.end())
+        return symbol->second;
+
+    std::stringstream ss;
+    ss << "$" << std::uppercase << std::hex << std::setfill('0');
+    if(location >> 16)
+        ss << std::setw(2) << (location >> 16) << ":";
+    ss << std::setw(4) << (location & 0xFFFF);
+    return ss.str();
+}
+
+uint64_t GuestProfiler::getCycles(uint16_t address, uint32_t bank) const {
+
+    size_t location = (static_cast<size_t>(bank) << 16) | address;
+    return location < m_cycles.size() ? m_cycles[location] : 0;
+}
+
+uint64_t GuestProfiler::getTotalCycles() const {
+    return m_time;
+}
+
+uint64_t GuestProfiler::getFrameCount() const {
+    return m_frames;
+}
+
+size_t GuestProfiler::getDepth() const {
+    return m_depth;
+}
+
+std::vector<GuestProfiler::RoutineReport> GuestProfiler::getReport() const {
+
+    // Include the unfinished calls and frame.
+    std::vector<uint64_t> openInclusive(m_routines.size(), 0);
+    for(size_t i = 0; i < m_depth; i++)
+        if(m_stack[i].outermost)
+            openInclusive[m_stack[i].routine] += m_time - m_stack[i].start;
+
+    double frames = static_cast<double>(std::max<uint64_t>(m_frames, 1));
+    std::vector<RoutineReport> report;
+    report.reserve(m_routines.size());
+
+    for(size_t i = 0; i < m_routines.size(); i++) {
+
+        const Routine & r = m_routines[i];
+        uint64_t exclusive = r.exclusive + r.frameExclusive;
+        uint64_t inclusive = r.inclusive + r.frameInclusive + openInclusive[i];
+
+        report.push_back(RoutineReport{
+            .bank = r.location >> 16,
+            .address = static_cast<uint16_t>(r.location & 0xFFFF),
+            .name = r.entry == ENTRY::ROOT ? "(root)" : getName(r.location),
+            .entry = r.entry,
+            .calls = r.calls,
+            .exclusive = exclusive,
+            .inclusive = inclusive,
+            .exclusivePerFrame = static_cast<double>(exclusive) / frames,
+            .inclusivePerFrame = static_cast<double>(inclusive) / frames,
+            .maxExclusive = std::max(r.maxExclusive, r.frameExclusive),
+            .maxInclusive = std::max(r.maxInclusive, r.frameInclusive + openInclusive[i])
+        });
+    }
+
+    std::sort(report.begin(), report.end(), [](const RoutineReport & a, const RoutineReport & b){
+        return a.inclusive > b.inclusive;
+    });
+
+    return report;
+}
+
+void GuestProfiler::writeFlameGraph(std::ostream & os) const {
+
+    // Frame names, interrupt handlers are marked.
+    std::vector<std::string> names(m_routines.size());
+    for(size_t i = 0; i < m_routines.size(); i++) {
+        const Routine & r = m_routines[i];
+        switch(r.entry) {
+            case ENTRY::ROOT: names[i] = "(root)"; break;
+            case ENTRY::CALL: names[i] = getName(r.location); break;
+            case ENTRY::NMI:  names[i] = "[NMI] " + getName(r.location); break;
+            case ENTRY::IRQ:  names[i] = "[IRQ] " + getName(r.location); break;
+        }
+    }
+
+    // Depth-first walk with an explicit path.
+    std::vector<uint32_t> path;
+    std::vector<uint32_t> pending{0};
+    while(!pending.empty()) {
+
+        uint32_t node = pending.back();
+        pending.pop_back();
+
+        while(!path.empty() && path.back() != m_nodes[node].parent)
+            path.pop_back();
+        path.push_back(node);
+
+        if(m_nodes[node].cycles) {
+            for(size_t i = 0; i < path.size(); i++)
+                os << (i ? ";" : "") << names[m_nodes[path[i]].routine];
+            os << " " << m_nodes[node].cycles << "\n";
+        }
+
+        for(uint32_t child = m_nodes[node].firstChild; child != NO_NODE; child = m_nodes[child].nextSibling)
+            pending.push_back(child);
+    }
+}
+
+void GuestProfiler::drawGUI() {
+
+    if(ImGui::Button("Reset"))
+        reset();
+    ImGui::SameLine();
+    ImGui::Text("Frames: %llu, cycles: %llu, depth: %zu", (unsigned long long)m_frames, (unsigned long long)m_time, m_depth);
+    if(m_droppedCalls)
+        ImGui::Text("Calls deeper than %zu: %llu", MAX_DEPTH, (unsigned long long)m_droppedCalls);
+
+    ImGui::InputText("Symbols (.dbg/.nl)", m_symbolPath, sizeof(m_symbolPath));
+    ImGui::SameLine();
+    if(ImGui::Button("Load")) {
+        try {
+            loadSymbols(m_symbolPath);
+            m_guiStatus = "Symbols loaded: " + std::to_string(m_symbols.size()) + ".";
+        } catch(std::exception & e) {
+            m_guiStatus = e.what();
+        }
+    }
+
+    ImGui::InputText("Flame graph file", m_flameGraphPath, sizeof(m_flameGraphPath));
+    ImGui::SameLine();
+    if(ImGui::Button("Save")) {
+        std::ofstream file(m_flameGraphPath);
+        if(file) {
+            writeFlameGraph(file);
+            m_guiStatus = "Saved.";
+        } else {
+            m_guiStatus = "File couldn't be opened!";
+        }
+    }
+    if(!m_guiStatus.empty())
+        ImGui::Text("%s", m_guiStatus.c_str());
+
+    if(ImGui::BeginTable("routines", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+
+        ImGui::TableSetupColumn("Routine");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Excl./frame");
+        ImGui::TableSetupColumn("Incl./frame");
+        ImGui::TableSetupColumn("Max excl.");
+        ImGui::TableSetupColumn("Max incl.");
+        ImGui::TableHeadersRow();
+
+        for(auto & routine : getReport()) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(routine.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)routine.calls);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", routine.exclusivePerFrame);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", routine.inclusivePerFrame);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)routine.maxExclusive);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)routine.maxInclusive);
+        }
+
+        ImGui::EndTable();
+    }
+}
@@ -2,7 +2,9 @@
 // Created by golas on 2.3.23.
 //
 
+#include <algorithm>
 #include <fstream>
+#include <stdexcept>
 #include "components/Memory.h"
 #include "imgui.h"
 #include "imgui_memory_editor.h"
@@ -13,28 +15,25 @@ Memory::Memory(
     AddressRange addressRange,
     uint8_t defaultValue)
 
-    : m_data(size),
+    : m_data(size, defaultValue),
       m_addressRange(addressRange),
-      m_defaultValue(defaultValue) {
+      m_defaultValue(defaultValue),
+      m_offsetMask(size && !(size & (size - 1)) ? size - 1 : 0) {
 
     m_deviceName = "Memory";
 
     Connector dataConnector(
         DataInterface{
-             .read = [&](uint32_t address, uint32_t & buffer) {
-
-                 if(m_addressRange.has(address)) {
-                     buffer = m_data[(address - m_addressRange.from) % m_data.size()];
-                     return true;
-                 } else {
+             .read = [this](uint32_t address, uint32_t & buffer) {
+                 uint8_t data;
+                 if(!read(address, data))
                      return false;
-                 }
-
+                 buffer = data;
+                 return true;
              },
 
-             .write = [&](uint32_t address, uint32_t data){
-                 if(m_addressRange.has(address))
-                     m_data[(address - m_addressRange.from) % m_data.size()] = data;
+             .write = [this](uint32_t address, uint32_t data){
+                 write(address, data);
              }
      });
 
@@ -44,7 +43,7 @@ Memory::Memory(
 }
 
 void Memory::memoryInit() {
-    std::fill(m_data.begin(), m_data.end(), m_defaultValue);
+    m_data.fill(m_defaultValue);
 }
 
 void Memory::init() {
@@ -85,12 +84,18 @@ std::vector<EmulatorWindow> Memory::getGUIs() {
         ImGui::Text("Replace data");
         ImGui::InputScalar("Value", ImGuiDataType_U8, &fillWith, &step, &stepFast, "%08X");
         if(ImGui::Button("Fill")) {
-            std::fill(m_data.begin(), m_data.end(), fillWith);
+            m_data.fill(fillWith);
         }
         ImGui::Separator();
 
         ImGui::Text("Contents");
-        memoryEditor.DrawContents(m_data.data(), m_data.size());
+        // The editor needs contiguous data, the edited bytes are written back.
+        m_editorView.resize(m_data.size());
+        m_data.copyTo(m_editorView);
+        memoryEditor.DrawContents(m_editorView.data(), m_editorView.size());
+        for(size_t i = 0; i < m_editorView.size(); i++)
+            if(m_editorView[i] != m_data.read(i))
+                m_data.write(i, m_editorView[i]);
 
         // Dialogs
         // ===================================================================
@@ -131,11 +136,40 @@ std::vector<EmulatorWindow> Memory::getGUIs() {
     };
 }
 
+const PagedMemory & Memory::getData() const {
+    return m_data;
+}
+
+void Memory::copyState(const Memory & other, bool copyOnWrite) {
+
+    if(other.m_data.size() != m_data.size())
+        throw std::invalid_argument("Memory sizes differ.");
+
+    m_data = other.m_data;
+    if(!copyOnWrite)
+        m_data.unshare();
+}
+
+void Memory::hashState(StateHasher & hasher) const {
+    hasher.add(m_data);
+}
+
 void Memory::load(uint32_t startOffset, std::ifstream & src) {
 
     if(startOffset > m_data.size()) {
         throw std::invalid_argument("Offset is bigger than the memory size.");
     }
 
-    src.read((char *)(m_data.data() + startOffset), m_data.size() - startOffset);
-}
\ No newline at end of file
+    std::vector<uint8_t> buffer(m_data.size() - startOffset);
+    src.read((char *)buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    m_data.load(startOffset, std::span<const uint8_t>(buffer.data(), static_cast<size_t>(src.gcount())));
+}
+
+void Memory::load(uint32_t from, std::span<const uint8_t> data) {
+
+    if(from > m_data.size()) {
+        throw std::invalid_argument("Offset is bigger than the memory size.");
+    }
+
+    m_data.load(from, data);
+}
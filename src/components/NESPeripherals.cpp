@@ -1,33 +1,64 @@
 #include <cstdint>
 #include "components/NESPeripherals.h"
 #include "ImInputBinder.h"
+#include "StateHasher.h"
 
 NESPeripherals::NESPeripherals() {
 
     m_deviceName = "NES Peripherals";
 
     m_connectors["cpuBus"] = std::make_shared<Connector>(DataInterface{
-            .read = [&](uint32_t address, uint32_t & buffer) {
-                if(address == 0x4016) {
-                    buffer = m_controller1.DATA();
-                    return true;
-                } else if(address == 0x4017) {
-                    buffer = m_controller2.DATA();
-                    return true;
-                } else {
+            .read = [this](uint32_t address, uint32_t & buffer) {
+                uint8_t data;
+                if(!cpuRead(address, data))
                     return false;
-                }
-            },
-            .write = [&](uint32_t address, uint32_t data) {
-                if(address == 0x4016){
-                    // Controller 1 and 2 strobe bit.
-                    m_controller1.OUT(data & 0x1);
-                    m_controller2.OUT(data & 0x1);
-                }
+                buffer = data;
+                return true;
+            },
+            .write = [this](uint32_t address, uint32_t data) {
+                cpuWrite(address, data);
             }
     });
 }
 
+bool NESPeripherals::cpuRead(uint16_t address, uint8_t & buffer) {
+
+    if(address == 0x4016) {
+        buffer = m_controller1.DATA();
+        return true;
+    } else if(address == 0x4017) {
+        buffer = m_controller2.DATA();
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void NESPeripherals::cpuWrite(uint16_t address, uint8_t data) {
+
+    if(address == 0x4016){
+        // Controller 1 and 2 strobe bit.
+        m_controller1.OUT(data & 0x1);
+        m_controller2.OUT(data & 0x1);
+    }
+}
+
+void NESPeripherals::copyState(const NESPeripherals & other) {
+    m_controller1 = other.m_controller1;
+    m_controller2 = other.m_controller2;
+}
+
+void NESPeripherals::hashState(StateHasher & hasher) const {
+
+    for(const Controller * controller : {&m_controller1, &m_controller2}) {
+        hasher.add(controller->pressedButtons.data);
+        hasher.add(controller->dataShifter);
+        hasher.add(controller->shiftedCount);
+        hasher.add(controller->mic);
+        hasher.add(controller->strobeLatch);
+    }
+}
+
 void NESPeripherals::init() {
     m_controller1.pressedButtons.debug = 0;
     m_controller1.dataShifter    = 0;
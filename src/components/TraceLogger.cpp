@@ -0,0 +1,236 @@
+#include <stdexcept>
+#include "components/TraceLogger.h"
+
+namespace {
+
+    constexpr char HEX[] = "0123456789ABCDEF";
+
+    /// Bitmap of the 151 official opcodes.
+    constexpr std::array<uint64_t, 4> OFFICIAL_OPCODES = []() {
+        constexpr uint8_t official[] = {
+            0x69, 0x65, 0x75, 0x6D, 0x7D, 0x79, 0x61, 0x71, // ADC
+            0x29, 0x25, 0x35, 0x2D, 0x3D, 0x39, 0x21, 0x31, // AND
+            0x0A, 0x06, 0x16, 0x0E, 0x1E,                   // ASL
+            0x90, 0xB0, 0xF0, 0x30, 0xD0, 0x10, 0x50, 0x70, // Branches
+            0x24, 0x2C, 0x00,                               // BIT, BRK
+            0x18, 0xD8, 0x58, 0xB8,                         // CLC, CLD, CLI, CLV
+            0xC9, 0xC5, 0xD5, 0xCD, 0xDD, 0xD9, 0xC1, 0xD1, // CMP
+            0xE0, 0xE4, 0xEC, 0xC0, 0xC4, 0xCC,             // CPX, CPY
+            0xC6, 0xD6, 0xCE, 0xDE, 0xCA, 0x88,             // DEC, DEX, DEY
+            0x49, 0x45, 0x55, 0x4D, 0x5D, 0x59, 0x41, 0x51, // EOR
+            0xE6, 0xF6, 0xEE, 0xFE, 0xE8, 0xC8,             // INC, INX, INY
+            0x4C, 0x6C, 0x20,                               // JMP, JSR
+            0xA9, 0xA5, 0xB5, 0xAD, 0xBD, 0xB9, 0xA1, 0xB1, // LDA
+            0xA2, 0xA6, 0xB6, 0xAE, 0xBE,                   // LDX
+            0xA0, 0xA4, 0xB4, 0xAC, 0xBC,                   // LDY
+            0x4A, 0x46, 0x56, 0x4E, 0x5E,                   // LSR
+            0xEA,                                           // NOP
+            0x09, 0x05, 0x15, 0x0D, 0x1D, 0x19, 0x01, 0x11, // ORA
+            0x48, 0x08, 0x68, 0x28,                         // PHA, PHP, PLA, PLP
+            0x2A, 0x26, 0x36, 0x2E, 0x3E,                   // ROL
+            0x6A, 0x66, 0x76, 0x6E, 0x7E,                   // ROR
+            0x40, 0x60,                                     // RTI, RTS
+            0xE9, 0xE5, 0xF5, 0xED, 0xFD, 0xF9, 0xE1, 0xF1, // SBC
+            0x38, 0xF8, 0x78,                               // SEC, SED, SEI
+            0x85, 0x95, 0x8D, 0x9D, 0x99, 0x81, 0x91,       // STA
+            0x86, 0x96, 0x8E, 0x84, 0x94, 0x8C,             // STX, STY
+            0xAA, 0xA8, 0xBA, 0x8A, 0x9A, 0x98              // TAX, TAY, TSX, TXA, TXS, TYA
+        };
+
+        std::array<uint64_t, 4> bitmap{};
+        for(uint8_t opcode : official)
+            bitmap[opcode >> 6] |= uint64_t{1} << (opcode & 0x3F);
+        return bitmap;
+    }();
+
+    /// Minimal formatting helpers, the output is always large enough (see MAX_LINE_LENGTH).
+    struct LineWriter {
+
+        char * out;
+
+        void put(char c) { *out++ = c; }
+        void put(const char * str) { while(*str) *out++ = *str++; }
+        void hex8(uint8_t value) { put(HEX[value >> 4]); put(HEX[value & 0xF]); }
+        void hex16(uint16_t value) { hex8(value >> 8); hex8(value & 0xFF); }
+        void fill(char * until) { while(out < until) *out++ = ' '; }
+
+        /// Right-aligned decimal number.
+        void decimal(int64_t value, int width) {
+            char digits[24];
+            int count = 0;
+            bool negative = value < 0;
+            uint64_t magnitude = negative ? -static_cast<uint64_t>(value) : value;
+            do {
+                digits[count++] = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while(magnitude);
+            if(negative)
+                digits[count++] = '-';
+            for(int i = count; i < width; i++)
+                put(' ');
+            while(count)
+                put(digits[--count]);
+        }
+    };
+}
+
+TraceLogger::TraceLogger(const std::string & path, const std::array<Opcode, 256> & opcodes, PeekFunction peek, PositionFunction position)
+    : m_buffer(new char[BUFFER_SIZE]), m_opcodes(opcodes), m_peek(std::move(peek)), m_position(std::move(position)) {
+
+    if(!m_peek)
+        throw std::invalid_argument("Peek function can't be empty.");
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if(!m_file)
+        throw std::runtime_error("Trace file couldn't be opened!");
+
+    // The lines are buffered here, every flush is a single write.
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+}
+
+TraceLogger::~TraceLogger() {
+
+    try {
+        flush();
+    } catch(std::exception &) {
+        // Nothing to do, the trace is incomplete.
+    }
+    std::fclose(m_file);
+}
+
+size_t TraceLogger::formatLine(char * out, const CPUState & state) const {
+
+    LineWriter w{out};
+    char * lineStart = out;
+
+    uint8_t opcode = m_peek(state.pc);
+    const Opcode & description = m_opcodes[opcode];
+    uint8_t lo = m_peek(state.pc + 1);
+    uint8_t hi = m_peek(state.pc + 2);
+    uint16_t absolute = lo | (hi << 8);
+
+    // Address and instruction bytes.
+    w.hex16(state.pc);
+    w.put("  ");
+    w.hex8(opcode);
+
+    int length;
+    switch(description.mode) {
+        case ADDRESS_MODE::ACC:
+        case ADDRESS_MODE::IMP:
+            length = 1; break;
+        case ADDRESS_MODE::ABS:
+        case ADDRESS_MODE::ID0:
+        case ADDRESS_MODE::ABX:
+        case ADDRESS_MODE::ABY:
+            length = 3; break;
+        default:
+            length = 2; break;
+    }
+    if(length > 1) { w.put(' '); w.hex8(lo); }
+    if(length > 2) { w.put(' '); w.hex8(hi); }
+    w.fill(lineStart + 15);
+    w.put(isOfficial(opcode) ? ' ' : '*');
+
+    // Disassembly.
+    w.put(description.mnemonic);
+    bool jump = opcode == 0x4C || opcode == 0x20;
+
+    switch(description.mode) {
+        case ADDRESS_MODE::ACC:
+            w.put(" A");
+            break;
+        case ADDRESS_MODE::IMP:
+            break;
+        case ADDRESS_MODE::IMM:
+            w.put(" #$"); w.hex8(lo);
+            break;
+        case ADDRESS_MODE::ZP0:
+            w.put(" $"); w.hex8(lo);
+            w.put(" = "); w.hex8(m_peek(lo));
+            break;
+        case ADDRESS_MODE::ZPX:
+        case ADDRESS_MODE::ZPY: {
+            bool x = description.mode == ADDRESS_MODE::ZPX;
+            uint8_t address = lo + (x ? state.x : state.y);
+            w.put(" $"); w.hex8(lo); w.put(x ? ",X @ " : ",Y @ "); w.hex8(address);
+            w.put(" = "); w.hex8(m_peek(address));
+            break;
+        }
+        case ADDRESS_MODE::ABS:
+            w.put(" $"); w.hex16(absolute);
+            if(!jump) {
+                w.put(" = "); w.hex8(m_peek(absolute));
+            }
+            break;
+        case ADDRESS_MODE::ABX:
+        case ADDRESS_MODE::ABY: {
+            bool x = description.mode == ADDRESS_MODE::ABX;
+            uint16_t address = absolute + (x ? state.x : state.y);
+            w.put(" $"); w.hex16(absolute); w.put(x ? ",X @ " : ",Y @ "); w.hex16(address);
+            w.put(" = "); w.hex8(m_peek(address));
+            break;
+        }
+        case ADDRESS_MODE::REL:
+            w.put(" $"); w.hex16(state.pc + 2 + static_cast<int8_t>(lo));
+            break;
+        case ADDRESS_MODE::ID0: {
+            // The pointer doesn't cross the page boundary (6502 bug).
+            uint16_t target = m_peek(absolute) | (m_peek((absolute & 0xFF00) | ((absolute + 1) & 0x00FF)) << 8);
+            w.put(" ($"); w.hex16(absolute); w.put(") = "); w.hex16(target);
+            break;
+        }
+        case ADDRESS_MODE::IDX: {
+            uint8_t pointer = lo + state.x;
+            uint16_t address = m_peek(pointer) | (m_peek(static_cast<uint8_t>(pointer + 1)) << 8);
+            w.put(" ($"); w.hex8(lo); w.put(",X) @ "); w.hex8(pointer);
+            w.put(" = "); w.hex16(address); w.put(" = "); w.hex8(m_peek(address));
+            break;
+        }
+        case ADDRESS_MODE::IDY: {
+            uint16_t base = m_peek(lo) | (m_peek(static_cast<uint8_t>(lo + 1)) << 8);
+            uint16_t address = base + state.y;
+            w.put(" ($"); w.hex8(lo); w.put("),Y = "); w.hex16(base);
+            w.put(" @ "); w.hex16(address); w.put(" = "); w.hex8(m_peek(address));
+            break;
+        }
+    }
+    w.fill(lineStart + 48);
+
+    // Registers.
+    w.put("A:"); w.hex8(state.a);
+    w.put(" X:"); w.hex8(state.x);
+    w.put(" Y:"); w.hex8(state.y);
+    w.put(" P:"); w.hex8(state.p);
+    w.put(" SP:"); w.hex8(state.sp);
+
+    if(m_position) {
+        PPUPosition position = m_position();
+        w.put(" PPU:"); w.decimal(position.scanline, 3);
+        w.put(','); w.decimal(position.dot, 3);
+    }
+
+    w.put(" CYC:"); w.decimal(static_cast<int64_t>(state.cycles), 0);
+    w.put('\n');
+
+    return w.out - lineStart;
+}
+
+void TraceLogger::flush() {
+
+    if(!m_used)
+        return;
+
+    size_t size = m_used;
+    m_used = 0;
+    if(std::fwrite(m_buffer.get(), 1, size, m_file) != size)
+        throw std::runtime_error("Trace couldn't be written!");
+}
+
+uint64_t TraceLogger::getLineCount() const {
+    return m_lines;
+}
+
+bool TraceLogger::isOfficial(uint8_t opcode) {
+    return OFFICIAL_OPCODES[opcode >> 6] & (uint64_t{1} << (opcode & 0x3F));
+}
@@ -2,36 +2,174 @@
 // Created by golas on 22.2.23.
 //
 
+#include <fstream>
+#include <stdexcept>
+#include "imgui.h"
 #include "systems/Bare6502.h"
 
 Bare6502::Bare6502() {
 
     m_systemName = "Bare 6502";
+    m_systemClockRate = CPU_CLOCK_HZ;
 
-    m_bus.connect("slot 1", m_RAM.getConnector("data"));
-    m_cpu.connect("mainBus", m_bus.getConnector("master"));
+    m_bus.connect("slot 0", m_RAM.getConnector("data"));
+    setFlatMemory(true);
+
+    m_cpuClock.connect(m_cpu.getConnector("CLK"));
 
     m_components.push_back(&m_bus);
     m_components.push_back(&m_RAM);
     m_components.push_back(&m_cpu);
 }
 
+void Bare6502::clock() {
+
+    // The PC of a finished instruction is the address of the next one.
+    if(m_cpu.instrFinished()) {
+
+        uint16_t address = m_cpu.getProgramCounter();
+        if(m_instructionAddress == address) {
+            m_trapped = true;
+            return;
+        }
+        m_instructionAddress = address;
+    }
+
+    m_cpuClock.send();
+    m_clockCount++;
+}
+
 void Bare6502::init() {
 
+    // The CPU reads the reset vector on init, so the program has to be loaded first.
+    m_bus.init();
+    m_RAM.init();
+    m_RAM.load(m_programOffset, m_program);
+    m_cpu.init();
+
+    if(m_startAddress)
+        m_cpu.setProgramCounter(*m_startAddress);
+
+    m_frameCount = 0;
+    m_clockCount = 0;
+    m_instructionAddress.reset();
+    m_trapped = false;
+}
+
+void Bare6502::loadBinary(const std::string & path, uint32_t from) {
+
+    std::ifstream file(path, std::ios_base::binary);
+    if(!file)
+        throw std::runtime_error("Specified file couldn't be opened!");
+
+    std::vector<uint8_t> program((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if(from + program.size() > m_RAM.getData().size())
+        throw std::invalid_argument("The binary doesn't fit the memory.");
+
+    m_program = std::move(program);
+    m_programOffset = from;
+    init();
+}
+
+void Bare6502::setStartAddress(std::optional<uint16_t> address) {
+    m_startAddress = address;
+}
+
+void Bare6502::setFlatMemory(bool enabled) {
+
+    if(enabled)
+        m_cpu.connect("mainBus", m_RAM.getConnector("data"));
+    else
+        m_cpu.connect("mainBus", m_bus.getConnector("master"));
+
+    m_flatMemory = enabled;
+}
+
+bool Bare6502::isFlatMemory() const {
+    return m_flatMemory;
+}
+
+void Bare6502::setDebugHooksEnabled(bool enabled) {
+    m_cpu.setDebugHooksEnabled(enabled);
+}
+
+bool Bare6502::trapped() const {
+    return m_trapped;
+}
+
+uint16_t Bare6502::getTrapAddress() const {
+    return m_instructionAddress.value_or(0);
+}
+
+unsigned long long Bare6502::getClockCount() const {
+    return m_clockCount;
 }
 
 void Bare6502::doClocks(unsigned int count) {
 
+    m_cpu.clearBreakpointHit();
+    for(unsigned int i = 0; i < count && !breakpointHit(); i++)
+        clock();
 }
 
 void Bare6502::doSteps(unsigned int count) {
 
+    m_cpu.clearBreakpointHit();
+    for(unsigned int i = 0; i < count && !breakpointHit(); i++) {
+        do {
+            clock();
+        } while(!m_cpu.instrFinished() && !breakpointHit());
+    }
 }
 
 void Bare6502::doFrames(unsigned int count) {
 
+    m_cpu.clearBreakpointHit();
+    for(unsigned int i = 0; i < count && !breakpointHit(); i++) {
+        for(unsigned int clocks = 0; clocks < FRAME_CLOCKS && !breakpointHit(); clocks++)
+            clock();
+        m_frameCount++;
+    }
 }
 
 void Bare6502::doRun(unsigned int updateFrequency) {
 
+    if(updateFrequency > CPU_CLOCK_HZ)
+        throw std::invalid_argument("Update frequency too high!");
+
+    doClocks(CPU_CLOCK_HZ / updateFrequency);
+}
+
+bool Bare6502::breakpointHit() const {
+    return m_trapped || m_cpu.breakpointHit();
+}
+
+std::vector<EmulatorWindow> Bare6502::getGUIs() {
+
+    std::vector<EmulatorWindow> windows = System::getGUIs();
+
+    windows.push_back(EmulatorWindow{
+        .category = m_systemName,
+        .title = "Settings",
+        .id = reinterpret_cast<uintptr_t>(this),
+        .dock = DockSpace::RIGHT,
+        .guiFunction = [this](){
+
+            bool flatMemory = m_flatMemory;
+            if(ImGui::Checkbox("Connect the CPU directly to the memory", &flatMemory))
+                setFlatMemory(flatMemory);
+
+            bool useStart = m_startAddress.has_value();
+            if(ImGui::Checkbox("Start at a fixed address (applied on reset)", &useStart))
+                setStartAddress(useStart ? std::optional<uint16_t>(0x0400) : std::nullopt);
+            if(m_startAddress)
+                ImGui::InputScalar("Start address", ImGuiDataType_U16, &*m_startAddress, nullptr, nullptr, "%04X", ImGuiInputTextFlags_CharsHexadecimal);
+
+            ImGui::Text("CPU cycles: %llu", m_clockCount);
+            if(m_trapped)
+                ImGui::Text("Trapped at $%04X.", getTrapAddress());
+        }
+    });
+
+    return windows;
 }
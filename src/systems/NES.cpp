@@ -1,4 +1,8 @@
+#include "imgui.h"
 #include "systems/NES.h"
+#include "Sound.h"
+#include "Profiler.h"
+#include "StateHasher.h"
 
 NES::NES() {
 
@@ -13,33 +17,35 @@ NES::NES() {
     m_cpuBus.connect("slot 1", m_ppu.getConnector("cpuBus"));
     m_cpuBus.connect("slot 2", m_cart.getConnector("cpuBus"));
 
-    // Create and connect special connector for APU and peripherals.
-    // This is necessary because there are conflicts on address 0x4017.
-    m_apuPeripheralConnector = std::make_shared<Connector>(DataInterface{
-            .read = [&](uint32_t address, uint32_t & buffer) {
-
-                uint32_t apuResult, peripheralResult;
-                if(address == 0x4017) {
-                    m_apu.getConnector("cpuBus").lock()->getDataInterface().read(address, apuResult);
-                    m_peripherals.getConnector("cpuBus").lock()->getDataInterface().read(address, peripheralResult);
-                    buffer = apuResult | peripheralResult;
-                    return true;
-                } else if(m_apu.getConnector("cpuBus").lock()->getDataInterface().read(address, apuResult)) {
-                    buffer = apuResult;
-                    return true;
-                } else if(m_peripherals.getConnector("cpuBus").lock()->getDataInterface().read(address, peripheralResult)) {
-                    buffer = peripheralResult;
-                    return true;
-                }
+    // The APU is advanced lazily (see flushAPU), so it is brought up to date before its registers are accessed.
+    m_apuConnector = std::make_shared<Connector>(DataInterface{
+            .read = [this](uint32_t address, uint32_t & buffer) {
+
+                if(address >= 0x4000 && address <= 0x4017)
+                    flushAPU();
 
-                return false;
+                uint8_t data;
+                if(!m_apu.cpuRead(address, data))
+                    return false;
+                buffer = data;
+                return true;
             },
-            .write = [&](uint32_t address, uint32_t data) {
-                m_apu.getConnector("cpuBus").lock()->getDataInterface().write(address, data);
-                m_peripherals.getConnector("cpuBus").lock()->getDataInterface().write(address, data);
+            .write = [this](uint32_t address, uint32_t data) {
+
+                if(address >= 0x4000 && address <= 0x4017) {
+                    flushAPU();
+                    if(m_synthesizer)
+                        m_synthesizer->write(m_apuCycles, address, data);
+                }
+
+                m_apu.cpuWrite(address, data);
             }
     });
-    m_cpuBus.connect("slot 3", m_apuPeripheralConnector);
+
+    // APU and peripherals share a single slot, both respond to 0x4017.
+    m_apuPeripheralBus.connect("slot 0", m_apuConnector);
+    m_apuPeripheralBus.connect("slot 1", m_peripherals.getConnector("cpuBus"));
+    m_cpuBus.connect("slot 3", m_apuPeripheralBus.getConnector("master"));
     // This will effectively connect CPU back to itself. OAMDMA pin is located on the CPU.
     m_cpuBus.connect("slot 4", m_cpu.getConnector("OAMDMA"));
 
@@ -51,18 +57,51 @@ NES::NES() {
     // Connect PPU's INT pin to 6502's NMI.
     m_ppu.connect("INT", m_cpu.getConnector("NMI"));
 
+    // While logging, the CPU and PPU tell the cartridge's Code/Data Logger the kind of their reads.
+    m_cart.setCodeDataLoggerListener([this](CodeDataLogger * logger){
+        m_cpu.setCodeDataLogger(logger);
+        m_ppu.setCodeDataLogger(logger);
+    });
+
+    // Banked code is told apart by the guest profiler.
+    m_cpu.setBankResolver([this](uint16_t address){ return m_cart.getPRGBank(address); });
+
+    // CPU trace and breakpoint conditions read only RAM and cartridge, I/O registers are shown as $FF (same as in nestest.log).
+    DataInterface ramData = m_RAM.getConnector("data").lock()->getDataInterface();
+    DataInterface cartData = m_cart.getConnector("cpuBus").lock()->getDataInterface();
+    m_cpu.setDebugSources(
+        [ramData, cartData](uint16_t address) {
+            uint32_t data = 0xFF;
+            if(address < 0x2000)
+                ramData.read(address, data);
+            else if(address >= 0x4020)
+                cartData.read(address, data);
+            return static_cast<uint8_t>(data);
+        },
+        [this]() {
+            // The PPU is clocked first, so it has already rendered the dot of the current CPU cycle.
+            int scanline = m_ppu.getScanline(), dot = m_ppu.getCycle() - 1;
+            if(dot < 0) {
+                dot = 340;
+                scanline = scanline > -1 ? scanline - 1 : 260;
+            }
+            return TraceLogger::PPUPosition{scanline, dot};
+        }
+    );
+
     // Connect APU's IRQ pin to 6502's IRQ.
     m_apu.connect("IRQ", m_cpu.getConnector("IRQ"));
 
-    // Connect CPU's, PPU's and APU's clock to the system clock.
+    // Connect CPU's and PPU's clock to the system clock.
+    // APU is clocked directly in batches, see flushAPU.
     m_cpuClock.connect(m_cpu.getConnector("CLK"));
     m_ppuClock.connect(m_ppu.getConnector("CLK"));
-    m_apuClock.connect(m_apu.getConnector("CLK"));
 
     // Load components to make base class "aware" of the components
     // to show GUI, correctly initialize the system, add sound sources etc.
     m_components.push_back(&m_cpuBus);
     m_components.push_back(&m_ppuBus);
+    m_components.push_back(&m_apuPeripheralBus);
     m_components.push_back(&m_cpu);
     m_components.push_back(&m_apu);
     m_components.push_back(&m_RAM);
@@ -70,38 +109,163 @@ NES::NES() {
     m_components.push_back(&m_cart);
     m_components.push_back(&m_peripherals);
 
+    // APU output is taken either from the synthesizer or directly from the APU.
     for(auto & component : m_components)
-        for(auto & source : component->getSoundSampleSources())
-            m_sampleSources.push_back(source);
+        if(component != &m_apu)
+            for(auto & source : component->getSoundSampleSources())
+                m_sampleSources.push_back(source);
+
+    m_sampleSources.push_back([this](){
+        float sample = m_synthesizer ? m_synthesizer->nextSample() : m_apu.output();
+        if(m_export)
+            m_export->pushAudioSample(sample);
+        return SoundStereoFrame{sample, sample};
+    });
+
+    addFrameSink(&m_screen);
 };
 
 void NES::clock() {
 
     m_ppuClock.send();
+
+    if(m_ppu.frameFinished()) {
+
+        m_frameCount++;
+        USE_PROFILE_FRAME();
+
+        if(m_stateHashEnabled)
+            m_frameStateHash = computeStateHash();
+
+        if(GuestProfiler * profiler = m_cpu.getGuestProfiler())
+            profiler->endFrame();
+
+        // Hand the composed frame to the sinks directly from the PPU frame buffer.
+        if(!m_ppu.renderSkip() && (!m_frameSinks.empty() || m_export)) {
+            VideoFrame frame = m_ppu.getFrame();
+            frame.number = m_frameCount;
+            emitFrame(frame);
+
+            if(m_export)
+                publishState(frame);
+        }
+
+        // Decide whether the next frame will be composed.
+        if(m_frameSkip) {
+            if(m_skippedFrames < m_frameSkip) {
+                m_skippedFrames++;
+                m_ppu.setRenderSkip(true);
+            } else {
+                m_skippedFrames = 0;
+                m_ppu.setRenderSkip(false);
+            }
+        }
+    }
+
     if(m_clockCount % 3 == 0){
 
         m_cpuClock.send();
         if(m_clockCount % 2 == 0){
-            m_apuClock.send();
+            if(++m_apuPendingCycles >= m_apuBatchLimit)
+                flushAPU();
         }
     }
 
     m_clockCount++;
 }
 
+void NES::flushAPU() {
+
+    if(m_apuPendingCycles) {
+        m_apu.clock(m_apuPendingCycles);
+        m_apuCycles += m_apuPendingCycles;
+        m_apuPendingCycles = 0;
+    }
+
+    m_apuBatchLimit = m_apu.cyclesUntilEvent();
+
+    if(m_synthesizer && m_apuCycles - m_apuLastSync >= APU_SYNC_INTERVAL) {
+        m_synthesizer->sync(m_apuCycles);
+        m_apuLastSync = m_apuCycles;
+    }
+}
+
+void NES::publishState(const VideoFrame & frame) {
+
+    const PagedMemory & ram = m_RAM.getData();
+    const PagedMemory & prgRam = m_cart.getPRGRAM();
+    m_exportRAM.resize(ram.size());
+    m_exportPRGRAM.resize(prgRam.size());
+    ram.copyTo(m_exportRAM);
+    prgRam.copyTo(m_exportPRGRAM);
+
+    m_export->publish(frame, m_exportRAM, m_exportPRGRAM);
+}
+
+void NES::setAudioThread(bool enabled) {
+
+    // The synthesizer continues from the live APU state and time, so the running sound isn't lost.
+    flushAPU();
+    if(enabled)
+        m_synthesizer = std::make_unique<APUSynthesizer>(APU_CLOCK_HZ, Sound::getSampleRate(), m_apu, m_apuCycles);
+    else
+        m_synthesizer.reset();
+
+    m_apu.setTimingOnly(enabled);
+    m_apuLastSync = m_apuCycles;
+}
+
+void NES::init() {
+
+    System::init();
+
+    m_apuPendingCycles = 0;
+    m_apuBatchLimit = m_apu.cyclesUntilEvent();
+
+    // Restart the synthesizer, so its APU is reset too.
+    setAudioThread(m_synthesizer != nullptr);
+}
+
+void NES::loadCartridge(const std::string & path) {
+
+    std::ifstream file(path, std::ios_base::binary);
+    if(!file)
+        throw std::runtime_error("Specified file couldn't be opened!");
+
+    m_cart.load(file);
+    init();
+}
+
 void NES::doClocks(unsigned int count) {
-    for(int i = 0; i < count; i++)
+
+    m_cpu.clearBreakpointHit();
+    for(int i = 0; i < count && !m_cpu.breakpointHit(); i++)
         clock();
+
+    flushAPU();
 }
 
 void NES::doSteps(unsigned int count) {
-    while(!m_cpu.instrFinished())
+
+    m_cpu.clearBreakpointHit();
+    while(!m_cpu.instrFinished() && !m_cpu.breakpointHit())
+        clock();
+    if(!m_cpu.breakpointHit())
         clock();
-    clock();
+
+    flushAPU();
 }
 
 void NES::doFrames(unsigned int count) {
 
+    m_cpu.clearBreakpointHit();
+    for(unsigned int i = 0; i < count && !m_cpu.breakpointHit(); i++) {
+        do {
+            clock();
+        } while(!m_ppu.frameFinished() && !m_cpu.breakpointHit());
+    }
+
+    flushAPU();
 }
 
 void NES::doRun(unsigned int updateFrequency) {
@@ -112,9 +276,160 @@ void NES::doRun(unsigned int updateFrequency) {
     // Calculate how many clocks to run based on function call interval.
     unsigned int remainingClocks = PPU_CLOCK_HZ / updateFrequency;
 
-    while(remainingClocks) {
+    m_cpu.clearBreakpointHit();
+    while(remainingClocks && !m_cpu.breakpointHit()) {
         clock();
         remainingClocks--;
     }
+
+    flushAPU();
+}
+
+void NES::setFrameSkip(unsigned int count) {
+
+    m_frameSkip = count;
+    m_skippedFrames = 0;
+
+    // Render the frames again immediately.
+    if(!m_frameSkip)
+        m_ppu.setRenderSkip(false);
+}
+
+std::unique_ptr<System> NES::fork(bool copyOnWrite) const {
+
+    auto copy = std::make_unique<NES>();
+    copy->setDebugHooksEnabled(m_cpu.isDebugHooksEnabled());
+
+    copy->m_cart.copyState(m_cart, copyOnWrite);
+    copy->m_RAM.copyState(m_RAM, copyOnWrite);
+    copy->m_apu.copyState(m_apu);
+    copy->m_peripherals.copyState(m_peripherals);
+    copy->m_ppu.copyState(m_ppu);
+    copy->m_cpu.copyState(m_cpu);
+
+    copy->m_clockCount = m_clockCount;
+    copy->m_frameSkip = m_frameSkip;
+    copy->m_skippedFrames = m_skippedFrames;
+    copy->m_apuPendingCycles = m_apuPendingCycles;
+    copy->m_apuBatchLimit = m_apuBatchLimit;
+    copy->m_apuCycles = m_apuCycles;
+    copy->m_frameCount = m_frameCount;
+    copy->m_stateHashEnabled = m_stateHashEnabled;
+    copy->m_frameStateHash = m_frameStateHash;
+
+    return copy;
+}
+
+uint64_t NES::computeStateHash() {
+
+    flushAPU();
+
+    StateHasher hasher;
+    hasher.add(m_clockCount);
+    m_cpu.hashState(hasher);
+    m_ppu.hashState(hasher);
+    m_apu.hashState(hasher);
+    m_RAM.hashState(hasher);
+    m_cart.hashState(hasher);
+    m_peripherals.hashState(hasher);
+
+    return hasher.digest();
+}
+
+void NES::setSharedMemoryExport(const std::string & name) {
+
+    // Remove the old region first, the name can be the same.
+    m_export.reset();
+    if(!name.empty())
+        m_export = std::make_unique<SharedMemoryExport>(name, Sound::getSampleRate());
+}
+
+void NES::setDebugHooksEnabled(bool enabled) {
+    m_cpu.setDebugHooksEnabled(enabled);
+    m_ppu.setDebugHooksEnabled(enabled);
+}
+
+void NES::setGuestProfilerEnabled(bool enabled) {
+    m_cpu.setGuestProfilerEnabled(enabled);
+}
+
+GuestProfiler * NES::getGuestProfiler() {
+    return m_cpu.getGuestProfiler();
 }
 
+void NES::startCPUTrace(const std::string & path) {
+    m_cpu.startTrace(path);
+}
+
+void NES::stopCPUTrace() {
+    m_cpu.stopTrace();
+}
+
+void NES::setCodeDataLoggerEnabled(bool enabled) {
+    m_cart.setCodeDataLoggerEnabled(enabled);
+}
+
+const CodeDataLogger & NES::getCodeDataLogger() {
+    return m_cart.getCodeDataLogger();
+}
+
+bool NES::breakpointHit() const {
+    return m_cpu.breakpointHit();
+}
+
+std::vector<EmulatorWindow> NES::getGUIs() {
+
+    std::vector<EmulatorWindow> windows = System::getGUIs();
+
+    windows.push_back(EmulatorWindow{
+        .category = m_systemName,
+        .title = "Screen",
+        .id = reinterpret_cast<uintptr_t>(this),
+        .dock = DockSpace::MAIN,
+        .guiFunction = [this](){
+
+            static float scale = 1.0f;
+            ImGui::SliderFloat("Scale", &scale, 1.0, 5.0);
+            m_screen.render(scale);
+        }
+    });
+
+    windows.push_back(EmulatorWindow{
+        .category = m_systemName,
+        .title = "Settings",
+        .id = reinterpret_cast<uintptr_t>(this),
+        .dock = DockSpace::RIGHT,
+        .guiFunction = [this](){
+
+            bool audioThread = m_synthesizer != nullptr;
+            if(ImGui::Checkbox("Synthesize sound on a separate thread", &audioThread))
+                setAudioThread(audioThread);
+
+            if(m_synthesizer) {
+                ImGui::Text("Buffered samples: %zu", m_synthesizer->availableSamples());
+                ImGui::Text("Underruns: %llu", (unsigned long long)m_synthesizer->getUnderruns());
+                ImGui::Text("Overruns: %llu", (unsigned long long)m_synthesizer->getOverruns());
+            }
+
+            bool exportEnabled = m_export != nullptr;
+            if(ImGui::Checkbox("Export state to shared memory", &exportEnabled)) {
+                try {
+                    setSharedMemoryExport(exportEnabled ? DEFAULT_EXPORT_NAME : "");
+                    m_exportError.clear();
+                } catch(std::exception & e) {
+                    m_exportError = e.what();
+                }
+            }
+            if(m_export)
+                ImGui::Text("Region: %s", m_export->getName().c_str());
+            if(!m_exportError.empty())
+                ImGui::Text("Export failed: %s", m_exportError.c_str());
+
+            bool debugHooks = m_cpu.isDebugHooksEnabled();
+            if(ImGui::Checkbox("Debug hooks (trace, profiler, breakpoints, CDL)", &debugHooks))
+                setDebugHooksEnabled(debugHooks);
+        }
+    });
+
+    return windows;
+}
@@ -0,0 +1,252 @@
+#include <fstream>
+#include <stdexcept>
+#include "components/6502Impl.h"
+#include "components/2C02Impl.h"
+#include "StateHasher.h"
+#include "systems/StaticNES.h"
+
+uint8_t StaticNESCPUBus::read(uint16_t address) {
+    return nes->cpuRead(address);
+}
+
+void StaticNESCPUBus::write(uint16_t address, uint8_t data) {
+    nes->cpuWrite(address, data);
+}
+
+template class MOS6502<StaticNESCPUBus>;
+template void MOS6502<StaticNESCPUBus>::CLK<NoHooks>();
+template class R2C02<StaticNESPPUBus>;
+template void R2C02<StaticNESPPUBus>::clock<NoHooks>();
+
+StaticNES::StaticNES() {
+
+    m_systemName = "NES (static)";
+    m_systemClockRate = PPU_CLOCK_HZ;
+
+    // The buses are wired by the policies, only the interrupt lines are connected.
+    m_ppu.connect("INT", m_cpu.getConnector("NMI"));
+    m_apu.connect("IRQ", m_cpu.getConnector("IRQ"));
+
+    // Same order as in NES, the CPU writes the APU registers on init.
+    m_components.push_back(&m_cpu);
+    m_components.push_back(&m_apu);
+    m_components.push_back(&m_RAM);
+    m_components.push_back(&m_ppu);
+    m_components.push_back(&m_cart);
+    m_components.push_back(&m_peripherals);
+
+    for(auto & component : m_components)
+        if(component != &m_apu)
+            for(auto & source : component->getSoundSampleSources())
+                m_sampleSources.push_back(source);
+
+    m_sampleSources.push_back([this](){
+        float sample = m_apu.output();
+        return SoundStereoFrame{sample, sample};
+    });
+}
+
+uint8_t StaticNES::cpuRead(uint16_t address) {
+
+    uint8_t data = 0;
+
+    if(address < 0x2000) {
+        m_RAM.read(address, data);
+    } else if(address < 0x4000) {
+        m_ppu.cpuRead(address, data);
+    } else if(address >= 0x4020) {
+        // Cartridge space, unmapped addresses read as 0.
+        m_cart.cpuRead(address, data);
+    } else if(address == 0x4014) {
+        // OAMDMA is write-only, the PPU responds with 0.
+    } else {
+        // APU and peripherals, both respond to $4017.
+        if(address <= 0x4017)
+            flushAPU();
+
+        if(address == 0x4017) {
+            uint8_t apuData = 0, peripheralData = 0;
+            m_apu.cpuRead(address, apuData);
+            m_peripherals.cpuRead(address, peripheralData);
+            data = apuData | peripheralData;
+        } else if(!m_apu.cpuRead(address, data)) {
+            m_peripherals.cpuRead(address, data);
+        }
+    }
+
+    return data;
+}
+
+void StaticNES::cpuWrite(uint16_t address, uint8_t data) {
+
+    if(address < 0x2000) {
+        m_RAM.write(address, data);
+    } else if(address < 0x4000) {
+        m_ppu.cpuWrite(address, data);
+    } else if(address >= 0x4020) {
+        m_cart.cpuWrite(address, data);
+    } else {
+        if(address <= 0x4017)
+            flushAPU();
+
+        m_apu.cpuWrite(address, data);
+        m_peripherals.cpuWrite(address, data);
+
+        // OAMDMA pin is located on the CPU.
+        if(address == 0x4014)
+            m_cpu.OAMDMA(data);
+    }
+}
+
+void StaticNES::clock() {
+
+    m_ppu.clock<NoHooks>();
+
+    if(m_ppu.frameFinished()) {
+
+        m_frameCount++;
+
+        if(m_stateHashEnabled)
+            m_frameStateHash = computeStateHash();
+
+        if(!m_ppu.renderSkip() && !m_frameSinks.empty()) {
+            VideoFrame frame = m_ppu.getFrame();
+            frame.number = m_frameCount;
+            emitFrame(frame);
+        }
+
+        if(m_frameSkip) {
+            if(m_skippedFrames < m_frameSkip) {
+                m_skippedFrames++;
+                m_ppu.setRenderSkip(true);
+            } else {
+                m_skippedFrames = 0;
+                m_ppu.setRenderSkip(false);
+            }
+        }
+    }
+
+    if(m_clockCount % 3 == 0){
+
+        m_cpu.CLK<NoHooks>();
+        if(m_clockCount % 2 == 0){
+            if(++m_apuPendingCycles >= m_apuBatchLimit)
+                flushAPU();
+        }
+    }
+
+    m_clockCount++;
+}
+
+void StaticNES::flushAPU() {
+
+    if(m_apuPendingCycles) {
+        m_apu.clock(m_apuPendingCycles);
+        m_apuPendingCycles = 0;
+    }
+
+    m_apuBatchLimit = m_apu.cyclesUntilEvent();
+}
+
+void StaticNES::init() {
+
+    System::init();
+
+    m_apuPendingCycles = 0;
+    m_apuBatchLimit = m_apu.cyclesUntilEvent();
+}
+
+void StaticNES::loadCartridge(const std::string & path) {
+
+    std::ifstream file(path, std::ios_base::binary);
+    if(!file)
+        throw std::runtime_error("Specified file couldn't be opened!");
+
+    m_cart.load(file);
+    init();
+}
+
+void StaticNES::doClocks(unsigned int count) {
+
+    for(unsigned int i = 0; i < count; i++)
+        clock();
+
+    flushAPU();
+}
+
+void StaticNES::doSteps(unsigned int /*count*/) {
+
+    // A single instruction, the same as NES::doSteps.
+    while(!m_cpu.instrFinished())
+        clock();
+    clock();
+
+    flushAPU();
+}
+
+void StaticNES::doFrames(unsigned int count) {
+
+    for(unsigned int i = 0; i < count; i++) {
+        do {
+            clock();
+        } while(!m_ppu.frameFinished());
+    }
+
+    flushAPU();
+}
+
+void StaticNES::doRun(unsigned int updateFrequency) {
+
+    if(updateFrequency > PPU_CLOCK_HZ)
+        throw std::invalid_argument("Update frequency too high!");
+
+    doClocks(PPU_CLOCK_HZ / updateFrequency);
+}
+
+void StaticNES::setFrameSkip(unsigned int count) {
+
+    m_frameSkip = count;
+    m_skippedFrames = 0;
+
+    if(!m_frameSkip)
+        m_ppu.setRenderSkip(false);
+}
+
+std::unique_ptr<System> StaticNES::fork(bool copyOnWrite) const {
+
+    auto copy = std::make_unique<StaticNES>();
+
+    copy->m_cart.copyState(m_cart, copyOnWrite);
+    copy->m_RAM.copyState(m_RAM, copyOnWrite);
+    copy->m_apu.copyState(m_apu);
+    copy->m_peripherals.copyState(m_peripherals);
+    copy->m_ppu.copyState(m_ppu);
+    copy->m_cpu.copyState(m_cpu);
+
+    copy->m_clockCount = m_clockCount;
+    copy->m_frameSkip = m_frameSkip;
+    copy->m_skippedFrames = m_skippedFrames;
+    copy->m_apuPendingCycles = m_apuPendingCycles;
+    copy->m_apuBatchLimit = m_apuBatchLimit;
+    copy->m_frameCount = m_frameCount;
+    copy->m_stateHashEnabled = m_stateHashEnabled;
+    copy->m_frameStateHash = m_frameStateHash;
+
+    return copy;
+}
+
+uint64_t StaticNES::computeStateHash() {
+
+    flushAPU();
+
+    StateHasher hasher;
+    hasher.add(m_clockCount);
+    m_cpu.hashState(hasher);
+    m_ppu.hashState(hasher);
+    m_apu.hashState(hasher);
+    m_RAM.hashState(hasher);
+    m_cart.hashState(hasher);
+    m_peripherals.hashState(hasher);
+
+    return hasher.digest();
+}
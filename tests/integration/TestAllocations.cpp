@@ -0,0 +1,187 @@
+/**
+ * @file TestAllocations.cpp Steady-state emulation must not allocate, per-instance footprint.
+ *
+ * The global operator new is replaced by a counting one. Allocations are counted only inside
+ * an AllocationCounter scope, so the test framework itself is not affected.
+ * The live heap size is tracked all the time, every block starts with its size.
+ * */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include "gtest/gtest.h"
+#include "HashFrameSink.h"
+#include "TestCartridge.h"
+#include "systems/NES.h"
+#include "systems/StaticNES.h"
+
+namespace {
+
+    std::atomic<bool> countingEnabled{false};
+    std::atomic<size_t> allocationCount{0};
+    std::atomic<size_t> liveBytes{0};
+
+    /// Size header in front of every block, keeps the default new alignment.
+    constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    /**
+     * Count the heap allocations while the object exists.
+     * */
+    class AllocationCounter {
+    public:
+        AllocationCounter() {
+            allocationCount = 0;
+            countingEnabled = true;
+        }
+
+        ~AllocationCounter() {
+            countingEnabled = false;
+        }
+
+        [[nodiscard]] size_t count() const {
+            return allocationCount;
+        }
+    };
+
+    void * countedAlloc(std::size_t size) {
+
+        if(countingEnabled)
+            allocationCount++;
+
+        auto * block = static_cast<unsigned char *>(std::malloc(size + HEADER_SIZE));
+        if(!block)
+            throw std::bad_alloc();
+
+        *reinterpret_cast<size_t *>(block) = size;
+        liveBytes += size;
+        return block + HEADER_SIZE;
+    }
+
+    void countedFree(void * ptr) {
+
+        if(!ptr)
+            return;
+
+        auto * block = static_cast<unsigned char *>(ptr) - HEADER_SIZE;
+        liveBytes -= *reinterpret_cast<size_t *>(block);
+        std::free(block);
+    }
+
+    class TestAllocations : public TestCartridge {};
+}
+
+void * operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void * operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void * ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void * ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept {
+    countedFree(ptr);
+}
+
+TEST_F(TestAllocations, Counter) {
+
+    AllocationCounter counter;
+    // Direct call, a new-expression could be elided by the compiler.
+    void * data = ::operator new(16);
+    ::operator delete(data);
+    EXPECT_EQ(counter.count(), 1);
+}
+
+TEST_F(TestAllocations, NES) {
+
+    for(bool debugHooks : {true, false}) {
+
+        NES nes;
+        nes.loadCartridge(m_path);
+        nes.setDebugHooksEnabled(debugHooks);
+
+        HashFrameSink sink;
+        nes.addFrameSink(&sink);
+
+        // Warm-up: lazily sized buffers reach their final size.
+        runFrames(nes, 10);
+        nes.doFrames(10);
+
+        AllocationCounter counter;
+        runFrames(nes, 30);
+        nes.doFrames(30);
+        EXPECT_EQ(counter.count(), 0) << "Debug hooks: " << debugHooks;
+    }
+}
+
+TEST_F(TestAllocations, NESDebugFeatures) {
+
+    NES nes;
+    nes.loadCartridge(m_path);
+    nes.setGuestProfilerEnabled(true);
+    nes.setCodeDataLoggerEnabled(true);
+    nes.setFrameSkip(1);
+    nes.setStateHashEnabled(true);
+
+    runFrames(nes, 10);
+
+    AllocationCounter counter;
+    runFrames(nes, 30);
+    EXPECT_EQ(counter.count(), 0);
+}
+
+TEST_F(TestAllocations, StaticNES) {
+
+    StaticNES nes;
+    nes.loadCartridge(m_path);
+
+    HashFrameSink sink;
+    nes.addFrameSink(&sink);
+
+    runFrames(nes, 10);
+
+    AllocationCounter counter;
+    runFrames(nes, 30);
+    nes.doFrames(30);
+    EXPECT_EQ(counter.count(), 0);
+}
+
+/**
+ * Per-instance footprint, for workloads running many instances at once.
+ * The immutable tables (opcodes, colors, APU tables) are shared, the heap is mostly the PPU frame buffers.
+ * */
+TEST_F(TestAllocations, Footprint) {
+
+    const size_t before = liveBytes;
+    auto nes = std::make_unique<NES>();
+    const size_t constructed = liveBytes - before;
+    nes->loadCartridge(m_path);
+    runFrames(*nes, 10);
+    const size_t running = liveBytes - before;
+
+    nes.reset();
+    EXPECT_EQ(liveBytes, before) << "NES leaked memory.";
+
+    RecordProperty("sizeof_NES", static_cast<int>(sizeof(NES)));
+    RecordProperty("sizeof_StaticNES", static_cast<int>(sizeof(StaticNES)));
+    RecordProperty("heap_NES_constructed", static_cast<int>(constructed));
+    RecordProperty("heap_NES", static_cast<int>(running));
+
+    // Regression bounds, the per-instance opcode table alone used to take 10 KiB.
+    EXPECT_LE(sizeof(NES), 8 * 1024);
+    EXPECT_LE(sizeof(StaticNES), 8 * 1024);
+    EXPECT_LE(running, 1024 * 1024);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file TestCartridge.h Generated test cartridge, fixture and run helper shared by the integration tests.
+ * */
+
+#ifndef USE_TESTCARTRIDGE_H
+#define USE_TESTCARTRIDGE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "System.h"
+
+/**
+ * Write a generated NROM cartridge which exercises most of the NES: palette writes through PPUDATA,
+ * scrolling, NMI, OAM DMA, sound registers and the $4015/$4017 reads.
+ * @param path Cartridge path.
+ * @throw std::runtime_error If the file can't be created.
+ * */
+inline void writeTestCartridge(const std::string & path) {
+
+    std::vector<uint8_t> PRGROM(0x4000, 0xEA);
+    const uint8_t program[] = {
+        0x78,                   // $8000 SEI
+        0xD8,                   //       CLD
+        0xA2, 0xFF,             //       LDX #$FF
+        0x9A,                   //       TXS
+        0x2C, 0x02, 0x20,       //       BIT $2002
+        0xA9, 0x3F,             //       LDA #$3F
+        0x8D, 0x06, 0x20,       //       STA $2006
+        0xA9, 0x00,             //       LDA #$00
+        0x8D, 0x06, 0x20,       //       STA $2006
+        0xA2, 0x00,             //       LDX #$00
+        0x8A,                   // $8014 TXA
+        0x8D, 0x07, 0x20,       //       STA $2007
+        0xE8,                   //       INX
+        0xE0, 0x20,             //       CPX #$20
+        0xD0, 0xF7,             //       BNE $8014
+        0xA9, 0x0F,             //       LDA #$0F
+        0x8D, 0x15, 0x40,       //       STA $4015
+        0xA9, 0xBF,             //       LDA #$BF
+        0x8D, 0x00, 0x40,       //       STA $4000
+        0xA9, 0xFD,             //       LDA #$FD
+        0x8D, 0x02, 0x40,       //       STA $4002
+        0xA9, 0x00,             //       LDA #$00
+        0x8D, 0x03, 0x40,       //       STA $4003
+        0xA9, 0x88,             //       LDA #$88
+        0x8D, 0x04, 0x40,       //       STA $4004
+        0xA9, 0x80,             //       LDA #$80
+        0x8D, 0x06, 0x40,       //       STA $4006
+        0xA9, 0x09,             //       LDA #$09
+        0x8D, 0x07, 0x40,       //       STA $4007
+        0xA9, 0x1E,             //       LDA #$1E
+        0x8D, 0x01, 0x20,       //       STA $2001
+        0xA9, 0x80,             //       LDA #$80
+        0x8D, 0x00, 0x20,       //       STA $2000
+        0xAD, 0x15, 0x40,       // $804A LDA $4015
+        0xAD, 0x17, 0x40,       //       LDA $4017
+        0xE6, 0x00,             //       INC $00
+        0x4C, 0x4A, 0x80,       //       JMP $804A
+        0xE6, 0x01,             // $8055 INC $01 (NMI)
+        0xA5, 0x01,             //       LDA $01
+        0x8D, 0x02, 0x40,       //       STA $4002
+        0xA9, 0x02,             //       LDA #$02
+        0x8D, 0x14, 0x40,       //       STA $4014
+        0xA5, 0x01,             //       LDA $01
+        0x8D, 0x05, 0x20,       //       STA $2005
+        0x8D, 0x05, 0x20,       //       STA $2005
+        0x40,                   //       RTI
+        0x40                    // $806A RTI (IRQ)
+    };
+    std::copy(std::begin(program), std::end(program), PRGROM.begin());
+    const uint8_t vectors[] = {0x55, 0x80, 0x00, 0x80, 0x6A, 0x80};
+    std::copy(std::begin(vectors), std::end(vectors), PRGROM.begin() + 0x3FFA);
+
+    std::vector<uint8_t> CHRROM(0x2000);
+    for(size_t i = 0; i < CHRROM.size(); i++)
+        CHRROM[i] = static_cast<uint8_t>(i * 7);
+
+    std::ofstream file(path, std::ios_base::binary);
+    if(!file)
+        throw std::runtime_error("Can't create the test cartridge!");
+
+    const uint8_t header[16] = {'N', 'E', 'S', 0x1A, 1, 1};
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(PRGROM.data()), static_cast<std::streamsize>(PRGROM.size()));
+    file.write(reinterpret_cast<const char *>(CHRROM.data()), static_cast<std::streamsize>(CHRROM.size()));
+}
+
+/**
+ * Fixture writing the test cartridge (see writeTestCartridge) before every test and removing it afterwards.
+ * The file is named after the test, so the tests can run in parallel.
+ * */
+class TestCartridge : public ::testing::Test {
+protected:
+    std::string m_path;
+
+    void SetUp() override {
+        const ::testing::TestInfo * info = ::testing::UnitTest::GetInstance()->current_test_info();
+        m_path = std::string(info->test_suite_name()) + "_" + info->name() + ".nes";
+        ASSERT_NO_THROW(writeTestCartridge(m_path));
+    }
+
+    void TearDown() override {
+        std::remove(m_path.c_str());
+    }
+};
+
+/// Clocks per audio sample, as in the headless runner.
+constexpr unsigned int CHUNK = 121;
+
+/**
+ * Run the system the same way as the frontends do: in audio sample chunks, so the run usually stops
+ * in the middle of a frame.
+ * @param system System to run.
+ * @param frames Count of frames to run.
+ * @param afterChunk Called after every chunk, e.g. to read the sample sources.
+ * @param chunk Clocks per doClocks call.
+ * */
+template<class Callback>
+void runFrames(System & system, uint64_t frames, Callback afterChunk, unsigned int chunk = CHUNK) {
+
+    const uint64_t end = system.getFrameCount() + frames;
+    while(system.getFrameCount() < end) {
+        system.doClocks(chunk);
+        afterChunk();
+    }
+}
+
+/**
+ * Run the system in audio sample chunks, reading every sample source.
+ * @param system System to run.
+ * @param frames Count of frames to run.
+ * */
+inline void runFrames(System & system, uint64_t frames) {
+    runFrames(system, frames, [&system](){
+        for(auto & source : system.getSampleSources())
+            source();
+    });
+}
+
+#endif //USE_TESTCARTRIDGE_H
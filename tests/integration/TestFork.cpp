@@ -0,0 +1,147 @@
+/**
+ * @file TestFork.cpp Forked systems continue exactly like the original and don't affect each other.
+ * */
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HashFrameSink.h"
+#include "TestCartridge.h"
+#include "systems/NES.h"
+#include "systems/StaticNES.h"
+
+namespace {
+
+    /// Frame hashes and audio samples of a run.
+    struct Output {
+        std::vector<uint64_t> frames;
+        std::vector<float> audio;
+    };
+
+    /**
+     * Run the system in audio sample chunks, the run usually stops in the middle of a frame.
+     * @param system System to run.
+     * @param frames Count of frames to run.
+     * @return Hashes of the composed frames and the samples.
+     * */
+    Output run(System & system, uint64_t frames) {
+
+        Output output;
+        HashFrameSink sink(true);
+        system.addFrameSink(&sink);
+
+        runFrames(system, frames, [&](){
+            for(auto & source : system.getSampleSources())
+                output.audio.push_back(source().left);
+        });
+
+        system.removeFrameSink(&sink);
+        output.frames = sink.getHashes();
+        return output;
+    }
+
+    /**
+     * Fork a running system and check that the original, the fork and an uninterrupted run all agree.
+     * @tparam SystemT System type.
+     * @param path Cartridge path.
+     * @param copyOnWrite Fork mode.
+     * */
+    template<class SystemT>
+    void checkFork(const std::string & path, bool copyOnWrite) {
+
+        SystemT reference, original;
+        reference.loadCartridge(path);
+        original.loadCartridge(path);
+        run(reference, 20);
+        run(original, 20);
+
+        std::unique_ptr<System> fork = original.fork(copyOnWrite);
+        EXPECT_EQ(fork->getFrameCount(), original.getFrameCount());
+
+        // The fork runs first, the original must not see any of its writes.
+        Output expected = run(reference, 30);
+        Output forked = run(*fork, 30);
+        Output continued = run(original, 30);
+
+        EXPECT_EQ(forked.frames, expected.frames);
+        EXPECT_EQ(continued.frames, expected.frames);
+        EXPECT_EQ(forked.audio, expected.audio);
+        EXPECT_EQ(continued.audio, expected.audio);
+
+        // A fork of a fork, the original is gone.
+        std::unique_ptr<System> second = fork->fork(copyOnWrite);
+        fork.reset();
+        EXPECT_EQ(run(*second, 10).frames, run(reference, 10).frames);
+    }
+
+    class TestFork : public TestCartridge {};
+}
+
+TEST_F(TestFork, NES) {
+    checkFork<NES>(m_path, true);
+    checkFork<NES>(m_path, false);
+}
+
+TEST_F(TestFork, StaticNES) {
+    checkFork<StaticNES>(m_path, true);
+    checkFork<StaticNES>(m_path, false);
+}
+
+TEST_F(TestFork, Threads) {
+
+    NES reference, original;
+    reference.loadCartridge(m_path);
+    original.loadCartridge(m_path);
+    run(reference, 20);
+    run(original, 20);
+
+    // Both forks share the pages with the original and with each other while they run concurrently.
+    std::unique_ptr<System> first = original.fork();
+    std::unique_ptr<System> second = original.fork();
+    Output firstOutput, secondOutput;
+    std::thread firstThread([&](){ firstOutput = run(*first, 30); });
+    std::thread secondThread([&](){ secondOutput = run(*second, 30); });
+    firstThread.join();
+    secondThread.join();
+
+    Output expected = run(reference, 30);
+    EXPECT_EQ(firstOutput.frames, expected.frames);
+    EXPECT_EQ(secondOutput.frames, expected.frames);
+    EXPECT_EQ(firstOutput.audio, expected.audio);
+    EXPECT_EQ(secondOutput.audio, expected.audio);
+    EXPECT_EQ(run(original, 30).frames, expected.frames);
+}
+
+TEST_F(TestFork, FrameSkip) {
+
+    NES reference, original;
+    reference.loadCartridge(m_path);
+    original.loadCartridge(m_path);
+    reference.setFrameSkip(1);
+    original.setFrameSkip(1);
+    run(reference, 11);
+    run(original, 11);
+
+    std::unique_ptr<System> fork = original.fork();
+    Output expected = run(reference, 20);
+    EXPECT_EQ(run(*fork, 20).frames, expected.frames);
+    EXPECT_EQ(run(original, 20).frames, expected.frames);
+}
+
+TEST_F(TestFork, CodeDataLogger) {
+
+    NES nes;
+    nes.loadCartridge(m_path);
+    run(nes, 2);
+
+    // The fork only allocates the log if it logs.
+    std::unique_ptr<System> fork = nes.fork();
+    auto & forkedNES = dynamic_cast<NES &>(*fork);
+    EXPECT_TRUE(forkedNES.getCodeDataLogger().getPRG().empty());
+
+    forkedNES.setCodeDataLoggerEnabled(true);
+    EXPECT_EQ(forkedNES.getCodeDataLogger().getPRG().size(), nes.getCodeDataLogger().getPRG().size());
+    run(forkedNES, 1);
+    EXPECT_LT(forkedNES.getCodeDataLogger().getSummary().unusedPRG, forkedNES.getCodeDataLogger().getPRG().size());
+}
@@ -0,0 +1,59 @@
+/**
+ * @file TestNestest.cpp CPU trace comparison against the nestest.log reference.
+ * */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "gtest/gtest.h"
+#include "systems/NES.h"
+
+/**
+ * Run nestest in the automated mode (from $C000) and compare the CPU trace line by line with the reference log.
+ * */
+TEST(TestNestest, CPUTrace) {
+
+    class DUT : public NES {
+    public:
+        void prepare() {
+            // The reference log assumes cleared RAM.
+            DataInterface ram = m_RAM.getConnector("data").lock()->getDataInterface();
+            for(uint32_t address = 0x0000; address < 0x0800; address++)
+                ram.write(address, 0x00);
+            m_cpu.setProgramCounter(0xC000);
+        }
+    };
+
+    std::ifstream reference("testfiles/nestest.log");
+    ASSERT_TRUE(reference) << "Can't open nestest.log!";
+
+    std::vector<std::string> expected;
+    for(std::string line; std::getline(reference, line);) {
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        expected.push_back(line);
+    }
+    ASSERT_FALSE(expected.empty());
+
+    const char * tracePath = "nestest_trace.log";
+    DUT nes;
+    nes.loadCartridge("testfiles/nestest.nes");
+    nes.prepare();
+
+    nes.startCPUTrace(tracePath);
+    for(size_t i = 0; i < expected.size(); i++)
+        nes.doSteps(1);
+    nes.stopCPUTrace();
+
+    std::ifstream trace(tracePath);
+    ASSERT_TRUE(trace) << "Can't open the trace!";
+
+    std::string line;
+    for(size_t i = 0; i < expected.size(); i++) {
+        ASSERT_TRUE(std::getline(trace, line)) << "Trace ended at line " << i + 1;
+        ASSERT_EQ(line, expected[i]) << "Mismatch at line " << i + 1;
+    }
+
+    trace.close();
+    std::remove(tracePath);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file TestStateHash.cpp Per-frame state hashes are deterministic and independent of how the system is run.
+ * */
+
+#include <memory>
+#include <set>
+#include <vector>
+#include "gtest/gtest.h"
+#include "TestCartridge.h"
+#include "systems/NES.h"
+#include "systems/StaticNES.h"
+
+namespace {
+
+    /**
+     * Run the system in chunks and collect the state hash of every frame.
+     * @param system System to run, with the state hashing enabled.
+     * @param frames Count of frames to run.
+     * @param chunk Clocks per doClocks call, shorter than a frame.
+     * @return State hashes.
+     * */
+    std::vector<uint64_t> run(System & system, uint64_t frames, unsigned int chunk = CHUNK) {
+
+        std::vector<uint64_t> hashes;
+        uint64_t frame = system.getFrameCount();
+        runFrames(system, frames, [&](){
+            if(system.getFrameCount() != frame) {
+                frame = system.getFrameCount();
+                hashes.push_back(system.getFrameStateHash());
+            }
+        }, chunk);
+
+        return hashes;
+    }
+
+    class TestStateHash : public TestCartridge {
+    protected:
+        template<class SystemT>
+        std::unique_ptr<SystemT> create() {
+            auto system = std::make_unique<SystemT>();
+            system->loadCartridge(m_path);
+            system->setStateHashEnabled(true);
+            return system;
+        }
+    };
+}
+
+TEST_F(TestStateHash, Deterministic) {
+
+    std::vector<uint64_t> first = run(*create<NES>(), 60);
+    ASSERT_EQ(first.size(), 60);
+    EXPECT_EQ(run(*create<NES>(), 60), first);
+
+    // The state changes every frame.
+    EXPECT_EQ(std::set<uint64_t>(first.begin(), first.end()).size(), first.size());
+}
+
+TEST_F(TestStateHash, StaticNES) {
+    EXPECT_EQ(run(*create<StaticNES>(), 60), run(*create<NES>(), 60));
+}
+
+TEST_F(TestStateHash, Batching) {
+
+    std::vector<uint64_t> expected = run(*create<NES>(), 30);
+
+    // Neither the clock batching nor the APU batching affects the hash.
+    EXPECT_EQ(run(*create<NES>(), 30, 1), expected);
+    EXPECT_EQ(run(*create<NES>(), 30, 5000), expected);
+
+    auto nes = create<NES>();
+    std::vector<uint64_t> frames;
+    for(int i = 0; i < 30; i++) {
+        nes->doFrames(1);
+        frames.push_back(nes->getFrameStateHash());
+    }
+    EXPECT_EQ(frames, expected);
+}
+
+TEST_F(TestStateHash, OutputSettings) {
+
+    std::vector<uint64_t> expected = run(*create<NES>(), 30);
+
+    // The frame skip and the debug hooks only change the outputs, not the emulation.
+    auto skipping = create<NES>();
+    skipping->setFrameSkip(2);
+    EXPECT_EQ(run(*skipping, 30), expected);
+
+    auto hooks = create<NES>();
+    hooks->setDebugHooksEnabled(true);
+    EXPECT_EQ(run(*hooks, 30), expected);
+
+    auto noHooks = create<NES>();
+    noHooks->setDebugHooksEnabled(false);
+    EXPECT_EQ(run(*noHooks, 30), expected);
+}
+
+TEST_F(TestStateHash, Fork) {
+
+    auto reference = create<NES>();
+    auto original = create<NES>();
+    run(*reference, 20);
+    run(*original, 20);
+
+    // A fork is in the same state, also in the middle of a frame.
+    original->doClocks(1000);
+    reference->doClocks(1000);
+    std::unique_ptr<System> fork = original->fork();
+    EXPECT_EQ(fork->computeStateHash(), original->computeStateHash());
+    EXPECT_EQ(fork->getFrameStateHash(), original->getFrameStateHash());
+
+    std::vector<uint64_t> expected = run(*reference, 20);
+    EXPECT_EQ(run(*fork, 20), expected);
+    EXPECT_EQ(run(*original, 20), expected);
+}
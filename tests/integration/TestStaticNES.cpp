@@ -0,0 +1,72 @@
+/**
+ * @file TestStaticNES.cpp Cross-check of StaticNES against NES.
+ * */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HashFrameSink.h"
+#include "TestCartridge.h"
+#include "systems/NES.h"
+#include "systems/StaticNES.h"
+
+namespace {
+
+    /**
+     * Run both systems in lockstep and compare every audio sample and frame.
+     * @param path Cartridge path.
+     * @param frames Count of frames to run.
+     * */
+    void crossCheck(const std::string & path, uint64_t frames) {
+
+        NES nes;
+        StaticNES staticNES;
+        nes.loadCartridge(path);
+        staticNES.loadCartridge(path);
+
+        HashFrameSink nesHashes(true), staticHashes(true);
+        nes.addFrameSink(&nesHashes);
+        staticNES.addFrameSink(&staticHashes);
+
+        // Roughly one chunk per 44.1 kHz sample, as in the headless runner.
+        constexpr unsigned int CHUNK = 121;
+        while(nes.getFrameCount() < frames) {
+
+            nes.doClocks(CHUNK);
+            staticNES.doClocks(CHUNK);
+
+            const SoundSampleSources & nesSources = nes.getSampleSources();
+            const SoundSampleSources & staticSources = staticNES.getSampleSources();
+            ASSERT_EQ(nesSources.size(), staticSources.size());
+            for(size_t i = 0; i < nesSources.size(); i++) {
+                SoundStereoFrame expected = nesSources[i](), actual = staticSources[i]();
+                ASSERT_EQ(expected.left, actual.left) << "Audio differs in frame " << nes.getFrameCount() << ".";
+                ASSERT_EQ(expected.right, actual.right) << "Audio differs in frame " << nes.getFrameCount() << ".";
+            }
+        }
+
+        EXPECT_EQ(staticNES.getFrameCount(), nes.getFrameCount());
+        EXPECT_EQ(staticHashes.getHashes(), nesHashes.getHashes());
+        EXPECT_EQ(nesHashes.getFrameCount(), frames);
+    }
+}
+
+/**
+ * The generated cartridge exercises the paths wired differently in StaticNES.
+ * */
+TEST(TestStaticNES, CrossCheck) {
+
+    const char * path = "static_nes_test.nes";
+    ASSERT_NO_THROW(writeTestCartridge(path));
+
+    crossCheck(path, 60);
+    std::remove(path);
+}
+
+TEST(TestStaticNES, Nestest) {
+
+    ASSERT_TRUE(std::ifstream("testfiles/nestest.nes")) << "Can't open nestest.nes!";
+    crossCheck("testfiles/nestest.nes", 30);
+}
@@ -3,8 +3,9 @@
  * */
 
 #include <fstream>
+#include <random>
 #include "gtest/gtest.h"
-#include "components/6502.h"
+#include "Test6502DUT.h"
 
 TEST(Test6502, Functional) {
 
@@ -20,23 +21,11 @@ TEST(Test6502, Functional) {
     testROM.read((char*)memory.data(), memory.size());
     ASSERT_TRUE(testROM) << "Can't load test ROM.";
 
-    // Create a connector for the mock memory.
-    std::shared_ptr<Connector> memCon = std::make_shared<Connector>(
-        DataInterface{
-            .read = [&memory](uint32_t address, uint32_t & buffer) -> bool{
-                buffer = memory.at(address);
-                return true;
-            },
-            .write = [&memory](uint32_t address, uint32_t data){
-                memory.at(address) = data;
-            }
-        }
-    );
-
-    // Create a CPU and connect the memory.
-    // No other devices will be connected, so the bus can be represented by the memory.
-    class DUT : public MOS6502 {
+    // Create a CPU with the memory as its bus.
+    // No other devices will be connected, so the flat bus variant is used.
+    class DUT : public MOS6502<FlatBus> {
     public:
+        using MOS6502<FlatBus>::MOS6502;
         void step() {
             while(!instrFinished()) {
                 CLK();
@@ -51,8 +40,7 @@ TEST(Test6502, Functional) {
         }
     };
 
-    DUT cpu;
-    cpu.connect("mainBus", memCon);
+    DUT cpu(FlatBus{memory.data()});
     cpu.setPC(0x400);
 
     uint16_t prevPC;
@@ -84,7 +72,7 @@ TEST(Test6502, Interrupt) {
 
     // Create a CPU and connect the memory.
     // No other devices will be connected, so the bus can be represented by the memory.
-    class DUT : public MOS6502 {
+    class DUT : public MOS6502<> {
     public:
         void step() {
             while(!instrFinished()) {
@@ -135,4 +123,39 @@ TEST(Test6502, Interrupt) {
     } while(prevPC != cpu.getPC());
 
     EXPECT_EQ(prevPC, ADR_SUCCESS) << "The test failed on trap at address 0x" << std::hex << prevPC;
-}
\ No newline at end of file
+}
+
+TEST(Test6502, BusPolicies) {
+
+    // Random memory without the JAM opcodes, run on the DataPort and the flat bus variant.
+    std::mt19937 generator(6502);
+    std::vector<uint8_t> image(0x10000);
+    for(auto & byte : image) {
+        byte = static_cast<uint8_t>(generator());
+        if((byte & 0x0F) == 0x02 && (byte < 0x80 || byte == 0x92 || byte == 0xB2 || byte == 0xD2 || byte == 0xF2))
+            byte = 0xEA;
+    }
+
+    class FlatDUT : public MOS6502<FlatBus> {
+    public:
+        using MOS6502<FlatBus>::MOS6502;
+        void run(int clocks) { while(clocks--) CLK(); }
+    };
+
+    std::vector<uint8_t> portMemory = image, flatMemory = image;
+    auto memCon = makeMemoryConnector(portMemory);
+
+    Test6502DUT portCPU;
+    portCPU.connect("mainBus", memCon);
+    portCPU.init();
+    FlatDUT flatCPU(FlatBus{flatMemory.data()});
+    flatCPU.init();
+
+    for(int slice = 0; slice < 100; slice++) {
+        portCPU.run(1000);
+        flatCPU.run(1000);
+        ASSERT_EQ(portCPU.getProgramCounter(), flatCPU.getProgramCounter()) << "Diverged in slice " << slice;
+    }
+    EXPECT_EQ(portMemory, flatMemory);
+    EXPECT_NE(flatMemory, image);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file Test6502DUT.h 6502 harness shared by the CPU unit tests.
+ * */
+
+#ifndef USE_TEST6502DUT_H
+#define USE_TEST6502DUT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "components/6502.h"
+
+/**
+ * Create a connector for a mock memory. No other devices are connected, so the bus can be represented by the memory.
+ * @param memory 64 KiB of memory, it has to outlive the connector.
+ * @return Connector for the CPU's "mainBus" port, the test has to keep it (ports hold weak references).
+ * */
+inline std::shared_ptr<Connector> makeMemoryConnector(std::vector<uint8_t> & memory) {
+
+    return std::make_shared<Connector>(DataInterface{
+        .read = [&memory](uint32_t address, uint32_t & buffer) {
+            buffer = memory.at(address);
+            return true;
+        },
+        .write = [&memory](uint32_t address, uint32_t data) {
+            memory.at(address) = data;
+        }
+    });
+}
+
+/**
+ * 6502 with access to its registers, clocked directly by the test.
+ * */
+class Test6502DUT : public MOS6502<> {
+public:
+    /// Finish the current instruction and fetch the next one.
+    void step() {
+        while(!instrFinished())
+            CLK();
+        CLK();
+    }
+
+    /// Clock until a breakpoint is hit, return the clock count.
+    int run(int limit) {
+        clearBreakpointHit();
+        int clocks = 0;
+        while(!breakpointHit() && clocks < limit) {
+            CLK();
+            clocks++;
+        }
+        return clocks;
+    }
+
+    uint16_t getPC() const { return m_registers.pc; }
+    void setPC(uint16_t val) { m_registers.pc = val; }
+    uint8_t getX() const { return m_registers.x; }
+};
+
+#endif //USE_TEST6502DUT_H
@@ -0,0 +1,242 @@
+/**
+ * @file TestAPU.cpp APU tests.
+ * */
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "gtest/gtest.h"
+#include "components/APU.h"
+#include "components/APUSynthesizer.h"
+
+TEST(TestAPU, Silence) {
+
+    APU apu;
+    apu.init();
+
+    EXPECT_FLOAT_EQ(apu.output(), 0);
+
+    std::vector<float> block(256, 1.0f);
+    apu.render(block.data(), block.size(), 894886, 44100);
+    for(auto sample : block)
+        EXPECT_FLOAT_EQ(sample, 0);
+}
+
+TEST(TestAPU, PulseRender) {
+
+    APU apu;
+    apu.init();
+    auto cpuBus = apu.getConnector("cpuBus").lock()->getDataInterface();
+
+    // Pulse 1: enable, 50 % duty, constant volume 15, period 0xFD (about 440 Hz).
+    cpuBus.write(0x4015, 0x01);
+    cpuBus.write(0x4000, 0xBF);
+    cpuBus.write(0x4002, 0xFD);
+    cpuBus.write(0x4003, 0x08);
+
+    std::vector<float> block(4410);
+    apu.render(block.data(), block.size(), 894886, 44100);
+
+    // Max level of a single pulse channel at full volume: 95.52 / (8128 / 15 + 100).
+    const float high = 95.52f / (8128.0f / 15.0f + 100.0f);
+
+    int highCount = 0, edges = 0;
+    for(size_t i = 0; i < block.size(); i++) {
+        EXPECT_TRUE(block[i] == 0 || block[i] == high);
+        if(block[i] == high) highCount++;
+        if(i > 0 && block[i] != block[i - 1]) edges++;
+    }
+
+    // 50 % duty cycle.
+    EXPECT_NEAR(highCount, block.size() / 2, block.size() / 20);
+    // 0.1 s of a 440 Hz square wave = 88 edges.
+    EXPECT_NEAR(edges, 88, 4);
+}
+
+TEST(TestAPU, BatchedClock) {
+
+    // Batched clocking must be equivalent to the single cycle clocking, and both to the APU before the batching.
+    APU single, batched;
+    single.init();
+    batched.init();
+
+    bool irqSingle = false, irqBatched = false;
+    auto irqSingleConnector = std::make_shared<Connector>(SignalInterface{.set = [&](bool active){ irqSingle = active; }});
+    auto irqBatchedConnector = std::make_shared<Connector>(SignalInterface{.set = [&](bool active){ irqBatched = active; }});
+    single.connect("IRQ", irqSingleConnector);
+    batched.connect("IRQ", irqBatchedConnector);
+
+    auto busSingle = single.getConnector("cpuBus").lock()->getDataInterface();
+    auto busBatched = batched.getConnector("cpuBus").lock()->getDataInterface();
+    auto write = [&](uint32_t address, uint32_t data) {
+        busSingle.write(address, data);
+        busBatched.write(address, data);
+    };
+
+    // Reference recorded with the per-cycle APU::clock() of the APU before the batching: state before
+    // the status read of every 50th round, and a FNV-1a hash of the output bits, IRQ and status of all rounds.
+    struct Checkpoint {
+        uint64_t cycles;
+        float output;
+        bool irq;
+        uint32_t status;
+    };
+    const Checkpoint reference[] = {
+            {13385,  0x0p+0f,         false, 0x03},
+            {29992,  0x0p+0f,         true,  0x43},
+            {43647,  0x1.6f06b4p-5f,  false, 0x03},
+            {58959,  0x0p+0f,         true,  0x43},
+            {74861,  0x0p+0f,         true,  0x43},
+            {88788,  0x1.6f06b4p-5f,  true,  0x43},
+            {104099, 0x0p+0f,         true,  0x43},
+            {119931, 0x1.6f06b4p-5f,  true,  0x43},
+    };
+    const uint64_t referenceHash = 0xC87F198F7E3C253B;
+
+    uint64_t hash = 0xCBF29CE484222325;
+    auto feed = [&hash](uint32_t value) {
+        for(int i = 0; i < 4; i++) {
+            hash ^= (value >> (8 * i)) & 0xFF;
+            hash *= 0x100000001B3;
+        }
+    };
+
+    write(0x4015, 0x0B);
+    write(0x4000, 0x94);  // Envelope decay, period 4.
+    write(0x4001, 0xA2);  // Sweep.
+    write(0x4002, 0x40);
+    write(0x4003, 0x31);
+    write(0x4004, 0x5A);
+    write(0x4006, 0x13);
+    write(0x4007, 0x08);
+    write(0x400C, 0x07);
+    write(0x400E, 0x83);
+    write(0x400F, 0x18);
+
+    uint32_t step = 1;
+    uint64_t cycles = 0;
+    for(int round = 0; round < 400; round++) {
+
+        for(uint32_t i = 0; i < step; i++)
+            single.clock();
+        batched.clock(step);
+        cycles += step;
+
+        float output = batched.output();
+        ASSERT_FLOAT_EQ(single.output(), output) << "Round " << round;
+        ASSERT_EQ(irqSingle, irqBatched) << "Round " << round;
+        feed(std::bit_cast<uint32_t>(output));
+        feed(irqBatched);
+
+        // Status read clears the IRQ.
+        if(round % 50 == 49) {
+
+            const Checkpoint & expected = reference[round / 50];
+            ASSERT_EQ(cycles, expected.cycles);
+            EXPECT_EQ(output, expected.output) << "Round " << round;
+            EXPECT_EQ(irqBatched, expected.irq) << "Round " << round;
+
+            uint32_t statusSingle, statusBatched;
+            busSingle.read(0x4015, statusSingle);
+            busBatched.read(0x4015, statusBatched);
+            ASSERT_EQ(statusSingle, statusBatched);
+            EXPECT_EQ(statusBatched, expected.status) << "Round " << round;
+            feed(statusBatched);
+        }
+
+        // Switch to the 5-step sequence in the middle.
+        if(round == 200)
+            write(0x4017, 0x80);
+
+        step = (step * 7 + 13) % 577 + 1;
+    }
+
+    EXPECT_EQ(hash, referenceHash);
+}
+
+TEST(TestAPU, Synthesizer) {
+
+    const uint32_t clockRate = 894886, sampleRate = 44100;
+
+    // Reference: writes applied at the same sample boundaries, rendered on this thread.
+    APU reference;
+    reference.init();
+    auto referenceBus = reference.getConnector("cpuBus").lock()->getDataInterface();
+
+    APUSynthesizer synthesizer(clockRate, sampleRate);
+
+    const std::vector<APUSynthesizer::RegisterWrite> writes = {
+            {.timestamp = 100,   .address = 0x4015, .data = 0x09},
+            {.timestamp = 100,   .address = 0x4000, .data = 0xBF},
+            {.timestamp = 120,   .address = 0x4002, .data = 0xFD},
+            {.timestamp = 150,   .address = 0x4003, .data = 0x08},
+            {.timestamp = 5000,  .address = 0x400C, .data = 0x3A},
+            {.timestamp = 5000,  .address = 0x400E, .data = 0x04},
+            {.timestamp = 5020,  .address = 0x400F, .data = 0x08},
+            {.timestamp = 12000, .address = 0x4002, .data = 0x70},
+    };
+    const uint64_t endTime = 20000;
+
+    std::vector<float> expected;
+    uint64_t rendered = 0;
+    auto renderReference = [&](uint64_t time) {
+        uint64_t due = time * sampleRate / clockRate;
+        std::vector<float> block(due - rendered);
+        reference.render(block.data(), block.size(), clockRate, sampleRate);
+        expected.insert(expected.end(), block.begin(), block.end());
+        rendered = due;
+    };
+
+    for(auto & write : writes) {
+        renderReference(write.timestamp);
+        referenceBus.write(write.address, write.data);
+        synthesizer.write(write.timestamp, write.address, write.data);
+    }
+    renderReference(endTime);
+    synthesizer.sync(endTime);
+
+    // Wait for the synthesizer thread.
+    for(int i = 0; i < 1000 && synthesizer.availableSamples() < expected.size(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(synthesizer.availableSamples(), expected.size());
+
+    for(float sample : expected)
+        ASSERT_FLOAT_EQ(synthesizer.nextSample(), sample);
+    EXPECT_EQ(synthesizer.getUnderruns(), 0);
+}
+
+TEST(TestAPU, SynthesizerContinues) {
+
+    const uint32_t clockRate = 894886, sampleRate = 44100;
+
+    // The sound is started before the synthesizer exists.
+    APU reference;
+    reference.init();
+    auto referenceBus = reference.getConnector("cpuBus").lock()->getDataInterface();
+    referenceBus.write(0x4015, 0x01);
+    referenceBus.write(0x4000, 0xBF);
+    referenceBus.write(0x4002, 0xFD);
+    referenceBus.write(0x4003, 0x08);
+
+    const uint64_t startTime = 10000, endTime = 30000;
+    uint64_t rendered = startTime * sampleRate / clockRate;
+    std::vector<float> block(rendered);
+    reference.render(block.data(), block.size(), clockRate, sampleRate);
+
+    APUSynthesizer synthesizer(clockRate, sampleRate, reference, startTime);
+
+    std::vector<float> expected(endTime * sampleRate / clockRate - rendered);
+    reference.render(expected.data(), expected.size(), clockRate, sampleRate);
+    synthesizer.sync(endTime);
+
+    for(int i = 0; i < 1000 && synthesizer.availableSamples() < expected.size(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(synthesizer.availableSamples(), expected.size());
+
+    // The tone continues without a gap.
+    for(float sample : expected)
+        ASSERT_FLOAT_EQ(synthesizer.nextSample(), sample);
+    EXPECT_NE(*std::max_element(expected.begin(), expected.end()), 0);
+}
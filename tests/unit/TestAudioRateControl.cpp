@@ -0,0 +1,116 @@
+/**
+ * @file TestAudioRateControl.cpp Audio rate control tests.
+ * */
+
+#include <algorithm>
+#include "gtest/gtest.h"
+#include "AudioRateControl.h"
+
+namespace {
+
+    constexpr size_t TARGET = 1470;
+    constexpr double MAX_DEVIATION = 0.005;
+
+    /**
+     * Sink with a ring buffer read by a device whose clock differs from the producer clock.
+     * */
+    struct SimulatedSink {
+
+        static constexpr size_t BUFFER_SIZE = 4096;
+        /// Frames read by the device at once.
+        static constexpr size_t PERIOD = 512;
+
+        AudioRateControl control{TARGET, MAX_DEVIATION};
+        size_t buffered = TARGET;
+        /// Fractional frames of the producer.
+        double produced = 0;
+
+        /**
+         * Produce the frames of a device period at the rate ratio, then let the device read the period.
+         * @param drift Relative speed of the device clock to the producer clock (0.01 = 1 % faster).
+         * */
+        void period(double drift) {
+
+            produced += PERIOD * control.getRateRatio(buffered) / (1.0 + drift);
+            for(; produced >= 1.0; produced -= 1.0) {
+                if(buffered == BUFFER_SIZE)
+                    control.overrun();
+                else
+                    buffered++;
+            }
+
+            control.read(buffered, PERIOD);
+            buffered -= std::min(buffered, PERIOD);
+        }
+    };
+}
+
+TEST(TestAudioRateControl, RateRatio) {
+
+    AudioRateControl control(TARGET, MAX_DEVIATION);
+    EXPECT_EQ(control.getTargetFrames(), TARGET);
+
+    EXPECT_DOUBLE_EQ(control.getRateRatio(TARGET), 1.0);
+    // Draining buffer, produce more.
+    EXPECT_DOUBLE_EQ(control.getRateRatio(0), 1.0 + MAX_DEVIATION);
+    EXPECT_DOUBLE_EQ(control.getRateRatio(TARGET / 2), 1.0 + MAX_DEVIATION / 2);
+    // Filling buffer, produce less, the deviation is limited.
+    EXPECT_DOUBLE_EQ(control.getRateRatio(TARGET * 3 / 2), 1.0 - MAX_DEVIATION / 2);
+    EXPECT_DOUBLE_EQ(control.getRateRatio(TARGET * 10), 1.0 - MAX_DEVIATION);
+}
+
+TEST(TestAudioRateControl, Counters) {
+
+    AudioRateControl control(TARGET, MAX_DEVIATION);
+    control.read(512, 512);
+    control.read(2000, 512);
+    EXPECT_EQ(control.getUnderruns(), 0);
+    control.read(511, 512);
+    control.read(0, 512);
+    EXPECT_EQ(control.getUnderruns(), 2);
+
+    EXPECT_EQ(control.getOverruns(), 0);
+    control.overrun();
+    EXPECT_EQ(control.getOverruns(), 1);
+    EXPECT_EQ(control.getUnderruns(), 2);
+}
+
+TEST(TestAudioRateControl, CompensatedDrift) {
+
+    // A drift within the maximal deviation settles where the ratio compensates it, without any underrun or overrun.
+    for(double drift : {0.003, -0.003}) {
+
+        SimulatedSink sink;
+        for(int i = 0; i < 20000; i++)
+            sink.period(drift);
+
+        EXPECT_EQ(sink.control.getUnderruns(), 0) << "Drift " << drift;
+        EXPECT_EQ(sink.control.getOverruns(), 0) << "Drift " << drift;
+        EXPECT_NEAR(sink.control.getRateRatio(sink.buffered), 1.0 + drift, 0.0002) << "Drift " << drift;
+    }
+}
+
+TEST(TestAudioRateControl, Underrun) {
+
+    // The device is too fast to compensate: the buffer drains and the ratio stays at the maximum.
+    SimulatedSink sink;
+    for(int i = 0; i < 5000; i++)
+        sink.period(0.01);
+
+    EXPECT_GT(sink.control.getUnderruns(), 0);
+    EXPECT_EQ(sink.control.getOverruns(), 0);
+    EXPECT_GT(sink.control.getRateRatio(sink.buffered), 1.0);
+    EXPECT_DOUBLE_EQ(sink.control.getRateRatio(0), 1.0 + MAX_DEVIATION);
+}
+
+TEST(TestAudioRateControl, Overrun) {
+
+    // The device is too slow to compensate: the buffer fills up and the producer is slowed down.
+    SimulatedSink sink;
+    for(int i = 0; i < 5000; i++)
+        sink.period(-0.01);
+
+    EXPECT_GT(sink.control.getOverruns(), 0);
+    EXPECT_EQ(sink.control.getUnderruns(), 0);
+    EXPECT_DOUBLE_EQ(sink.control.getRateRatio(sink.buffered), 1.0 - MAX_DEVIATION);
+}
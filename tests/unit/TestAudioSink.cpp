@@ -0,0 +1,130 @@
+/**
+ * @file TestAudioSink.cpp Audio sink tests.
+ * */
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include "gtest/gtest.h"
+#include "AudioSink.h"
+#include "MemoryAudioSink.h"
+#include "WavAudioSink.h"
+
+namespace {
+
+    SoundSampleSources makeSources(float & value) {
+        return {
+            [&value](){ return SoundStereoFrame{value, -value}; },
+            [](){ return SoundStereoFrame{0.25f, 0.25f}; }
+        };
+    }
+
+    uint32_t readLE32(const std::vector<char> & data, size_t offset) {
+        uint32_t value = 0;
+        for(size_t i = 0; i < 4; i++)
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(data[offset + i])) << (8 * i);
+        return value;
+    }
+}
+
+TEST(TestAudioSink, Null) {
+
+    bool evaluated = false;
+    SoundSampleSources sources{[&evaluated](){ evaluated = true; return SoundStereoFrame{0, 0}; }};
+
+    NullAudioSink sink;
+    sink.start();
+    sink.writeFrames(sources);
+    sink.stop();
+
+    EXPECT_FALSE(evaluated);
+    EXPECT_EQ(sink.getTargetBufferedFrames(), 0);
+    EXPECT_DOUBLE_EQ(sink.getRateRatio(), 1.0);
+}
+
+TEST(TestAudioSink, Memory) {
+
+    float value = 0;
+    SoundSampleSources sources = makeSources(value);
+    MemoryAudioSink sink;
+
+    for(int i = 0; i < 10; i++) {
+        value = i * 0.05f;
+        sink.writeFrames(sources);
+    }
+
+    ASSERT_EQ(sink.getFrameCount(), 10);
+    EXPECT_FLOAT_EQ(sink.getSamples()[6], 0.15f + 0.25f);
+    EXPECT_FLOAT_EQ(sink.getSamples()[7], -0.15f + 0.25f);
+
+    // Same data = same hash.
+    MemoryAudioSink other;
+    for(int i = 0; i < 10; i++) {
+        value = i * 0.05f;
+        other.writeFrames(sources);
+    }
+    EXPECT_EQ(sink.hash(), other.hash());
+
+    other.writeFrames(sources);
+    EXPECT_NE(sink.hash(), other.hash());
+
+    other.clear();
+    EXPECT_EQ(other.getFrameCount(), 0);
+}
+
+TEST(TestAudioSink, Wav) {
+
+    const char * path = "TestAudioSink.wav";
+    const size_t frames = 100000;   // More than a single block.
+
+    for(auto format : {WavAudioSink::FORMAT::FLOAT32, WavAudioSink::FORMAT::PCM16}) {
+
+        float value = 0;
+        SoundSampleSources sources = makeSources(value);
+        const size_t sampleBytes = (format == WavAudioSink::FORMAT::FLOAT32) ? 4 : 2;
+
+        {
+            WavAudioSink sink(path, 44100, format);
+            for(size_t i = 0; i < frames; i++) {
+                value = static_cast<float>(i % 100) / 200.0f;
+                sink.writeFrames(sources);
+            }
+            EXPECT_EQ(sink.getFrameCount(), frames);
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        ASSERT_EQ(data.size(), 44 + frames * 2 * sampleBytes);
+        EXPECT_EQ(std::memcmp(data.data(), "RIFF", 4), 0);
+        EXPECT_EQ(readLE32(data, 4), data.size() - 8);
+        EXPECT_EQ(std::memcmp(data.data() + 8, "WAVE", 4), 0);
+        EXPECT_EQ(readLE32(data, 24), 44100);
+        EXPECT_EQ(readLE32(data, 40), frames * 2 * sampleBytes);
+
+        // Frame 30: left = 0.15 + 0.25, right = -0.15 + 0.25.
+        size_t offset = 44 + 30 * 2 * sampleBytes;
+        if(format == WavAudioSink::FORMAT::FLOAT32) {
+            float left, right;
+            std::memcpy(&left, data.data() + offset, 4);
+            std::memcpy(&right, data.data() + offset + 4, 4);
+            EXPECT_FLOAT_EQ(left, 0.4f);
+            EXPECT_FLOAT_EQ(right, 0.1f);
+        } else {
+            int16_t left = static_cast<int16_t>(readLE32(data, offset) & 0xFFFF);
+            EXPECT_EQ(left, static_cast<int16_t>(0.4f * 32767.0f));
+        }
+    }
+
+    std::remove(path);
+}
+
+TEST(TestAudioSink, WavWriteError) {
+
+    if(!std::filesystem::exists("/dev/full"))
+        GTEST_SKIP() << "No full device to write to.";
+
+    EXPECT_THROW(WavAudioSink("/dev/full", 44100), std::runtime_error);
+}
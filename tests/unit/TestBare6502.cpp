@@ -0,0 +1,105 @@
+/**
+ * @file TestBare6502.cpp Bare 6502 system tests.
+ * */
+
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+#include "systems/Bare6502.h"
+
+TEST(TestBare6502, Trap) {
+
+    // $0400: LDX #$05; loop: DEX, BNE loop; LDA #$01, BEQ * (not taken); BNE * (trap).
+    std::vector<uint8_t> binary(0x10000, 0x00);
+    const uint8_t program[] = {0xA2, 0x05, 0xCA, 0xD0, 0xFD, 0xA9, 0x01, 0xF0, 0xFE, 0xD0, 0xFE};
+    std::copy(std::begin(program), std::end(program), binary.begin() + 0x0400);
+    binary[0xFFFC] = 0x00;
+    binary[0xFFFD] = 0x04;
+
+    const char * path = "bare6502_test.bin";
+    {
+        std::ofstream file(path, std::ios_base::binary);
+        file.write(reinterpret_cast<const char *>(binary.data()), static_cast<std::streamsize>(binary.size()));
+    }
+
+    unsigned long long clocks[2];
+    for(bool flat : {true, false}) {
+
+        Bare6502 system;
+        system.setFlatMemory(flat);
+        EXPECT_EQ(system.isFlatMemory(), flat);
+        system.loadBinary(path);
+
+        system.doFrames(1);
+        EXPECT_TRUE(system.trapped());
+        EXPECT_TRUE(system.breakpointHit());
+        EXPECT_EQ(system.getTrapAddress(), 0x0409);
+        clocks[flat] = system.getClockCount();
+
+        // Stays trapped, the CPU isn't clocked anymore.
+        system.doClocks(100);
+        EXPECT_EQ(system.getClockCount(), clocks[flat]);
+
+        // Starting right at the trap.
+        system.setStartAddress(0x0409);
+        system.init();
+        EXPECT_FALSE(system.trapped());
+        system.doSteps(10);
+        EXPECT_TRUE(system.trapped());
+        EXPECT_EQ(system.getTrapAddress(), 0x0409);
+    }
+    // Reset (7) + LDX (2) + 4 taken BNE (3) + DEX (2) * 5 + BNE not taken (2) + LDA (2) + BEQ (2) + BNE (3).
+    EXPECT_EQ(clocks[true], 7 + 2 + 4 * 3 + 5 * 2 + 2 + 2 + 2 + 3);
+    EXPECT_EQ(clocks[true], clocks[false]);
+
+    Bare6502 system;
+    EXPECT_THROW(system.loadBinary(path, 0x0001), std::invalid_argument);
+    std::remove(path);
+    EXPECT_THROW(system.loadBinary("missing.bin"), std::runtime_error);
+}
+
+TEST(TestBare6502, Configurations) {
+
+    // Loaded at $0400 without a reset vector: LDX #$00; loop: TXA, STA $0200,X, INX, CPX #$10, BNE loop; JMP *.
+    const uint8_t program[] = {0xA2, 0x00, 0x8A, 0x9D, 0x00, 0x02, 0xE8, 0xE0, 0x10, 0xD0, 0xF7, 0x4C, 0x0B, 0x04};
+    const char * path = "bare6502_config.bin";
+    {
+        std::ofstream file(path, std::ios_base::binary);
+        file.write(reinterpret_cast<const char *>(program), sizeof(program));
+    }
+
+    class DUT : public Bare6502 {
+    public:
+        [[nodiscard]] uint8_t peek(uint16_t address) const { return m_RAM.getData().read(address); }
+    };
+
+    // The memory path and the clock instantiation must not change the result.
+    for(bool flat : {true, false}) {
+        for(bool debugHooks : {true, false}) {
+
+            DUT system;
+            system.setFlatMemory(flat);
+            system.setDebugHooksEnabled(debugHooks);
+            system.setStartAddress(0x0400);
+            system.loadBinary(path, 0x0400);
+            EXPECT_EQ(system.peek(0x040B), 0x4C);
+
+            // The loop takes a few hundred cycles, a frame is plenty.
+            system.doFrames(1);
+            ASSERT_TRUE(system.trapped()) << "flat " << flat << ", debug hooks " << debugHooks;
+            EXPECT_EQ(system.getTrapAddress(), 0x040B);
+            // Reset (7) + LDX (2) + (TXA (2) + STA (5) + INX (2) + CPX (2)) * 16 + 15 taken BNE (3) + BNE (2) + JMP (3).
+            EXPECT_EQ(system.getClockCount(), 7 + 2 + 11 * 16 + 15 * 3 + 2 + 3);
+            for(uint8_t i = 0; i < 0x10; i++)
+                EXPECT_EQ(system.peek(0x0200 + i), i);
+
+            // The memory is cleared and the program reloaded on init.
+            system.init();
+            EXPECT_FALSE(system.trapped());
+            EXPECT_EQ(system.peek(0x0201), 0x00);
+            EXPECT_EQ(system.peek(0x040B), 0x4C);
+        }
+    }
+
+    std::remove(path);
+}
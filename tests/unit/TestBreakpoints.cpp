@@ -0,0 +1,162 @@
+/**
+ * @file TestBreakpoints.cpp Breakpoint and watchpoint tests.
+ * */
+
+#include "gtest/gtest.h"
+#include "Test6502DUT.h"
+#include "components/Breakpoints.h"
+
+TEST(TestBreakpoints, Conditions) {
+
+    std::vector<uint8_t> memory(0x10000, 0x00);
+    memory[0x00FF] = 11;
+    Breakpoints::PeekFunction peek = [&memory](uint16_t address) { return memory[address]; };
+    Breakpoints::Context context{.pc = 0x8000, .a = 3, .x = 0x10, .y = 0xFF, .p = 0x24, .sp = 0xFD, .address = 0x2002, .value = 0x80};
+
+    auto evaluate = [&](const std::string & expression) {
+        return Breakpoints::Condition(expression).evaluate(context, peek);
+    };
+
+    EXPECT_TRUE(evaluate(""));
+    EXPECT_TRUE(evaluate("A==3 && [$00FF]>10"));
+    EXPECT_FALSE(evaluate("A==3 && [$00FF]>11"));
+    EXPECT_TRUE(evaluate("a == 4 || x == 0x10"));
+    EXPECT_TRUE(evaluate("[X + $EF] == 11"));
+    EXPECT_TRUE(evaluate("(P & %00000100) != 0"));
+    EXPECT_TRUE(evaluate("PC == $8000 && SP >= 253 && Y > X"));
+    EXPECT_TRUE(evaluate("ADDR == $2002 && VALUE & $80"));
+    EXPECT_TRUE(evaluate("!(A - 3) && ~A == -4"));
+    EXPECT_TRUE(evaluate("A ^ 1 | 0 == 2"));
+    EXPECT_TRUE(evaluate("1 + 2 == A"));
+
+    EXPECT_EQ(Breakpoints::Condition("A==3 && [$00FF]>10").getCode().size(), 8);
+    EXPECT_THROW(Breakpoints::Condition("A =="), std::invalid_argument);
+    EXPECT_THROW(Breakpoints::Condition("B == 1"), std::invalid_argument);
+    EXPECT_THROW(Breakpoints::Condition("[$10"), std::invalid_argument);
+    EXPECT_THROW(Breakpoints::Condition("$10000"), std::invalid_argument);
+    EXPECT_THROW(Breakpoints::Condition("A 3"), std::invalid_argument);
+    EXPECT_THROW(Breakpoints::Condition("1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+1)))))))))))))))"), std::invalid_argument);
+}
+
+TEST(TestBreakpoints, Pages) {
+
+    Breakpoints breakpoints;
+    EXPECT_FALSE(breakpoints.hasType(Breakpoints::EXECUTE));
+
+    size_t range = breakpoints.add(0x80F0, 0x8110, Breakpoints::EXECUTE);
+    breakpoints.add(0x0300, 0x0300, Breakpoints::READ | Breakpoints::WRITE, "VALUE == 1");
+    EXPECT_TRUE(breakpoints.isMarked(0x8000, Breakpoints::EXECUTE));
+    EXPECT_TRUE(breakpoints.isMarked(0x81FF, Breakpoints::EXECUTE));
+    EXPECT_FALSE(breakpoints.isMarked(0x8200, Breakpoints::EXECUTE));
+    EXPECT_FALSE(breakpoints.isMarked(0x8100, Breakpoints::READ));
+    EXPECT_TRUE(breakpoints.isMarked(0x03FF, Breakpoints::WRITE));
+
+    Breakpoints::PeekFunction peek = [](uint16_t) { return uint8_t{0}; };
+    Breakpoints::Context context{};
+    context.address = 0x80EF;
+    EXPECT_FALSE(breakpoints.check(Breakpoints::EXECUTE, context, peek));
+    context.address = 0x8100;
+    EXPECT_TRUE(breakpoints.check(Breakpoints::EXECUTE, context, peek));
+    EXPECT_TRUE(breakpoints.isHit());
+    EXPECT_EQ(breakpoints.getLastHit().index, range);
+    breakpoints.clearHit();
+
+    context.address = 0x0300;
+    context.value = 2;
+    EXPECT_FALSE(breakpoints.check(Breakpoints::WRITE, context, peek));
+    context.value = 1;
+    EXPECT_TRUE(breakpoints.check(Breakpoints::WRITE, context, peek));
+    EXPECT_EQ(breakpoints.getBreakpoints()[1].hits, 1);
+
+    breakpoints.setEnabled(range, false);
+    EXPECT_FALSE(breakpoints.isMarked(0x8100, Breakpoints::EXECUTE));
+    EXPECT_FALSE(breakpoints.hasType(Breakpoints::EXECUTE));
+    breakpoints.remove(range);
+    EXPECT_EQ(breakpoints.getBreakpoints().size(), 1);
+    EXPECT_THROW(breakpoints.remove(1), std::out_of_range);
+    EXPECT_THROW(breakpoints.add(0x10, 0x0F, Breakpoints::READ), std::invalid_argument);
+    EXPECT_THROW(breakpoints.add(0x10, 0x10, 0), std::invalid_argument);
+
+    breakpoints.clear();
+    EXPECT_FALSE(breakpoints.isMarked(0x0300, Breakpoints::WRITE));
+}
+
+TEST(TestBreakpoints, CPU) {
+
+    // $8000: LDX #$00; loop: INX, STX $0300, JMP loop.
+    std::vector<uint8_t> memory(0x10000, 0xEA);
+    const uint8_t program[] = {0xA2, 0x00, 0xE8, 0x8E, 0x00, 0x03, 0x4C, 0x02, 0x80};
+    std::copy(std::begin(program), std::end(program), memory.begin() + 0x8000);
+    memory[0xFFFC] = 0x00;
+    memory[0xFFFD] = 0x80;
+
+    auto memCon = makeMemoryConnector(memory);
+
+    Test6502DUT cpu;
+    cpu.connect("mainBus", memCon);
+    cpu.init();
+
+    // Execution: stops before the fetch of INX when X is 4.
+    size_t execution = cpu.addBreakpoint(0x8002, 0x8002, Breakpoints::EXECUTE, "X == 4");
+    EXPECT_LT(cpu.run(1000), 1000);
+    EXPECT_EQ(cpu.getPC(), 0x8002);
+    EXPECT_EQ(cpu.getX(), 4);
+    EXPECT_TRUE(cpu.instrFinished());
+    EXPECT_EQ(cpu.getBreakpoints().getLastHit().type, Breakpoints::EXECUTE);
+
+    // Continues from the breakpoint.
+    cpu.removeBreakpoint(execution);
+    EXPECT_EQ(cpu.run(100), 100);
+
+    // Write watchpoint.
+    cpu.addBreakpoint(0x0300, 0x0300, Breakpoints::WRITE, "VALUE == $20");
+    cpu.run(10000);
+    EXPECT_TRUE(cpu.breakpointHit());
+    EXPECT_EQ(memory[0x0300], 0x20);
+    EXPECT_EQ(cpu.getBreakpoints().getLastHit().address, 0x0300);
+    EXPECT_EQ(cpu.getBreakpoints().getLastHit().type, Breakpoints::WRITE);
+
+    // Read watchpoint at the program itself.
+    size_t read = cpu.addBreakpoint(0x8006, 0x8006, Breakpoints::READ);
+    cpu.run(100);
+    EXPECT_TRUE(cpu.breakpointHit());
+    EXPECT_EQ(cpu.getBreakpoints().getLastHit().type, Breakpoints::READ);
+    EXPECT_EQ(cpu.getBreakpoints().getLastHit().value, 0x4C);
+
+    // Disabled watchpoints don't stop.
+    cpu.setBreakpointEnabled(read, false);
+    cpu.setBreakpointEnabled(0, false);
+    EXPECT_EQ(cpu.run(10000), 10000);
+}
+
+TEST(TestBreakpoints, DebugHooks) {
+
+    // $8000: JMP $8000.
+    std::vector<uint8_t> memory(0x10000, 0xEA);
+    const uint8_t program[] = {0x4C, 0x00, 0x80};
+    std::copy(std::begin(program), std::end(program), memory.begin() + 0x8000);
+    memory[0xFFFC] = 0x00;
+    memory[0xFFFD] = 0x80;
+
+    auto memCon = makeMemoryConnector(memory);
+
+    MOS6502<> cpu;
+    cpu.connect("mainBus", memCon);
+    cpu.init();
+    cpu.addBreakpoint(0x8000, 0x8000, Breakpoints::EXECUTE);
+
+    SignalPort clock;
+    clock.connect(cpu.getConnector("CLK"));
+
+    // The NoHooks clock doesn't check the breakpoints.
+    cpu.setDebugHooksEnabled(false);
+    EXPECT_FALSE(cpu.isDebugHooksEnabled());
+    for(int i = 0; i < 100; i++)
+        clock.send();
+    EXPECT_FALSE(cpu.breakpointHit());
+
+    cpu.setDebugHooksEnabled(true);
+    for(int i = 0; i < 100 && !cpu.breakpointHit(); i++)
+        clock.send();
+    EXPECT_TRUE(cpu.breakpointHit());
+}
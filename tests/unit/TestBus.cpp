@@ -128,4 +128,98 @@ TEST_F(TestBus, Masking) {
             EXPECT_EQ(buffer, i);
         }
     }
-}
\ No newline at end of file
+}
+
+/// Check the access statistics.
+TEST_F(TestBus, Statistics) {
+
+    uint32_t buffer;
+
+    for(int i = 0; i < deviceCount; i++) {
+        bus.connect("slot " + std::to_string(i), devices[i]);
+    }
+
+    EXPECT_EQ(bus.getStatistics(), nullptr);
+    bus.setStatisticsEnabled(true);
+    ASSERT_NE(bus.getStatistics(), nullptr);
+    auto trackedIf = busConnector.lock()->getDataInterface();
+
+    // Device 0 twice, device 2 once, unclaimed once.
+    trackedIf.read(0x0010, buffer);
+    trackedIf.read(0x0010, buffer);
+    trackedIf.read(2 * memorySize + 1, buffer);
+    EXPECT_FALSE(trackedIf.read(0x8000, buffer));
+    trackedIf.write(0x0120, 0x1AB);
+
+    const BusStatistics * stats = bus.getStatistics();
+    EXPECT_EQ(stats->getTrackedSize(), 0x10000);
+    EXPECT_EQ(stats->getReads(0x0010), 2);
+    EXPECT_EQ(stats->getWrites(0x0120), 1);
+    EXPECT_EQ(stats->getPageReads(0x00), 2);
+    EXPECT_EQ(stats->getPageWrites(0x01), 1);
+    EXPECT_EQ(stats->getPageReads(0x80), 1);
+    EXPECT_EQ(stats->getDeviceReads(0), 2);
+    EXPECT_EQ(stats->getDeviceReads(1), 0);
+    EXPECT_EQ(stats->getDeviceReads(2), 1);
+    EXPECT_EQ(stats->getUnclaimedReads(), 1);
+    EXPECT_EQ(stats->getTotalReads(), 4);
+    EXPECT_EQ(stats->getTotalWrites(), 1);
+    EXPECT_EQ(stats->getLastAccess().type, BusStatistics::ACCESS::WRITE);
+    EXPECT_EQ(stats->getLastAccess().address, 0x0120);
+    EXPECT_EQ(stats->getLastAccess().data, 0xAB);
+    EXPECT_EQ(deviceMemories[1][0x0120 - memorySize], 0xAB);
+
+    // Disabling restores the plain interface.
+    bus.setStatisticsEnabled(false);
+    EXPECT_EQ(bus.getStatistics(), nullptr);
+    EXPECT_TRUE(busConnector.lock()->getDataInterface().read(0x0010, buffer));
+}
+
+TEST_F(TestBus, Merge) {
+
+    // The fixture bus uses the default arbitration.
+    Bus mergeBus{3, addrWidth, dataWidth, Bus::ARBITRATION::MERGE};
+    DataInterface mergeIf = mergeBus.getConnector("master").lock()->getDataInterface();
+
+    // Two devices sharing 0x4017, the second one also responds to 0x4016. Slot 1 is empty.
+    uint32_t written = 0;
+    auto low = std::make_shared<Connector>(DataInterface{
+        .read = [](uint32_t address, uint32_t & buffer) {
+            if(address != 0x4017)
+                return false;
+            buffer = 0x01;
+            return true;
+        },
+        .write = [&](uint32_t, uint32_t data) { written += data; }
+    });
+    auto high = std::make_shared<Connector>(DataInterface{
+        .read = [](uint32_t address, uint32_t & buffer) {
+            if(address == 0x4017 || address == 0x4016) {
+                buffer = 0x140;
+                return true;
+            }
+            return false;
+        },
+        .write = [&](uint32_t, uint32_t data) { written += data; }
+    });
+    mergeBus.connect("slot 0", low);
+    mergeBus.connect("slot 2", high);
+
+    uint32_t buffer = 0xDEAD;
+    EXPECT_TRUE(mergeIf.read(0x4017, buffer));
+    EXPECT_EQ(buffer, 0x41);
+    EXPECT_TRUE(mergeIf.read(0x4016, buffer));
+    EXPECT_EQ(buffer, 0x40);
+    buffer = 0xDEAD;
+    EXPECT_FALSE(mergeIf.read(0x4015, buffer));
+    EXPECT_EQ(buffer, 0xDEAD);
+
+    // Writes are sent to every device.
+    mergeIf.write(0x4016, 0x101);
+    EXPECT_EQ(written, 2);
+
+    mergeBus.setStatisticsEnabled(true);
+    mergeBus.getConnector("master").lock()->getDataInterface().read(0x4017, buffer);
+    EXPECT_EQ(mergeBus.getStatistics()->getDeviceReads(0), 1);
+    EXPECT_EQ(buffer, 0x41);
+}
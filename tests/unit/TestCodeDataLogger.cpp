@@ -0,0 +1,133 @@
+/**
+ * @file TestCodeDataLogger.cpp Code/Data Logger tests.
+ * */
+
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+#include "Test6502DUT.h"
+#include "components/CodeDataLogger.h"
+#include "components/Gamepak/Mapper000.h"
+
+TEST(TestCodeDataLogger, CPU) {
+
+    // NROM-128: $C000: LDA $C100, LDA ($00),Y, JMP ($C102); $C200: JMP $C200.
+    std::vector<uint8_t> PRGROM(0x4000, 0xEA);
+    std::vector<uint8_t> CHRROM(0x2000, 0x00);
+    const uint8_t program[] = {0xAD, 0x00, 0xC1, 0xB1, 0x00, 0x6C, 0x02, 0xC1};
+    std::copy(std::begin(program), std::end(program), PRGROM.begin());
+    PRGROM[0x0102] = 0x00;
+    PRGROM[0x0103] = 0xC2;
+    const uint8_t loop[] = {0x4C, 0x00, 0xC2};
+    std::copy(std::begin(loop), std::end(loop), PRGROM.begin() + 0x200);
+    PRGROM[0x3FFC] = 0x00;
+    PRGROM[0x3FFD] = 0xC0;
+
+    Mapper000 mapper(PRGROM, CHRROM, Mapper::mirroringType_t::HORIZONTAL);
+    CodeDataLogger logger;
+    logger.resize(PRGROM.size(), CHRROM.size());
+    mapper.setCodeDataLogger(&logger);
+
+    // Zero page pointer to $C110.
+    std::vector<uint8_t> RAM(0x800, 0x00);
+    RAM[0x00] = 0x10;
+    RAM[0x01] = 0xC1;
+
+    auto memCon = std::make_shared<Connector>(DataInterface{
+        .read = [&](uint32_t address, uint32_t & buffer) {
+            if(address < 0x2000) {
+                buffer = RAM[address & 0x7FF];
+                return true;
+            }
+            uint8_t data;
+            bool result = mapper.cpuRead(address, data);
+            buffer = data;
+            return result;
+        },
+        .write = [&](uint32_t address, uint32_t data) {
+            if(address < 0x2000)
+                RAM[address & 0x7FF] = data;
+        }
+    });
+
+    Test6502DUT cpu;
+    cpu.connect("mainBus", memCon);
+    cpu.setCodeDataLogger(&logger);
+    cpu.init();
+
+    for(int i = 0; i < 5; i++)
+        cpu.step();
+
+    auto PRG = logger.getPRG();
+    // $C000 is mapped to the $C000 window (10).
+    constexpr uint8_t WINDOW = 0x08;
+    EXPECT_EQ(PRG[0x0000], CodeDataLogger::CODE | WINDOW);
+    EXPECT_EQ(PRG[0x0002], CodeDataLogger::CODE | WINDOW);
+    EXPECT_EQ(PRG[0x0100], CodeDataLogger::DATA | WINDOW);
+    EXPECT_EQ(PRG[0x0110], CodeDataLogger::DATA | CodeDataLogger::INDIRECT_DATA | WINDOW);
+    EXPECT_EQ(PRG[0x0102], CodeDataLogger::DATA | WINDOW);
+    EXPECT_EQ(PRG[0x0103], CodeDataLogger::DATA | WINDOW);
+    EXPECT_EQ(PRG[0x0200], CodeDataLogger::CODE | CodeDataLogger::INDIRECT_CODE | WINDOW);
+    EXPECT_EQ(PRG[0x0201], CodeDataLogger::CODE | WINDOW);
+    // Reset vector.
+    EXPECT_EQ(PRG[0x3FFC], CodeDataLogger::DATA | (0x0C));
+    EXPECT_EQ(PRG[0x0300], 0);
+
+    // Second pass through the JMP $C200 loop is not indirect anymore, the flag stays.
+    cpu.step();
+    EXPECT_EQ(logger.getPRG()[0x0200], CodeDataLogger::CODE | CodeDataLogger::INDIRECT_CODE | WINDOW);
+
+    // CHR: rendered, then read through PPUDATA.
+    uint8_t data;
+    mapper.ppuRead(0x0010, data);
+    logger.setCHRAccess(CodeDataLogger::READ);
+    mapper.ppuRead(0x0020, data);
+    EXPECT_EQ(logger.getCHR()[0x0010], CodeDataLogger::RENDERED);
+    EXPECT_EQ(logger.getCHR()[0x0020], CodeDataLogger::READ);
+
+    CodeDataLogger::Summary summary = logger.getSummary();
+    EXPECT_EQ(summary.rendered, 1);
+    EXPECT_EQ(summary.read, 1);
+    EXPECT_EQ(summary.unusedCHR, 0x2000 - 2);
+    EXPECT_EQ(summary.unusedPRG, 0x4000 - summary.code - summary.data);
+
+    // Disabled logging doesn't mark anything.
+    mapper.setCodeDataLogger(nullptr);
+    mapper.cpuRead(0xC300, data);
+    EXPECT_EQ(logger.getPRG()[0x0300], 0);
+}
+
+TEST(TestCodeDataLogger, File) {
+
+    CodeDataLogger logger;
+    logger.resize(0x4000, 0x2000);
+    logger.markPRG(0x0001, 0x8001);
+    logger.markCHR(0x1FFF);
+
+    const char * path = "cdl_test.cdl";
+    logger.save(path);
+    {
+        std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
+        ASSERT_TRUE(file) << "Can't open the CDL file!";
+        EXPECT_EQ(file.tellg(), 0x6000);
+    }
+
+    CodeDataLogger loaded;
+    loaded.resize(0x4000, 0x2000);
+    loaded.load(path);
+    EXPECT_EQ(loaded.getPRG()[0x0001], CodeDataLogger::DATA);
+    EXPECT_EQ(loaded.getCHR()[0x1FFF], CodeDataLogger::RENDERED);
+
+    CodeDataLogger other;
+    other.resize(0x8000, 0x2000);
+    EXPECT_THROW(other.load(path), std::invalid_argument);
+    std::remove(path);
+
+    EXPECT_THROW(other.load("missing.cdl"), std::runtime_error);
+
+    // CHR RAM: nothing to log.
+    CodeDataLogger noCHR;
+    noCHR.resize(0x4000, 0);
+    EXPECT_NO_THROW(noCHR.markCHR(0x10));
+    EXPECT_TRUE(noCHR.getCHR().empty());
+}
@@ -4,6 +4,7 @@
 
 #include "gtest/gtest.h"
 #include "Connector.h"
+#include "Port.h"
 #include <memory>
 
 /// Test default connector state (no interfaces).
@@ -100,4 +101,37 @@ TEST(TestConnector, Assignments) {
         EXPECT_TRUE(c.hasDataInterface());
         EXPECT_FALSE(c.hasSignalInterface());
     }
-}
\ No newline at end of file
+}
+
+/// Test that the ports use the current interface of the connector after it is swapped.
+TEST(TestConnector, PortInterfaceSwap) {
+
+    auto data = std::make_shared<Connector>(DataInterface{
+        .read = [](uint32_t, uint32_t & buffer) { buffer = 1; return true; },
+        .write = [](uint32_t, uint32_t) {}
+    });
+    int sent = 0;
+    auto signal = std::make_shared<Connector>(SignalInterface{ .send = [&](){ sent += 1; } });
+
+    DataPort dataPort;
+    SignalPort signalPort;
+    dataPort.connect(data);
+    signalPort.connect(signal);
+    EXPECT_EQ(dataPort.read(0), 1);
+    signalPort.send();
+
+    data->setInterface(DataInterface{
+        .read = [](uint32_t, uint32_t & buffer) { buffer = 2; return true; },
+        .write = [](uint32_t, uint32_t) {}
+    });
+    signal->setInterface(SignalInterface{ .send = [&](){ sent += 10; } });
+    EXPECT_EQ(dataPort.read(0), 2);
+    signalPort.send();
+    EXPECT_EQ(sent, 11);
+
+    // Destroyed connectors are not used.
+    data.reset();
+    signal.reset();
+    EXPECT_EQ(dataPort.read(0), 0);
+    EXPECT_NO_THROW(signalPort.send());
+}
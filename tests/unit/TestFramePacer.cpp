@@ -0,0 +1,91 @@
+/**
+ * @file TestFramePacer.cpp FramePacer tests.
+ * */
+
+#include "gtest/gtest.h"
+#include "FramePacer.h"
+
+using namespace std::chrono;
+
+TEST(TestFramePacer, Basic) {
+
+    FramePacer pacer(1000);
+    FramePacer::clock_t::time_point t0{};
+    pacer.start(t0);
+
+    EXPECT_EQ(pacer.clocksDue(t0), 0);
+    EXPECT_EQ(pacer.clocksDue(t0 + milliseconds(1)), 1);
+    EXPECT_EQ(pacer.clocksDue(t0 + milliseconds(11)), 10);
+
+    // Time going backwards is ignored.
+    EXPECT_EQ(pacer.clocksDue(t0), 0);
+}
+
+TEST(TestFramePacer, FractionalAccumulator) {
+
+    // NES PPU clock rate: 5369318 clocks per second, which is not divisible by the common refresh rates.
+    const uint64_t rate = 5369318;
+    FramePacer pacer(rate);
+    FramePacer::clock_t::time_point t{};
+    pacer.start(t);
+
+    // Simulate one hour of irregular GUI frames (jitter between 15 and 18 ms).
+    uint64_t total = 0;
+    nanoseconds elapsed{0};
+    for(int i = 0; elapsed < hours(1); i++) {
+        nanoseconds step = microseconds(15000 + (i * 7919u) % 3000) + nanoseconds(i % 997);
+        t += step;
+        elapsed += step;
+        total += pacer.clocksDue(t);
+    }
+
+    // Emulated time must match the real time within a single clock.
+    uint64_t ns = elapsed.count();
+    uint64_t expected = ns / 1'000'000'000 * rate + ns % 1'000'000'000 * rate / 1'000'000'000;
+    EXPECT_LE(expected > total ? expected - total : total - expected, 1);
+    EXPECT_EQ(pacer.getDroppedTime().count(), 0);
+}
+
+TEST(TestFramePacer, CatchUpLimit) {
+
+    FramePacer pacer(1000);
+    pacer.setMaxCatchUp(milliseconds(50));
+    FramePacer::clock_t::time_point t0{};
+    pacer.start(t0);
+
+    EXPECT_EQ(pacer.clocksDue(t0 + seconds(2)), 50);
+    EXPECT_EQ(pacer.getDroppedTime(), milliseconds(1950));
+}
+
+TEST(TestFramePacer, Speed) {
+
+    FramePacer pacer(1000);
+    FramePacer::clock_t::time_point t0{};
+    pacer.start(t0);
+    pacer.setSpeed(4);
+
+    EXPECT_EQ(pacer.clocksDue(t0 + milliseconds(10)), 40);
+    EXPECT_THROW(pacer.setSpeed(0), std::invalid_argument);
+}
+
+TEST(TestFramePacer, AudioMaster) {
+
+    FramePacer pacer(1000);
+    EXPECT_THROW(pacer.setMode(FramePacer::MODE::AUDIO), std::logic_error);
+
+    pacer.setAudioMaster(100, 50);
+    EXPECT_EQ(pacer.getMode(), FramePacer::MODE::AUDIO);
+
+    // 10 clocks per audio frame.
+    EXPECT_EQ(pacer.clocksDueAudio(50), 0);
+    EXPECT_EQ(pacer.clocksDueAudio(100), 0);
+    EXPECT_EQ(pacer.clocksDueAudio(40), 100);
+    EXPECT_EQ(pacer.clocksDueAudio(0), 500);
+
+    // Fractional clocks per frame are accumulated.
+    pacer.setAudioMaster(300, 50);
+    uint64_t total = 0;
+    for(int i = 0; i < 3; i++)
+        total += pacer.clocksDueAudio(49);
+    EXPECT_EQ(total, 10);
+}
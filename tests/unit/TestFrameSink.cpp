@@ -0,0 +1,121 @@
+/**
+ * @file TestFrameSink.cpp Frame sink tests.
+ * */
+
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include "gtest/gtest.h"
+#include "systems/NES.h"
+#include "HashFrameSink.h"
+#include "StreamFrameSink.h"
+
+namespace {
+
+    /// Collects numbers of the received frames.
+    class NumberFrameSink : public FrameSink {
+    public:
+        std::vector<uint64_t> numbers;
+        void onFrame(const VideoFrame & frame) override {
+            EXPECT_NE(frame.pixels, nullptr);
+            EXPECT_EQ(frame.width, 256);
+            EXPECT_EQ(frame.height, 240);
+            numbers.push_back(frame.number);
+        }
+    };
+
+    std::vector<char> readFile(const std::filesystem::path & path) {
+        std::ifstream file(path, std::ios_base::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+}
+
+TEST(TestFrameSink, SystemEmitsFrames) {
+
+    NES nes;
+    nes.init();
+
+    NumberFrameSink numbers;
+    HashFrameSink hashes(true);
+    nes.addFrameSink(&numbers);
+    nes.addFrameSink(&hashes);
+    nes.addFrameSink(&hashes);  // Duplicates are ignored.
+    EXPECT_THROW(nes.addFrameSink(nullptr), std::invalid_argument);
+
+    nes.doFrames(4);
+    EXPECT_EQ(nes.getFrameCount(), 4);
+    EXPECT_EQ(numbers.numbers, (std::vector<uint64_t>{1, 2, 3, 4}));
+    EXPECT_EQ(hashes.getFrameCount(), 4);
+    EXPECT_EQ(hashes.getHashes().size(), 4);
+
+    // Skipped frames are counted but not emitted (the skip starts after the next frame).
+    nes.setFrameSkip(2);
+    nes.doFrames(6);
+    EXPECT_EQ(nes.getFrameCount(), 10);
+    EXPECT_EQ(numbers.numbers, (std::vector<uint64_t>{1, 2, 3, 4, 5, 8}));
+
+    nes.removeFrameSink(&numbers);
+    nes.setFrameSkip(0);
+    nes.doFrames(1);
+    EXPECT_EQ(numbers.numbers.size(), 6);
+    EXPECT_EQ(hashes.getFrameCount(), 7);
+}
+
+TEST(TestFrameSink, Hash) {
+
+    std::vector<RGBPixel> pixels(4 * 3, {1, 2, 3});
+    VideoFrame frame{.pixels = pixels.data(), .width = 4, .height = 3, .number = 1};
+
+    HashFrameSink sink;
+    sink.onFrame(frame);
+    uint64_t first = sink.getLastHash();
+    EXPECT_EQ(first, HashFrameSink::hash(frame));
+
+    pixels[5].green = 0;
+    sink.onFrame(frame);
+    EXPECT_NE(sink.getLastHash(), first);
+    EXPECT_TRUE(sink.getHashes().empty());
+}
+
+TEST(TestFrameSink, Stream) {
+
+    auto rgbPath = std::filesystem::temp_directory_path() / "use_test_frames.rgb";
+    auto y4mPath = std::filesystem::temp_directory_path() / "use_test_frames.y4m";
+
+    std::vector<RGBPixel> pixels(4 * 2, {255, 255, 255});
+    pixels[0] = {0, 0, 0};
+    VideoFrame frame{.pixels = pixels.data(), .width = 4, .height = 2, .number = 1};
+
+    {
+        StreamFrameSink rgb(rgbPath.string(), StreamFrameSink::FORMAT::RGB24);
+        StreamFrameSink y4m(y4mPath.string(), StreamFrameSink::FORMAT::Y4M, 30, 1);
+        for(int i = 0; i < 3; i++) {
+            rgb.onFrame(frame);
+            y4m.onFrame(frame);
+        }
+        rgb.close();
+        y4m.close();
+
+        // Written or dropped, nothing is lost silently.
+        EXPECT_EQ(rgb.getWrittenFrames() + rgb.getDroppedFrames(), 3);
+        EXPECT_EQ(y4m.getWrittenFrames() + y4m.getDroppedFrames(), 3);
+        EXPECT_EQ(rgb.getDroppedFrames(), 0);
+    }
+
+    auto rgbData = readFile(rgbPath);
+    ASSERT_EQ(rgbData.size(), 3 * 4 * 2 * 3);
+    EXPECT_EQ(rgbData[0], 0);
+    EXPECT_EQ(static_cast<uint8_t>(rgbData[3]), 255);
+
+    auto y4mData = readFile(y4mPath);
+    const std::string header = "YUV4MPEG2 W4 H2 F30:1 Ip A1:1 C444\n";
+    ASSERT_GE(y4mData.size(), header.size());
+    EXPECT_EQ(std::string(y4mData.begin(), y4mData.begin() + header.size()), header);
+    ASSERT_EQ(y4mData.size(), header.size() + 3 * (6 + 4 * 2 * 3));
+    // Black and white luma (limited range).
+    EXPECT_EQ(static_cast<uint8_t>(y4mData[header.size() + 6]), 16);
+    EXPECT_EQ(static_cast<uint8_t>(y4mData[header.size() + 7]), 235);
+
+    std::filesystem::remove(rgbPath);
+    std::filesystem::remove(y4mPath);
+}
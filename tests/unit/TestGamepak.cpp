@@ -61,8 +61,8 @@ TEST(TestGamepak, FileLoad) {
             EXPECT_EQ(m_params.CHRRAMsize, 0);
             EXPECT_EQ(m_params.CHRNVRAMsize, 0);
 
-            EXPECT_EQ(m_PRGROM, rawPRGData);
-            EXPECT_EQ(m_CHRROM, rawCHRData);
+            EXPECT_EQ(*m_PRGROM, rawPRGData);
+            EXPECT_EQ(*m_CHRROM, rawCHRData);
         }
     } gamepak;
 
@@ -86,4 +86,21 @@ TEST(TestGamepak, FileLoad) {
     // Test init fuction - it should not change any parameters.
     gamepak.init();
     gamepak.test(rawPRGData, rawCHRData);
-}
\ No newline at end of file
+}
+
+/**
+ * Test the Code/Data Logger listener is given the logger only while logging.
+ * */
+TEST(TestGamepak, CodeDataLoggerListener) {
+
+    Gamepak gamepak;
+    CodeDataLogger * installed = &gamepak.getCodeDataLogger();
+    gamepak.setCodeDataLoggerListener([&](CodeDataLogger * logger){ installed = logger; });
+    EXPECT_EQ(installed, nullptr);
+
+    gamepak.setCodeDataLoggerEnabled(true);
+    EXPECT_EQ(installed, &gamepak.getCodeDataLogger());
+
+    gamepak.setCodeDataLoggerEnabled(false);
+    EXPECT_EQ(installed, nullptr);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file TestGuestProfiler.cpp Guest code profiler tests.
+ * */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "Test6502DUT.h"
+#include "components/GuestProfiler.h"
+
+namespace {
+
+    const GuestProfiler::RoutineReport & findRoutine(const std::vector<GuestProfiler::RoutineReport> & report, const std::string & name) {
+
+        for(auto & routine : report)
+            if(routine.name == name)
+                return routine;
+
+        throw std::logic_error("Routine " + name + " not found.");
+    }
+}
+
+TEST(TestGuestProfiler, CallTree) {
+
+    GuestProfiler profiler;
+    profiler.addSymbol(0x8100, 1, "update");
+    profiler.addSymbol(0x8200, 1, "draw");
+
+    for(int frame = 0; frame < 2; frame++) {
+
+        profiler.instruction(0x8000, 0, 10);
+        // JSR update: SP 0xFD -> 0xFB.
+        profiler.call(0x8100, 1, 0xFD, GuestProfiler::ENTRY::CALL);
+        profiler.instruction(0x8100, 1, 20);
+        // JSR draw: SP 0xFB -> 0xF9.
+        profiler.call(0x8200, 1, 0xFB, GuestProfiler::ENTRY::CALL);
+        profiler.instruction(0x8200, 1, 5 * (frame + 1));
+        profiler.ret(0xFB);
+        // Jump table: pushed address and RTS doesn't leave the routine.
+        profiler.instruction(0x8110, 1, 3);
+        profiler.ret(0xFB);
+        EXPECT_EQ(profiler.getDepth(), 2);
+        profiler.ret(0xFD);
+        EXPECT_EQ(profiler.getDepth(), 1);
+
+        profiler.endFrame();
+    }
+
+    auto report = profiler.getReport();
+    EXPECT_EQ(profiler.getFrameCount(), 2);
+    EXPECT_EQ(profiler.getTotalCycles(), 2 * 38 + 5);
+    EXPECT_EQ(profiler.getCycles(0x8100, 1), 40);
+    EXPECT_EQ(profiler.getCycles(0x8100, 0), 0);
+
+    auto & update = findRoutine(report, "update");
+    EXPECT_EQ(update.calls, 2);
+    EXPECT_EQ(update.exclusive, 46);
+    EXPECT_EQ(update.inclusive, 46 + 15);
+    EXPECT_DOUBLE_EQ(update.inclusivePerFrame, (46.0 + 15) / 2);
+    EXPECT_EQ(update.maxInclusive, 33);
+
+    auto & draw = findRoutine(report, "draw");
+    EXPECT_EQ(draw.exclusive, 15);
+    EXPECT_EQ(draw.inclusive, 15);
+    EXPECT_EQ(draw.maxExclusive, 10);
+
+    auto & root = findRoutine(report, "(root)");
+    EXPECT_EQ(root.exclusive, 20);
+    EXPECT_EQ(root.inclusive, 81);
+    EXPECT_EQ(report.front().name, "(root)");
+
+    std::stringstream flameGraph;
+    profiler.writeFlameGraph(flameGraph);
+    std::string folded = flameGraph.str();
+    EXPECT_NE(folded.find("(root) 20\n"), std::string::npos);
+    EXPECT_NE(folded.find("(root);update 46\n"), std::string::npos);
+    EXPECT_NE(folded.find("(root);update;draw 15\n"), std::string::npos);
+}
+
+TEST(TestGuestProfiler, Interrupts) {
+
+    GuestProfiler profiler;
+
+    // Main loop interrupted by NMI across the frame boundary.
+    profiler.call(0x9000, 0, 0xFD, GuestProfiler::ENTRY::CALL);
+    profiler.instruction(0x9000, 0, 100);
+    profiler.call(0xC000, 0, 0xFB, GuestProfiler::ENTRY::NMI);
+    profiler.instruction(0xC000, 0, 7);
+    profiler.endFrame();
+    profiler.instruction(0xC001, 0, 13);
+    profiler.ret(0xFB);
+    profiler.instruction(0x9001, 0, 50);
+    profiler.endFrame();
+
+    auto report = profiler.getReport();
+    auto & nmi = findRoutine(report, "$C000");
+    EXPECT_EQ(nmi.entry, GuestProfiler::ENTRY::NMI);
+    EXPECT_EQ(nmi.inclusive, 20);
+    EXPECT_EQ(nmi.maxInclusive, 13);
+
+    auto & main = findRoutine(report, "$9000");
+    EXPECT_EQ(main.exclusive, 150);
+    EXPECT_EQ(main.inclusive, 170);
+    EXPECT_EQ(main.maxInclusive, 107);
+
+    std::stringstream flameGraph;
+    profiler.writeFlameGraph(flameGraph);
+    EXPECT_NE(flameGraph.str().find("(root);$9000;[NMI] $C000 20\n"), std::string::npos);
+}
+
+TEST(TestGuestProfiler, CPU) {
+
+    // $8000: JSR $8010, JMP $8000; $8010: NOP, NOP, RTS.
+    std::vector<uint8_t> memory(0x10000, 0xEA);
+    const uint8_t program[] = {0x20, 0x10, 0x80, 0x4C, 0x00, 0x80};
+    std::copy(std::begin(program), std::end(program), memory.begin() + 0x8000);
+    memory[0x8012] = 0x60;
+
+    auto memCon = makeMemoryConnector(memory);
+
+    Test6502DUT cpu;
+    cpu.connect("mainBus", memCon);
+    cpu.setPC(0x8000);
+    EXPECT_EQ(cpu.getGuestProfiler(), nullptr);
+    cpu.setGuestProfilerEnabled(true);
+    cpu.setBankResolver([](uint16_t address){ return address >= 0x8000 ? 2 : 0; });
+
+    // 5 loop iterations.
+    for(int i = 0; i < 5 * 5; i++)
+        cpu.step();
+
+    GuestProfiler * profiler = cpu.getGuestProfiler();
+    ASSERT_NE(profiler, nullptr);
+    EXPECT_EQ(profiler->getDepth(), 1);
+    EXPECT_EQ(profiler->getCycles(0x8000, 2), 5 * 6);
+    EXPECT_EQ(profiler->getCycles(0x8012, 2), 5 * 6);
+
+    auto report = profiler->getReport();
+    auto & routine = findRoutine(report, "$02:8010");
+    EXPECT_EQ(routine.calls, 5);
+    EXPECT_EQ(routine.exclusive, 5 * 10);
+    EXPECT_EQ(routine.inclusive, 5 * 10);
+    EXPECT_EQ(findRoutine(report, "(root)").exclusive, 5 * 9);
+
+    cpu.setGuestProfilerEnabled(false);
+    EXPECT_EQ(cpu.getGuestProfiler(), nullptr);
+}
+
+TEST(TestGuestProfiler, Symbols) {
+
+    GuestProfiler profiler;
+
+    const char * nlPath = "guest_profiler_test.nes.1.nl";
+    {
+        std::ofstream nl(nlPath);
+        nl << "$8000#reset#Entry point\n$0300/10#buffer#\n$C010#nmi#\ngarbage\n";
+    }
+    profiler.loadSymbols(nlPath);
+    std::remove(nlPath);
+    EXPECT_EQ(profiler.getSymbolCount(), 3);
+
+    const char * dbgPath = "guest_profiler_test.dbg";
+    {
+        std::ofstream dbg(dbgPath);
+        dbg << "version\tmajor=2,minor=0\n"
+            << "seg\tid=0,name=\"CODE\",start=0x008000,size=0x8000,addrsize=absolute,type=ro,oname=\"game.nes\",ooffs=32784\n"
+            << "seg\tid=1,name=\"BSS\",start=0x000300,size=0x0100,addrsize=absolute,type=rw\n"
+            << "sym\tid=0,name=\"main\",addrsize=absolute,scope=0,def=1,val=0x8100,seg=0,type=lab\n"
+            << "sym\tid=1,name=\"irq\",addrsize=absolute,scope=0,def=2,val=0xC200,seg=0,type=lab\n"
+            << "sym\tid=2,name=\"SPEED\",addrsize=zeropage,scope=0,def=3,val=0x4,type=equ\n"
+            << "sym\tid=3,name=\"frames\",addrsize=absolute,scope=0,def=4,val=0x301,seg=1,type=lab\n";
+    }
+    profiler.loadSymbols(dbgPath);
+    std::remove(dbgPath);
+    EXPECT_EQ(profiler.getSymbolCount(), 6);
+
+    // CODE starts at PRG ROM offset 0x8000 = bank 2.
+    profiler.call(0x8000, 1, 0xFD, GuestProfiler::ENTRY::CALL);
+    profiler.call(0x8100, 2, 0xFB, GuestProfiler::ENTRY::CALL);
+    profiler.call(0xC200, 3, 0xF9, GuestProfiler::ENTRY::CALL);
+    profiler.call(0xC010, 0, 0xF7, GuestProfiler::ENTRY::CALL);
+    auto report = profiler.getReport();
+    EXPECT_NO_THROW(findRoutine(report, "reset"));
+    EXPECT_NO_THROW(findRoutine(report, "main"));
+    EXPECT_NO_THROW(findRoutine(report, "irq"));
+    EXPECT_NO_THROW(findRoutine(report, "$C010"));
+
+    EXPECT_THROW(profiler.loadSymbols("symbols.txt"), std::invalid_argument);
+    EXPECT_THROW(profiler.loadSymbols("missing.nl"), std::runtime_error);
+}
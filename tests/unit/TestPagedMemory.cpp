@@ -0,0 +1,78 @@
+/**
+ * @file TestPagedMemory.cpp Test the copy-on-write memory.
+ * */
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "PagedMemory.h"
+
+TEST(TestPagedMemory, ReadWrite) {
+
+    PagedMemory memory(PagedMemory::PAGE_SIZE * 2 + 10, 0x55);
+    EXPECT_EQ(memory.size(), PagedMemory::PAGE_SIZE * 2 + 10);
+    EXPECT_FALSE(memory.empty());
+    EXPECT_TRUE(PagedMemory().empty());
+
+    for(size_t i = 0; i < memory.size(); i++)
+        EXPECT_EQ(memory.read(i), 0x55);
+
+    for(size_t i = 0; i < memory.size(); i++)
+        memory.write(i, static_cast<uint8_t>(i * 7));
+    for(size_t i = 0; i < memory.size(); i++)
+        EXPECT_EQ(memory.read(i), static_cast<uint8_t>(i * 7)) << "Error at offset: " << i;
+
+    memory.fill(0xAA);
+    EXPECT_EQ(memory.read(memory.size() - 1), 0xAA);
+}
+
+TEST(TestPagedMemory, LoadAndCopy) {
+
+    PagedMemory memory(PagedMemory::PAGE_SIZE * 2);
+    std::vector<uint8_t> data(PagedMemory::PAGE_SIZE + 4);
+    for(size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(i);
+
+    // The part which doesn't fit is ignored.
+    memory.load(PagedMemory::PAGE_SIZE - 2, data);
+    EXPECT_EQ(memory.read(PagedMemory::PAGE_SIZE - 2), 0);
+    EXPECT_EQ(memory.read(PagedMemory::PAGE_SIZE + 3), 5);
+    EXPECT_EQ(memory.read(memory.size() - 1), static_cast<uint8_t>(PagedMemory::PAGE_SIZE + 1));
+    EXPECT_NO_THROW(memory.load(memory.size(), data));
+
+    std::vector<uint8_t> contents(memory.size() + 16, 0xFF);
+    memory.copyTo(contents);
+    for(size_t i = 0; i < memory.size(); i++)
+        EXPECT_EQ(contents[i], memory.read(i));
+    EXPECT_EQ(contents.back(), 0xFF);
+}
+
+TEST(TestPagedMemory, CopyOnWrite) {
+
+    PagedMemory original(PagedMemory::PAGE_SIZE * 4, 0x11);
+    PagedMemory copy = original;
+    EXPECT_EQ(original.sharedPageCount(), 4);
+    EXPECT_EQ(copy.sharedPageCount(), 4);
+
+    // Only the written page is duplicated.
+    copy.write(PagedMemory::PAGE_SIZE + 1, 0x22);
+    EXPECT_EQ(copy.read(PagedMemory::PAGE_SIZE + 1), 0x22);
+    EXPECT_EQ(original.read(PagedMemory::PAGE_SIZE + 1), 0x11);
+    EXPECT_EQ(copy.read(PagedMemory::PAGE_SIZE), 0x11);
+    EXPECT_EQ(copy.sharedPageCount(), 3);
+    EXPECT_EQ(original.sharedPageCount(), 3);
+
+    original.write(0, 0x33);
+    EXPECT_EQ(copy.read(0), 0x11);
+    EXPECT_EQ(original.sharedPageCount(), 2);
+
+    // Filling replaces the shared pages instead of writing them.
+    copy.fill(0x44);
+    EXPECT_EQ(original.read(PagedMemory::PAGE_SIZE * 3), 0x11);
+    EXPECT_EQ(copy.sharedPageCount(), 0);
+
+    PagedMemory snapshot = original;
+    snapshot.unshare();
+    EXPECT_EQ(snapshot.sharedPageCount(), 0);
+    EXPECT_EQ(original.sharedPageCount(), 0);
+    EXPECT_EQ(snapshot.read(0), 0x33);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file TestPerfCounters.cpp Hardware performance counters tests.
+ * */
+
+#include "gtest/gtest.h"
+#include "PerfCounters.h"
+
+TEST(TestPerfCounters, Basic) {
+
+    // Counters are often not permitted (containers, VMs), the class must work anyway.
+    PerfCounters counters;
+    EXPECT_FALSE(counters.getStatus().empty());
+
+    PerfCounters::Values first = counters.read();
+    volatile uint64_t sum = 0;
+    for(uint64_t i = 0; i < 100000; i++)
+        sum += i;
+    PerfCounters::Values second = counters.read();
+
+    for(size_t i = 0; i < PerfCounters::EVENT_COUNT; i++) {
+        auto event = static_cast<PerfCounters::EVENT>(i);
+        if(counters.available(event))
+            EXPECT_GE(second[i], first[i]) << PerfCounters::name(event);
+        else
+            EXPECT_EQ(second[i], 0) << PerfCounters::name(event);
+    }
+
+    if(counters.available(PerfCounters::EVENT::INSTRUCTIONS))
+        EXPECT_GT(second[0], first[0] + 100000);
+
+    EXPECT_FALSE(counters.anyAvailable() == false && counters.fastReadAvailable());
+}
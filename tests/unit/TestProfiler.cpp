@@ -0,0 +1,44 @@
+/**
+ * @file TestProfiler.cpp Profiler tests.
+ * */
+
+#include <sstream>
+#include "gtest/gtest.h"
+
+// Test the instrumentation macros regardless of the build configuration.
+#ifndef USE_PROFILING
+#define USE_PROFILING
+#endif
+#include "Profiler.h"
+
+namespace {
+    void instrumented(int calls) {
+        for(int i = 0; i < calls; i++) {
+            USE_PROFILE_SCOPE("Test scope");
+            USE_PROFILE_COUNT("Test counter", 2);
+        }
+    }
+}
+
+TEST(TestProfiler, Sections) {
+
+    Profiler & profiler = Profiler::instance();
+    size_t section = profiler.registerSection("Test section");
+    EXPECT_EQ(profiler.registerSection("Test section"), section);
+    EXPECT_NE(profiler.registerSection("Test other section"), section);
+
+    profiler.reset();
+    instrumented(10);
+    profiler.add(section, 1000);
+    USE_PROFILE_FRAME();
+
+    std::stringstream trace;
+    profiler.writeChromeTrace(trace);
+    std::string json = trace.str();
+
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_NE(json.find(R"("name":"Test scope")"), std::string::npos);
+    EXPECT_NE(json.find(R"("name":"Test counter calls","ph":"C","pid":1,"ts":0,"args":{"calls":20})"), std::string::npos);
+    EXPECT_NE(json.find(R"("name":"Test section","ph":"X")"), std::string::npos);
+    EXPECT_NE(json.find(R"("dur":1})"), std::string::npos);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file TestSharedMemoryExport.cpp Shared memory export tests.
+ * */
+
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+#include "SharedMemoryExport.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+    /**
+     * Reader process: checks every consistent snapshot is not torn (all the data is filled with the same value).
+     * @return Exit code, 0 on success.
+     * */
+    int readerProcess(const std::string & name, uint64_t lastFrame) {
+
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if(fd < 0)
+            return 2;
+
+        void * region = mmap(nullptr, sizeof(SharedMemory::Layout), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if(region == MAP_FAILED)
+            return 3;
+
+        const auto & layout = *static_cast<const SharedMemory::Layout *>(region);
+        if(layout.magic != SharedMemory::MAGIC)
+            return 4;
+
+        uint64_t snapshots = 0;
+        uint64_t frameNumber = 0;
+        while(frameNumber < lastFrame) {
+
+            bool valid = true;
+            bool consistent = SharedMemory::read(layout, [&](const SharedMemory::Layout & data) {
+
+                frameNumber = data.frameNumber;
+                auto expected = static_cast<uint8_t>(frameNumber);
+                valid = data.frameWidth == 4 && data.frameHeight == 2 && data.prgRamSize == 16;
+                for(size_t i = 0; i < 4 * 2 * 3; i++)
+                    valid = valid && data.frame[i] == expected;
+                for(size_t i = 0; i < SharedMemory::RAM_SIZE; i++)
+                    valid = valid && data.ram[i] == expected;
+                for(size_t i = 0; i < 16; i++)
+                    valid = valid && data.prgRam[i] == expected;
+                // The newest 100 samples belong to the last frame.
+                valid = valid && data.audioSampleCount >= 100;
+                for(size_t i = data.audioSampleCount - 100; valid && i < data.audioSampleCount; i++)
+                    valid = data.audio[i] == static_cast<float>(expected);
+            });
+
+            // Frame 0 = nothing published yet.
+            if(consistent && frameNumber > 0) {
+                if(!valid)
+                    return 1;
+                snapshots++;
+            }
+        }
+
+        return snapshots > 0 ? 0 : 5;
+    }
+}
+
+TEST(TestSharedMemoryExport, ReaderProcess) {
+
+    const std::string name = "/use-test-" + std::to_string(getpid());
+    const uint64_t lastFrame = 20000;
+
+    SharedMemoryExport exporter(name, 44100);
+
+    pid_t reader = fork();
+    ASSERT_GE(reader, 0);
+    if(reader == 0)
+        _exit(readerProcess(name, lastFrame));
+
+    std::vector<RGBPixel> pixels(4 * 2);
+    std::vector<uint8_t> ram(SharedMemory::RAM_SIZE), prgRam(16);
+
+    // Keep publishing until the reader is done, the writer never waits for it.
+    int status = 0;
+    for(uint64_t frame = 1; waitpid(reader, &status, WNOHANG) == 0; frame = std::min(frame + 1, lastFrame)) {
+
+        auto value = static_cast<uint8_t>(frame);
+        std::fill(pixels.begin(), pixels.end(), RGBPixel{value, value, value});
+        std::fill(ram.begin(), ram.end(), value);
+        std::fill(prgRam.begin(), prgRam.end(), value);
+        for(int i = 0; i < 100; i++)
+            exporter.pushAudioSample(value);
+
+        exporter.publish({.pixels = pixels.data(), .width = 4, .height = 2, .number = frame}, ram, prgRam);
+    }
+
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(TestSharedMemoryExport, ExistingRegion) {
+
+    const std::string name = "/use-test-existing-" + std::to_string(getpid());
+    SharedMemoryExport exporter(name, 44100);
+
+    // The second writer must not take over (and clear) the region of the first one.
+    EXPECT_THROW(SharedMemoryExport(name, 44100), std::runtime_error);
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    void * region = mmap(nullptr, sizeof(SharedMemory::Layout), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(region, MAP_FAILED);
+    EXPECT_EQ(static_cast<const SharedMemory::Layout *>(region)->magic, SharedMemory::MAGIC);
+    munmap(region, sizeof(SharedMemory::Layout));
+}
+
+#endif
+
+TEST(TestSharedMemoryExport, InvalidName) {
+    EXPECT_THROW(SharedMemoryExport("no-slash", 44100), std::invalid_argument);
+    EXPECT_THROW(SharedMemoryExport("/a/b", 44100), std::invalid_argument);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file TestStateHasher.cpp Test the streaming state hash.
+ * */
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "StateHasher.h"
+
+namespace {
+
+    uint64_t hash(std::span<const uint8_t> data) {
+        StateHasher hasher;
+        hasher.add(data);
+        return hasher.digest();
+    }
+}
+
+TEST(TestStateHasher, Streaming) {
+
+    std::vector<uint8_t> data(1000);
+    for(size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+
+    const uint64_t expected = hash(data);
+
+    // Any split gives the same hash, including splits inside a stripe.
+    for(size_t split : {size_t{1}, size_t{7}, size_t{31}, size_t{32}, size_t{33}, size_t{500}}) {
+        StateHasher hasher;
+        for(size_t offset = 0; offset < data.size(); offset += split)
+            hasher.add(std::span<const uint8_t>(data).subspan(offset, std::min(split, data.size() - offset)));
+        EXPECT_EQ(hasher.digest(), expected) << "Split: " << split;
+    }
+
+    // Digest doesn't end the hashing.
+    StateHasher hasher;
+    hasher.add(std::span<const uint8_t>(data).first(100));
+    (void)hasher.digest();
+    hasher.add(std::span<const uint8_t>(data).subspan(100));
+    EXPECT_EQ(hasher.digest(), expected);
+}
+
+TEST(TestStateHasher, Scalars) {
+
+    // Scalars are hashed as little-endian bytes.
+    StateHasher scalars;
+    scalars.add(uint16_t{0x1234});
+    scalars.add(true);
+    scalars.add(uint32_t{0xAABBCCDD});
+
+    std::vector<uint8_t> bytes = {0x34, 0x12, 0x01, 0xDD, 0xCC, 0xBB, 0xAA};
+    EXPECT_EQ(scalars.digest(), hash(bytes));
+
+    // The width matters.
+    StateHasher narrow, wide;
+    narrow.add(uint8_t{1});
+    wide.add(uint16_t{1});
+    EXPECT_NE(narrow.digest(), wide.digest());
+}
+
+TEST(TestStateHasher, Sensitivity) {
+
+    std::vector<uint8_t> data(4096, 0x00);
+    const uint64_t base = hash(data);
+    EXPECT_NE(base, hash(std::span<const uint8_t>(data).first(4095)));
+    EXPECT_NE(hash({}), hash(std::vector<uint8_t>(1, 0x00)));
+
+    // Every single bit flip changes the hash.
+    for(size_t offset : {size_t{0}, size_t{17}, size_t{2048}, size_t{4095}}) {
+        for(int bit = 0; bit < 8; bit++) {
+            data[offset] ^= 1 << bit;
+            EXPECT_NE(hash(data), base) << "Offset: " << offset << ", bit: " << bit;
+            data[offset] ^= 1 << bit;
+        }
+    }
+}
+
+TEST(TestStateHasher, PagedMemory) {
+
+    PagedMemory memory(PagedMemory::PAGE_SIZE * 2 + 100);
+    for(size_t i = 0; i < memory.size(); i++)
+        memory.write(i, static_cast<uint8_t>(i ^ (i >> 8)));
+
+    std::vector<uint8_t> contents(memory.size());
+    memory.copyTo(contents);
+
+    StateHasher hasher;
+    hasher.add(memory);
+    EXPECT_EQ(hasher.digest(), hash(contents));
+
+    // Shared pages hash the same.
+    PagedMemory copy = memory;
+    StateHasher copyHasher;
+    copyHasher.add(copy);
+    EXPECT_EQ(copyHasher.digest(), hasher.digest());
+}
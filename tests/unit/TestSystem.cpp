@@ -0,0 +1,26 @@
+/**
+ * @file TestSystem.cpp System base class tests.
+ * */
+
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "System.h"
+
+/**
+ * The optional features throw if the system doesn't implement them.
+ * */
+TEST(TestSystem, Unsupported) {
+
+    class Empty : public System {
+    public:
+        void doClocks(unsigned int) override {}
+        void doSteps(unsigned int) override {}
+        void doFrames(unsigned int) override {}
+        void doRun(unsigned int) override {}
+    } system;
+
+    EXPECT_THROW((void)system.fork(), std::logic_error);
+    EXPECT_THROW((void)system.computeStateHash(), std::logic_error);
+    EXPECT_THROW(system.setStateHashEnabled(true), std::logic_error);
+    EXPECT_NO_THROW(system.setStateHashEnabled(false));
+}
@@ -0,0 +1,66 @@
+/**
+ * @file TestTraceLogger.cpp CPU trace logger tests.
+ * */
+
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+#include "Test6502DUT.h"
+#include "components/TraceLogger.h"
+
+TEST(TestTraceLogger, Format) {
+
+    // $C000: JMP $C5F5; $C5F5: LDX #$00, STX $10, LDA ($80,X), LDA $0300,Y, *NOP $04, JMP ($02FF).
+    std::vector<uint8_t> memory(0x10000, 0x00);
+    const uint8_t jump[] = {0x4C, 0xF5, 0xC5};
+    const uint8_t program[] = {0xA2, 0x00, 0x86, 0x10, 0xA1, 0x80, 0xB9, 0x00, 0x03, 0x04, 0x04, 0x6C, 0xFF, 0x02};
+    std::copy(std::begin(jump), std::end(jump), memory.begin() + 0xC000);
+    std::copy(std::begin(program), std::end(program), memory.begin() + 0xC5F5);
+    memory[0x0080] = 0x00;
+    memory[0x0081] = 0x02;
+    memory[0x0200] = 0x5A;
+    memory[0x02FF] = 0x00;
+    memory[0x0300] = 0x80;
+
+    auto memCon = makeMemoryConnector(memory);
+
+    const char * tracePath = "trace_logger_test.log";
+    Test6502DUT cpu;
+    cpu.connect("mainBus", memCon);
+    cpu.init();
+    cpu.setProgramCounter(0xC000);
+    EXPECT_FALSE(cpu.isTracing());
+    cpu.startTrace(tracePath);
+    EXPECT_TRUE(cpu.isTracing());
+
+    for(int i = 0; i < 7; i++)
+        cpu.step();
+    cpu.stopTrace();
+    EXPECT_FALSE(cpu.isTracing());
+
+    std::ifstream trace(tracePath);
+    ASSERT_TRUE(trace) << "Can't open the trace!";
+    std::vector<std::string> lines;
+    for(std::string line; std::getline(trace, line);)
+        lines.push_back(line);
+    trace.close();
+    std::remove(tracePath);
+
+    ASSERT_EQ(lines.size(), 7);
+    EXPECT_EQ(lines[0], "C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD CYC:7");
+    EXPECT_EQ(lines[1], "C5F5  A2 00     LDX #$00                        A:00 X:00 Y:00 P:24 SP:FD CYC:10");
+    EXPECT_EQ(lines[2], "C5F7  86 10     STX $10 = 00                    A:00 X:00 Y:00 P:26 SP:FD CYC:12");
+    EXPECT_EQ(lines[3], "C5F9  A1 80     LDA ($80,X) @ 80 = 0200 = 5A    A:00 X:00 Y:00 P:26 SP:FD CYC:15");
+    EXPECT_EQ(lines[4], "C5FB  B9 00 03  LDA $0300,Y @ 0300 = 80         A:5A X:00 Y:00 P:24 SP:FD CYC:21");
+    EXPECT_EQ(lines[5], "C5FE  04 04    *NOP $04 = 00                    A:80 X:00 Y:00 P:A4 SP:FD CYC:25");
+    EXPECT_EQ(lines[6], "C600  6C FF 02  JMP ($02FF) = 5A00              A:80 X:00 Y:00 P:A4 SP:FD CYC:28");
+}
+
+TEST(TestTraceLogger, Errors) {
+
+    std::array<TraceLogger::Opcode, 256> opcodes{};
+    EXPECT_THROW(TraceLogger("trace_logger_test.log", opcodes, {}), std::invalid_argument);
+    EXPECT_THROW(TraceLogger("missing/trace.log", opcodes, [](uint16_t){ return uint8_t{0}; }), std::runtime_error);
+    EXPECT_TRUE(TraceLogger::isOfficial(0xEA));
+    EXPECT_FALSE(TraceLogger::isOfficial(0x04));
+}